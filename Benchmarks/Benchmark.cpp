@@ -0,0 +1,113 @@
+#include "Benchmark.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+
+namespace CDBTo3DTiles {
+
+// stops benchmarks that take nanoseconds from running forever to reach the minimum time
+static const size_t MAX_ITERATIONS = 100000;
+
+BenchmarkRunner::BenchmarkRunner(double minSeconds, size_t minIterations)
+    : m_minSeconds{minSeconds}
+    , m_minIterations{std::max<size_t>(minIterations, 1)}
+{}
+
+void BenchmarkRunner::add(const std::string &name, BenchmarkSetup setup)
+{
+    m_benchmarks.push_back({name, std::move(setup)});
+}
+
+std::vector<BenchmarkResult> BenchmarkRunner::run(const std::string &filter, std::ostream &log) const
+{
+    std::vector<BenchmarkResult> results;
+    for (const auto &benchmark : m_benchmarks) {
+        if (benchmark.name.find(filter) == std::string::npos) {
+            continue;
+        }
+
+        auto result = runBenchmark(benchmark);
+        auto flags = log.flags();
+        log << std::left << std::setw(40) << result.name << std::right << std::setw(8) << result.iterations
+            << " iterations " << std::scientific << std::setprecision(3) << std::setw(12)
+            << result.medianSeconds << " s " << std::setw(12)
+            << static_cast<double>(result.items) / result.medianSeconds << " items/s" << std::endl;
+        log.flags(flags);
+        results.emplace_back(std::move(result));
+    }
+
+    return results;
+}
+
+nlohmann::json BenchmarkRunner::convertResultsToJson(const std::vector<BenchmarkResult> &results)
+{
+    nlohmann::json resultsJson = nlohmann::json::array();
+    for (const auto &result : results) {
+        resultsJson.push_back({{"name", result.name},
+                               {"iterations", result.iterations},
+                               {"items", result.items},
+                               {"minSeconds", result.minSeconds},
+                               {"medianSeconds", result.medianSeconds},
+                               {"meanSeconds", result.meanSeconds},
+                               {"itemsPerSecond", static_cast<double>(result.items) / result.medianSeconds}});
+    }
+
+    return resultsJson;
+}
+
+void BenchmarkRunner::compareResults(const std::vector<BenchmarkResult> &results,
+                                     const nlohmann::json &baselineJson,
+                                     std::ostream &os)
+{
+    auto flags = os.flags();
+    os << std::fixed << std::setprecision(2);
+    for (const auto &result : results) {
+        auto baseline = std::find_if(baselineJson.begin(),
+                                     baselineJson.end(),
+                                     [&](const nlohmann::json &json) {
+                                         return json.value("name", "") == result.name;
+                                     });
+
+        if (baseline == baselineJson.end()) {
+            continue;
+        }
+
+        // compare throughput, so a benchmark that changed its input size is still comparable
+        double baselineThroughput = baseline->at("itemsPerSecond").get<double>();
+        double throughput = static_cast<double>(result.items) / result.medianSeconds;
+        os << std::left << std::setw(40) << result.name << std::right << std::setw(8)
+           << throughput / baselineThroughput << "x\n";
+    }
+
+    os.flags(flags);
+}
+
+BenchmarkResult BenchmarkRunner::runBenchmark(const Benchmark &benchmark) const
+{
+    BenchmarkWork work = benchmark.setup();
+
+    // the first run warms up caches and lazily initialized state and isn't timed
+    size_t items = work();
+
+    std::vector<double> seconds;
+    double totalSeconds = 0.0;
+    while ((seconds.size() < m_minIterations || totalSeconds < m_minSeconds)
+           && seconds.size() < MAX_ITERATIONS) {
+        auto start = std::chrono::steady_clock::now();
+        items = work();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        seconds.emplace_back(elapsed.count());
+        totalSeconds += elapsed.count();
+    }
+
+    std::sort(seconds.begin(), seconds.end());
+    BenchmarkResult result;
+    result.name = benchmark.name;
+    result.iterations = seconds.size();
+    result.items = items;
+    result.minSeconds = seconds.front();
+    result.medianSeconds = seconds[seconds.size() / 2];
+    result.meanSeconds = totalSeconds / static_cast<double>(seconds.size());
+    return result;
+}
+} // namespace CDBTo3DTiles
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "nlohmann/json.hpp"
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace CDBTo3DTiles {
+// Work of one benchmark iteration. Returns the number of items it processed, which gives the throughput
+using BenchmarkWork = std::function<size_t()>;
+
+// Prepares the inputs of a benchmark outside of the timing and returns the work to time
+using BenchmarkSetup = std::function<BenchmarkWork()>;
+
+struct BenchmarkResult
+{
+    std::string name;
+    size_t iterations;
+    size_t items;
+    double minSeconds;
+    double medianSeconds;
+    double meanSeconds;
+};
+
+class BenchmarkRunner
+{
+public:
+    // Every benchmark runs at least minIterations times and until it has been timed for minSeconds
+    BenchmarkRunner(double minSeconds, size_t minIterations);
+
+    void add(const std::string &name, BenchmarkSetup setup);
+
+    // Runs the benchmarks whose name contains the filter, and prints each result as it finishes
+    std::vector<BenchmarkResult> run(const std::string &filter, std::ostream &log) const;
+
+    static nlohmann::json convertResultsToJson(const std::vector<BenchmarkResult> &results);
+
+    // Prints how much faster each result is than the result of the same name in a previous report
+    static void compareResults(const std::vector<BenchmarkResult> &results,
+                               const nlohmann::json &baselineJson,
+                               std::ostream &os);
+
+private:
+    struct Benchmark
+    {
+        std::string name;
+        BenchmarkSetup setup;
+    };
+
+    BenchmarkResult runBenchmark(const Benchmark &benchmark) const;
+
+    double m_minSeconds;
+    size_t m_minIterations;
+    std::vector<Benchmark> m_benchmarks;
+};
+} // namespace CDBTo3DTiles
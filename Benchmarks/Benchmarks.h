@@ -0,0 +1,22 @@
+#pragma once
+
+#include "Benchmark.h"
+#include "SyntheticCDB.h"
+#include <filesystem>
+
+namespace CDBTo3DTiles {
+// Grid to mesh, simplification and b3dm writing of the deepest synthetic elevation tile
+void addElevationBenchmarks(BenchmarkRunner &runner, const SyntheticCDB &cdb);
+
+// Batched ellipsoid conversions, polygon triangulation, and reading synthetic vector tiles and attributes
+void addVectorBenchmarks(BenchmarkRunner &runner, const SyntheticCDB &cdb);
+
+// i3dm of synthetic GTFeature instances and tileset json of a full quadtree
+void addTileFormatBenchmarks(BenchmarkRunner &runner, const SyntheticCDB &cdb);
+
+// End to end conversion of every CDB under the test data and of the synthetic CDB, written to outputPath
+void addConvertBenchmarks(BenchmarkRunner &runner,
+                          const SyntheticCDB &cdb,
+                          const std::filesystem::path &testDataPath,
+                          const std::filesystem::path &outputPath);
+} // namespace CDBTo3DTiles
@@ -0,0 +1,66 @@
+#include "Benchmarks.h"
+#include "CDBTo3DTiles.h"
+#include <algorithm>
+
+namespace CDBTo3DTiles {
+
+static void addConvertBenchmark(BenchmarkRunner &runner,
+                                const std::string &name,
+                                const std::filesystem::path &CDBPath,
+                                const std::filesystem::path &outputPath);
+
+static size_t countFiles(const std::filesystem::path &directory);
+
+void addConvertBenchmarks(BenchmarkRunner &runner,
+                          const SyntheticCDB &cdb,
+                          const std::filesystem::path &testDataPath,
+                          const std::filesystem::path &outputPath)
+{
+    // every test data directory laid out as a CDB, in a fixed order so reports line up between runs
+    std::vector<std::filesystem::path> CDBPaths;
+    if (std::filesystem::exists(testDataPath)) {
+        for (const auto &entry : std::filesystem::directory_iterator(testDataPath)) {
+            if (std::filesystem::exists(entry.path() / "Tiles")) {
+                CDBPaths.emplace_back(entry.path());
+            }
+        }
+    }
+
+    std::sort(CDBPaths.begin(), CDBPaths.end());
+    for (const auto &CDBPath : CDBPaths) {
+        std::string name = CDBPath.filename().string();
+        addConvertBenchmark(runner, "convert/" + name, CDBPath, outputPath / name);
+    }
+
+    addConvertBenchmark(runner, "convert/synthetic", cdb.getPath(), outputPath / "synthetic");
+}
+
+void addConvertBenchmark(BenchmarkRunner &runner,
+                         const std::string &name,
+                         const std::filesystem::path &CDBPath,
+                         const std::filesystem::path &outputPath)
+{
+    runner.add(name, [CDBPath, outputPath]() -> BenchmarkWork {
+        size_t fileCount = countFiles(CDBPath);
+        return [CDBPath, outputPath, fileCount]() {
+            // start every iteration from an empty output, the converter skips nothing then
+            std::filesystem::remove_all(outputPath);
+            Converter converter(CDBPath, outputPath);
+            converter.convert();
+            return fileCount;
+        };
+    });
+}
+
+size_t countFiles(const std::filesystem::path &directory)
+{
+    size_t fileCount = 0;
+    for (const auto &entry : std::filesystem::recursive_directory_iterator(directory)) {
+        if (entry.is_regular_file()) {
+            ++fileCount;
+        }
+    }
+
+    return fileCount;
+}
+} // namespace CDBTo3DTiles
@@ -0,0 +1,68 @@
+#include "Benchmarks.h"
+#include "CDBElevation.h"
+#include "Gltf.h"
+#include "TileFormatIO.h"
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+namespace CDBTo3DTiles {
+
+// same fractions of indices and error as the converter defaults
+static const float TARGET_INDEX_FRACTION = 0.3f;
+static const float TARGET_ERROR = 0.01f;
+
+static std::shared_ptr<const CDBElevation> loadElevation(const std::filesystem::path &path);
+
+static Mesh simplifyElevation(const CDBElevation &elevation);
+
+void addElevationBenchmarks(BenchmarkRunner &runner, const SyntheticCDB &cdb)
+{
+    CDBTile tile(cdb.getGeoCell(0), CDBDataset::Elevation, 1, 1, cdb.getOptions().maxLevel, 0, 0);
+    auto elevationPath = cdb.getTilePath(tile, ".tif");
+
+    // decodes the raster and builds the uniform grid mesh, the way the converter reads every elevation tile
+    runner.add("elevation/gridToMesh", [elevationPath]() -> BenchmarkWork {
+        return [elevationPath]() {
+            auto elevation = loadElevation(elevationPath);
+            return elevation->getUniformGridMesh().positions.size();
+        };
+    });
+
+    runner.add("elevation/simplify", [elevationPath]() -> BenchmarkWork {
+        auto elevation = loadElevation(elevationPath);
+        return [elevation]() {
+            simplifyElevation(*elevation);
+            return elevation->getUniformGridMesh().indices.size() / 3;
+        };
+    });
+
+    runner.add("elevation/gltfB3dm", [elevationPath]() -> BenchmarkWork {
+        auto simplified = std::make_shared<const Mesh>(simplifyElevation(*loadElevation(elevationPath)));
+        return [simplified]() {
+            tinygltf::Model gltf = createGltf(*simplified, nullptr, nullptr);
+            std::ostringstream ss;
+            writeToB3DM(&gltf, nullptr, ss);
+            return simplified->indices.size() / 3;
+        };
+    });
+}
+
+std::shared_ptr<const CDBElevation> loadElevation(const std::filesystem::path &path)
+{
+    auto elevation = CDBElevation::createFromFile(path);
+    if (!elevation) {
+        throw std::runtime_error("Cannot read elevation " + path.string());
+    }
+
+    return std::make_shared<const CDBElevation>(std::move(*elevation));
+}
+
+Mesh simplifyElevation(const CDBElevation &elevation)
+{
+    const auto &mesh = elevation.getUniformGridMesh();
+    auto targetIndexCount = static_cast<size_t>(static_cast<float>(mesh.indices.size())
+                                                * TARGET_INDEX_FRACTION);
+    return elevation.createSimplifiedMesh(targetIndexCount, TARGET_ERROR);
+}
+} // namespace CDBTo3DTiles
@@ -0,0 +1,631 @@
+#include "SyntheticCDB.h"
+#include "ArchiveWriter.h"
+#include "CDB.h"
+#include "CDBAttributes.h"
+#include "MathHelpers.h"
+#include "Utility.h"
+#include "glm/glm.hpp"
+#include "nlohmann/json.hpp"
+#include "ogrsf_frmts.h"
+#include "osg/Geode"
+#include "osg/Geometry"
+#include "osgDB/WriteFile"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+
+namespace CDBTo3DTiles {
+
+// GeoCells per row of latitude before the layout wraps northwards
+static const int GEOCELLS_PER_ROW = 8;
+
+const int SyntheticCDB::ROAD_NETWORK_CS_1 = 2;
+const int SyntheticCDB::HYDROGRAPHY_NETWORK_CS_1 = 2;
+const int SyntheticCDB::GTFEATURE_CS_1 = 1;
+const int SyntheticCDB::GSFEATURE_CS_1 = 1;
+const std::string SyntheticCDB::OPTIONS_FILENAME = "SyntheticCDB.json";
+
+// every model instance is a building, so all models live in one feature code directory
+static const std::string MODEL_FACC = "AL015";
+static const int MODEL_FSC = 0;
+
+static void forEachTileOfLevel(const CDBGeoCell &geoCell,
+                               CDBDataset dataset,
+                               int CS_1,
+                               int CS_2,
+                               int level,
+                               std::function<void(const CDBTile &)> process);
+
+static double computeTerrainHeight(double longitude, double latitude);
+
+static std::array<double, 6> computeGeoTransform(const CDBTile &tile, int rasterSize);
+
+static void setGeoreference(GDALDataset &dataset, const std::array<double, 6> &geoTransform);
+
+static std::string getModelName(int model);
+
+static osg::ref_ptr<osg::Geode> createBox(double width, double depth, double height);
+
+static GDALDatasetUniquePtr createShapefile(const std::filesystem::path &shapefilePath,
+                                            OGRwkbGeometryType geometryType,
+                                            OGRLayer *&layer);
+
+static void addFields(OGRLayer &layer);
+
+static void setFields(OGRFeature &feature, const CDBTile &tile, int featureIndex);
+
+SyntheticCDB::SyntheticCDB(const std::filesystem::path &CDBPath, const SyntheticCDBOptions &options)
+    : m_CDBPath{CDBPath}
+    , m_options{options}
+    , m_random{options.seed}
+{}
+
+void SyntheticCDB::write()
+{
+    if (m_options.modelCount < 1) {
+        throw std::runtime_error("A synthetic CDB needs at least one model for its features");
+    }
+
+    m_random.seed(m_options.seed);
+    writeOptions();
+    encodeModels();
+    writeGTModels();
+    for (int i = 0; i < m_options.geoCellCount; ++i) {
+        CDBGeoCell geoCell = getGeoCell(i);
+        for (int level = -10; level <= m_options.maxLevel; ++level) {
+            forEachTileOfLevel(geoCell, CDBDataset::Elevation, 1, 1, level, [&](const CDBTile &tile) {
+                writeElevation(tile);
+            });
+
+            if (m_options.imageryTileSize > 0) {
+                forEachTileOfLevel(geoCell, CDBDataset::Imagery, 1, 1, level, [&](const CDBTile &tile) {
+                    writeImagery(tile);
+                });
+            }
+        }
+
+        forEachTileOfLevel(geoCell,
+                           CDBDataset::RoadNetwork,
+                           ROAD_NETWORK_CS_1,
+                           static_cast<int>(CDBVectorCS2::LinealFeature),
+                           m_options.maxLevel,
+                           [&](const CDBTile &tile) { writeLines(tile); });
+
+        forEachTileOfLevel(geoCell,
+                           CDBDataset::HydrographyNetwork,
+                           HYDROGRAPHY_NETWORK_CS_1,
+                           static_cast<int>(CDBVectorCS2::PolygonFeature),
+                           m_options.maxLevel,
+                           [&](const CDBTile &tile) { writePolygons(tile); });
+
+        forEachTileOfLevel(geoCell,
+                           CDBDataset::GTFeature,
+                           GTFEATURE_CS_1,
+                           static_cast<int>(CDBVectorCS2::PointFeature),
+                           m_options.maxLevel,
+                           [&](const CDBTile &tile) { writePoints(tile, m_options.pointsPerTile); });
+
+        forEachTileOfLevel(geoCell,
+                           CDBDataset::GSFeature,
+                           GSFEATURE_CS_1,
+                           static_cast<int>(CDBVectorCS2::PointFeature),
+                           m_options.maxLevel,
+                           [&](const CDBTile &tile) {
+                               writePoints(tile, m_options.GSFeaturesPerTile);
+                               writeGSModels(tile);
+                           });
+    }
+}
+
+CDBGeoCell SyntheticCDB::getGeoCell(int geoCell) const
+{
+    int latitude = m_options.firstLatitude + geoCell / GEOCELLS_PER_ROW;
+    int longitudeExtent = CDBGeoCell(latitude, m_options.firstLongitude).getLongitudeExtentInDegree();
+    int longitude = m_options.firstLongitude + (geoCell % GEOCELLS_PER_ROW) * longitudeExtent;
+    return CDBGeoCell(latitude, longitude);
+}
+
+std::filesystem::path SyntheticCDB::getTilePath(const CDBTile &tile, const std::string &extension) const
+{
+    return m_CDBPath / (tile.getRelativePath().string() + extension);
+}
+
+SyntheticCDBOptions SyntheticCDB::createOptions(const std::string &scale)
+{
+    SyntheticCDBOptions options;
+    if (scale == "small") {
+        return options;
+    }
+
+    if (scale == "medium") {
+        options.geoCellCount = 2;
+        options.maxLevel = 3;
+        options.elevationGridSize = 256;
+        options.imageryTileSize = 512;
+        options.polygonsPerTile = 1000;
+        options.linesPerTile = 1000;
+        options.pointsPerTile = 1000;
+        options.GSFeaturesPerTile = 1000;
+        options.modelCount = 32;
+        return options;
+    }
+
+    if (scale == "large") {
+        options.geoCellCount = 4;
+        options.maxLevel = 4;
+        options.elevationGridSize = 512;
+        options.imageryTileSize = 1024;
+        options.polygonsPerTile = 10000;
+        options.linesPerTile = 10000;
+        options.pointsPerTile = 10000;
+        options.GSFeaturesPerTile = 10000;
+        options.modelCount = 64;
+        return options;
+    }
+
+    throw std::runtime_error("Unknown synthetic CDB scale " + scale + ". Use small, medium or large");
+}
+
+std::optional<SyntheticCDB> SyntheticCDB::createFromDirectory(const std::filesystem::path &CDBPath)
+{
+    std::ifstream fs(CDBPath / OPTIONS_FILENAME);
+    if (!fs) {
+        return std::nullopt;
+    }
+
+    nlohmann::json optionsJson = nlohmann::json::parse(fs, nullptr, false);
+    if (optionsJson.is_discarded() || !optionsJson.is_object()) {
+        return std::nullopt;
+    }
+
+    // options missing from the file keep their defaults, so older CDBs still open
+    SyntheticCDBOptions options;
+    options.firstLatitude = optionsJson.value("firstLatitude", options.firstLatitude);
+    options.firstLongitude = optionsJson.value("firstLongitude", options.firstLongitude);
+    options.geoCellCount = optionsJson.value("geoCellCount", options.geoCellCount);
+    options.maxLevel = optionsJson.value("maxLevel", options.maxLevel);
+    options.elevationGridSize = optionsJson.value("elevationGridSize", options.elevationGridSize);
+    options.imageryTileSize = optionsJson.value("imageryTileSize", options.imageryTileSize);
+    options.polygonsPerTile = optionsJson.value("polygonsPerTile", options.polygonsPerTile);
+    options.polygonVertexCount = optionsJson.value("polygonVertexCount", options.polygonVertexCount);
+    options.linesPerTile = optionsJson.value("linesPerTile", options.linesPerTile);
+    options.lineVertexCount = optionsJson.value("lineVertexCount", options.lineVertexCount);
+    options.pointsPerTile = optionsJson.value("pointsPerTile", options.pointsPerTile);
+    options.GSFeaturesPerTile = optionsJson.value("GSFeaturesPerTile", options.GSFeaturesPerTile);
+    options.modelCount = optionsJson.value("modelCount", options.modelCount);
+    options.seed = optionsJson.value("seed", options.seed);
+    return SyntheticCDB(CDBPath, options);
+}
+
+void SyntheticCDB::writeOptions() const
+{
+    nlohmann::json optionsJson = {{"firstLatitude", m_options.firstLatitude},
+                                  {"firstLongitude", m_options.firstLongitude},
+                                  {"geoCellCount", m_options.geoCellCount},
+                                  {"maxLevel", m_options.maxLevel},
+                                  {"elevationGridSize", m_options.elevationGridSize},
+                                  {"imageryTileSize", m_options.imageryTileSize},
+                                  {"polygonsPerTile", m_options.polygonsPerTile},
+                                  {"polygonVertexCount", m_options.polygonVertexCount},
+                                  {"linesPerTile", m_options.linesPerTile},
+                                  {"lineVertexCount", m_options.lineVertexCount},
+                                  {"pointsPerTile", m_options.pointsPerTile},
+                                  {"GSFeaturesPerTile", m_options.GSFeaturesPerTile},
+                                  {"modelCount", m_options.modelCount},
+                                  {"seed", m_options.seed}};
+
+    std::filesystem::create_directories(m_CDBPath);
+    std::ofstream fs(m_CDBPath / OPTIONS_FILENAME);
+    fs << optionsJson.dump(4);
+}
+
+void SyntheticCDB::writeElevation(const CDBTile &tile)
+{
+    // negative levels halve the resolution per level like a real CDB, down to a few pixels
+    int gridSize = m_options.elevationGridSize;
+    if (tile.getLevel() < 0) {
+        gridSize = std::max(gridSize >> -tile.getLevel(), 2);
+    }
+
+    auto path = getTilePath(tile, ".tif");
+    std::filesystem::create_directories(path.parent_path());
+    auto driver = GetGDALDriverManager()->GetDriverByName("GTiff");
+    GDALDatasetUniquePtr dataset(
+        driver->Create(path.string().c_str(), gridSize, gridSize, 1, GDT_Float32, nullptr));
+    if (!dataset) {
+        throw std::runtime_error("Cannot create " + path.string());
+    }
+
+    auto geoTransform = computeGeoTransform(tile, gridSize);
+    setGeoreference(*dataset, geoTransform);
+
+    // heights depend on the position only, so neighbouring tiles and levels agree at their borders
+    std::vector<float> heights(static_cast<size_t>(gridSize * gridSize));
+    for (int y = 0; y < gridSize; ++y) {
+        for (int x = 0; x < gridSize; ++x) {
+            double longitude = geoTransform[0] + (x + 0.5) * geoTransform[1];
+            double latitude = geoTransform[3] + (y + 0.5) * geoTransform[5];
+            heights[static_cast<size_t>(y * gridSize + x)] = static_cast<float>(
+                computeTerrainHeight(longitude, latitude));
+        }
+    }
+
+    auto error = dataset->GetRasterBand(1)->RasterIO(
+        GF_Write, 0, 0, gridSize, gridSize, heights.data(), gridSize, gridSize, GDT_Float32, 0, 0, nullptr);
+    if (error != CE_None) {
+        throw std::runtime_error("Cannot write " + path.string());
+    }
+}
+
+void SyntheticCDB::writeLines(const CDBTile &tile)
+{
+    OGRLayer *layer = nullptr;
+    auto dataset = createShapefile(getTilePath(tile, ".shp"), wkbLineString, layer);
+    addFields(*layer);
+
+    const auto &rectangle = tile.getBoundRegion().getRectangle();
+    double west = glm::degrees(rectangle.getWest());
+    double south = glm::degrees(rectangle.getSouth());
+    double width = glm::degrees(rectangle.computeWidth());
+    double height = glm::degrees(rectangle.computeHeight());
+    double step = std::min(width, height) / 64.0;
+    for (int i = 0; i < m_options.linesPerTile; ++i) {
+        // random walks that stay inside the tile
+        double x = west + random() * width;
+        double y = south + random() * height;
+        OGRLineString line;
+        for (int vertex = 0; vertex < m_options.lineVertexCount; ++vertex) {
+            line.addPoint(x, y);
+            x = std::clamp(x + (random() - 0.5) * step, west, west + width);
+            y = std::clamp(y + (random() - 0.5) * step, south, south + height);
+        }
+
+        OGRFeatureUniquePtr feature(OGRFeature::CreateFeature(layer->GetLayerDefn()));
+        setFields(*feature, tile, i);
+        feature->SetGeometry(&line);
+        layer->CreateFeature(feature.get());
+    }
+}
+
+void SyntheticCDB::writePolygons(const CDBTile &tile)
+{
+    OGRLayer *layer = nullptr;
+    auto dataset = createShapefile(getTilePath(tile, ".shp"), wkbPolygon, layer);
+    addFields(*layer);
+
+    const auto &rectangle = tile.getBoundRegion().getRectangle();
+    double west = glm::degrees(rectangle.getWest());
+    double south = glm::degrees(rectangle.getSouth());
+    double width = glm::degrees(rectangle.computeWidth());
+    double height = glm::degrees(rectangle.computeHeight());
+    double maxRadius = std::min(width, height) / 32.0;
+    for (int i = 0; i < m_options.polygonsPerTile; ++i) {
+        // star shaped rings around a center never intersect themselves, but are concave like real lakes
+        double centerX = west + maxRadius + random() * (width - 2.0 * maxRadius);
+        double centerY = south + maxRadius + random() * (height - 2.0 * maxRadius);
+        OGRLinearRing ring;
+        for (int vertex = 0; vertex < m_options.polygonVertexCount; ++vertex) {
+            double angle = Core::Math::TWO_PI * vertex / m_options.polygonVertexCount;
+            double radius = maxRadius * (0.5 + 0.5 * random());
+            ring.addPoint(centerX + radius * std::cos(angle), centerY + radius * std::sin(angle));
+        }
+
+        ring.closeRings();
+        OGRPolygon polygon;
+        polygon.addRing(&ring);
+
+        OGRFeatureUniquePtr feature(OGRFeature::CreateFeature(layer->GetLayerDefn()));
+        setFields(*feature, tile, i);
+        feature->SetGeometry(&polygon);
+        layer->CreateFeature(feature.get());
+    }
+}
+
+void SyntheticCDB::writeImagery(const CDBTile &tile)
+{
+    int imageSize = m_options.imageryTileSize;
+    if (tile.getLevel() < 0) {
+        imageSize = std::max(imageSize >> -tile.getLevel(), 2);
+    }
+
+    // the JPEG 2000 drivers only copy, so the pixels are written to memory first
+    auto memoryDriver = GetGDALDriverManager()->GetDriverByName("MEM");
+    GDALDatasetUniquePtr memoryDataset(
+        memoryDriver->Create("", imageSize, imageSize, 3, GDT_Byte, nullptr));
+    if (!memoryDataset) {
+        throw std::runtime_error("Cannot create imagery of " + tile.getRelativePath().string());
+    }
+
+    auto geoTransform = computeGeoTransform(tile, imageSize);
+    setGeoreference(*memoryDataset, geoTransform);
+
+    // a ramp of colors over the terrain height, so imagery lines up with elevation like real photography
+    auto pixelCount = static_cast<size_t>(imageSize * imageSize);
+    std::vector<uint8_t> pixels(3 * pixelCount);
+    for (int y = 0; y < imageSize; ++y) {
+        for (int x = 0; x < imageSize; ++x) {
+            double longitude = geoTransform[0] + (x + 0.5) * geoTransform[1];
+            double latitude = geoTransform[3] + (y + 0.5) * geoTransform[5];
+            double shade = std::clamp((computeTerrainHeight(longitude, latitude) - 80.0) / 440.0, 0.0, 1.0);
+            auto pixel = static_cast<size_t>(y * imageSize + x);
+            pixels[pixel] = static_cast<uint8_t>(60.0 + 120.0 * shade);
+            pixels[pixelCount + pixel] = static_cast<uint8_t>(110.0 + 60.0 * shade);
+            pixels[2 * pixelCount + pixel] = static_cast<uint8_t>(50.0 + 40.0 * shade);
+        }
+    }
+
+    auto path = getTilePath(tile, ".jp2");
+    auto error = memoryDataset->RasterIO(GF_Write,
+                                         0,
+                                         0,
+                                         imageSize,
+                                         imageSize,
+                                         pixels.data(),
+                                         imageSize,
+                                         imageSize,
+                                         GDT_Byte,
+                                         3,
+                                         nullptr,
+                                         0,
+                                         0,
+                                         0,
+                                         nullptr);
+    if (error != CE_None) {
+        throw std::runtime_error("Cannot write " + path.string());
+    }
+
+    auto driver = GetGDALDriverManager()->GetDriverByName("JP2OpenJPEG");
+    if (!driver) {
+        throw std::runtime_error("Writing synthetic imagery needs the JP2OpenJPEG driver of GDAL");
+    }
+
+    std::filesystem::create_directories(path.parent_path());
+    GDALDatasetUniquePtr dataset(
+        driver->CreateCopy(path.string().c_str(), memoryDataset.get(), FALSE, nullptr, nullptr, nullptr));
+    if (!dataset) {
+        throw std::runtime_error("Cannot create " + path.string());
+    }
+}
+
+void SyntheticCDB::writePoints(const CDBTile &tile, int pointCount)
+{
+    OGRLayer *layer = nullptr;
+    auto dataset = createShapefile(getTilePath(tile, ".shp"), wkbPoint25D, layer);
+    addFields(*layer);
+
+    // the attributes the converter places and scales model instances with
+    for (const char *field : {"AO1", "SCALx", "SCALy", "SCALz"}) {
+        OGRFieldDefn fieldDefinition(field, OFTReal);
+        layer->CreateField(&fieldDefinition);
+    }
+
+    OGRFieldDefn modelDefinition("MODL", OFTString);
+    modelDefinition.SetWidth(32);
+    layer->CreateField(&modelDefinition);
+
+    const auto &rectangle = tile.getBoundRegion().getRectangle();
+    double west = glm::degrees(rectangle.getWest());
+    double south = glm::degrees(rectangle.getSouth());
+    double width = glm::degrees(rectangle.computeWidth());
+    double height = glm::degrees(rectangle.computeHeight());
+    for (int i = 0; i < pointCount; ++i) {
+        double longitude = west + random() * width;
+        double latitude = south + random() * height;
+        OGRPoint point(longitude, latitude, computeTerrainHeight(longitude, latitude));
+
+        OGRFeatureUniquePtr feature(OGRFeature::CreateFeature(layer->GetLayerDefn()));
+        setFields(*feature, tile, i);
+        double scale = 0.5 + random();
+        feature->SetField("FACC", MODEL_FACC.c_str());
+        feature->SetField("FSC", MODEL_FSC);
+        feature->SetField("AO1", random() * 360.0);
+        feature->SetField("SCALx", scale);
+        feature->SetField("SCALy", scale);
+        feature->SetField("SCALz", scale);
+        feature->SetField("MODL", getModelName(i % m_options.modelCount).c_str());
+        feature->SetGeometry(&point);
+        layer->CreateFeature(feature.get());
+    }
+}
+
+void SyntheticCDB::writeGTModels()
+{
+    // the converter finds GTModels by the first letters of the category directories and the feature code
+    auto directory = m_CDBPath / CDB::GTModel / getCDBDatasetDirectoryName(CDBDataset::GTModelGeometry_500)
+                     / "A_Culture" / "L_Misc_Feature" / "015_Building";
+    std::filesystem::create_directories(directory);
+    for (size_t i = 0; i < m_models.size(); ++i) {
+        auto filename = "D500_S001_T001_" + MODEL_FACC + "_" + toStringWithZeroPadding(3, MODEL_FSC) + "_"
+                        + getModelName(static_cast<int>(i)) + ".flt";
+        std::ofstream fs(directory / filename, std::ios::binary);
+        fs.write(m_models[i].data(), static_cast<std::streamsize>(m_models[i].size()));
+        if (!fs) {
+            throw std::runtime_error("Cannot write " + (directory / filename).string());
+        }
+    }
+}
+
+void SyntheticCDB::writeGSModels(const CDBTile &tile)
+{
+    // a zip per tile holding a copy of every model, named after the tile the way the converter looks them up
+    CDBTile modelTile(tile.getGeoCell(),
+                      CDBDataset::GSModelGeometry,
+                      1,
+                      1,
+                      tile.getLevel(),
+                      tile.getUREF(),
+                      tile.getRREF());
+    std::string tileFilename = modelTile.getRelativePath().filename().string();
+    ArchiveWriter archive(getTilePath(modelTile, ".zip"));
+    for (size_t i = 0; i < m_models.size(); ++i) {
+        auto filename = tileFilename + "_" + MODEL_FACC + "_" + toStringWithZeroPadding(3, MODEL_FSC) + "_"
+                        + getModelName(static_cast<int>(i)) + ".flt";
+        archive.addFile(filename, m_models[i].data(), m_models[i].size());
+    }
+
+    archive.close();
+}
+
+void SyntheticCDB::encodeModels()
+{
+    // buildings of different sizes, encoded once and copied for GTModels and into every GSModel zip
+    m_models.clear();
+    std::filesystem::create_directories(m_CDBPath);
+    auto modelPath = m_CDBPath / "SyntheticModel.flt";
+    for (int i = 0; i < m_options.modelCount; ++i) {
+        double width = 5.0 + 20.0 * random();
+        double depth = 5.0 + 20.0 * random();
+        double height = 5.0 + 45.0 * random();
+        if (!osgDB::writeNodeFile(*createBox(width, depth, height), modelPath.string())) {
+            throw std::runtime_error("Cannot write " + modelPath.string());
+        }
+
+        std::ifstream fs(modelPath, std::ios::binary);
+        m_models.emplace_back(std::istreambuf_iterator<char>(fs), std::istreambuf_iterator<char>());
+    }
+
+    std::filesystem::remove(modelPath);
+}
+
+double SyntheticCDB::random()
+{
+    return static_cast<double>(m_random()) / 4294967296.0;
+}
+
+void forEachTileOfLevel(const CDBGeoCell &geoCell,
+                        CDBDataset dataset,
+                        int CS_1,
+                        int CS_2,
+                        int level,
+                        std::function<void(const CDBTile &)> process)
+{
+    // every negative level is a single tile covering the GeoCell
+    int tileCount = level > 0 ? 1 << level : 1;
+    for (int UREF = 0; UREF < tileCount; ++UREF) {
+        for (int RREF = 0; RREF < tileCount; ++RREF) {
+            process(CDBTile(geoCell, dataset, CS_1, CS_2, level, UREF, RREF));
+        }
+    }
+}
+
+double computeTerrainHeight(double longitude, double latitude)
+{
+    // rolling hills over a few kilometers on top of ridges over tens of kilometers
+    return 300.0 + 200.0 * std::sin(longitude * 7.0) * std::cos(latitude * 5.0)
+           + 20.0 * std::sin(longitude * 211.0) * std::sin(latitude * 173.0);
+}
+
+std::array<double, 6> computeGeoTransform(const CDBTile &tile, int rasterSize)
+{
+    const auto &rectangle = tile.getBoundRegion().getRectangle();
+    double west = glm::degrees(rectangle.getWest());
+    double north = glm::degrees(rectangle.getNorth());
+    double pixelWidth = glm::degrees(rectangle.computeWidth()) / rasterSize;
+    double pixelHeight = glm::degrees(rectangle.computeHeight()) / rasterSize;
+    return {west, pixelWidth, 0.0, north, 0.0, -pixelHeight};
+}
+
+void setGeoreference(GDALDataset &dataset, const std::array<double, 6> &geoTransform)
+{
+    auto transform = geoTransform;
+    dataset.SetGeoTransform(transform.data());
+
+    OGRSpatialReference spatialReference;
+    spatialReference.SetWellKnownGeogCS("WGS84");
+    dataset.SetSpatialRef(&spatialReference);
+}
+
+std::string getModelName(int model)
+{
+    return "synthetic_" + std::to_string(model);
+}
+
+osg::ref_ptr<osg::Geode> createBox(double width, double depth, double height)
+{
+    auto x = static_cast<float>(width / 2.0);
+    auto y = static_cast<float>(depth / 2.0);
+    auto z = static_cast<float>(height);
+    osg::ref_ptr<osg::Vec3Array> vertices = new osg::Vec3Array();
+    vertices->push_back(osg::Vec3(-x, -y, 0.0f));
+    vertices->push_back(osg::Vec3(x, -y, 0.0f));
+    vertices->push_back(osg::Vec3(x, y, 0.0f));
+    vertices->push_back(osg::Vec3(-x, y, 0.0f));
+    vertices->push_back(osg::Vec3(-x, -y, z));
+    vertices->push_back(osg::Vec3(x, -y, z));
+    vertices->push_back(osg::Vec3(x, y, z));
+    vertices->push_back(osg::Vec3(-x, y, z));
+
+    // counter clockwise seen from outside: bottom, top, south, east, north and west
+    static const GLushort indices[] = {0, 2, 1, 0, 3, 2, 4, 5, 6, 4, 6, 7, 0, 1, 5, 0, 5, 4,
+                                       1, 2, 6, 1, 6, 5, 2, 3, 7, 2, 7, 6, 3, 0, 4, 3, 4, 7};
+
+    osg::ref_ptr<osg::Vec4Array> colors = new osg::Vec4Array();
+    colors->push_back(osg::Vec4(0.8f, 0.75f, 0.7f, 1.0f));
+
+    osg::ref_ptr<osg::Geometry> geometry = new osg::Geometry();
+    geometry->setVertexArray(vertices);
+    geometry->setColorArray(colors, osg::Array::BIND_OVERALL);
+    geometry->addPrimitiveSet(
+        new osg::DrawElementsUShort(GL_TRIANGLES, static_cast<unsigned>(std::size(indices)), indices));
+
+    osg::ref_ptr<osg::Geode> geode = new osg::Geode();
+    geode->addDrawable(geometry);
+    return geode;
+}
+
+GDALDatasetUniquePtr createShapefile(const std::filesystem::path &shapefilePath,
+                                     OGRwkbGeometryType geometryType,
+                                     OGRLayer *&layer)
+{
+    std::filesystem::create_directories(shapefilePath.parent_path());
+    auto driver = GetGDALDriverManager()->GetDriverByName("ESRI Shapefile");
+    GDALDatasetUniquePtr dataset(
+        driver->Create(shapefilePath.string().c_str(), 0, 0, 0, GDT_Unknown, nullptr));
+    if (!dataset) {
+        throw std::runtime_error("Cannot create " + shapefilePath.string());
+    }
+
+    OGRSpatialReference spatialReference;
+    spatialReference.SetWellKnownGeogCS("WGS84");
+    layer = dataset->CreateLayer(shapefilePath.stem().string().c_str(),
+                                 &spatialReference,
+                                 geometryType,
+                                 nullptr);
+    if (!layer) {
+        throw std::runtime_error("Cannot create layer of " + shapefilePath.string());
+    }
+
+    return dataset;
+}
+
+void addFields(OGRLayer &layer)
+{
+    OGRFieldDefn CNAMDefinition("CNAM", OFTString);
+    CNAMDefinition.SetWidth(32);
+    layer.CreateField(&CNAMDefinition);
+
+    OGRFieldDefn FACCDefinition("FACC", OFTString);
+    FACCDefinition.SetWidth(5);
+    layer.CreateField(&FACCDefinition);
+
+    OGRFieldDefn FSCDefinition("FSC", OFTInteger);
+    layer.CreateField(&FSCDefinition);
+
+    OGRFieldDefn WIDDefinition("WID", OFTReal);
+    layer.CreateField(&WIDDefinition);
+}
+
+void setFields(OGRFeature &feature, const CDBTile &tile, int featureIndex)
+{
+    // class names repeat, like the few classes a real tile has many instances of
+    std::string CNAM = "CN" + std::to_string(tile.getLevel()) + "_" + std::to_string(featureIndex % 16);
+    feature.SetField("CNAM", CNAM.c_str());
+    feature.SetField("FACC", "AL015");
+    feature.SetField("FSC", featureIndex % 4);
+    feature.SetField("WID", 1.0 + featureIndex % 10);
+}
+} // namespace CDBTo3DTiles
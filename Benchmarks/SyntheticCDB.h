@@ -0,0 +1,95 @@
+#pragma once
+
+#include "CDBTile.h"
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace CDBTo3DTiles {
+struct SyntheticCDBOptions
+{
+    // GeoCells are laid out eastwards from the first one, wrapping to the next row of latitude
+    int firstLatitude = 32;
+    int firstLongitude = -119;
+    int geoCellCount = 1;
+
+    // elevation and imagery are written for every level from -10 to maxLevel, vectors and features at
+    // maxLevel only
+    int maxLevel = 1;
+    int elevationGridSize = 64;
+    int imageryTileSize = 256;
+    int polygonsPerTile = 100;
+    int polygonVertexCount = 16;
+    int linesPerTile = 100;
+    int lineVertexCount = 16;
+    int pointsPerTile = 100;
+    int GSFeaturesPerTile = 100;
+
+    // GTFeature and GSFeature instances are spread over this many distinct models, so fewer models means
+    // more instances share each model
+    int modelCount = 8;
+    uint32_t seed = 1;
+};
+
+// Writes a structurally valid CDB of any size with elevation rasters, JPEG 2000 imagery, road network lines,
+// hydrography polygons, GTFeature points with their OpenFlight GTModels, and GSFeature points with zipped
+// OpenFlight GSModels. The same options and seed always give the same files, so benchmark runs on different
+// machines convert the same input
+class SyntheticCDB
+{
+public:
+    SyntheticCDB(const std::filesystem::path &CDBPath, const SyntheticCDBOptions &options);
+
+    void write();
+
+    inline const std::filesystem::path &getPath() const noexcept { return m_CDBPath; }
+
+    inline const SyntheticCDBOptions &getOptions() const noexcept { return m_options; }
+
+    CDBGeoCell getGeoCell(int geoCell) const;
+
+    std::filesystem::path getTilePath(const CDBTile &tile, const std::string &extension) const;
+
+    static SyntheticCDBOptions createOptions(const std::string &scale);
+
+    // Opens a CDB written by write(), which saves its options next to the tiles
+    static std::optional<SyntheticCDB> createFromDirectory(const std::filesystem::path &CDBPath);
+
+    static const int ROAD_NETWORK_CS_1;
+    static const int HYDROGRAPHY_NETWORK_CS_1;
+    static const int GTFEATURE_CS_1;
+    static const int GSFEATURE_CS_1;
+    static const std::string OPTIONS_FILENAME;
+
+private:
+    void writeOptions() const;
+
+    void writeElevation(const CDBTile &tile);
+
+    void writeLines(const CDBTile &tile);
+
+    void writePolygons(const CDBTile &tile);
+
+    void writeImagery(const CDBTile &tile);
+
+    void writePoints(const CDBTile &tile, int pointCount);
+
+    void writeGTModels();
+
+    void writeGSModels(const CDBTile &tile);
+
+    void encodeModels();
+
+    // uniform in [0, 1). Computed from the raw engine output, which unlike the standard distributions gives
+    // the same numbers with every standard library
+    double random();
+
+    std::filesystem::path m_CDBPath;
+    SyntheticCDBOptions m_options;
+    std::mt19937 m_random;
+    std::vector<std::string> m_models;
+};
+} // namespace CDBTo3DTiles
@@ -0,0 +1,108 @@
+#include "CDBTo3DTiles.h"
+#include "SyntheticCDB.h"
+#include "cxxopts.hpp"
+#include <iostream>
+
+int main(int argc, char **argv)
+{
+    cxxopts::Options options("SyntheticCDBGenerator", "Write a synthetic CDB of configurable size");
+
+    // clang-format off
+    options.add_options()
+        ("o, output",
+            "CDB directory to write",
+            cxxopts::value<std::string>())
+        ("scale",
+            "Preset the other options start from: small, medium or large",
+            cxxopts::value<std::string>()->default_value("small"))
+        ("geocells",
+            "Number of GeoCells, laid out eastwards in rows of 8",
+            cxxopts::value<int>())
+        ("max-level",
+            "Deepest level of detail. Elevation and imagery are written for every level from -10, vectors and features at this level",
+            cxxopts::value<int>())
+        ("elevation-size",
+            "Elevation samples along each side of an elevation tile",
+            cxxopts::value<int>())
+        ("imagery-size",
+            "Pixels along each side of an imagery tile. 0 writes no imagery",
+            cxxopts::value<int>())
+        ("polygons",
+            "Hydrography polygons per tile",
+            cxxopts::value<int>())
+        ("lines",
+            "Road network lines per tile",
+            cxxopts::value<int>())
+        ("gt-features",
+            "GTFeature model instances per tile",
+            cxxopts::value<int>())
+        ("gs-features",
+            "GSFeature model instances per tile",
+            cxxopts::value<int>())
+        ("models",
+            "Distinct models the instances are spread over. Fewer models means more instances share a model",
+            cxxopts::value<int>())
+        ("seed",
+            "Seed of the random features",
+            cxxopts::value<uint32_t>())
+        ("h, help", "Print usage");
+    // clang-format on
+
+    auto result = options.parse(argc, argv);
+    if (result.count("help") || !result.count("output")) {
+        std::cout << options.help() << "\n";
+        return 0;
+    }
+
+    try {
+        auto CDBOptions = CDBTo3DTiles::SyntheticCDB::createOptions(result["scale"].as<std::string>());
+        if (result.count("geocells")) {
+            CDBOptions.geoCellCount = result["geocells"].as<int>();
+        }
+
+        if (result.count("max-level")) {
+            CDBOptions.maxLevel = result["max-level"].as<int>();
+        }
+
+        if (result.count("elevation-size")) {
+            CDBOptions.elevationGridSize = result["elevation-size"].as<int>();
+        }
+
+        if (result.count("imagery-size")) {
+            CDBOptions.imageryTileSize = result["imagery-size"].as<int>();
+        }
+
+        if (result.count("polygons")) {
+            CDBOptions.polygonsPerTile = result["polygons"].as<int>();
+        }
+
+        if (result.count("lines")) {
+            CDBOptions.linesPerTile = result["lines"].as<int>();
+        }
+
+        if (result.count("gt-features")) {
+            CDBOptions.pointsPerTile = result["gt-features"].as<int>();
+        }
+
+        if (result.count("gs-features")) {
+            CDBOptions.GSFeaturesPerTile = result["gs-features"].as<int>();
+        }
+
+        if (result.count("models")) {
+            CDBOptions.modelCount = result["models"].as<int>();
+        }
+
+        if (result.count("seed")) {
+            CDBOptions.seed = result["seed"].as<uint32_t>();
+        }
+
+        CDBTo3DTiles::GlobalInitializer initializer;
+        CDBTo3DTiles::SyntheticCDB cdb(result["output"].as<std::string>(), CDBOptions);
+        cdb.write();
+    } catch (const std::exception &e) {
+        std::cout << "An error has occured: " << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,114 @@
+#include "Benchmarks.h"
+#include "CDBAttributes.h"
+#include "CDBTileset.h"
+#include "TileFormatIO.h"
+#include "gdal_priv.h"
+#include <memory>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+namespace CDBTo3DTiles {
+
+// levels below the deepest synthetic level, so the tileset is deep even for the small scale
+static const int TILESET_EXTRA_LEVELS = 5;
+
+static std::shared_ptr<const CDBTileset> createQuadtreeTileset(const CDBGeoCell &geoCell, int maxLevel);
+
+static void insertContentTile(CDBTileset &tileset,
+                              const CDBTile &tile,
+                              float geometricError,
+                              size_t &tileCount);
+
+static void insertQuadtreeTiles(CDBTileset &tileset, const CDBTile &tile, int maxLevel, size_t &tileCount);
+
+void addTileFormatBenchmarks(BenchmarkRunner &runner, const SyntheticCDB &cdb)
+{
+    CDBGeoCell geoCell = cdb.getGeoCell(0);
+    CDBTile pointsTile(geoCell,
+                       CDBDataset::GTFeature,
+                       SyntheticCDB::GTFEATURE_CS_1,
+                       static_cast<int>(CDBVectorCS2::PointFeature),
+                       cdb.getOptions().maxLevel,
+                       0,
+                       0);
+    auto attributesPath = cdb.getTilePath(pointsTile, ".dbf");
+    auto CDBPath = cdb.getPath();
+    runner.add("tileFormat/i3dm", [pointsTile, attributesPath, CDBPath]() -> BenchmarkWork {
+        GDALDatasetUniquePtr dataset = GDALDatasetUniquePtr((GDALDataset *) GDALOpenEx(
+            attributesPath.string().c_str(), GDAL_OF_VECTOR, nullptr, nullptr, nullptr));
+        if (!dataset) {
+            throw std::runtime_error("Cannot read attributes " + attributesPath.string());
+        }
+
+        auto modelsAttributes = std::make_shared<const CDBModelsAttributes>(std::move(dataset),
+                                                                            pointsTile,
+                                                                            CDBPath);
+        auto indices = std::make_shared<std::vector<int>>(
+            modelsAttributes->getInstancesAttributes().getInstancesCount());
+        std::iota(indices->begin(), indices->end(), 0);
+        return [modelsAttributes, indices]() {
+            std::ostringstream ss;
+            writeToI3DM("synthetic.glb", *modelsAttributes, *indices, ss);
+            return indices->size();
+        };
+    });
+
+    int maxLevel = cdb.getOptions().maxLevel + TILESET_EXTRA_LEVELS;
+    runner.add("tileFormat/tilesetJson", [geoCell, maxLevel]() -> BenchmarkWork {
+        auto tileset = createQuadtreeTileset(geoCell, maxLevel);
+        return [tileset]() {
+            std::ostringstream ss;
+            writeToTilesetJson(*tileset, true, ss);
+            return ss.str().size();
+        };
+    });
+
+    runner.add("tileFormat/tilesetJsonOBB", [geoCell, maxLevel]() -> BenchmarkWork {
+        auto tileset = createQuadtreeTileset(geoCell, maxLevel);
+        return [tileset]() {
+            std::ostringstream ss;
+            writeToTilesetJson(*tileset, true, ss, true);
+            return ss.str().size();
+        };
+    });
+}
+
+std::shared_ptr<const CDBTileset> createQuadtreeTileset(const CDBGeoCell &geoCell, int maxLevel)
+{
+    // every negative level, then every tile of the quadtree down to maxLevel, all with content and heights
+    auto tileset = std::make_shared<CDBTileset>();
+    size_t tileCount = 0;
+    CDBTile tile(geoCell, CDBDataset::Elevation, 1, 1, -10, 0, 0);
+    while (tile.getLevel() < 0) {
+        insertContentTile(*tileset, tile, static_cast<float>(maxLevel - tile.getLevel()), tileCount);
+        tile = CDBTile::createChildForNegativeLOD(tile);
+    }
+
+    insertQuadtreeTiles(*tileset, tile, maxLevel, tileCount);
+    return tileset;
+}
+
+void insertContentTile(CDBTileset &tileset, const CDBTile &tile, float geometricError, size_t &tileCount)
+{
+    CDBTile content = tile;
+    content.setCustomContentURI("Tiles/" + std::to_string(tileCount) + ".b3dm");
+    content.setGeometricError(geometricError);
+    content.expandHeights(static_cast<double>(tileCount % 100), static_cast<double>(100 + tileCount % 1000));
+    tileset.insertTile(content);
+    ++tileCount;
+}
+
+void insertQuadtreeTiles(CDBTileset &tileset, const CDBTile &tile, int maxLevel, size_t &tileCount)
+{
+    insertContentTile(tileset, tile, static_cast<float>(maxLevel - tile.getLevel()), tileCount);
+    if (tile.getLevel() >= maxLevel) {
+        return;
+    }
+
+    insertQuadtreeTiles(tileset, CDBTile::createSouthWestForPositiveLOD(tile), maxLevel, tileCount);
+    insertQuadtreeTiles(tileset, CDBTile::createSouthEastForPositiveLOD(tile), maxLevel, tileCount);
+    insertQuadtreeTiles(tileset, CDBTile::createNorthWestForPositiveLOD(tile), maxLevel, tileCount);
+    insertQuadtreeTiles(tileset, CDBTile::createNorthEastForPositiveLOD(tile), maxLevel, tileCount);
+}
+} // namespace CDBTo3DTiles
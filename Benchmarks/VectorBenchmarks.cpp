@@ -0,0 +1,186 @@
+#include "Benchmarks.h"
+#include "CDBAttributes.h"
+#include "CDBGeometryVectors.h"
+#include "Ellipsoid.h"
+#include "MathHelpers.h"
+#include "mapbox/earcut.hpp"
+#include <cmath>
+#include <memory>
+#include <random>
+#include <stdexcept>
+
+namespace CDBTo3DTiles {
+
+static const size_t ELLIPSOID_POINT_COUNT = 1000000;
+
+using EarcutPolygon = std::vector<std::vector<std::pair<double, double>>>;
+
+static std::shared_ptr<const std::vector<Core::Cartographic>> createCartographics(size_t count,
+                                                                                  uint32_t seed);
+
+static std::shared_ptr<const std::vector<EarcutPolygon>> createPolygons(const SyntheticCDBOptions &options);
+
+static void addReadVectorsBenchmark(BenchmarkRunner &runner,
+                                    const std::string &name,
+                                    const SyntheticCDB &cdb,
+                                    const CDBTile &tile);
+
+void addVectorBenchmarks(BenchmarkRunner &runner, const SyntheticCDB &cdb)
+{
+    const auto &options = cdb.getOptions();
+    runner.add("ellipsoid/cartographicToCartesian", [options]() -> BenchmarkWork {
+        auto cartographics = createCartographics(ELLIPSOID_POINT_COUNT, options.seed);
+        auto cartesians = std::make_shared<std::vector<glm::dvec3>>(cartographics->size());
+        return [cartographics, cartesians]() {
+            const auto &ellipsoid = Core::Ellipsoid::WGS84;
+            for (size_t i = 0; i < cartographics->size(); ++i) {
+                (*cartesians)[i] = ellipsoid.cartographicToCartesian((*cartographics)[i]);
+            }
+
+            return cartographics->size();
+        };
+    });
+
+    runner.add("ellipsoid/cartographicToCartesianBatch", [options]() -> BenchmarkWork {
+        auto cartographics = createCartographics(ELLIPSOID_POINT_COUNT, options.seed);
+        auto cartesians = std::make_shared<std::vector<glm::dvec3>>(cartographics->size());
+        return [cartographics, cartesians]() {
+            Core::Ellipsoid::WGS84.cartographicToCartesian(cartographics->data(),
+                                                           cartographics->size(),
+                                                           cartesians->data());
+            return cartographics->size();
+        };
+    });
+
+    runner.add("vectors/earcut", [options]() -> BenchmarkWork {
+        auto polygons = createPolygons(options);
+        return [polygons]() {
+            size_t indexCount = 0;
+            for (const auto &polygon : *polygons) {
+                indexCount += mapbox::earcut<uint32_t>(polygon).size();
+            }
+
+            return indexCount / 3;
+        };
+    });
+
+    CDBGeoCell geoCell = cdb.getGeoCell(0);
+    CDBTile linesTile(geoCell,
+                      CDBDataset::RoadNetwork,
+                      SyntheticCDB::ROAD_NETWORK_CS_1,
+                      static_cast<int>(CDBVectorCS2::LinealFeature),
+                      options.maxLevel,
+                      0,
+                      0);
+    addReadVectorsBenchmark(runner, "vectors/readLines", cdb, linesTile);
+
+    CDBTile polygonsTile(geoCell,
+                         CDBDataset::HydrographyNetwork,
+                         SyntheticCDB::HYDROGRAPHY_NETWORK_CS_1,
+                         static_cast<int>(CDBVectorCS2::PolygonFeature),
+                         options.maxLevel,
+                         0,
+                         0);
+    addReadVectorsBenchmark(runner, "vectors/readPolygons", cdb, polygonsTile);
+
+    // the memory mapped dBase reader against decoding every field through OGR
+    CDBTile pointsTile(geoCell,
+                       CDBDataset::GTFeature,
+                       SyntheticCDB::GTFEATURE_CS_1,
+                       static_cast<int>(CDBVectorCS2::PointFeature),
+                       options.maxLevel,
+                       0,
+                       0);
+    auto attributesPath = cdb.getTilePath(pointsTile, ".dbf");
+    runner.add("attributes/dbf", [attributesPath]() -> BenchmarkWork {
+        return [attributesPath]() {
+            auto attributesTable = DBFReader::createFromFile(attributesPath);
+            if (!attributesTable) {
+                throw std::runtime_error("Cannot read attributes " + attributesPath.string());
+            }
+
+            CDBInstancesAttributes attributes;
+            attributes.addInstancesFeatures(*attributesTable);
+            return attributes.getInstancesCount();
+        };
+    });
+
+    runner.add("attributes/ogr", [attributesPath]() -> BenchmarkWork {
+        return [attributesPath]() {
+            GDALDatasetUniquePtr dataset = GDALDatasetUniquePtr((GDALDataset *) GDALOpenEx(
+                attributesPath.string().c_str(), GDAL_OF_VECTOR, nullptr, nullptr, nullptr));
+            if (!dataset) {
+                throw std::runtime_error("Cannot read attributes " + attributesPath.string());
+            }
+
+            CDBInstancesAttributes attributes;
+            for (int i = 0; i < dataset->GetLayerCount(); ++i) {
+                for (const auto &feature : *dataset->GetLayer(i)) {
+                    attributes.addInstanceFeature(*feature);
+                }
+            }
+
+            return attributes.getInstancesCount();
+        };
+    });
+}
+
+std::shared_ptr<const std::vector<Core::Cartographic>> createCartographics(size_t count, uint32_t seed)
+{
+    std::mt19937 random(seed);
+    auto cartographics = std::make_shared<std::vector<Core::Cartographic>>();
+    cartographics->reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        double longitude = static_cast<double>(random()) / 4294967296.0 * Core::Math::TWO_PI
+                           - Core::Math::ONE_PI;
+        double latitude = static_cast<double>(random()) / 4294967296.0 * Core::Math::ONE_PI
+                          - Core::Math::PI_OVER_TWO;
+        cartographics->emplace_back(longitude, latitude, static_cast<double>(random() % 9000));
+    }
+
+    return cartographics;
+}
+
+std::shared_ptr<const std::vector<EarcutPolygon>> createPolygons(const SyntheticCDBOptions &options)
+{
+    // the same star shaped rings as the synthetic hydrography, in meters on a tangent plane
+    std::mt19937 random(options.seed);
+    auto polygons = std::make_shared<std::vector<EarcutPolygon>>();
+    polygons->reserve(static_cast<size_t>(options.polygonsPerTile));
+    for (int i = 0; i < options.polygonsPerTile; ++i) {
+        double centerX = static_cast<double>(random() % 100000);
+        double centerY = static_cast<double>(random() % 100000);
+        EarcutPolygon polygon(1);
+        for (int vertex = 0; vertex < options.polygonVertexCount; ++vertex) {
+            double angle = Core::Math::TWO_PI * vertex / options.polygonVertexCount;
+            double radius = 50.0 + static_cast<double>(random() % 50);
+            polygon.front().emplace_back(centerX + radius * std::cos(angle),
+                                         centerY + radius * std::sin(angle));
+        }
+
+        polygons->emplace_back(std::move(polygon));
+    }
+
+    return polygons;
+}
+
+void addReadVectorsBenchmark(BenchmarkRunner &runner,
+                             const std::string &name,
+                             const SyntheticCDB &cdb,
+                             const CDBTile &tile)
+{
+    // reads the shapefile, converts to cartesian and triangulates polygons like every converted vector tile
+    auto vectorsPath = cdb.getTilePath(tile, ".dbf");
+    auto CDBPath = cdb.getPath();
+    runner.add(name, [vectorsPath, CDBPath]() -> BenchmarkWork {
+        return [vectorsPath, CDBPath]() {
+            auto vectors = CDBGeometryVectors::createFromFile(vectorsPath, CDBPath);
+            if (!vectors) {
+                throw std::runtime_error("Cannot read vectors " + vectorsPath.string());
+            }
+
+            return vectors->getInstancesAttributes().getInstancesCount();
+        };
+    });
+}
+} // namespace CDBTo3DTiles
@@ -0,0 +1,108 @@
+#include "Benchmarks.h"
+#include "CDBTo3DTiles.h"
+#include "cxxopts.hpp"
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+
+int main(int argc, char **argv)
+{
+    cxxopts::Options options("Benchmarks", "Time the conversion stages on synthetic and test CDBs");
+
+    // clang-format off
+    options.add_options()
+        ("o, output",
+            "Write the results to a JSON file",
+            cxxopts::value<std::string>())
+        ("filter",
+            "Only run the benchmarks whose name contains this text, e.g. elevation/ or convert/",
+            cxxopts::value<std::string>()->default_value(""))
+        ("scale",
+            "Size of the synthetic CDB: small, medium or large",
+            cxxopts::value<std::string>()->default_value("small"))
+        ("input",
+            "Benchmark a CDB written by SyntheticCDBGenerator instead of writing one of the given scale",
+            cxxopts::value<std::string>())
+        ("data",
+            "Directory for the synthetic CDB and the converted output. A temporary directory removed after the run is used by default",
+            cxxopts::value<std::string>())
+        ("min-time",
+            "Minimum seconds to time each benchmark",
+            cxxopts::value<double>()->default_value("1"))
+        ("min-iterations",
+            "Minimum iterations of each benchmark",
+            cxxopts::value<size_t>()->default_value("3"))
+        ("baseline",
+            "Compare the results with a JSON file written by a previous run",
+            cxxopts::value<std::string>())
+        ("h, help", "Print usage");
+    // clang-format on
+
+    auto result = options.parse(argc, argv);
+    if (result.count("help")) {
+        std::cout << options.help() << "\n";
+        return 0;
+    }
+
+    try {
+        std::string scale = result["scale"].as<std::string>();
+        bool removeData = result.count("data") == 0;
+        std::filesystem::path dataPath = std::filesystem::temp_directory_path() / "CDBTo3DTilesBenchmarks";
+        if (!removeData) {
+            dataPath = result["data"].as<std::string>();
+        }
+
+        CDBTo3DTiles::GlobalInitializer initializer;
+        std::optional<CDBTo3DTiles::SyntheticCDB> cdb;
+        if (result.count("input")) {
+            std::filesystem::path CDBPath = result["input"].as<std::string>();
+            cdb = CDBTo3DTiles::SyntheticCDB::createFromDirectory(CDBPath);
+            if (!cdb) {
+                throw std::runtime_error(CDBPath.string() + " is not a CDB written by SyntheticCDBGenerator");
+            }
+
+            scale = "custom";
+        } else {
+            cdb.emplace(dataPath / ("SyntheticCDB_" + scale),
+                        CDBTo3DTiles::SyntheticCDB::createOptions(scale));
+            std::cout << "Writing synthetic CDB to " << cdb->getPath() << "\n";
+            cdb->write();
+        }
+
+        CDBTo3DTiles::BenchmarkRunner runner(result["min-time"].as<double>(),
+                                             result["min-iterations"].as<size_t>());
+        CDBTo3DTiles::addElevationBenchmarks(runner, *cdb);
+        CDBTo3DTiles::addVectorBenchmarks(runner, *cdb);
+        CDBTo3DTiles::addTileFormatBenchmarks(runner, *cdb);
+        CDBTo3DTiles::addConvertBenchmarks(runner, *cdb, TEST_DATA_DIR, dataPath / "Output");
+        auto results = runner.run(result["filter"].as<std::string>(), std::cout);
+
+        if (result.count("output")) {
+            nlohmann::json resultsJson;
+            resultsJson["context"] = {{"scale", scale},
+                                      {"threads", std::thread::hardware_concurrency()},
+                                      {"minSeconds", result["min-time"].as<double>()},
+                                      {"minIterations", result["min-iterations"].as<size_t>()}};
+            resultsJson["benchmarks"] = CDBTo3DTiles::BenchmarkRunner::convertResultsToJson(results);
+            std::ofstream fs(result["output"].as<std::string>());
+            fs << resultsJson.dump(4);
+        }
+
+        if (result.count("baseline")) {
+            std::ifstream fs(result["baseline"].as<std::string>());
+            nlohmann::json baselineJson = nlohmann::json::parse(fs);
+            CDBTo3DTiles::BenchmarkRunner::compareResults(results, baselineJson.at("benchmarks"), std::cout);
+        }
+
+        if (removeData) {
+            std::filesystem::remove_all(dataPath);
+        }
+    } catch (const std::exception &e) {
+        std::cout << "An error has occured: " << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
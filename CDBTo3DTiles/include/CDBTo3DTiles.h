@@ -31,8 +31,69 @@ public:
 
     void setElevationThresholdIndices(float elevationThresholdIndices);
 
+    void setDictionaryEncodeStrings(bool dictionaryEncodeStrings);
+
+    void setIncremental(bool incremental);
+
+    void setDeduplicate(bool deduplicate);
+
+    void setArchive(bool archive);
+
+    void setImplicitTiling(bool implicitTiling);
+
+    void setOrientedBoundingBox(bool orientedBoundingBox);
+
+    void setBilinearModelClamping(bool bilinearModelClamping);
+
+    void setElevationCacheSize(size_t elevationCacheSize);
+
+    // Bytes the converter tries to stay within, 0 for no limit. Caches are sized to a share of it and shrunk
+    // whenever the process goes over it
+    void setMemoryBudget(size_t memoryBudget);
+
+    // Tiles whose source files are read on background threads ahead of the tile being converted, 0 to read
+    // every file when it is needed
+    void setPrefetchDepth(size_t prefetchDepth);
+
+    // Threads writing the output files, so conversion goes on with the next tile while a tile is written
+    void setWriterThreads(size_t writerThreadCount);
+
+    // Syncs the output files to disk before conversion returns
+    void setSyncOutput(bool syncOutput);
+
+    // Writes a gzip compressed copy of every tile and tileset file next to it, with .gz appended, for web
+    // servers sending pre-compressed files. Images and archives are not compressed
+    void setGzipOutput(bool gzipOutput);
+
+    // Converts only the GeoCells overlapping the rectangle, in degrees, and the GeoCells added with
+    // addGeoCell. GeoCells left out keep their earlier output in an incremental conversion
+    void setRegion(double west, double south, double east, double north);
+
+    // Converts the GeoCell with the name, e.g. N32W119, and the region
+    void addGeoCell(const std::string &geoCellName);
+
+    // Converts only the datasets with the names, e.g. Elevation or GTModels
+    void setDatasets(const std::vector<std::string> &datasets);
+
+    // Converts only the levels from minLevel to maxLevel, -10 to 23, of every dataset without a range of
+    // its own
+    void setLevelRange(int minLevel, int maxLevel);
+
+    void setLevelRange(const std::string &dataset, int minLevel, int maxLevel);
+
+    // Converts only the GeoCells of one of shardCount shards, numbered from 0, and writes a shard manifest
+    // instead of the combined tilesets. Shards can run in separate processes sharing the output directory
+    void setShard(size_t shardIndex, size_t shardCount);
+
+    // Writes the time, bytes and counts of each conversion stage to the file as JSON
+    void setStatsFile(const std::filesystem::path &statsFile);
+
     void convert();
 
+    // Combines the manifests written by every shard in the output directory into the manifest and combined
+    // tilesets of the whole conversion, without reading the converted tiles
+    void merge();
+
 private:
     struct Impl;
     struct TilesetCollection;
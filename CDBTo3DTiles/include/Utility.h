@@ -1,8 +1,12 @@
 #pragma once
 
+#include <algorithm>
 #include <cstddef>
+#include <exception>
 #include <functional>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace CDBTo3DTiles {
 template<class T>
@@ -41,4 +45,43 @@ inline std::vector<std::string> splitString(const std::string &str, const std::s
     results.emplace_back(str.substr(last));
     return results;
 }
+
+inline size_t getParallelRangeCount(size_t count, size_t minRangeSize)
+{
+    size_t threadCount = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    return std::max<size_t>(std::min(threadCount, count / std::max<size_t>(minRangeSize, 1)), 1);
+}
+
+// Calls runRange(range) for every range in [0, rangeCount) and returns once all of them ended. The ranges run
+// on worker threads that are started by the first call and kept for the whole process, and on the calling
+// thread. While another call is using the workers, the ranges run on the calling thread alone. runRange must
+// not throw
+void runRangesOnWorkers(size_t rangeCount, const std::function<void(size_t)> &runRange);
+
+// Splits [0, count) into rangeCount contiguous ranges and calls function(range, begin, end) for each of them
+// in parallel. Exceptions are rethrown after all ranges end
+template<typename Function>
+inline void parallelForRanges(size_t count, size_t rangeCount, Function &&function)
+{
+    // a single range runs on the calling thread without waking the workers
+    if (rangeCount == 1) {
+        function(0, 0, count);
+        return;
+    }
+
+    std::vector<std::exception_ptr> exceptions(rangeCount);
+    runRangesOnWorkers(rangeCount, [&](size_t range) {
+        try {
+            function(range, count * range / rangeCount, count * (range + 1) / rangeCount);
+        } catch (...) {
+            exceptions[range] = std::current_exception();
+        }
+    });
+
+    for (const auto &exception : exceptions) {
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+    }
+}
 } // namespace CDBTo3DTiles
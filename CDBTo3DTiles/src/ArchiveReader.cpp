@@ -0,0 +1,216 @@
+#include "ArchiveReader.h"
+#include "ArchiveWriter.h"
+#include "ContentHash.h"
+#include <algorithm>
+#include <cstring>
+#include <tuple>
+
+namespace CDBTo3DTiles {
+
+static const uint32_t LOCAL_FILE_HEADER_SIGNATURE = 0x04034b50;
+static const uint32_t CENTRAL_DIRECTORY_SIGNATURE = 0x02014b50;
+static const uint32_t ZIP64_END_OF_CENTRAL_DIRECTORY_SIGNATURE = 0x06064b50;
+static const uint32_t ZIP64_END_OF_CENTRAL_DIRECTORY_LOCATOR_SIGNATURE = 0x07064b50;
+static const uint32_t END_OF_CENTRAL_DIRECTORY_SIGNATURE = 0x06054b50;
+static const uint16_t ZIP64_EXTRA_FIELD_ID = 0x0001;
+static const size_t END_OF_CENTRAL_DIRECTORY_SIZE = 22;
+
+template<typename T>
+static T readValue(const uint8_t *data);
+
+static std::optional<uint64_t> readZip64Value(const uint8_t *extra, size_t extraSize, size_t valueIndex);
+
+ArchiveReader::ArchiveReader(MappedFile file, std::vector<IndexEntry> index)
+    : m_file{std::move(file)}
+    , m_index{std::move(index)}
+{}
+
+std::optional<std::string_view> ArchiveReader::getFile(const std::string &path) const
+{
+    auto hash = computeMD5(path.data(), path.size());
+    IndexEntry key{readValue<uint64_t>(hash.data()), readValue<uint64_t>(hash.data() + 8), 0};
+    auto entry = std::lower_bound(m_index.begin(),
+                                  m_index.end(),
+                                  key,
+                                  [](const IndexEntry &lhs, const IndexEntry &rhs) {
+                                      return std::tie(lhs.hashLow, lhs.hashHigh)
+                                             < std::tie(rhs.hashLow, rhs.hashHigh);
+                                  });
+
+    // paths with the same hash are next to each other, the local header tells them apart
+    for (; entry != m_index.end() && entry->hashLow == key.hashLow && entry->hashHigh == key.hashHigh;
+         ++entry) {
+        const uint8_t *header = m_file.getData() + entry->offset;
+        uint16_t nameSize = readValue<uint16_t>(header + 26);
+        if (entry->offset + 30 + nameSize <= m_file.getSize()
+            && std::string_view(reinterpret_cast<const char *>(header + 30), nameSize) == path) {
+            return readEntry(m_file, entry->offset);
+        }
+    }
+
+    return std::nullopt;
+}
+
+std::optional<ArchiveReader> ArchiveReader::createFromFile(const std::filesystem::path &file)
+{
+    auto mappedFile = MappedFile::createFromFile(file);
+    if (!mappedFile || mappedFile->getSize() < END_OF_CENTRAL_DIRECTORY_SIZE) {
+        return std::nullopt;
+    }
+
+    const uint8_t *data = mappedFile->getData();
+    size_t size = mappedFile->getSize();
+
+    // the end of central directory record is followed by a comment of at most 64KB
+    size_t endOffset = size - END_OF_CENTRAL_DIRECTORY_SIZE;
+    size_t searchEnd = endOffset > 0xffff ? endOffset - 0xffff : 0;
+    while (readValue<uint32_t>(data + endOffset) != END_OF_CENTRAL_DIRECTORY_SIGNATURE) {
+        if (endOffset == searchEnd) {
+            return std::nullopt;
+        }
+
+        --endOffset;
+    }
+
+    uint64_t entryCount = readValue<uint16_t>(data + endOffset + 10);
+    uint64_t centralDirectoryOffset = readValue<uint32_t>(data + endOffset + 16);
+    if (entryCount == 0xffff || centralDirectoryOffset == 0xffffffff) {
+        if (endOffset < 20) {
+            return std::nullopt;
+        }
+
+        size_t locatorOffset = endOffset - 20;
+        if (readValue<uint32_t>(data + locatorOffset) != ZIP64_END_OF_CENTRAL_DIRECTORY_LOCATOR_SIGNATURE) {
+            return std::nullopt;
+        }
+
+        uint64_t zip64EndOffset = readValue<uint64_t>(data + locatorOffset + 8);
+        if (zip64EndOffset + 56 > size
+            || readValue<uint32_t>(data + zip64EndOffset) != ZIP64_END_OF_CENTRAL_DIRECTORY_SIGNATURE) {
+            return std::nullopt;
+        }
+
+        entryCount = readValue<uint64_t>(data + zip64EndOffset + 32);
+        centralDirectoryOffset = readValue<uint64_t>(data + zip64EndOffset + 48);
+    }
+
+    // the index is the last entry of the central directory
+    std::optional<uint64_t> indexOffset;
+    uint64_t offset = centralDirectoryOffset;
+    for (uint64_t i = 0; i < entryCount; ++i) {
+        if (offset + 46 > size || readValue<uint32_t>(data + offset) != CENTRAL_DIRECTORY_SIGNATURE) {
+            return std::nullopt;
+        }
+
+        uint16_t nameSize = readValue<uint16_t>(data + offset + 28);
+        uint16_t extraSize = readValue<uint16_t>(data + offset + 30);
+        uint16_t commentSize = readValue<uint16_t>(data + offset + 32);
+        if (offset + 46 + nameSize + extraSize > size) {
+            return std::nullopt;
+        }
+
+        std::string_view name(reinterpret_cast<const char *>(data + offset + 46), nameSize);
+        if (i + 1 == entryCount && name == ArchiveWriter::INDEX_FILENAME) {
+            uint64_t localOffset = readValue<uint32_t>(data + offset + 42);
+            if (localOffset == 0xffffffff) {
+                // sizes come first in the zip64 extra field when they overflowed too
+                size_t valueIndex = readValue<uint32_t>(data + offset + 24) == 0xffffffff ? 2 : 0;
+                auto zip64Offset = readZip64Value(data + offset + 46 + nameSize, extraSize, valueIndex);
+                if (!zip64Offset) {
+                    return std::nullopt;
+                }
+
+                localOffset = *zip64Offset;
+            }
+
+            indexOffset = localOffset;
+        }
+
+        offset += 46 + nameSize + extraSize + commentSize;
+    }
+
+    if (!indexOffset) {
+        return std::nullopt;
+    }
+
+    auto indexContent = readEntry(*mappedFile, *indexOffset);
+    if (!indexContent || indexContent->size() % 24 != 0) {
+        return std::nullopt;
+    }
+
+    std::vector<IndexEntry> index(indexContent->size() / 24);
+    const uint8_t *indexData = reinterpret_cast<const uint8_t *>(indexContent->data());
+    for (size_t i = 0; i < index.size(); ++i) {
+        index[i].hashLow = readValue<uint64_t>(indexData + i * 24);
+        index[i].hashHigh = readValue<uint64_t>(indexData + i * 24 + 8);
+        index[i].offset = readValue<uint64_t>(indexData + i * 24 + 16);
+        if (index[i].offset + 30 > size) {
+            return std::nullopt;
+        }
+    }
+
+    return ArchiveReader(std::move(*mappedFile), std::move(index));
+}
+
+std::optional<std::string_view> ArchiveReader::readEntry(const MappedFile &file, uint64_t offset)
+{
+    const uint8_t *data = file.getData();
+    size_t size = file.getSize();
+    if (offset + 30 > size || readValue<uint32_t>(data + offset) != LOCAL_FILE_HEADER_SIGNATURE) {
+        return std::nullopt;
+    }
+
+    // only stored entries
+    if (readValue<uint16_t>(data + offset + 8) != 0) {
+        return std::nullopt;
+    }
+
+    uint64_t entrySize = readValue<uint32_t>(data + offset + 22);
+    uint16_t nameSize = readValue<uint16_t>(data + offset + 26);
+    uint16_t extraSize = readValue<uint16_t>(data + offset + 28);
+    if (entrySize == 0xffffffff) {
+        auto zip64Size = readZip64Value(data + offset + 30 + nameSize, extraSize, 0);
+        if (!zip64Size) {
+            return std::nullopt;
+        }
+
+        entrySize = *zip64Size;
+    }
+
+    uint64_t dataOffset = offset + 30 + nameSize + extraSize;
+    if (dataOffset + entrySize > size) {
+        return std::nullopt;
+    }
+
+    const char *entryData = reinterpret_cast<const char *>(data + dataOffset);
+    return std::string_view(entryData, static_cast<size_t>(entrySize));
+}
+
+template<typename T>
+T readValue(const uint8_t *data)
+{
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+std::optional<uint64_t> readZip64Value(const uint8_t *extra, size_t extraSize, size_t valueIndex)
+{
+    size_t offset = 0;
+    while (offset + 4 <= extraSize) {
+        uint16_t id = readValue<uint16_t>(extra + offset);
+        uint16_t fieldSize = readValue<uint16_t>(extra + offset + 2);
+        if (id == ZIP64_EXTRA_FIELD_ID) {
+            if ((valueIndex + 1) * 8 > fieldSize || offset + 4 + fieldSize > extraSize) {
+                return std::nullopt;
+            }
+
+            return readValue<uint64_t>(extra + offset + 4 + valueIndex * 8);
+        }
+
+        offset += 4 + static_cast<size_t>(fieldSize);
+    }
+
+    return std::nullopt;
+}
+} // namespace CDBTo3DTiles
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "MappedFile.h"
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace CDBTo3DTiles {
+// Looks up files of an archive written by ArchiveWriter through its index. Only uncompressed entries are read
+class ArchiveReader
+{
+public:
+    inline size_t getFileCount() const noexcept { return m_index.size(); }
+
+    std::optional<std::string_view> getFile(const std::string &path) const;
+
+    static std::optional<ArchiveReader> createFromFile(const std::filesystem::path &file);
+
+private:
+    struct IndexEntry
+    {
+        uint64_t hashLow;
+        uint64_t hashHigh;
+        uint64_t offset;
+    };
+
+    ArchiveReader(MappedFile file, std::vector<IndexEntry> index);
+
+    static std::optional<std::string_view> readEntry(const MappedFile &file, uint64_t offset);
+
+    MappedFile m_file;
+    std::vector<IndexEntry> m_index;
+};
+} // namespace CDBTo3DTiles
@@ -0,0 +1,290 @@
+#include "ArchiveWriter.h"
+#include "ContentHash.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace CDBTo3DTiles {
+
+static const size_t WRITE_BUFFER_SIZE = 8 * 1024 * 1024;
+
+static const uint32_t LOCAL_FILE_HEADER_SIGNATURE = 0x04034b50;
+static const uint32_t CENTRAL_DIRECTORY_SIGNATURE = 0x02014b50;
+static const uint32_t ZIP64_END_OF_CENTRAL_DIRECTORY_SIGNATURE = 0x06064b50;
+static const uint32_t ZIP64_END_OF_CENTRAL_DIRECTORY_LOCATOR_SIGNATURE = 0x07064b50;
+static const uint32_t END_OF_CENTRAL_DIRECTORY_SIGNATURE = 0x06054b50;
+static const uint16_t ZIP64_EXTRA_FIELD_ID = 0x0001;
+static const uint16_t ZIP_VERSION = 20;
+static const uint16_t ZIP64_VERSION = 45;
+static const uint16_t UTF8_FILENAME_FLAG = 0x0800;
+
+// MS-DOS date of 1980-01-01, so archives of the same input are identical
+static const uint16_t ENTRY_DATE = (1 << 5) | 1;
+
+static void appendUint16(std::vector<uint8_t> &buffer, uint16_t value);
+
+static void appendUint32(std::vector<uint8_t> &buffer, uint32_t value);
+
+static void appendUint64(std::vector<uint8_t> &buffer, uint64_t value);
+
+static bool isZip64Size(uint64_t value);
+
+const std::string ArchiveWriter::INDEX_FILENAME = "@3dtilesIndex1@";
+
+ArchiveWriter::ArchiveWriter(const std::filesystem::path &file)
+    : m_path{file}
+    , m_buffer(WRITE_BUFFER_SIZE)
+    , m_bufferSize{0}
+    , m_offset{0}
+    , m_closed{false}
+{
+    if (file.has_parent_path()) {
+        std::filesystem::create_directories(file.parent_path());
+    }
+
+    m_fs.open(file, std::ios::binary | std::ios::trunc);
+    if (!m_fs) {
+        throw std::runtime_error("Cannot create archive " + file.string());
+    }
+}
+
+ArchiveWriter::~ArchiveWriter() noexcept
+{
+    try {
+        close();
+    } catch (...) {
+        // the archive is left without an index and won't be readable
+    }
+}
+
+void ArchiveWriter::addFile(const std::string &path, const void *data, size_t size)
+{
+    if (m_closed) {
+        throw std::runtime_error("Cannot add " + path + " to the closed archive " + m_path.string());
+    }
+
+    if (path == INDEX_FILENAME) {
+        throw std::runtime_error(INDEX_FILENAME + " is reserved for the archive index");
+    }
+
+    writeEntry(path, data, size);
+}
+
+void ArchiveWriter::close()
+{
+    if (m_closed) {
+        return;
+    }
+
+    m_closed = true;
+
+    // the index is sorted by the MD5 of the path, read as two little endian 64 bit integers
+    std::vector<std::pair<std::array<uint8_t, 16>, uint64_t>> index;
+    index.reserve(m_entries.size());
+    for (const auto &entry : m_entries) {
+        index.emplace_back(computeMD5(entry.path.data(), entry.path.size()), entry.offset);
+    }
+
+    auto toKey = [](const std::array<uint8_t, 16> &hash) {
+        uint64_t low;
+        uint64_t high;
+        std::memcpy(&low, hash.data(), sizeof(low));
+        std::memcpy(&high, hash.data() + sizeof(low), sizeof(high));
+        return std::make_pair(low, high);
+    };
+
+    std::sort(index.begin(), index.end(), [&](const auto &lhs, const auto &rhs) {
+        return toKey(lhs.first) < toKey(rhs.first);
+    });
+
+    std::vector<uint8_t> indexBuffer;
+    indexBuffer.reserve(index.size() * 24);
+    for (const auto &indexEntry : index) {
+        indexBuffer.insert(indexBuffer.end(), indexEntry.first.begin(), indexEntry.first.end());
+        appendUint64(indexBuffer, indexEntry.second);
+    }
+
+    writeEntry(INDEX_FILENAME, indexBuffer.data(), indexBuffer.size());
+    writeCentralDirectory();
+    flush();
+    m_fs.close();
+    if (!m_fs) {
+        throw std::runtime_error("Cannot write archive " + m_path.string());
+    }
+}
+
+void ArchiveWriter::writeEntry(const std::string &path, const void *data, size_t size)
+{
+    Entry entry;
+    entry.path = path;
+    entry.offset = m_offset;
+    entry.size = static_cast<uint64_t>(size);
+    entry.crc = computeCRC32(data, size);
+
+    bool zip64 = isZip64Size(entry.size);
+    std::vector<uint8_t> header;
+    header.reserve(30 + path.size() + 20);
+    appendUint32(header, LOCAL_FILE_HEADER_SIGNATURE);
+    appendUint16(header, zip64 ? ZIP64_VERSION : ZIP_VERSION);
+    appendUint16(header, UTF8_FILENAME_FLAG);
+    appendUint16(header, 0); // stored
+    appendUint16(header, 0);
+    appendUint16(header, ENTRY_DATE);
+    appendUint32(header, entry.crc);
+    appendUint32(header, zip64 ? 0xffffffff : static_cast<uint32_t>(entry.size));
+    appendUint32(header, zip64 ? 0xffffffff : static_cast<uint32_t>(entry.size));
+    appendUint16(header, static_cast<uint16_t>(path.size()));
+    appendUint16(header, zip64 ? 20 : 0);
+    header.insert(header.end(), path.begin(), path.end());
+    if (zip64) {
+        appendUint16(header, ZIP64_EXTRA_FIELD_ID);
+        appendUint16(header, 16);
+        appendUint64(header, entry.size);
+        appendUint64(header, entry.size);
+    }
+
+    write(header.data(), header.size());
+    write(data, size);
+
+    auto existingEntry = m_entryIndices.find(path);
+    if (existingEntry != m_entryIndices.end()) {
+        m_entries[existingEntry->second] = std::move(entry);
+    } else {
+        m_entryIndices.insert({path, m_entries.size()});
+        m_entries.emplace_back(std::move(entry));
+    }
+}
+
+void ArchiveWriter::writeCentralDirectory()
+{
+    uint64_t centralDirectoryOffset = m_offset;
+    std::vector<uint8_t> header;
+    for (const auto &entry : m_entries) {
+        bool zip64Size = isZip64Size(entry.size);
+        bool zip64Offset = isZip64Size(entry.offset);
+        uint16_t extraSize = static_cast<uint16_t>((zip64Size ? 16 : 0) + (zip64Offset ? 8 : 0));
+
+        header.clear();
+        appendUint32(header, CENTRAL_DIRECTORY_SIGNATURE);
+        appendUint16(header, ZIP64_VERSION);
+        appendUint16(header, extraSize > 0 ? ZIP64_VERSION : ZIP_VERSION);
+        appendUint16(header, UTF8_FILENAME_FLAG);
+        appendUint16(header, 0);
+        appendUint16(header, 0);
+        appendUint16(header, ENTRY_DATE);
+        appendUint32(header, entry.crc);
+        appendUint32(header, zip64Size ? 0xffffffff : static_cast<uint32_t>(entry.size));
+        appendUint32(header, zip64Size ? 0xffffffff : static_cast<uint32_t>(entry.size));
+        appendUint16(header, static_cast<uint16_t>(entry.path.size()));
+        appendUint16(header, extraSize > 0 ? static_cast<uint16_t>(extraSize + 4) : 0);
+        appendUint16(header, 0);
+        appendUint16(header, 0);
+        appendUint16(header, 0);
+        appendUint32(header, 0);
+        appendUint32(header, zip64Offset ? 0xffffffff : static_cast<uint32_t>(entry.offset));
+        header.insert(header.end(), entry.path.begin(), entry.path.end());
+        if (extraSize > 0) {
+            appendUint16(header, ZIP64_EXTRA_FIELD_ID);
+            appendUint16(header, extraSize);
+            if (zip64Size) {
+                appendUint64(header, entry.size);
+                appendUint64(header, entry.size);
+            }
+
+            if (zip64Offset) {
+                appendUint64(header, entry.offset);
+            }
+        }
+
+        write(header.data(), header.size());
+    }
+
+    uint64_t centralDirectorySize = m_offset - centralDirectoryOffset;
+    uint64_t entryCount = static_cast<uint64_t>(m_entries.size());
+    bool zip64 = entryCount >= 0xffff || isZip64Size(centralDirectoryOffset)
+                 || isZip64Size(centralDirectorySize);
+
+    header.clear();
+    if (zip64) {
+        uint64_t zip64EndOffset = m_offset;
+        appendUint32(header, ZIP64_END_OF_CENTRAL_DIRECTORY_SIGNATURE);
+        appendUint64(header, 44);
+        appendUint16(header, ZIP64_VERSION);
+        appendUint16(header, ZIP64_VERSION);
+        appendUint32(header, 0);
+        appendUint32(header, 0);
+        appendUint64(header, entryCount);
+        appendUint64(header, entryCount);
+        appendUint64(header, centralDirectorySize);
+        appendUint64(header, centralDirectoryOffset);
+
+        appendUint32(header, ZIP64_END_OF_CENTRAL_DIRECTORY_LOCATOR_SIGNATURE);
+        appendUint32(header, 0);
+        appendUint64(header, zip64EndOffset);
+        appendUint32(header, 1);
+    }
+
+    appendUint32(header, END_OF_CENTRAL_DIRECTORY_SIGNATURE);
+    appendUint16(header, 0);
+    appendUint16(header, 0);
+    appendUint16(header, zip64 ? 0xffff : static_cast<uint16_t>(entryCount));
+    appendUint16(header, zip64 ? 0xffff : static_cast<uint16_t>(entryCount));
+    appendUint32(header, zip64 ? 0xffffffff : static_cast<uint32_t>(centralDirectorySize));
+    appendUint32(header, zip64 ? 0xffffffff : static_cast<uint32_t>(centralDirectoryOffset));
+    appendUint16(header, 0);
+    write(header.data(), header.size());
+}
+
+void ArchiveWriter::write(const void *data, size_t size)
+{
+    m_offset += static_cast<uint64_t>(size);
+    if (m_bufferSize + size > m_buffer.size()) {
+        flush();
+    }
+
+    // large files skip the buffer, it would only add a copy
+    if (size >= m_buffer.size()) {
+        m_fs.write(static_cast<const char *>(data), static_cast<std::streamsize>(size));
+        return;
+    }
+
+    if (size > 0) {
+        std::memcpy(m_buffer.data() + m_bufferSize, data, size);
+        m_bufferSize += size;
+    }
+}
+
+void ArchiveWriter::flush()
+{
+    m_fs.write(m_buffer.data(), static_cast<std::streamsize>(m_bufferSize));
+    m_bufferSize = 0;
+    if (!m_fs) {
+        throw std::runtime_error("Cannot write archive " + m_path.string());
+    }
+}
+
+void appendUint16(std::vector<uint8_t> &buffer, uint16_t value)
+{
+    buffer.push_back(static_cast<uint8_t>(value));
+    buffer.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+void appendUint32(std::vector<uint8_t> &buffer, uint32_t value)
+{
+    for (int i = 0; i < 4; ++i) {
+        buffer.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+void appendUint64(std::vector<uint8_t> &buffer, uint64_t value)
+{
+    for (int i = 0; i < 8; ++i) {
+        buffer.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+bool isZip64Size(uint64_t value)
+{
+    return value >= 0xffffffff;
+}
+} // namespace CDBTo3DTiles
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace CDBTo3DTiles {
+// Writes a 3D Tiles archive (.3tz): an uncompressed zip whose last entry is an index of every file, sorted by
+// the MD5 of its path. Files are appended in the order they are added, the index and central directory are
+// written when the archive is closed
+class ArchiveWriter
+{
+public:
+    explicit ArchiveWriter(const std::filesystem::path &file);
+
+    ArchiveWriter(const ArchiveWriter &) = delete;
+
+    ~ArchiveWriter() noexcept;
+
+    ArchiveWriter &operator=(const ArchiveWriter &) = delete;
+
+    inline const std::filesystem::path &getPath() const noexcept { return m_path; }
+
+    // Adding a path again replaces the earlier file, the same way writing over a file would
+    void addFile(const std::string &path, const void *data, size_t size);
+
+    void close();
+
+    static const std::string INDEX_FILENAME;
+
+private:
+    struct Entry
+    {
+        std::string path;
+        uint64_t offset;
+        uint64_t size;
+        uint32_t crc;
+    };
+
+    void writeEntry(const std::string &path, const void *data, size_t size);
+
+    void writeCentralDirectory();
+
+    void write(const void *data, size_t size);
+
+    void flush();
+
+    std::filesystem::path m_path;
+    std::ofstream m_fs;
+    std::vector<char> m_buffer;
+    size_t m_bufferSize;
+    uint64_t m_offset;
+    std::vector<Entry> m_entries;
+    std::unordered_map<std::string, size_t> m_entryIndices;
+    bool m_closed;
+};
+} // namespace CDBTo3DTiles
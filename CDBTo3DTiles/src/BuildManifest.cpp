@@ -0,0 +1,294 @@
+#include "BuildManifest.h"
+#include "ContentHash.h"
+#include "MappedFile.h"
+#include "nlohmann/json.hpp"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <stdexcept>
+
+namespace CDBTo3DTiles {
+
+static const int MANIFEST_VERSION = 2;
+
+static const std::string SHARD_FILENAME_PREFIX = "manifest.shard-";
+
+static const std::string SHARD_FILENAME_SEPARATOR = "-of-";
+
+static const std::string SHARD_FILENAME_EXTENSION = ".json";
+
+static nlohmann::json convertFilesToJson(const std::vector<BuildManifestFile> &files);
+
+static std::vector<BuildManifestFile> parseFilesFromJson(const nlohmann::json &json);
+
+const std::filesystem::path BuildManifest::FILENAME = "manifest.json";
+
+bool operator==(const BuildManifestFile &lhs, const BuildManifestFile &rhs) noexcept
+{
+    return lhs.path == rhs.path && lhs.size == rhs.size && lhs.modifiedTime == rhs.modifiedTime
+           && lhs.contentHash == rhs.contentHash;
+}
+
+bool operator!=(const BuildManifestFile &lhs, const BuildManifestFile &rhs) noexcept
+{
+    return !(lhs == rhs);
+}
+
+BuildManifest::BuildManifest(const std::string &settings)
+    : m_settings{settings}
+{}
+
+void BuildManifest::setSharedInputs(std::vector<BuildManifestFile> sharedInputs)
+{
+    m_sharedInputs = std::move(sharedInputs);
+}
+
+const BuildManifestGeoCell *BuildManifest::getGeoCell(const std::filesystem::path &geoCellPath) const
+{
+    auto geoCell = m_geoCells.find(geoCellPath);
+    if (geoCell == m_geoCells.end()) {
+        return nullptr;
+    }
+
+    return &geoCell->second;
+}
+
+void BuildManifest::setGeoCell(const std::filesystem::path &geoCellPath, BuildManifestGeoCell geoCell)
+{
+    m_geoCells[geoCellPath] = std::move(geoCell);
+}
+
+void BuildManifest::removeGeoCell(const std::filesystem::path &geoCellPath)
+{
+    m_geoCells.erase(geoCellPath);
+}
+
+void BuildManifest::merge(const BuildManifest &shard)
+{
+    if (shard.m_settings != m_settings) {
+        throw std::runtime_error("Shards were converted with different settings: " + m_settings + " and "
+                                 + shard.m_settings);
+    }
+
+    if (shard.m_sharedInputs != m_sharedInputs) {
+        throw std::runtime_error("Shards were converted from different GTModels or metadata");
+    }
+
+    for (const auto &geoCell : shard.m_geoCells) {
+        if (!m_geoCells.insert(geoCell).second) {
+            throw std::runtime_error("GeoCell " + geoCell.first.generic_string()
+                                     + " was converted by more than one shard");
+        }
+    }
+}
+
+void BuildManifest::writeToFile(const std::filesystem::path &file) const
+{
+    nlohmann::json manifestJson;
+    manifestJson["version"] = MANIFEST_VERSION;
+    manifestJson["settings"] = m_settings;
+    manifestJson["sharedInputs"] = convertFilesToJson(m_sharedInputs);
+    manifestJson["geoCells"] = nlohmann::json::object();
+    for (const auto &geoCell : m_geoCells) {
+        nlohmann::json geoCellJson;
+        geoCellJson["inputs"] = convertFilesToJson(geoCell.second.inputs);
+        geoCellJson["tilesets"] = nlohmann::json::array();
+        for (const auto &tileset : geoCell.second.tilesets) {
+            geoCellJson["tilesets"].emplace_back(tileset.generic_string());
+        }
+
+        geoCellJson["tilesetHeights"] = geoCell.second.tilesetHeights;
+
+        manifestJson["geoCells"][geoCell.first.generic_string()] = std::move(geoCellJson);
+    }
+
+    // write next to the manifest and rename over it, so an interrupted run never leaves a truncated manifest
+    std::filesystem::path temporaryFile = file;
+    temporaryFile += ".tmp";
+    {
+        std::ofstream fs(temporaryFile);
+        fs << manifestJson;
+        if (!fs) {
+            throw std::runtime_error("Cannot write build manifest " + temporaryFile.string());
+        }
+    }
+
+    std::filesystem::rename(temporaryFile, file);
+}
+
+std::optional<BuildManifest> BuildManifest::createFromFile(const std::filesystem::path &file)
+{
+    std::ifstream fs(file);
+    if (!fs) {
+        return std::nullopt;
+    }
+
+    nlohmann::json manifestJson = nlohmann::json::parse(fs, nullptr, false);
+    if (manifestJson.is_discarded() || !manifestJson.is_object()) {
+        return std::nullopt;
+    }
+
+    try {
+        if (manifestJson.at("version").get<int>() != MANIFEST_VERSION) {
+            return std::nullopt;
+        }
+
+        BuildManifest manifest(manifestJson.at("settings").get<std::string>());
+        manifest.m_sharedInputs = parseFilesFromJson(manifestJson.at("sharedInputs"));
+        for (const auto &geoCellJson : manifestJson.at("geoCells").items()) {
+            BuildManifestGeoCell geoCell;
+            geoCell.inputs = parseFilesFromJson(geoCellJson.value().at("inputs"));
+            for (const auto &tileset : geoCellJson.value().at("tilesets")) {
+                geoCell.tilesets.emplace_back(tileset.get<std::string>());
+            }
+
+            const auto &tilesetHeights = geoCellJson.value().at("tilesetHeights");
+            geoCell.tilesetHeights = tilesetHeights.get<std::vector<std::array<double, 2>>>();
+            if (geoCell.tilesetHeights.size() != geoCell.tilesets.size()) {
+                return std::nullopt;
+            }
+
+            manifest.m_geoCells.insert({geoCellJson.key(), std::move(geoCell)});
+        }
+
+        return manifest;
+    } catch (const nlohmann::json::exception &) {
+        return std::nullopt;
+    }
+}
+
+std::vector<BuildManifestFile> BuildManifest::collectInputFiles(
+    const std::filesystem::path &root,
+    const std::filesystem::path &directory,
+    const std::vector<BuildManifestFile> *previous)
+{
+    std::vector<BuildManifestFile> files;
+    if (!std::filesystem::is_directory(directory)) {
+        return files;
+    }
+
+    for (const auto &entry : std::filesystem::recursive_directory_iterator(directory)) {
+        if (!entry.is_regular_file()) {
+            continue;
+        }
+
+        BuildManifestFile file;
+        file.path = std::filesystem::relative(entry.path(), root).generic_string();
+        file.size = static_cast<uint64_t>(entry.file_size());
+        file.modifiedTime = static_cast<int64_t>(entry.last_write_time().time_since_epoch().count());
+        file.contentHash = 0;
+        files.emplace_back(std::move(file));
+    }
+
+    std::sort(files.begin(), files.end(), [](const BuildManifestFile &lhs, const BuildManifestFile &rhs) {
+        return lhs.path < rhs.path;
+    });
+
+    // hashing is the expensive part, so only files whose size or time stamp changed are read again
+    auto isPathLess = [](const BuildManifestFile &lhs, const std::filesystem::path &path) {
+        return lhs.path < path;
+    };
+
+    for (auto &file : files) {
+        if (previous) {
+            auto previousFile = std::lower_bound(previous->begin(), previous->end(), file.path, isPathLess);
+            if (previousFile != previous->end() && previousFile->path == file.path
+                && previousFile->size == file.size && previousFile->modifiedTime == file.modifiedTime) {
+                file.contentHash = previousFile->contentHash;
+                continue;
+            }
+        }
+
+        file.contentHash = hashFileContent(root / file.path);
+    }
+
+    return files;
+}
+
+uint64_t BuildManifest::hashFileContent(const std::filesystem::path &file)
+{
+    auto mappedFile = MappedFile::createFromFile(file);
+    if (!mappedFile) {
+        throw std::runtime_error("Cannot read " + file.string());
+    }
+
+    return computeContentHash(mappedFile->getData(), mappedFile->getSize());
+}
+
+std::filesystem::path BuildManifest::getShardFilename(size_t shardIndex, size_t shardCount)
+{
+    return SHARD_FILENAME_PREFIX + std::to_string(shardIndex) + SHARD_FILENAME_SEPARATOR
+           + std::to_string(shardCount) + SHARD_FILENAME_EXTENSION;
+}
+
+std::optional<std::pair<size_t, size_t>> BuildManifest::parseShardFilename(const std::string &filename)
+{
+    if (filename.size() <= SHARD_FILENAME_PREFIX.size() + SHARD_FILENAME_EXTENSION.size()
+        || filename.compare(0, SHARD_FILENAME_PREFIX.size(), SHARD_FILENAME_PREFIX) != 0
+        || filename.compare(filename.size() - SHARD_FILENAME_EXTENSION.size(),
+                            SHARD_FILENAME_EXTENSION.size(),
+                            SHARD_FILENAME_EXTENSION)
+               != 0) {
+        return std::nullopt;
+    }
+
+    std::string shard = filename.substr(SHARD_FILENAME_PREFIX.size(),
+                                        filename.size() - SHARD_FILENAME_PREFIX.size()
+                                            - SHARD_FILENAME_EXTENSION.size());
+    size_t separator = shard.find(SHARD_FILENAME_SEPARATOR);
+    if (separator == std::string::npos) {
+        return std::nullopt;
+    }
+
+    std::string index = shard.substr(0, separator);
+    std::string count = shard.substr(separator + SHARD_FILENAME_SEPARATOR.size());
+    auto isNumber = [](const std::string &text) {
+        return !text.empty() && std::all_of(text.begin(), text.end(), [](char c) {
+            return std::isdigit(static_cast<unsigned char>(c)) != 0;
+        });
+    };
+
+    if (!isNumber(index) || !isNumber(count)) {
+        return std::nullopt;
+    }
+
+    size_t shardIndex = std::stoul(index);
+    size_t shardCount = std::stoul(count);
+    if (shardIndex >= shardCount) {
+        return std::nullopt;
+    }
+
+    return std::make_pair(shardIndex, shardCount);
+}
+
+nlohmann::json convertFilesToJson(const std::vector<BuildManifestFile> &files)
+{
+    auto filesJson = nlohmann::json::array();
+    for (const auto &file : files) {
+        nlohmann::json fileJson;
+        fileJson["path"] = file.path.generic_string();
+        fileJson["size"] = file.size;
+        fileJson["modifiedTime"] = file.modifiedTime;
+        fileJson["contentHash"] = file.contentHash;
+        filesJson.emplace_back(std::move(fileJson));
+    }
+
+    return filesJson;
+}
+
+std::vector<BuildManifestFile> parseFilesFromJson(const nlohmann::json &json)
+{
+    std::vector<BuildManifestFile> files;
+    files.reserve(json.size());
+    for (const auto &fileJson : json) {
+        BuildManifestFile file;
+        file.path = fileJson.at("path").get<std::string>();
+        file.size = fileJson.at("size").get<uint64_t>();
+        file.modifiedTime = fileJson.at("modifiedTime").get<int64_t>();
+        file.contentHash = fileJson.at("contentHash").get<uint64_t>();
+        files.emplace_back(std::move(file));
+    }
+
+    return files;
+}
+} // namespace CDBTo3DTiles
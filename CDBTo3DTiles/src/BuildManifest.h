@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace CDBTo3DTiles {
+struct BuildManifestFile
+{
+    std::filesystem::path path;
+    uint64_t size;
+    int64_t modifiedTime;
+    uint64_t contentHash;
+};
+
+bool operator==(const BuildManifestFile &lhs, const BuildManifestFile &rhs) noexcept;
+
+bool operator!=(const BuildManifestFile &lhs, const BuildManifestFile &rhs) noexcept;
+
+struct BuildManifestGeoCell
+{
+    std::vector<BuildManifestFile> inputs;
+    std::vector<std::filesystem::path> tilesets;
+
+    // Minimum and maximum height of the content of each tileset, in the same order as tilesets
+    std::vector<std::array<double, 2>> tilesetHeights;
+};
+
+class BuildManifest
+{
+public:
+    explicit BuildManifest(const std::string &settings);
+
+    inline const std::string &getSettings() const noexcept { return m_settings; }
+
+    inline const std::vector<BuildManifestFile> &getSharedInputs() const noexcept { return m_sharedInputs; }
+
+    void setSharedInputs(std::vector<BuildManifestFile> sharedInputs);
+
+    inline const std::map<std::filesystem::path, BuildManifestGeoCell> &getGeoCells() const noexcept
+    {
+        return m_geoCells;
+    }
+
+    const BuildManifestGeoCell *getGeoCell(const std::filesystem::path &geoCellPath) const;
+
+    void setGeoCell(const std::filesystem::path &geoCellPath, BuildManifestGeoCell geoCell);
+
+    void removeGeoCell(const std::filesystem::path &geoCellPath);
+
+    // Adds the GeoCells of a manifest written by another shard of the same conversion. Throws if the shard was
+    // converted with different settings or shared inputs, or converted a GeoCell this manifest already has
+    void merge(const BuildManifest &shard);
+
+    void writeToFile(const std::filesystem::path &file) const;
+
+    static std::optional<BuildManifest> createFromFile(const std::filesystem::path &file);
+
+    static std::vector<BuildManifestFile> collectInputFiles(const std::filesystem::path &root,
+                                                            const std::filesystem::path &directory,
+                                                            const std::vector<BuildManifestFile> *previous);
+
+    static uint64_t hashFileContent(const std::filesystem::path &file);
+
+    // The manifest a shard of a conversion writes instead of FILENAME, so shards can share an output directory
+    static std::filesystem::path getShardFilename(size_t shardIndex, size_t shardCount);
+
+    // Returns the index and count of the shard that wrote a manifest with this filename
+    static std::optional<std::pair<size_t, size_t>> parseShardFilename(const std::string &filename);
+
+    static const std::filesystem::path FILENAME;
+
+private:
+    std::string m_settings;
+    std::vector<BuildManifestFile> m_sharedInputs;
+    std::map<std::filesystem::path, BuildManifestGeoCell> m_geoCells;
+};
+} // namespace CDBTo3DTiles
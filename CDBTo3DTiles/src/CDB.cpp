@@ -1,45 +1,85 @@
 #include "CDB.h"
+#include "ConversionStats.h"
+#include <algorithm>
 #include <iostream>
 #include <string.h>
+#include <thread>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
 namespace CDBTo3DTiles {
 
+static bool isDirectoryScanned(const CDBFilter &filter, const std::string &directory);
+
+static std::optional<int> parseLevelFromDirectoryName(const std::string &directoryName);
+
 const std::filesystem::path CDB::TILES = "Tiles";
 const std::filesystem::path CDB::METADATA = "Metadata";
 const std::filesystem::path CDB::GTModel = "GTModel";
 
 CDB::CDB(const std::filesystem::path &path)
     : m_path{path}
+    , m_elevationSampler(path, ElevationSampler::DEFAULT_CACHE_SIZE)
+    , m_prefetchDepth{0}
 {
     m_GTModelCache = CDBGTModelCache(path);
 }
 
-void CDB::forEachGeoCell(std::function<void(CDBGeoCell)> process)
+void CDB::setFilter(const CDBFilter &filter)
+{
+    m_filter = filter;
+    m_catalog.reset();
+    m_GTModelCache->setCatalog(nullptr);
+}
+
+const CDBCatalog &CDB::getCatalog() const
+{
+    if (!m_catalog) {
+        ScopedStageTimer timer("scanCDB");
+        size_t threadCount = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, MAX_SCAN_THREADS);
+        auto isScanned = [this](const std::string &directory) {
+            return isDirectoryScanned(m_filter, directory);
+        };
+
+        m_catalog = CDBCatalog::createFromDirectory(m_path, threadCount, isScanned);
+    }
+
+    return *m_catalog;
+}
+
+void CDB::setPrefetchDepth(size_t depth)
 {
-    std::filesystem::path tilesPath = m_path / TILES;
+    m_prefetchDepth = depth;
+    m_prefetcher.reset();
+    if (depth > 0) {
+        m_prefetcher = std::make_unique<FilePrefetcher>(std::min(depth, MAX_PREFETCH_THREADS));
+    }
+}
 
-    if (!std::filesystem::exists(tilesPath) || !std::filesystem::is_directory(tilesPath)) {
-        throw std::runtime_error(tilesPath.string() + " directory does not exist");
+void CDB::forEachGeoCell(std::function<void(CDBGeoCell)> process)
+{
+    const auto &catalog = getCatalog();
+    if (!catalog.isDirectoryExist(TILES)) {
+        throw std::runtime_error((m_path / TILES).string() + " directory does not exist");
     }
 
-    for (std::filesystem::directory_entry geoCellLatDir : std::filesystem::directory_iterator(tilesPath)) {
-        auto geoCellLatitude = CDBGeoCell::parseLatFromFilename(geoCellLatDir.path().filename().string());
-        if (!geoCellLatitude) {
+    for (const auto &geoCellLatDir : catalog.getDirectories(TILES)) {
+        auto geoCellLatitude = CDBGeoCell::parseLatFromFilename(geoCellLatDir);
+        if (!geoCellLatitude || !m_filter.isLatitudeIncluded(*geoCellLatitude)) {
             continue;
         }
 
-        for (std::filesystem::directory_entry geoCellLongDir :
-             std::filesystem::directory_iterator(geoCellLatDir)) {
-            auto geoCellLongitude = CDBGeoCell::parseLongFromFilename(
-                geoCellLongDir.path().filename().string());
+        for (const auto &geoCellLongDir : catalog.getDirectories(TILES / geoCellLatDir)) {
+            auto geoCellLongitude = CDBGeoCell::parseLongFromFilename(geoCellLongDir);
             if (!geoCellLongitude) {
                 continue;
             }
 
-            process(CDBGeoCell(*geoCellLatitude, *geoCellLongitude));
+            CDBGeoCell geoCell(*geoCellLatitude, *geoCellLongitude);
+            if (m_filter.isGeoCellIncluded(geoCell)) {
+                process(geoCell);
+            }
         }
     }
 }
@@ -47,8 +87,25 @@ void CDB::forEachGeoCell(std::function<void(CDBGeoCell)> process)
 void CDB::forEachElevationTile(const CDBGeoCell &geoCell, std::function<void(CDBElevation)> process)
 {
     forEachDatasetTile(geoCell, CDBDataset::Elevation, [&](const std::filesystem::path &elevationTilePath) {
-        std::optional<CDBElevation> elevation = CDBElevation::createFromFile(elevationTilePath);
+        std::optional<CDBElevation> elevation;
+        {
+            ScopedStageTimer timer("readElevation");
+            timer.addInputFile(elevationTilePath);
+            std::optional<PrefetchedFile> prefetchedFile;
+            if (m_prefetcher && elevationTilePath.extension() == ".tif") {
+                prefetchedFile = m_prefetcher->take(elevationTilePath);
+            }
+
+            if (prefetchedFile) {
+                elevation = CDBElevation::createFromFile(elevationTilePath, prefetchedFile->getGDALPath());
+            } else {
+                elevation = CDBElevation::createFromFile(elevationTilePath);
+            }
+        }
+
         if (elevation) {
+            // model clamping samples the same rasters later, keep them decoded
+            m_elevationSampler.insertGrid(elevation->getTile(), elevation->getHeightGrid());
             process(std::move(*elevation));
         }
     });
@@ -56,6 +113,9 @@ void CDB::forEachElevationTile(const CDBGeoCell &geoCell, std::function<void(CDB
 
 void CDB::forEachGTModelTile(const CDBGeoCell &geoCell, std::function<void(CDBGTModels)> process)
 {
+    // models are looked up in the library through the catalog
+    m_GTModelCache->setCatalog(&getCatalog());
+
     std::unordered_map<size_t, CDBTileset> tilesets;
     forEachDatasetTile(geoCell, CDBDataset::GTFeature, [&](const std::filesystem::path &GTFeaturePath) {
         if (GTFeaturePath.extension() != ".dbf") {
@@ -79,12 +139,17 @@ void CDB::forEachGTModelTile(const CDBGeoCell &geoCell, std::function<void(CDBGT
     });
 
     for (const auto &tileset : tilesets) {
-        traverseModelsAttributes(tileset.second.getRoot(),
-                                 nullptr,
+        traverseModelsAttributes(tileset.second,
+                                 tileset.second.getRoot(),
                                  nullptr,
                                  [&](CDBModelsAttributes modelsAttributes) {
-                                     auto models = CDBGTModels::createFromModelsAttributes(modelsAttributes,
+                                     std::optional<CDBGTModels> models;
+                                     {
+                                         ScopedStageTimer timer("readModels");
+                                         models = CDBGTModels::createFromModelsAttributes(modelsAttributes,
                                                                                            &*m_GTModelCache);
+                                     }
+
                                      if (models) {
                                          process(std::move(*models));
                                      }
@@ -117,12 +182,17 @@ void CDB::forEachGSModelTile(const CDBGeoCell &geoCell, std::function<void(CDBGS
     });
 
     for (const auto &tileset : tilesets) {
-        traverseModelsAttributes(tileset.second.getRoot(),
-                                 nullptr,
+        traverseModelsAttributes(tileset.second,
+                                 tileset.second.getRoot(),
                                  nullptr,
                                  [&](CDBModelsAttributes modelAttribute) {
-                                     auto models = CDBGSModels::createFromModelsAttributes(modelAttribute,
+                                     std::optional<CDBGSModels> models;
+                                     {
+                                         ScopedStageTimer timer("readModels");
+                                         models = CDBGSModels::createFromModelsAttributes(modelAttribute,
                                                                                            m_path);
+                                     }
+
                                      if (models) {
                                          process(std::move(*models));
                                      }
@@ -133,8 +203,8 @@ void CDB::forEachGSModelTile(const CDBGeoCell &geoCell, std::function<void(CDBGS
 void CDB::forEachRoadNetworkTile(const CDBGeoCell &geoCell, std::function<void(CDBGeometryVectors)> process)
 {
     forEachDatasetTile(geoCell, CDBDataset::RoadNetwork, [&](const std::filesystem::path &roadNetworkTilePath) {
-        std::optional<CDBGeometryVectors> roadNetwork = CDBGeometryVectors::createFromFile(roadNetworkTilePath,
-                                                                                           m_path);
+        std::optional<CDBGeometryVectors> roadNetwork
+            = CDBGeometryVectors::createFromFile(roadNetworkTilePath, m_path, m_prefetcher.get());
         if (roadNetwork) {
             process(std::move(*roadNetwork));
         }
@@ -148,7 +218,9 @@ void CDB::forEachRailRoadNetworkTile(const CDBGeoCell &geoCell,
                        CDBDataset::RailRoadNetwork,
                        [&](const std::filesystem::path &railRoadNetworkTilePath) {
                            std::optional<CDBGeometryVectors> railRoadNetwork
-                               = CDBGeometryVectors::createFromFile(railRoadNetworkTilePath, m_path);
+                               = CDBGeometryVectors::createFromFile(railRoadNetworkTilePath,
+                                                                    m_path,
+                                                                    m_prefetcher.get());
                            if (railRoadNetwork) {
                                process(std::move(*railRoadNetwork));
                            }
@@ -162,7 +234,9 @@ void CDB::forEachPowerlineNetworkTile(const CDBGeoCell &geoCell,
                        CDBDataset::PowerlineNetwork,
                        [&](const std::filesystem::path &powerlineNetworkTilePath) {
                            std::optional<CDBGeometryVectors> powerlineNetwork
-                               = CDBGeometryVectors::createFromFile(powerlineNetworkTilePath, m_path);
+                               = CDBGeometryVectors::createFromFile(powerlineNetworkTilePath,
+                                                                    m_path,
+                                                                    m_prefetcher.get());
                            if (powerlineNetwork) {
                                process(std::move(*powerlineNetwork));
                            }
@@ -176,16 +250,18 @@ void CDB::forEachHydrographyNetworkTile(const CDBGeoCell &geoCell,
                        CDBDataset::HydrographyNetwork,
                        [&](const std::filesystem::path &hydrographyNetworkTilePath) {
                            std::optional<CDBGeometryVectors> hydrographyNetwork
-                               = CDBGeometryVectors::createFromFile(hydrographyNetworkTilePath, m_path);
+                               = CDBGeometryVectors::createFromFile(hydrographyNetworkTilePath,
+                                                                    m_path,
+                                                                    m_prefetcher.get());
                            if (hydrographyNetwork) {
                                process(std::move(*hydrographyNetwork));
                            }
                        });
 }
 
-void CDB::traverseModelsAttributes(const CDBTile *root,
+void CDB::traverseModelsAttributes(const CDBTileset &tileset,
+                                   const CDBTile *root,
                                    const CDBTile *oldElevationTile,
-                                   GDALDataset *oldElevationDataset,
                                    std::function<void(CDBModelsAttributes)> process)
 {
     if (root == nullptr) {
@@ -194,12 +270,16 @@ void CDB::traverseModelsAttributes(const CDBTile *root,
 
     const auto &featureFile = root->getCustomContentURI();
     if (featureFile) {
-        GDALDatasetUniquePtr attributesDataset = GDALDatasetUniquePtr(
-            (GDALDataset *) GDALOpenEx(featureFile->c_str(), GDAL_OF_VECTOR, nullptr, nullptr, nullptr));
+        std::optional<CDBModelsAttributes> model;
+        {
+            ScopedStageTimer timer("readAttributes");
+            timer.addInputFile(*featureFile);
+            timer.addInputFile(std::filesystem::path(*featureFile).replace_extension(".shp"));
+            model = CDBModelsAttributes::createFromFile(*featureFile, *root, m_path);
+        }
 
-        if (attributesDataset) {
-            CDBModelsAttributes model(std::move(attributesDataset), *root, m_path);
-            if (model.getInstancesAttributes().getInstancesCount() > 0) {
+        if (model) {
+            if (model->getInstancesAttributes().getInstancesCount() > 0) {
                 CDBTile currentElevation = CDBTile(root->getGeoCell(),
                                                    CDBDataset::Elevation,
                                                    1,
@@ -208,45 +288,37 @@ void CDB::traverseModelsAttributes(const CDBTile *root,
                                                    root->getUREF(),
                                                    root->getRREF());
 
-                auto currentElevationPath = m_path / (currentElevation.getRelativePath().string() + ".tif");
-                if (!std::filesystem::exists(currentElevationPath)) {
+                if (!isElevationExist(currentElevation)) {
                     // reuse the previous read parent elevation if there is any
                     if (oldElevationTile) {
-                        for (auto &point : model.getCartographicPositions()) {
-                            clampPointOnElevation(*oldElevationTile, *oldElevationDataset, point);
+                        {
+                            ScopedStageTimer timer("clampModels");
+                            m_elevationSampler.sampleHeights(*oldElevationTile,
+                                                             model->getCartographicPositions());
                         }
 
-                        process(std::move(model));
-                        for (auto child : root->getChildren()) {
-                            traverseModelsAttributes(child, oldElevationTile, oldElevationDataset, process);
+                        process(std::move(*model));
+                        for (auto child : tileset.getChildren(*root)) {
+                            traverseModelsAttributes(tileset, child, oldElevationTile, process);
                         }
                     } else {
                         // find the parent elevation to clamp on if no current elevation is found
-                        auto parentElevation = queryParentElevationTiles(currentElevation);
-                        GDALDatasetUniquePtr elevationData;
-                        if (parentElevation) {
-                            auto elevationFile = m_path
-                                                 / (parentElevation->getRelativePath().string() + ".tif");
-                            elevationData = GDALDatasetUniquePtr(
-                                (GDALDataset *) GDALOpen(elevationFile.c_str(), GDALAccess::GA_ReadOnly));
-
-                            if (elevationData) {
-                                for (auto &point : model.getCartographicPositions()) {
-                                    clampPointOnElevation(*parentElevation, *elevationData, point);
-                                }
+                        std::optional<CDBTile> parentElevation;
+                        {
+                            ScopedStageTimer timer("clampModels");
+                            parentElevation = queryParentElevationTiles(currentElevation);
+                            if (parentElevation) {
+                                m_elevationSampler.sampleHeights(*parentElevation,
+                                                                 model->getCartographicPositions());
                             }
                         }
 
-                        process(std::move(model));
-                        for (auto child : root->getChildren()) {
-                            if (parentElevation) {
-                                traverseModelsAttributes(child,
-                                                         &*parentElevation,
-                                                         elevationData.get(),
-                                                         process);
-                            } else {
-                                traverseModelsAttributes(child, nullptr, nullptr, process);
-                            }
+                        process(std::move(*model));
+                        for (auto child : tileset.getChildren(*root)) {
+                            traverseModelsAttributes(tileset,
+                                                     child,
+                                                     parentElevation ? &*parentElevation : nullptr,
+                                                     process);
                         }
                     }
 
@@ -258,21 +330,25 @@ void CDB::traverseModelsAttributes(const CDBTile *root,
                 // can continue refining due to higher LOD and completely cover low level GTFeature point, making the GTModel sink inside the terrain mesh.
                 // We don't need to do this for non-leaf since it will be replaced by higher level anyway due to
                 // replace refinement
-                CDBTileset underlyingElevations(root->getLevel(), root->getUREF(), root->getRREF());
-                if (root->getChildren().empty()) {
-                    queryElevationTiles(currentElevation, underlyingElevations);
-                } else {
-                    underlyingElevations.insertTile(currentElevation);
+                {
+                    ScopedStageTimer timer("clampModels");
+                    CDBTileset underlyingElevations(root->getLevel(), root->getUREF(), root->getRREF());
+                    if (tileset.isLeaf(*root)) {
+                        queryElevationTiles(currentElevation, underlyingElevations);
+                    } else {
+                        underlyingElevations.insertTile(currentElevation);
+                    }
+
+                    clampPointsOnElevationTileset(model->getCartographicPositions(), underlyingElevations);
                 }
 
-                clampPointsOnElevationTileset(model.getCartographicPositions(), underlyingElevations);
-                process(std::move(model));
+                process(std::move(*model));
             }
         }
     }
 
-    for (auto child : root->getChildren()) {
-        traverseModelsAttributes(child, nullptr, nullptr, process);
+    for (auto child : tileset.getChildren(*root)) {
+        traverseModelsAttributes(tileset, child, nullptr, process);
     }
 }
 
@@ -353,64 +429,21 @@ void CDB::clampPointsOnElevationTileset(std::vector<Core::Cartographic> &points,
                                         const CDBTileset &elevationTileset)
 {
     if (elevationTileset.getRoot()) {
-        std::unordered_map<CDBTile, std::vector<size_t>> elevationToClamp;
+        // tiles live in the tileset for the whole function, so they are grouped by address instead of by hash
+        std::unordered_map<const CDBTile *, std::vector<size_t>> elevationToClamp;
         for (size_t i = 0; i < points.size(); ++i) {
             auto elevationTile = elevationTileset.getFitTile(points[i]);
             if (elevationTile) {
-                elevationToClamp[*elevationTile].emplace_back(i);
+                elevationToClamp[elevationTile].emplace_back(i);
             }
         }
 
         for (const auto &elevation : elevationToClamp) {
-            const auto &elevationTile = elevation.first;
-            auto elevationFile = m_path / (elevationTile.getRelativePath().string() + ".tif");
-            GDALDatasetUniquePtr rasterData = GDALDatasetUniquePtr(
-                (GDALDataset *) GDALOpen(elevationFile.c_str(), GDALAccess::GA_ReadOnly));
-
-            if (rasterData == nullptr) {
-                continue;
-            }
-
-            auto heightBand = rasterData->GetRasterBand(1);
-            auto rasterDataType = heightBand->GetRasterDataType();
-            if (rasterDataType != GDT_Float32 && rasterDataType != GDT_Float64) {
-                return;
-            }
-
-            for (auto i : elevation.second) {
-                clampPointOnElevation(elevationTile, *rasterData, points[i]);
-            }
+            m_elevationSampler.sampleHeights(*elevation.first, points, elevation.second);
         }
     }
 }
 
-void CDB::clampPointOnElevation(const CDBTile &elevationTile,
-                                GDALDataset &elevationDataset,
-                                Core::Cartographic &point)
-{
-    const Core::BoundingRegion &region = elevationTile.getBoundRegion();
-    const Core::GlobeRectangle &rectangle = region.getRectangle();
-    auto heightBand = elevationDataset.GetRasterBand(1);
-    double rectangleWidth = rectangle.computeWidth();
-    double rectangleHeight = rectangle.computeHeight();
-    int rasterXSize = heightBand->GetXSize();
-    int rasterYSize = heightBand->GetYSize();
-    double gapX = rectangleWidth / rasterXSize;
-    double gapY = rectangleHeight / rasterYSize;
-
-    int x = static_cast<int>(glm::floor((point.longitude - rectangle.getWest()) / gapX));
-    x = glm::min(x, rasterXSize - 1);
-    int y = static_cast<int>(glm::floor((point.latitude - rectangle.getSouth()) / gapY));
-    y = glm::min(rasterYSize - y - 1, rasterYSize - 1);
-    double height = 0.0;
-    if (GDALRasterIO(heightBand, GDALRWFlag::GF_Read, x, y, 1, 1, &height, 1, 1, GDALDataType::GDT_Float64, 0, 0)
-        != CE_None) {
-        height = 0.0;
-    }
-
-    point.height = height;
-}
-
 bool CDB::isElevationExist(const CDBTile &tile) const
 {
     CDBTile elevationTile = CDBTile(tile.getGeoCell(),
@@ -421,22 +454,12 @@ bool CDB::isElevationExist(const CDBTile &tile) const
                                     tile.getUREF(),
                                     tile.getRREF());
 
-    auto elevationPath = m_path / (elevationTile.getRelativePath().string() + ".tif");
-    return std::filesystem::exists(elevationPath);
+    return getCatalog().isFileExist(elevationTile.getRelativePath().string() + ".tif");
 }
 
 bool CDB::isImageryExist(const CDBTile &tile) const
 {
-    CDBTile imageryTile = CDBTile(tile.getGeoCell(),
-                                  CDBDataset::Imagery,
-                                  1,
-                                  1,
-                                  tile.getLevel(),
-                                  tile.getUREF(),
-                                  tile.getRREF());
-
-    auto imagery = m_path / (imageryTile.getRelativePath().string() + ".jp2");
-    return std::filesystem::exists(imagery);
+    return getCatalog().isFileExist(getImageryRelativePath(tile));
 }
 
 std::optional<CDBImagery> CDB::getImagery(const CDBTile &tile) const
@@ -449,18 +472,33 @@ std::optional<CDBImagery> CDB::getImagery(const CDBTile &tile) const
                                   tile.getUREF(),
                                   tile.getRREF());
 
-    auto imageryPath = m_path / (imageryTile.getRelativePath().string() + ".jp2");
-    if (!std::filesystem::exists(imageryPath)) {
+    auto imageryRelativePath = getImageryRelativePath(imageryTile);
+    if (!getCatalog().isFileExist(imageryRelativePath)) {
         return std::nullopt;
     }
 
+    auto imageryPath = m_path / imageryRelativePath;
+
+    ScopedStageTimer timer("readImagery");
+    timer.addInputFile(imageryPath);
+    std::optional<PrefetchedFile> prefetchedFile;
+    if (m_prefetcher) {
+        prefetchedFile = m_prefetcher->take(imageryPath);
+    }
+
+    std::string imageryFile = prefetchedFile ? prefetchedFile->getGDALPath() : imageryPath.string();
     auto imageryDataset = GDALDatasetUniquePtr(
-        (GDALDataset *) GDALOpen(imageryPath.c_str(), GDALAccess::GA_ReadOnly));
+        (GDALDataset *) GDALOpen(imageryFile.c_str(), GDALAccess::GA_ReadOnly));
 
     if (!imageryDataset) {
         return std::nullopt;
     }
 
+    // the driver may read the in-memory file again until the dataset is closed
+    if (prefetchedFile) {
+        return CDBImagery(std::move(imageryDataset), imageryTile, std::move(*prefetchedFile));
+    }
+
     return CDBImagery(std::move(imageryDataset), imageryTile);
 }
 
@@ -468,25 +506,148 @@ void CDB::forEachDatasetTile(const CDBGeoCell &geoCell,
                              CDBDataset dataset,
                              std::function<void(const std::filesystem::path &)> process)
 {
-    auto datasetPath = m_path / geoCell.getRelativePath() / getCDBDatasetDirectoryName(dataset);
-    if (!std::filesystem::exists(datasetPath) || !std::filesystem::is_directory(datasetPath)) {
+    if (!m_filter.isDatasetIncluded(dataset)) {
         return;
     }
 
-    for (std::filesystem::directory_entry levelDir : std::filesystem::directory_iterator(datasetPath)) {
-        if (!std::filesystem::is_directory(levelDir)) {
-            continue;
+    const auto &catalog = getCatalog();
+    auto datasetPath = geoCell.getRelativePath() / getCDBDatasetDirectoryName(dataset);
+
+    // levels out of the filtered range are skipped by their directory name. Negative levels share the LC
+    // directory, so its tiles are told apart by their file name when only some of them are included
+    auto levelRange = m_filter.getLevelRange(dataset);
+    bool isEveryNegativeLevelIncluded = levelRange.first <= CDBFilter::MIN_LEVEL && levelRange.second >= -1;
+    std::vector<std::filesystem::path> tilePaths;
+    for (const auto &levelDir : catalog.getDirectories(datasetPath)) {
+        auto level = parseLevelFromDirectoryName(levelDir);
+        bool isNegativeLevelDir = level && *level < 0;
+        if (level) {
+            if (isNegativeLevelDir ? levelRange.first >= 0 : !m_filter.isLevelIncluded(dataset, *level)) {
+                continue;
+            }
         }
 
-        for (std::filesystem::directory_entry UREFDir : std::filesystem::directory_iterator(levelDir)) {
-            if (!std::filesystem::is_directory(UREFDir)) {
-                continue;
+        auto levelPath = datasetPath / levelDir;
+        for (const auto &UREFDir : catalog.getDirectories(levelPath)) {
+            auto UREFPath = m_path / levelPath / UREFDir;
+            for (const auto &tileFile : catalog.getFiles(levelPath / UREFDir)) {
+                auto tilePath = UREFPath / tileFile;
+                if (isNegativeLevelDir && !isEveryNegativeLevelIncluded) {
+                    auto tile = CDBTile::createFromFile(tilePath.stem().string());
+                    if (tile && !m_filter.isLevelIncluded(dataset, tile->getLevel())) {
+                        continue;
+                    }
+                }
+
+                tilePaths.emplace_back(std::move(tilePath));
+            }
+        }
+    }
+
+    // the files of the next tiles are read in the background while a tile is processed
+    size_t prefetchedTileCount = 0;
+    for (size_t i = 0; i < tilePaths.size(); ++i) {
+        if (m_prefetcher) {
+            size_t prefetchEnd = std::min(tilePaths.size(), i + 1 + m_prefetchDepth);
+            for (; prefetchedTileCount < prefetchEnd; ++prefetchedTileCount) {
+                for (const auto &file : getPrefetchFiles(dataset, tilePaths[prefetchedTileCount])) {
+                    m_prefetcher->prefetch(file);
+                }
             }
+        }
 
-            for (std::filesystem::directory_entry tilePath : std::filesystem::directory_iterator(UREFDir)) {
-                process(tilePath);
+        process(tilePaths[i]);
+
+        // drop what the tile didn't use, e.g. the imagery of elevation that failed to load
+        if (m_prefetcher) {
+            for (const auto &file : getPrefetchFiles(dataset, tilePaths[i])) {
+                m_prefetcher->discard(file);
             }
         }
     }
 }
+
+std::vector<std::filesystem::path> CDB::getPrefetchFiles(CDBDataset dataset,
+                                                         const std::filesystem::path &tilePath) const
+{
+    switch (dataset) {
+    case CDBDataset::Elevation: {
+        if (tilePath.extension() != ".tif") {
+            return {};
+        }
+
+        // imagery is draped over the elevation of the same tile
+        std::vector<std::filesystem::path> files{tilePath};
+        auto tile = CDBTile::createFromFile(tilePath.stem().string());
+        if (tile) {
+            files.emplace_back(m_path / getImageryRelativePath(*tile));
+        }
+
+        return files;
+    }
+    case CDBDataset::RoadNetwork:
+    case CDBDataset::RailRoadNetwork:
+    case CDBDataset::PowerlineNetwork:
+    case CDBDataset::HydrographyNetwork:
+        if (tilePath.extension() != ".dbf") {
+            return {};
+        }
+
+        return {tilePath, std::filesystem::path(tilePath).replace_extension(".shp")};
+    default:
+        // feature tiles only collect paths here, their files are read when the tilesets are traversed
+        return {};
+    }
+}
+
+std::filesystem::path CDB::getImageryRelativePath(const CDBTile &tile) const
+{
+    CDBTile imageryTile = CDBTile(tile.getGeoCell(),
+                                  CDBDataset::Imagery,
+                                  1,
+                                  1,
+                                  tile.getLevel(),
+                                  tile.getUREF(),
+                                  tile.getRREF());
+
+    return imageryTile.getRelativePath().string() + ".jp2";
+}
+
+bool isDirectoryScanned(const CDBFilter &filter, const std::string &directory)
+{
+    // GeoCells left out by the filter are pruned at their latitude and longitude directories
+    std::filesystem::path path = directory;
+    if (path.begin() == path.end() || *path.begin() != CDB::TILES) {
+        return true;
+    }
+
+    auto depth = std::distance(path.begin(), path.end());
+    if (depth == 2) {
+        auto latitude = CDBGeoCell::parseLatFromFilename(path.filename().string());
+        return !latitude || filter.isLatitudeIncluded(*latitude);
+    }
+
+    if (depth == 3) {
+        auto geoCell = CDBGeoCell::parseFromRelativePath(path);
+        return !geoCell || filter.isGeoCellIncluded(*geoCell);
+    }
+
+    return true;
+}
+
+std::optional<int> parseLevelFromDirectoryName(const std::string &directoryName)
+{
+    // every negative level is in the LC directory, so -1 stands for all of them
+    if (directoryName == "LC") {
+        return -1;
+    }
+
+    int level;
+    char rest;
+    if (sscanf(directoryName.c_str(), "L%d%c", &level, &rest) != 1) {
+        return std::nullopt;
+    }
+
+    return level;
+}
 } // namespace CDBTo3DTiles
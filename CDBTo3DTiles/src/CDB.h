@@ -1,15 +1,21 @@
 #pragma once
 
+#include "CDBCatalog.h"
 #include "CDBElevation.h"
+#include "CDBFilter.h"
 #include "CDBGeometryVectors.h"
 #include "CDBImagery.h"
 #include "CDBModels.h"
 #include "CDBTileset.h"
+#include "ElevationSampler.h"
+#include "FilePrefetcher.h"
 #include <filesystem>
 #include <functional>
+#include <memory>
 #include <optional>
 #include <stack>
 #include <string>
+#include <vector>
 
 namespace CDBTo3DTiles {
 
@@ -18,6 +24,24 @@ class CDB
 public:
     explicit CDB(const std::filesystem::path &path);
 
+    // Only the GeoCells, datasets and levels the filter includes are traversed
+    void setFilter(const CDBFilter &filter);
+
+    // The directories and files of the CDB, scanned on first use. GeoCells the filter leaves out are not
+    // scanned, so the filter is set first
+    const CDBCatalog &getCatalog() const;
+
+    inline const CDBFilter &getFilter() const noexcept { return m_filter; }
+
+    // Reads the files of the next tiles of a dataset on background threads while a tile is converted. A
+    // depth of 0 reads every file when it is needed
+    void setPrefetchDepth(size_t depth);
+
+    inline size_t getPrefetchDepth() const noexcept { return m_prefetchDepth; }
+
+    // Nothing is prefetched without a prefetcher
+    inline const FilePrefetcher *getPrefetcher() const noexcept { return m_prefetcher.get(); }
+
     void forEachGeoCell(std::function<void(CDBGeoCell geoCell)> process);
 
     void forEachElevationTile(const CDBGeoCell &geoCell, std::function<void(CDBElevation)> process);
@@ -43,14 +67,20 @@ public:
 
     std::optional<CDBImagery> getImagery(const CDBTile &tile) const;
 
+    inline ElevationSampler &getElevationSampler() noexcept { return m_elevationSampler; }
+
+    inline CDBGTModelCache &getGTModelCache() noexcept { return *m_GTModelCache; }
+
     static const std::filesystem::path TILES;
     static const std::filesystem::path METADATA;
     static const std::filesystem::path GTModel;
+    static constexpr size_t MAX_PREFETCH_THREADS = 8;
+    static constexpr size_t MAX_SCAN_THREADS = 16;
 
 private:
-    void traverseModelsAttributes(const CDBTile *root,
+    void traverseModelsAttributes(const CDBTileset &tileset,
+                                  const CDBTile *root,
                                   const CDBTile *oldElevationTile,
-                                  GDALDataset *oldElevationDataset,
                                   std::function<void(CDBModelsAttributes)> process);
 
     void queryElevationTiles(const CDBTile &elevationTile, CDBTileset &underlyingElevations);
@@ -60,16 +90,23 @@ private:
     void clampPointsOnElevationTileset(std::vector<Core::Cartographic> &points,
                                        const CDBTileset &elevationTileset);
 
-    void clampPointOnElevation(const CDBTile &elevationTile,
-                               GDALDataset &elevationDataset,
-                               Core::Cartographic &point);
-
     void forEachDatasetTile(const CDBGeoCell &geoCell,
                             CDBDataset dataset,
                             std::function<void(const std::filesystem::path &)> process);
 
+    // The files read when the tile is processed
+    std::vector<std::filesystem::path> getPrefetchFiles(CDBDataset dataset,
+                                                        const std::filesystem::path &tilePath) const;
+
+    std::filesystem::path getImageryRelativePath(const CDBTile &tile) const;
+
     std::optional<CDBGTModelCache> m_GTModelCache;
     std::filesystem::path m_path;
+    CDBFilter m_filter;
+    mutable std::optional<CDBCatalog> m_catalog;
+    ElevationSampler m_elevationSampler;
+    std::unique_ptr<FilePrefetcher> m_prefetcher;
+    size_t m_prefetchDepth;
 };
 } // namespace CDBTo3DTiles
 
@@ -40,6 +40,39 @@ void CDBInstancesAttributes::addInstanceFeature(const OGRFeature &feature)
     }
 }
 
+void CDBInstancesAttributes::addInstancesFeatures(const DBFReader &attributesTable)
+{
+    std::vector<size_t> records;
+    records.reserve(attributesTable.getRecordCount());
+    for (size_t i = 0; i < attributesTable.getRecordCount(); ++i) {
+        if (!attributesTable.isRecordDeleted(i)) {
+            records.emplace_back(i);
+        }
+    }
+
+    for (const auto &field : attributesTable.getFields()) {
+        if (field.type == DBFFieldType::Integer) {
+            auto &values = m_integerAttribs[field.name];
+            values.reserve(values.size() + records.size());
+            for (auto record : records) {
+                values.emplace_back(attributesTable.getFieldAsInteger(record, field));
+            }
+        } else if (field.type == DBFFieldType::Real) {
+            auto &values = m_doubleAttribs[field.name];
+            values.reserve(values.size() + records.size());
+            for (auto record : records) {
+                values.emplace_back(attributesTable.getFieldAsDouble(record, field));
+            }
+        } else if (field.type == DBFFieldType::String) {
+            auto &values = field.name == "CNAM" ? m_CNAMs : m_stringAttribs[field.name];
+            values.reserve(values.size() + records.size());
+            for (auto record : records) {
+                values.emplace_back(attributesTable.getFieldAsString(record, field));
+            }
+        }
+    }
+}
+
 void CDBInstancesAttributes::mergeClassesAttributes(const CDBClassesAttributes &classVectors) noexcept
 {
     const auto &classCNAMs = classVectors.getCNAMs();
@@ -91,6 +124,31 @@ CDBClassesAttributes::CDBClassesAttributes(GDALDatasetUniquePtr vectorDataset, C
     }
 }
 
+CDBClassesAttributes::CDBClassesAttributes(const DBFReader &attributesTable, CDBTile tile)
+    : m_tile{std::move(tile)}
+{
+    for (const auto &field : attributesTable.getFields()) {
+        for (size_t i = 0; i < attributesTable.getRecordCount(); ++i) {
+            if (attributesTable.isRecordDeleted(i)) {
+                continue;
+            }
+
+            if (field.type == DBFFieldType::Integer) {
+                m_integerAttribs[field.name].emplace_back(attributesTable.getFieldAsInteger(i, field));
+            } else if (field.type == DBFFieldType::Real) {
+                m_doubleAttribs[field.name].emplace_back(attributesTable.getFieldAsDouble(i, field));
+            } else if (field.type == DBFFieldType::String) {
+                if (field.name == "CNAM") {
+                    size_t classIndex = m_CNAMs.size();
+                    m_CNAMs[attributesTable.getFieldAsString(i, field)] = classIndex;
+                } else {
+                    m_stringAttribs[field.name].emplace_back(attributesTable.getFieldAsString(i, field));
+                }
+            }
+        }
+    }
+}
+
 void CDBClassesAttributes::addClassFeaturesAttribs(const OGRFeature &feature)
 {
     for (int i = 0; i < feature.GetFieldCount(); ++i) {
@@ -134,35 +192,58 @@ CDBModelsAttributes::CDBModelsAttributes(GDALDatasetUniquePtr featureDataset,
         }
     }
 
-    // add class attributes first
-    auto classAttribues = createClassesAttributes(tile, CDBPath);
-    if (classAttribues) {
-        m_instancesAttribs.mergeClassesAttributes(*classAttribues);
-    }
+    mergeClassesAttributes(CDBPath);
+}
 
-    // find orientations
-    const auto &doubleAttribs = m_instancesAttribs.getDoubleAttribs();
-    auto orientationAttribs = doubleAttribs.find("AO1");
-    if (orientationAttribs != doubleAttribs.end()) {
-        m_orientations.reserve(orientationAttribs->second.size());
-        for (size_t i = 0; i < orientationAttribs->second.size(); ++i) {
-            m_orientations.emplace_back(glm::radians(orientationAttribs->second[i]));
+CDBModelsAttributes::CDBModelsAttributes(const ShapefileReader &shapefile,
+                                         const DBFReader &attributesTable,
+                                         CDBTile tile,
+                                         const std::filesystem::path &CDBPath)
+    : m_tile{std::move(tile)}
+{
+    m_instancesAttribs.addInstancesFeatures(attributesTable);
+
+    // find position. OGR drops the point of a record deleted in the attribute table
+    m_cartographicPositions.reserve(shapefile.getRecordCount());
+    for (size_t i = 0; i < shapefile.getRecordCount(); ++i) {
+        if (attributesTable.isRecordDeleted(i)) {
+            continue;
         }
+
+        auto record = shapefile.getRecord(i);
+        if (record.getShapeType() != ShapeType::Point && record.getShapeType() != ShapeType::PointZ
+            && record.getShapeType() != ShapeType::PointM) {
+            continue;
+        }
+
+        auto point = record.getPart(0);
+        m_cartographicPositions.emplace_back(glm::radians(point.getX(0)),
+                                             glm::radians(point.getY(0)),
+                                             point.getZ(0));
     }
 
-    // find scale
-    auto scaleXAttribs = doubleAttribs.find("SCALx");
-    auto scaleYAttribs = doubleAttribs.find("SCALy");
-    auto scaleZAttribs = doubleAttribs.find("SCALz");
-    if (scaleXAttribs != doubleAttribs.end() && scaleYAttribs != doubleAttribs.end()
-        && scaleZAttribs != doubleAttribs.end()) {
-        m_scales.reserve(scaleXAttribs->second.size());
-        for (size_t i = 0; i < scaleXAttribs->second.size(); ++i) {
-            m_scales.emplace_back(scaleXAttribs->second[i],
-                                  scaleYAttribs->second[i],
-                                  scaleZAttribs->second[i]);
+    mergeClassesAttributes(CDBPath);
+}
+
+std::optional<CDBModelsAttributes> CDBModelsAttributes::createFromFile(const std::filesystem::path &file,
+                                                                       CDBTile tile,
+                                                                       const std::filesystem::path &CDBPath)
+{
+    auto shapefile = ShapefileReader::createFromFile(std::filesystem::path(file).replace_extension(".shp"));
+    if (shapefile) {
+        auto attributesTable = DBFReader::createFromFile(file);
+        if (attributesTable) {
+            return CDBModelsAttributes(*shapefile, *attributesTable, std::move(tile), CDBPath);
         }
     }
+
+    GDALDatasetUniquePtr dataset = GDALDatasetUniquePtr(
+        (GDALDataset *) GDALOpenEx(file.c_str(), GDAL_OF_VECTOR, nullptr, nullptr, nullptr));
+    if (dataset) {
+        return CDBModelsAttributes(std::move(dataset), std::move(tile), CDBPath);
+    }
+
+    return std::nullopt;
 }
 
 std::optional<CDBClassesAttributes> CDBModelsAttributes::createClassesAttributes(
@@ -188,6 +269,11 @@ std::optional<CDBClassesAttributes> CDBModelsAttributes::createClassesAttributes
         return std::nullopt;
     }
 
+    auto attributesTable = DBFReader::createFromFile(classLevelPath);
+    if (attributesTable) {
+        return CDBClassesAttributes(*attributesTable, std::move(classVectorsTile));
+    }
+
     GDALDatasetUniquePtr dataset = GDALDatasetUniquePtr(
         (GDALDataset *) GDALOpenEx(classLevelPath.c_str(), GDAL_OF_VECTOR, nullptr, nullptr, nullptr));
     if (!dataset) {
@@ -196,4 +282,37 @@ std::optional<CDBClassesAttributes> CDBModelsAttributes::createClassesAttributes
 
     return CDBClassesAttributes(std::move(dataset), std::move(classVectorsTile));
 }
+
+void CDBModelsAttributes::mergeClassesAttributes(const std::filesystem::path &CDBPath)
+{
+    // add class attributes first
+    auto classAttribues = createClassesAttributes(*m_tile, CDBPath);
+    if (classAttribues) {
+        m_instancesAttribs.mergeClassesAttributes(*classAttribues);
+    }
+
+    // find orientations
+    const auto &doubleAttribs = m_instancesAttribs.getDoubleAttribs();
+    auto orientationAttribs = doubleAttribs.find("AO1");
+    if (orientationAttribs != doubleAttribs.end()) {
+        m_orientations.reserve(orientationAttribs->second.size());
+        for (size_t i = 0; i < orientationAttribs->second.size(); ++i) {
+            m_orientations.emplace_back(glm::radians(orientationAttribs->second[i]));
+        }
+    }
+
+    // find scale
+    auto scaleXAttribs = doubleAttribs.find("SCALx");
+    auto scaleYAttribs = doubleAttribs.find("SCALy");
+    auto scaleZAttribs = doubleAttribs.find("SCALz");
+    if (scaleXAttribs != doubleAttribs.end() && scaleYAttribs != doubleAttribs.end()
+        && scaleZAttribs != doubleAttribs.end()) {
+        m_scales.reserve(scaleXAttribs->second.size());
+        for (size_t i = 0; i < scaleXAttribs->second.size(); ++i) {
+            m_scales.emplace_back(scaleXAttribs->second[i],
+                                  scaleYAttribs->second[i],
+                                  scaleZAttribs->second[i]);
+        }
+    }
+}
 } // namespace CDBTo3DTiles
@@ -2,6 +2,8 @@
 
 #include "CDBTile.h"
 #include "Cartographic.h"
+#include "DBFReader.h"
+#include "ShapefileReader.h"
 #include "gdal_priv.h"
 #include <glm/glm.hpp>
 
@@ -36,6 +38,8 @@ class CDBInstancesAttributes
 public:
     void addInstanceFeature(const OGRFeature &feature);
 
+    void addInstancesFeatures(const DBFReader &attributesTable);
+
     void mergeClassesAttributes(const CDBClassesAttributes &classVectors) noexcept;
 
     inline size_t getInstancesCount() const noexcept { return m_CNAMs.size(); }
@@ -80,6 +84,8 @@ class CDBClassesAttributes
 public:
     CDBClassesAttributes(GDALDatasetUniquePtr dataset, CDBTile tile);
 
+    CDBClassesAttributes(const DBFReader &attributesTable, CDBTile tile);
+
     inline const CDBTile &getTile() const noexcept { return *m_tile; }
 
     inline const std::map<std::string, size_t> &getCNAMs() const noexcept { return m_CNAMs; }
@@ -114,6 +120,11 @@ class CDBModelsAttributes
 public:
     CDBModelsAttributes(GDALDatasetUniquePtr dataset, CDBTile tile, const std::filesystem::path &CDBPath);
 
+    CDBModelsAttributes(const ShapefileReader &shapefile,
+                        const DBFReader &attributesTable,
+                        CDBTile tile,
+                        const std::filesystem::path &CDBPath);
+
     inline const std::vector<Core::Cartographic> &getCartographicPositions() const noexcept
     {
         return m_cartographicPositions;
@@ -135,10 +146,18 @@ public:
         return m_instancesAttribs;
     }
 
+    // The point geometry and attributes are read straight from the shapefile when possible, and by OGR
+    // otherwise
+    static std::optional<CDBModelsAttributes> createFromFile(const std::filesystem::path &file,
+                                                             CDBTile tile,
+                                                             const std::filesystem::path &CDBPath);
+
 private:
     std::optional<CDBClassesAttributes> createClassesAttributes(const CDBTile &instancesTile,
                                                                 const std::filesystem::path &CDBPath);
 
+    void mergeClassesAttributes(const std::filesystem::path &CDBPath);
+
     std::vector<glm::vec3> m_scales;
     std::vector<double> m_orientations;
     std::vector<Core::Cartographic> m_cartographicPositions;
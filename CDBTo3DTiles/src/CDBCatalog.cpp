@@ -0,0 +1,184 @@
+#include "CDBCatalog.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
+namespace CDBTo3DTiles {
+
+static const std::vector<std::string> NO_ENTRIES;
+
+CDBCatalog::CDBCatalog()
+    : m_fileCount{0}
+    , m_scanSeconds{0.0}
+{}
+
+const std::vector<std::string> &CDBCatalog::getDirectories(const std::filesystem::path &directory) const
+{
+    const Directory *entries = findDirectory(directory);
+    return entries ? entries->directories : NO_ENTRIES;
+}
+
+const std::vector<std::string> &CDBCatalog::getFiles(const std::filesystem::path &directory) const
+{
+    const Directory *entries = findDirectory(directory);
+    return entries ? entries->files : NO_ENTRIES;
+}
+
+bool CDBCatalog::isDirectoryExist(const std::filesystem::path &directory) const
+{
+    if (directory.empty()) {
+        return findDirectory(directory) != nullptr;
+    }
+
+    // directories left out by the filter exist in their parent without being listed themselves
+    const auto &directories = getDirectories(directory.parent_path());
+    return std::binary_search(directories.begin(), directories.end(), directory.filename().string());
+}
+
+bool CDBCatalog::isFileExist(const std::filesystem::path &file) const
+{
+    const auto &files = getFiles(file.parent_path());
+    return std::binary_search(files.begin(), files.end(), file.filename().string());
+}
+
+const CDBCatalog::Directory *CDBCatalog::findDirectory(const std::filesystem::path &directory) const
+{
+    auto entries = m_directories.find(directory.generic_string());
+    if (entries == m_directories.end()) {
+        return nullptr;
+    }
+
+    return &entries->second;
+}
+
+CDBCatalog CDBCatalog::createFromDirectory(const std::filesystem::path &root,
+                                           size_t threadCount,
+                                           const DirectoryFilter &filter)
+{
+    auto start = std::chrono::steady_clock::now();
+    CDBCatalog catalog;
+
+    // every thread takes a directory, lists it and hands its subdirectories back to the others. The scan is
+    // over once no directory is left and no thread is listing one
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::vector<std::string> pendingDirectories{""};
+    size_t listingCount = 0;
+    auto scan = [&]() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            condition.wait(lock, [&]() { return !pendingDirectories.empty() || listingCount == 0; });
+            if (pendingDirectories.empty()) {
+                return;
+            }
+
+            std::string directory = std::move(pendingDirectories.back());
+            pendingDirectories.pop_back();
+            ++listingCount;
+            lock.unlock();
+
+            Directory entries;
+            bool isListed = listDirectory(directory.empty() ? root : root / directory, entries);
+            std::vector<std::string> subdirectories;
+            for (const auto &name : entries.directories) {
+                std::string subdirectory = directory.empty() ? name : directory + "/" + name;
+                if (!filter || filter(subdirectory)) {
+                    subdirectories.emplace_back(std::move(subdirectory));
+                }
+            }
+
+            lock.lock();
+            if (isListed) {
+                catalog.m_fileCount += entries.files.size();
+                catalog.m_directories.emplace(std::move(directory), std::move(entries));
+            }
+
+            pendingDirectories.insert(pendingDirectories.end(),
+                                      std::make_move_iterator(subdirectories.begin()),
+                                      std::make_move_iterator(subdirectories.end()));
+            --listingCount;
+            condition.notify_all();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < threadCount; ++i) {
+        threads.emplace_back(scan);
+    }
+
+    scan();
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    catalog.m_scanSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return catalog;
+}
+
+bool CDBCatalog::listDirectory(const std::filesystem::path &directory, Directory &entries)
+{
+#ifndef _WIN32
+    DIR *dir = opendir(directory.c_str());
+    if (!dir) {
+        return false;
+    }
+
+    while (dirent *entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        if (name == "." || name == "..") {
+            continue;
+        }
+
+        // some file systems leave the type out, and links are followed like the file system library does
+        bool isDirectory = entry->d_type == DT_DIR;
+        if (entry->d_type == DT_UNKNOWN || entry->d_type == DT_LNK) {
+            struct stat entryStat;
+            if (fstatat(dirfd(dir), entry->d_name, &entryStat, 0) != 0) {
+                continue;
+            }
+
+            isDirectory = S_ISDIR(entryStat.st_mode);
+        }
+
+        if (isDirectory) {
+            entries.directories.emplace_back(std::move(name));
+        } else {
+            entries.files.emplace_back(std::move(name));
+        }
+    }
+
+    closedir(dir);
+#else
+    // the type comes with the directory entry on Windows, so is_directory doesn't query the file again
+    std::error_code error;
+    std::filesystem::directory_iterator entry(directory, error);
+    if (error) {
+        return false;
+    }
+
+    for (; entry != std::filesystem::directory_iterator(); entry.increment(error)) {
+        if (error) {
+            break;
+        }
+
+        if (entry->is_directory(error)) {
+            entries.directories.emplace_back(entry->path().filename().string());
+        } else {
+            entries.files.emplace_back(entry->path().filename().string());
+        }
+    }
+#endif
+
+    std::sort(entries.directories.begin(), entries.directories.end());
+    std::sort(entries.files.begin(), entries.files.end());
+    return true;
+}
+} // namespace CDBTo3DTiles
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace CDBTo3DTiles {
+// The directories and files under a CDB, listed once by a parallel scan so traversals and existence checks
+// don't go back to the file system. Paths are relative to the root and use forward slashes, so the entries
+// of a tile directory are grouped by GeoCell, dataset, level and UREF as they are on disk. Entries are sorted
+class CDBCatalog
+{
+public:
+    // Returns false for a directory, given relative to the root, whose content is left out of the scan
+    using DirectoryFilter = std::function<bool(const std::string &directory)>;
+
+    // The directory names in the directory, empty if it doesn't exist
+    const std::vector<std::string> &getDirectories(const std::filesystem::path &directory) const;
+
+    // The file names in the directory, empty if it doesn't exist
+    const std::vector<std::string> &getFiles(const std::filesystem::path &directory) const;
+
+    bool isDirectoryExist(const std::filesystem::path &directory) const;
+
+    bool isFileExist(const std::filesystem::path &file) const;
+
+    inline size_t getDirectoryCount() const noexcept { return m_directories.size(); }
+
+    inline size_t getFileCount() const noexcept { return m_fileCount; }
+
+    inline double getScanSeconds() const noexcept { return m_scanSeconds; }
+
+    // Lists the tree on the given number of threads. Directory types are taken from the directory entries,
+    // so files are only stat'ed on file systems that don't report them. A root that doesn't exist gives an
+    // empty catalog
+    static CDBCatalog createFromDirectory(const std::filesystem::path &root,
+                                          size_t threadCount,
+                                          const DirectoryFilter &filter = nullptr);
+
+private:
+    struct Directory
+    {
+        std::vector<std::string> directories;
+        std::vector<std::string> files;
+    };
+
+    CDBCatalog();
+
+    const Directory *findDirectory(const std::filesystem::path &directory) const;
+
+    static bool listDirectory(const std::filesystem::path &directory, Directory &entries);
+
+    std::unordered_map<std::string, Directory> m_directories;
+    size_t m_fileCount;
+    double m_scanSeconds;
+};
+} // namespace CDBTo3DTiles
@@ -4,6 +4,8 @@
 #include "MathHelpers.h"
 #include "glm/gtc/type_ptr.hpp"
 #include "meshoptimizer.h"
+#include <algorithm>
+#include <array>
 
 namespace CDBTo3DTiles {
 
@@ -17,7 +19,12 @@ static Mesh generateElevationMesh(const std::vector<double> terrainHeights,
 static void loadElevation(const std::filesystem::path &path,
                           Core::Cartographic topLeft,
                           glm::ivec2 &rasterSize,
-                          Mesh &mesh);
+                          Mesh &mesh,
+                          std::vector<double> &heights);
+
+static double computeSimplificationError(const Mesh &uniformGridMesh,
+                                         size_t verticesWidth,
+                                         const std::vector<unsigned int> &simplifiedIndices);
 
 static void extractVerticesFromExistingSimplifiedMesh(const Mesh &existingMesh,
                                                       Mesh &simplified,
@@ -35,6 +42,14 @@ CDBElevation::CDBElevation(Mesh uniformGridMesh, size_t gridWidth, size_t gridHe
 {}
 
 Mesh CDBElevation::createSimplifiedMesh(size_t targetIndexCount, float targetError) const
+{
+    double simplificationError;
+    return createSimplifiedMesh(targetIndexCount, targetError, simplificationError);
+}
+
+Mesh CDBElevation::createSimplifiedMesh(size_t targetIndexCount,
+                                        float targetError,
+                                        double &simplificationError) const
 {
     std::vector<unsigned int> lod(m_uniformGridMesh.indices.size());
     lod.resize(meshopt_simplify(&lod[0],
@@ -45,6 +60,7 @@ Mesh CDBElevation::createSimplifiedMesh(size_t targetIndexCount, float targetErr
                                 sizeof(glm::vec3),
                                 targetIndexCount,
                                 targetError));
+    simplificationError = computeSimplificationError(m_uniformGridMesh, m_gridWidth + 1, lod);
 
     Mesh simplified;
     simplified.aabb = AABB();
@@ -97,6 +113,49 @@ Mesh CDBElevation::createSimplifiedMesh(size_t targetIndexCount, float targetErr
     return simplified;
 }
 
+double CDBElevation::computeRefinementError() const
+{
+    size_t verticesWidth = m_gridWidth + 1;
+    size_t verticesHeight = m_gridHeight + 1;
+    const auto &positions = m_uniformGridMesh.positions;
+    if (positions.size() < verticesWidth * verticesHeight) {
+        return 0.0;
+    }
+
+    // rebuild every vertex from the vertices on even rows and columns around it
+    double error = 0.0;
+    for (size_t y = 0; y < verticesHeight; ++y) {
+        size_t y0 = y - y % 2;
+        size_t y1 = glm::min(y0 + 2, verticesHeight - 1);
+        double ty = y1 > y0 ? static_cast<double>(y - y0) / static_cast<double>(y1 - y0) : 0.0;
+        for (size_t x = 0; x < verticesWidth; ++x) {
+            size_t x0 = x - x % 2;
+            size_t x1 = glm::min(x0 + 2, verticesWidth - 1);
+            double tx = x1 > x0 ? static_cast<double>(x - x0) / static_cast<double>(x1 - x0) : 0.0;
+            glm::dvec3 top = glm::mix(positions[y0 * verticesWidth + x0],
+                                      positions[y0 * verticesWidth + x1],
+                                      tx);
+            glm::dvec3 bottom = glm::mix(positions[y1 * verticesWidth + x0],
+                                         positions[y1 * verticesWidth + x1],
+                                         tx);
+            glm::dvec3 coarse = glm::mix(top, bottom, ty);
+            error = glm::max(error, glm::distance(coarse, positions[y * verticesWidth + x]));
+        }
+    }
+
+    return error;
+}
+
+double CDBElevation::computeGridSpacing() const
+{
+    const auto &positions = m_uniformGridMesh.positions;
+    if (positions.size() < 2) {
+        return 0.0;
+    }
+
+    return glm::distance(positions[0], positions[1]);
+}
+
 void CDBElevation::indexUVRelativeToParent(const CDBTile &parentTile)
 {
     auto parentLevel = parentTile.getLevel();
@@ -183,6 +242,12 @@ std::optional<CDBElevation> CDBElevation::createSouthEastSubRegion(bool reindexU
 }
 
 std::optional<CDBElevation> CDBElevation::createFromFile(const std::filesystem::path &file)
+{
+    return createFromFile(file, file);
+}
+
+std::optional<CDBElevation> CDBElevation::createFromFile(const std::filesystem::path &file,
+                                                         const std::filesystem::path &sourceFile)
 {
     if (file.extension() != ".tif") {
         return std::nullopt;
@@ -201,7 +266,8 @@ std::optional<CDBElevation> CDBElevation::createFromFile(const std::filesystem::
         Core::Cartographic topLeft(rectangle.getWest(), rectangle.getNorth());
         glm::ivec2 rasterSize(0);
         Mesh uniformGridMesh;
-        loadElevation(file, topLeft, rasterSize, uniformGridMesh);
+        std::vector<double> heights;
+        loadElevation(sourceFile, topLeft, rasterSize, uniformGridMesh, heights);
 
         if (uniformGridMesh.positions.empty()) {
             return std::nullopt;
@@ -211,7 +277,16 @@ std::optional<CDBElevation> CDBElevation::createFromFile(const std::filesystem::
         size_t gridWidth = static_cast<size_t>(rasterSize.x);
         size_t gridHeight = static_cast<size_t>(rasterSize.y);
 
-        return CDBElevation(std::move(uniformGridMesh), gridWidth, gridHeight, *tile);
+        std::vector<float> gridHeights(heights.size());
+        std::transform(heights.begin(), heights.end(), gridHeights.begin(), [](double height) {
+            return static_cast<float>(height);
+        });
+
+        CDBElevation elevation(std::move(uniformGridMesh), gridWidth, gridHeight, *tile);
+        elevation.m_heightGrid = std::make_shared<const ElevationGrid>(gridWidth,
+                                                                       gridHeight,
+                                                                       std::move(gridHeights));
+        return elevation;
     }
 
     return std::nullopt;
@@ -284,6 +359,55 @@ Mesh CDBElevation::createSubRegionMesh(glm::uvec2 gridFrom, glm::uvec2 gridTo, b
     return elevation;
 }
 
+double computeSimplificationError(const Mesh &uniformGridMesh,
+                                  size_t verticesWidth,
+                                  const std::vector<unsigned int> &simplifiedIndices)
+{
+    // simplified triangles are made of grid vertices, so each one is walked in grid coordinates and the grid
+    // vertices inside of it are compared with the surface of the triangle
+    auto edge = [](glm::dvec2 a, glm::dvec2 b, glm::dvec2 p) {
+        return (b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x);
+    };
+
+    const auto &positions = uniformGridMesh.positions;
+    double error = 0.0;
+    for (size_t i = 0; i + 2 < simplifiedIndices.size(); i += 3) {
+        std::array<glm::dvec2, 3> corners;
+        std::array<glm::dvec3, 3> cornerPositions;
+        for (size_t j = 0; j < 3; ++j) {
+            size_t index = simplifiedIndices[i + j];
+            corners[j] = glm::dvec2(static_cast<double>(index % verticesWidth),
+                                    static_cast<double>(index / verticesWidth));
+            cornerPositions[j] = positions[index];
+        }
+
+        double area = edge(corners[0], corners[1], corners[2]);
+        if (glm::abs(area) < Core::Math::EPSILON10) {
+            continue;
+        }
+
+        glm::dvec2 minCorner = glm::min(glm::min(corners[0], corners[1]), corners[2]);
+        glm::dvec2 maxCorner = glm::max(glm::max(corners[0], corners[1]), corners[2]);
+        for (auto y = static_cast<size_t>(minCorner.y); y <= static_cast<size_t>(maxCorner.y); ++y) {
+            for (auto x = static_cast<size_t>(minCorner.x); x <= static_cast<size_t>(maxCorner.x); ++x) {
+                glm::dvec2 vertex(static_cast<double>(x), static_cast<double>(y));
+                double w0 = edge(corners[1], corners[2], vertex) / area;
+                double w1 = edge(corners[2], corners[0], vertex) / area;
+                double w2 = 1.0 - w0 - w1;
+                if (w0 < -Core::Math::EPSILON7 || w1 < -Core::Math::EPSILON7 || w2 < -Core::Math::EPSILON7) {
+                    continue;
+                }
+
+                glm::dvec3 surface = w0 * cornerPositions[0] + w1 * cornerPositions[1]
+                                     + w2 * cornerPositions[2];
+                error = glm::max(error, glm::distance(surface, positions[y * verticesWidth + x]));
+            }
+        }
+    }
+
+    return error;
+}
+
 void extractVerticesFromExistingSimplifiedMesh(const Mesh &existingSimplifiedMesh,
                                                Mesh &newSimplifiedMesh,
                                                std::vector<int> &remap,
@@ -376,22 +500,36 @@ Mesh generateElevationMesh(const std::vector<double> elevationHeights,
 
     size_t totalVertices = verticesWidth * verticesHeight;
     size_t totalIndices = (verticesWidth - 1) * (verticesHeight - 1) * 6;
-    elevation.positions.reserve(totalVertices);
+    elevation.positions.resize(totalVertices);
     elevation.positionRTCs.reserve(totalVertices);
     elevation.UVs.reserve(totalVertices);
     elevation.indices.reserve(totalIndices);
 
+    // convert a row of vertices at a time. Longitudes are the same for every row
+    std::vector<double> longitudes(verticesWidth);
+    std::vector<double> latitudes(verticesWidth);
+    std::vector<double> heights(verticesWidth);
+    for (size_t x = 0; x < verticesWidth; ++x) {
+        longitudes[x] = topLeft.longitude + glm::radians(static_cast<double>(x) * pixelSize.x);
+    }
+
     for (size_t y = 0; y < verticesHeight; ++y) {
+        double latitude = topLeft.latitude + glm::radians(static_cast<double>(y) * pixelSize.y);
+        const double *rowHeights = elevationHeights.data() + glm::min(y, rasterHeight - 1) * rasterWidth;
         for (size_t x = 0; x < verticesWidth; ++x) {
-            double longitude = topLeft.longitude + glm::radians(static_cast<double>(x) * pixelSize.x);
-            double latitude = topLeft.latitude + glm::radians(static_cast<double>(y) * pixelSize.y);
-            double height = static_cast<double>(
-                elevationHeights[glm::min(y, rasterHeight - 1) * rasterWidth + glm::min(x, rasterWidth - 1)]);
-            Core::Cartographic cartographic(longitude, latitude, height);
-            glm::dvec3 position = ellipsoid.cartographicToCartesian(cartographic);
+            latitudes[x] = latitude;
+            heights[x] = rowHeights[glm::min(x, rasterWidth - 1)];
+        }
 
-            elevation.positions.emplace_back(position);
-            elevation.aabb->merge(position);
+        glm::dvec3 *rowPositions = elevation.positions.data() + y * verticesWidth;
+        ellipsoid.cartographicToCartesian(longitudes.data(),
+                                          latitudes.data(),
+                                          heights.data(),
+                                          verticesWidth,
+                                          rowPositions);
+
+        for (size_t x = 0; x < verticesWidth; ++x) {
+            elevation.aabb->merge(rowPositions[x]);
             elevation.UVs.emplace_back(static_cast<float>(x) * inverseWidth,
                                        static_cast<float>(y) * inverseHeight);
             if (x < verticesWidth - 1 && y < verticesHeight - 1) {
@@ -419,7 +557,8 @@ Mesh generateElevationMesh(const std::vector<double> elevationHeights,
 void loadElevation(const std::filesystem::path &path,
                    Core::Cartographic topLeft,
                    glm::ivec2 &rasterSize,
-                   Mesh &mesh)
+                   Mesh &mesh,
+                   std::vector<double> &heights)
 {
     std::string file = path.string();
     GDALDatasetUniquePtr rasterData = GDALDatasetUniquePtr(
@@ -448,6 +587,7 @@ void loadElevation(const std::filesystem::path &path,
 
     // generate elevation mesh
     mesh = generateElevationMesh(elevationHeights, topLeft, rasterSize, pixelSize);
+    heights = std::move(elevationHeights);
 }
 
 } // namespace CDBTo3DTiles
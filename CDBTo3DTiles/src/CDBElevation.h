@@ -2,6 +2,7 @@
 
 #include "CDBTile.h"
 #include "Cartographic.h"
+#include "ElevationSampler.h"
 #include "Scene.h"
 #include "gdal_priv.h"
 #include <filesystem>
@@ -15,6 +16,16 @@ public:
 
     Mesh createSimplifiedMesh(size_t targetIndexCount, float targetError) const;
 
+    // Also reports the largest distance in meters between a vertex of the grid and the simplified surface
+    Mesh createSimplifiedMesh(size_t targetIndexCount, float targetError, double &simplificationError) const;
+
+    // Largest distance in meters between the grid and the same grid at half of its resolution, which is the
+    // detail that the parent tile misses over this tile
+    double computeRefinementError() const;
+
+    // Distance in meters between two neighbouring vertices of the grid
+    double computeGridSpacing() const;
+
     inline const Mesh &getUniformGridMesh() const noexcept { return m_uniformGridMesh; }
 
     inline size_t getGridWidth() const noexcept { return m_gridWidth; }
@@ -23,6 +34,10 @@ public:
 
     inline const CDBTile &getTile() const noexcept { return *m_tile; }
 
+    // Heights decoded from the raster, so model clamping can reuse them instead of decoding the raster again.
+    // Sub regions don't have one
+    inline const std::shared_ptr<const ElevationGrid> &getHeightGrid() const noexcept { return m_heightGrid; }
+
     inline void setTile(const CDBTile &tile) { m_tile = tile; }
 
     void indexUVRelativeToParent(const CDBTile &parentTile);
@@ -37,6 +52,10 @@ public:
 
     static std::optional<CDBElevation> createFromFile(const std::filesystem::path &file);
 
+    // Reads the raster from the source file, e.g. an in-memory copy, while the tile is named after the file
+    static std::optional<CDBElevation> createFromFile(const std::filesystem::path &file,
+                                                      const std::filesystem::path &sourceFile);
+
 private:
     CDBElevation createSubRegion(glm::uvec2 begin, const CDBTile &subRegionTile, bool reindexUV) const;
 
@@ -46,6 +65,7 @@ private:
     size_t m_gridHeight;
     Mesh m_uniformGridMesh;
     std::optional<CDBTile> m_tile;
+    std::shared_ptr<const ElevationGrid> m_heightGrid;
 };
 
 } // namespace CDBTo3DTiles
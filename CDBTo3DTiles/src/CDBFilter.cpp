@@ -0,0 +1,153 @@
+#include "CDBFilter.h"
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+namespace CDBTo3DTiles {
+
+const int CDBFilter::MIN_LEVEL = -10;
+const int CDBFilter::MAX_LEVEL = 23;
+
+CDBFilter::CDBFilter()
+    : m_levelRange{MIN_LEVEL, MAX_LEVEL}
+{}
+
+void CDBFilter::setRectangle(double west, double south, double east, double north)
+{
+    if (west >= east || south >= north) {
+        throw std::invalid_argument("Region has to be given as west, south, east and north in degrees");
+    }
+
+    m_rectangle = {west, south, east, north};
+}
+
+void CDBFilter::addGeoCell(const CDBGeoCell &geoCell)
+{
+    m_geoCells.insert(geoCell);
+    m_geoCellLatitudes.insert(geoCell.getLatitude());
+}
+
+void CDBFilter::addDataset(CDBDataset dataset)
+{
+    m_datasets.insert(dataset);
+}
+
+void CDBFilter::setLevelRange(int minLevel, int maxLevel)
+{
+    if (minLevel > maxLevel) {
+        throw std::invalid_argument("Minimum level " + std::to_string(minLevel)
+                                    + " is above the maximum level " + std::to_string(maxLevel));
+    }
+
+    m_levelRange = {minLevel, maxLevel};
+}
+
+void CDBFilter::setLevelRange(CDBDataset dataset, int minLevel, int maxLevel)
+{
+    if (minLevel > maxLevel) {
+        throw std::invalid_argument("Minimum level " + std::to_string(minLevel)
+                                    + " is above the maximum level " + std::to_string(maxLevel));
+    }
+
+    m_datasetLevelRanges[dataset] = {minLevel, maxLevel};
+}
+
+std::pair<int, int> CDBFilter::getLevelRange(CDBDataset dataset) const
+{
+    auto datasetLevelRange = m_datasetLevelRanges.find(dataset);
+    if (datasetLevelRange == m_datasetLevelRanges.end()) {
+        return m_levelRange;
+    }
+
+    return datasetLevelRange->second;
+}
+
+bool CDBFilter::isLatitudeIncluded(int latitude) const
+{
+    if (!isSpatiallyFiltered()) {
+        return true;
+    }
+
+    if (m_geoCellLatitudes.find(latitude) != m_geoCellLatitudes.end()) {
+        return true;
+    }
+
+    // every GeoCell is one degree high
+    return m_rectangle && latitude < (*m_rectangle)[3] && latitude + 1 > (*m_rectangle)[1];
+}
+
+bool CDBFilter::isGeoCellIncluded(const CDBGeoCell &geoCell) const
+{
+    if (!isSpatiallyFiltered()) {
+        return true;
+    }
+
+    if (m_geoCells.find(geoCell) != m_geoCells.end()) {
+        return true;
+    }
+
+    if (!m_rectangle) {
+        return false;
+    }
+
+    const auto &rectangle = *m_rectangle;
+    int latitude = geoCell.getLatitude();
+    int longitude = geoCell.getLongitude();
+    return latitude < rectangle[3] && latitude + geoCell.getLatitudeExtentInDegree() > rectangle[1]
+           && longitude < rectangle[2] && longitude + geoCell.getLongitudeExtentInDegree() > rectangle[0];
+}
+
+bool CDBFilter::isDatasetIncluded(CDBDataset dataset) const
+{
+    return m_datasets.empty() || m_datasets.find(dataset) != m_datasets.end();
+}
+
+bool CDBFilter::isLevelIncluded(CDBDataset dataset, int level) const
+{
+    auto levelRange = getLevelRange(dataset);
+    return level >= levelRange.first && level <= levelRange.second;
+}
+
+std::string CDBFilter::getContentSettings() const
+{
+    // sorted, so the same filters always give the same settings. Each setting starts with a separator, so
+    // they can be appended to the other settings of a conversion
+    std::string settings;
+    if (!m_datasets.empty()) {
+        std::vector<int> datasets;
+        for (auto dataset : m_datasets) {
+            datasets.emplace_back(static_cast<int>(dataset));
+        }
+
+        std::sort(datasets.begin(), datasets.end());
+        settings += ";datasets=";
+        for (auto dataset : datasets) {
+            settings += std::to_string(dataset) + ",";
+        }
+    }
+
+    if (m_levelRange != std::make_pair(MIN_LEVEL, MAX_LEVEL)) {
+        settings += ";levels=" + std::to_string(m_levelRange.first) + ":"
+                    + std::to_string(m_levelRange.second);
+    }
+
+    std::map<int, std::pair<int, int>> datasetLevelRanges;
+    for (const auto &datasetLevelRange : m_datasetLevelRanges) {
+        datasetLevelRanges.insert({static_cast<int>(datasetLevelRange.first), datasetLevelRange.second});
+    }
+
+    for (const auto &datasetLevelRange : datasetLevelRanges) {
+        settings += ";levels" + std::to_string(datasetLevelRange.first) + "="
+                    + std::to_string(datasetLevelRange.second.first) + ":"
+                    + std::to_string(datasetLevelRange.second.second);
+    }
+
+    return settings;
+}
+
+bool CDBFilter::isSpatiallyFiltered() const noexcept
+{
+    return m_rectangle || !m_geoCells.empty();
+}
+} // namespace CDBTo3DTiles
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "CDBDataset.h"
+#include "CDBGeoCell.h"
+#include <array>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace CDBTo3DTiles {
+// Limits the GeoCells, datasets and levels of detail a CDB traversal visits, so the directories left out are
+// never listed. Everything is visited when nothing is set
+class CDBFilter
+{
+public:
+    CDBFilter();
+
+    // Visits the GeoCells overlapping the rectangle, in degrees, as well as the GeoCells added one by one
+    void setRectangle(double west, double south, double east, double north);
+
+    void addGeoCell(const CDBGeoCell &geoCell);
+
+    // Once a dataset is added, only the added datasets are visited
+    void addDataset(CDBDataset dataset);
+
+    // Levels from minLevel to maxLevel inclusive, for the datasets without a range of their own
+    void setLevelRange(int minLevel, int maxLevel);
+
+    void setLevelRange(CDBDataset dataset, int minLevel, int maxLevel);
+
+    std::pair<int, int> getLevelRange(CDBDataset dataset) const;
+
+    bool isLatitudeIncluded(int latitude) const;
+
+    bool isGeoCellIncluded(const CDBGeoCell &geoCell) const;
+
+    bool isDatasetIncluded(CDBDataset dataset) const;
+
+    bool isLevelIncluded(CDBDataset dataset, int level) const;
+
+    // The dataset and level filters, which change the content of a converted GeoCell. The GeoCell filters
+    // only choose which GeoCells are converted, so they are left out
+    std::string getContentSettings() const;
+
+    static const int MIN_LEVEL;
+    static const int MAX_LEVEL;
+
+private:
+    bool isSpatiallyFiltered() const noexcept;
+
+    std::optional<std::array<double, 4>> m_rectangle;
+    std::unordered_set<CDBGeoCell> m_geoCells;
+    std::unordered_set<int> m_geoCellLatitudes;
+    std::unordered_set<CDBDataset> m_datasets;
+    std::pair<int, int> m_levelRange;
+    std::unordered_map<CDBDataset, std::pair<int, int>> m_datasetLevelRanges;
+};
+} // namespace CDBTo3DTiles
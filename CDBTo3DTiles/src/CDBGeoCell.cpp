@@ -145,6 +145,36 @@ std::optional<int> CDBGeoCell::parseLongFromFilename(const std::string &filename
     return longitude;
 }
 
+std::optional<CDBGeoCell> CDBGeoCell::parseFromName(const std::string &name)
+{
+    char NS, WE;
+    int latitude, longitude;
+    char rest;
+    int result = sscanf(name.c_str(), "%c%d%c%d%c", &NS, &latitude, &WE, &longitude, &rest);
+    if (result != 4) {
+        return std::nullopt;
+    }
+
+    auto parsedLatitude = parseLatFromFilename(std::string(1, NS) + std::to_string(latitude));
+    auto parsedLongitude = parseLongFromFilename(std::string(1, WE) + std::to_string(longitude));
+    if (!parsedLatitude || !parsedLongitude) {
+        return std::nullopt;
+    }
+
+    return CDBGeoCell(*parsedLatitude, *parsedLongitude);
+}
+
+std::optional<CDBGeoCell> CDBGeoCell::parseFromRelativePath(const std::filesystem::path &path)
+{
+    auto latitude = parseLatFromFilename(path.parent_path().filename().string());
+    auto longitude = parseLongFromFilename(path.filename().string());
+    if (!latitude || !longitude) {
+        return std::nullopt;
+    }
+
+    return CDBGeoCell(*latitude, *longitude);
+}
+
 int getZoneFromLatitude(int latitude)
 {
     if (latitude >= 89 && latitude < 90) {
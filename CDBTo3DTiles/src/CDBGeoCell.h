@@ -2,6 +2,7 @@
 
 #include "Utility.h"
 #include <filesystem>
+#include <optional>
 #include <string>
 
 namespace CDBTo3DTiles {
@@ -31,6 +32,12 @@ public:
 
     static std::optional<int> parseLongFromFilename(const std::string &filename);
 
+    // Parses the GeoCell from its name, e.g. N32W119
+    static std::optional<CDBGeoCell> parseFromName(const std::string &name);
+
+    // Parses the GeoCell from its path relative to the CDB, e.g. Tiles/N32/W119
+    static std::optional<CDBGeoCell> parseFromRelativePath(const std::filesystem::path &path);
+
 private:
     friend bool operator==(const CDBGeoCell &lhs, const CDBGeoCell &rhs) noexcept;
 
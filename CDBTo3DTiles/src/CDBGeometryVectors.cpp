@@ -1,12 +1,33 @@
 #include "CDBGeometryVectors.h"
+#include "ConversionStats.h"
+#include "Utility.h"
 #include "mapbox/earcut.hpp"
 #include "ogrsf_frmts.h"
+#include <algorithm>
 
 namespace CDBTo3DTiles {
 
+// below this many polygons per thread, starting threads costs more than triangulating serially
+static constexpr size_t MIN_POLYGONS_PER_THREAD = 512;
+
 static std::optional<CDBClassesAttributes> createClassesAttributes(const CDBTile &instancesTile,
                                                                    const std::filesystem::path &CDBPath);
 
+static std::optional<MappedFile> readFile(const std::filesystem::path &file, FilePrefetcher *prefetcher);
+
+static std::vector<std::vector<ShapefilePart>> groupPolygonRings(const ShapefileRecord &record);
+
+static void addPolygon(int featureID, const OGRPolygon *polygon, PolygonRings &polygons, Mesh &mesh);
+
+static void addPolygon(int featureID,
+                       const std::vector<ShapefilePart> &rings,
+                       PolygonRings &polygons,
+                       Mesh &mesh);
+
+static double computeRingSignedArea(const ShapefilePart &ring);
+
+static bool isPointInRing(double x, double y, const ShapefilePart &ring);
+
 CDBGeometryVectors::CDBGeometryVectors(GDALDatasetUniquePtr dataset,
                                        CDBTile tile,
                                        const std::filesystem::path &CDBPath)
@@ -27,15 +48,38 @@ CDBGeometryVectors::CDBGeometryVectors(GDALDatasetUniquePtr dataset,
         break;
     }
 
-    // merge instance attributes with class attributes
-    auto classesAttributes = createClassesAttributes(tile, CDBPath);
-    if (classesAttributes) {
-        m_instancesAttribs.mergeClassesAttributes(*classesAttributes);
+    mergeClassesAttributes(CDBPath);
+}
+
+CDBGeometryVectors::CDBGeometryVectors(const ShapefileReader &shapefile,
+                                       const DBFReader &attributesTable,
+                                       CDBTile tile,
+                                       const std::filesystem::path &CDBPath)
+    : m_tile{std::move(tile)}
+{
+    m_instancesAttribs.addInstancesFeatures(attributesTable);
+
+    int CS_2 = m_tile->getCS_2();
+    switch (CS_2) {
+    case static_cast<int>(CDBVectorCS2::PointFeature):
+        createPoint(shapefile, attributesTable);
+        break;
+    case static_cast<int>(CDBVectorCS2::LinealFeature):
+        createPolyline(shapefile, attributesTable);
+        break;
+    case static_cast<int>(CDBVectorCS2::PolygonFeature):
+        createPolygonOrMultiPolygon(shapefile, attributesTable);
+        break;
+    default:
+        break;
     }
+
+    mergeClassesAttributes(CDBPath);
 }
 
 std::optional<CDBGeometryVectors> CDBGeometryVectors::createFromFile(const std::filesystem::path &file,
-                                                                     const std::filesystem::path &CDBPath)
+                                                                     const std::filesystem::path &CDBPath,
+                                                                     FilePrefetcher *prefetcher)
 {
     if (file.extension() != ".dbf") {
         return std::nullopt;
@@ -50,6 +94,21 @@ std::optional<CDBGeometryVectors> CDBGeometryVectors::createFromFile(const std::
     if (CS_2 == static_cast<int>(CDBVectorCS2::PointFeature)
         || CS_2 == static_cast<int>(CDBVectorCS2::LinealFeature)
         || CS_2 == static_cast<int>(CDBVectorCS2::PolygonFeature)) {
+        // read geometry and attributes straight from the shapefile when possible and leave the rest to OGR
+        auto shapefilePath = std::filesystem::path(file).replace_extension(".shp");
+        ScopedStageTimer timer("readVectors");
+        timer.addInputFile(file);
+        timer.addInputFile(shapefilePath);
+        auto shapefileData = readFile(shapefilePath, prefetcher);
+        auto attributesData = readFile(file, prefetcher);
+        if (shapefileData && attributesData) {
+            auto shapefile = ShapefileReader::createFromMappedFile(std::move(*shapefileData));
+            auto attributesTable = DBFReader::createFromMappedFile(std::move(*attributesData));
+            if (shapefile && attributesTable) {
+                return CDBGeometryVectors(*shapefile, *attributesTable, *tile, CDBPath);
+            }
+        }
+
         GDALDatasetUniquePtr dataset = GDALDatasetUniquePtr(
             (GDALDataset *) GDALOpenEx(file.c_str(), GDAL_OF_VECTOR, nullptr, nullptr, nullptr));
         if (dataset) {
@@ -67,7 +126,7 @@ void CDBGeometryVectors::createPoint(GDALDataset *vectorDataset)
     m_mesh.aabb = AABB();
     m_mesh.primitiveType = PrimitiveType::Points;
 
-    const auto &ellipsoid = Core::Ellipsoid::WGS84;
+    std::vector<Core::Cartographic> cartographics;
     int featureID = 0;
     for (int i = 0; i < vectorDataset->GetLayerCount(); ++i) {
         OGRLayer *layer = vectorDataset->GetLayer(i);
@@ -77,13 +136,7 @@ void CDBGeometryVectors::createPoint(GDALDataset *vectorDataset)
             const OGRGeometry *geometry = feature->GetGeometryRef();
             if (geometry != nullptr && wkbFlatten(geometry->getGeometryType()) == wkbPoint) {
                 const OGRPoint *p = geometry->toPoint();
-
-                Core::Cartographic cartographic(glm::radians(p->getX()), glm::radians(p->getY()), p->getZ());
-
-                auto position = ellipsoid.cartographicToCartesian(cartographic);
-
-                m_mesh.aabb->merge(position);
-                m_mesh.positions.emplace_back(position);
+                cartographics.emplace_back(glm::radians(p->getX()), glm::radians(p->getY()), p->getZ());
                 m_mesh.batchIDs.emplace_back(featureID);
 
                 ++featureID;
@@ -91,6 +144,8 @@ void CDBGeometryVectors::createPoint(GDALDataset *vectorDataset)
         }
     }
 
+    appendPositions(cartographics);
+
     auto center = m_mesh.aabb->center();
     m_mesh.positionRTCs.reserve(m_mesh.positions.size());
     for (auto position : m_mesh.positions) {
@@ -103,7 +158,7 @@ void CDBGeometryVectors::createPolyline(GDALDataset *vectorDataset)
     m_mesh.aabb = AABB();
     m_mesh.primitiveType = PrimitiveType::Lines;
 
-    const auto &ellipsoid = Core::Ellipsoid::WGS84;
+    std::vector<Core::Cartographic> cartographics;
     int featureID = 0;
     for (int i = 0; i < vectorDataset->GetLayerCount(); ++i) {
         OGRLayer *layer = vectorDataset->GetLayer(i);
@@ -113,25 +168,14 @@ void CDBGeometryVectors::createPolyline(GDALDataset *vectorDataset)
             const OGRGeometry *geometry = feature->GetGeometryRef();
             if (geometry != nullptr && wkbFlatten(geometry->getGeometryType()) == wkbLineString) {
                 const OGRLineString *lineString = geometry->toLineString();
+                cartographics.clear();
                 for (int j = 0; j < lineString->getNumPoints(); ++j) {
                     OGRPoint p;
                     lineString->getPoint(j, &p);
-
-                    Core::Cartographic cartographic(glm::radians(p.getX()), glm::radians(p.getY()), p.getZ());
-
-                    auto position = ellipsoid.cartographicToCartesian(cartographic);
-
-                    m_mesh.aabb->merge(position);
-                    m_mesh.positions.emplace_back(position);
-                    m_mesh.batchIDs.emplace_back(featureID);
-
-                    if (j > 0) {
-                        auto index = m_mesh.positions.size() - 1;
-                        m_mesh.indices.emplace_back(index - 1);
-                        m_mesh.indices.emplace_back(index);
-                    }
+                    cartographics.emplace_back(glm::radians(p.getX()), glm::radians(p.getY()), p.getZ());
                 }
 
+                appendLineString(featureID, cartographics);
                 ++featureID;
             }
         }
@@ -148,14 +192,10 @@ void CDBGeometryVectors::createPolygonOrMultiPolygon(GDALDataset *vectorDataset)
 {
     m_mesh.aabb = AABB();
 
+    PolygonRings polygons;
     int featureID = 0;
     for (int i = 0; i < vectorDataset->GetLayerCount(); ++i) {
         OGRLayer *layer = vectorDataset->GetLayer(i);
-        Core::Ellipsoid ellipsoid = Core::Ellipsoid::WGS84;
-        Core::GlobeRectangle rectangle = m_tile->getBoundRegion().getRectangle();
-        Core::Cartographic tileCenter = rectangle.computeCenter();
-        Core::EllipsoidTangentPlane tangentPlane(ellipsoid.cartographicToCartesian(tileCenter));
-
         for (const auto &feature : *layer) {
             m_instancesAttribs.addInstanceFeature(*feature);
 
@@ -163,18 +203,55 @@ void CDBGeometryVectors::createPolygonOrMultiPolygon(GDALDataset *vectorDataset)
             if (geometry != nullptr && wkbFlatten(geometry->getGeometryType()) == wkbMultiPolygon) {
                 const OGRMultiPolygon *multiPolygon = geometry->toMultiPolygon();
                 for (auto polygon : *multiPolygon) {
-                    createPolygon(featureID, polygon, ellipsoid, tangentPlane);
+                    addPolygon(featureID, polygon, polygons, m_mesh);
                 }
 
                 ++featureID;
             } else if (geometry != nullptr && wkbFlatten(geometry->getGeometryType()) == wkbPolygon) {
                 const OGRPolygon *polygon = geometry->toPolygon();
-                createPolygon(featureID, polygon, ellipsoid, tangentPlane);
+                addPolygon(featureID, polygon, polygons, m_mesh);
                 ++featureID;
             }
         }
     }
 
+    triangulatePolygons(polygons);
+
+    auto center = m_mesh.aabb->center();
+    m_mesh.positionRTCs.reserve(m_mesh.positions.size());
+    for (auto position : m_mesh.positions) {
+        m_mesh.positionRTCs.emplace_back(position - center);
+    }
+}
+
+void CDBGeometryVectors::createPoint(const ShapefileReader &shapefile, const DBFReader &attributesTable)
+{
+    m_mesh.aabb = AABB();
+    m_mesh.primitiveType = PrimitiveType::Points;
+
+    std::vector<Core::Cartographic> cartographics;
+    cartographics.reserve(shapefile.getRecordCount());
+    int featureID = 0;
+    for (size_t i = 0; i < shapefile.getRecordCount(); ++i) {
+        if (attributesTable.isRecordDeleted(i)) {
+            continue;
+        }
+
+        auto record = shapefile.getRecord(i);
+        if (record.getShapeType() != ShapeType::Point && record.getShapeType() != ShapeType::PointZ
+            && record.getShapeType() != ShapeType::PointM) {
+            continue;
+        }
+
+        auto point = record.getPart(0);
+        cartographics.emplace_back(glm::radians(point.getX(0)), glm::radians(point.getY(0)), point.getZ(0));
+        m_mesh.batchIDs.emplace_back(featureID);
+
+        ++featureID;
+    }
+
+    appendPositions(cartographics);
+
     auto center = m_mesh.aabb->center();
     m_mesh.positionRTCs.reserve(m_mesh.positions.size());
     for (auto position : m_mesh.positions) {
@@ -182,36 +259,264 @@ void CDBGeometryVectors::createPolygonOrMultiPolygon(GDALDataset *vectorDataset)
     }
 }
 
-void CDBGeometryVectors::createPolygon(int featureID,
-                                       const OGRPolygon *polygon,
-                                       const Core::Ellipsoid &ellipsoid,
-                                       Core::EllipsoidTangentPlane &tangentPlane)
+void CDBGeometryVectors::createPolyline(const ShapefileReader &shapefile, const DBFReader &attributesTable)
+{
+    m_mesh.aabb = AABB();
+    m_mesh.primitiveType = PrimitiveType::Lines;
+
+    std::vector<Core::Cartographic> cartographics;
+    int featureID = 0;
+    for (size_t i = 0; i < shapefile.getRecordCount(); ++i) {
+        if (attributesTable.isRecordDeleted(i)) {
+            continue;
+        }
+
+        // OGR reads multi-part records as multi line strings, which are not converted
+        auto record = shapefile.getRecord(i);
+        if ((record.getShapeType() != ShapeType::PolyLine && record.getShapeType() != ShapeType::PolyLineZ
+             && record.getShapeType() != ShapeType::PolyLineM)
+            || record.getPartCount() != 1) {
+            continue;
+        }
+
+        auto lineString = record.getPart(0);
+        cartographics.clear();
+        for (size_t j = 0; j < lineString.getPointCount(); ++j) {
+            cartographics.emplace_back(glm::radians(lineString.getX(j)),
+                                       glm::radians(lineString.getY(j)),
+                                       lineString.getZ(j));
+        }
+
+        appendLineString(featureID, cartographics);
+        ++featureID;
+    }
+
+    auto center = m_mesh.aabb->center();
+    m_mesh.positionRTCs.reserve(m_mesh.positions.size());
+    for (auto position : m_mesh.positions) {
+        m_mesh.positionRTCs.emplace_back(position - center);
+    }
+}
+
+void CDBGeometryVectors::createPolygonOrMultiPolygon(const ShapefileReader &shapefile,
+                                                     const DBFReader &attributesTable)
+{
+    m_mesh.aabb = AABB();
+
+    PolygonRings polygons;
+    int featureID = 0;
+    for (size_t i = 0; i < shapefile.getRecordCount(); ++i) {
+        if (attributesTable.isRecordDeleted(i)) {
+            continue;
+        }
+
+        auto record = shapefile.getRecord(i);
+        if (record.getShapeType() != ShapeType::Polygon && record.getShapeType() != ShapeType::PolygonZ
+            && record.getShapeType() != ShapeType::PolygonM) {
+            continue;
+        }
+
+        for (const auto &rings : groupPolygonRings(record)) {
+            addPolygon(featureID, rings, polygons, m_mesh);
+        }
+
+        ++featureID;
+    }
+
+    triangulatePolygons(polygons);
+
+    auto center = m_mesh.aabb->center();
+    m_mesh.positionRTCs.reserve(m_mesh.positions.size());
+    for (auto position : m_mesh.positions) {
+        m_mesh.positionRTCs.emplace_back(position - center);
+    }
+}
+
+size_t CDBGeometryVectors::appendPositions(const std::vector<Core::Cartographic> &cartographics)
+{
+    size_t offset = m_mesh.positions.size();
+    m_mesh.positions.resize(offset + cartographics.size());
+    Core::Ellipsoid::WGS84.cartographicToCartesian(cartographics.data(),
+                                                   cartographics.size(),
+                                                   m_mesh.positions.data() + offset);
+    for (size_t i = offset; i < m_mesh.positions.size(); ++i) {
+        m_mesh.aabb->merge(m_mesh.positions[i]);
+    }
+
+    return offset;
+}
+
+void CDBGeometryVectors::appendLineString(int featureID, const std::vector<Core::Cartographic> &cartographics)
+{
+    size_t offset = appendPositions(cartographics);
+    for (size_t i = 0; i < cartographics.size(); ++i) {
+        m_mesh.batchIDs.emplace_back(featureID);
+
+        if (i > 0) {
+            auto index = offset + i;
+            m_mesh.indices.emplace_back(index - 1);
+            m_mesh.indices.emplace_back(index);
+        }
+    }
+}
+
+void CDBGeometryVectors::triangulatePolygons(const PolygonRings &polygons)
+{
+    size_t positionOffset = appendPositions(polygons.cartographics);
+
+    Core::GlobeRectangle rectangle = m_tile->getBoundRegion().getRectangle();
+    Core::Cartographic tileCenter = rectangle.computeCenter();
+    Core::EllipsoidTangentPlane tangentPlane(Core::Ellipsoid::WGS84.cartographicToCartesian(tileCenter));
+
+    // polygons are independent, so each thread triangulates a contiguous range of them into its own buffer
+    size_t polygonCount = polygons.polygonOffsets.size() - 1;
+    size_t rangeCount = getParallelRangeCount(polygonCount, MIN_POLYGONS_PER_THREAD);
+    std::vector<std::vector<uint32_t>> rangeIndices(rangeCount);
+    parallelForRanges(polygonCount, rangeCount, [&](size_t range, size_t begin, size_t end) {
+        ScopedStageTimer timer("triangulatePolygons");
+        Core::EllipsoidTangentPlane rangeTangentPlane = tangentPlane;
+        std::vector<std::vector<std::pair<double, double>>> mapboxRings;
+        auto &indices = rangeIndices[range];
+        for (size_t polygon = begin; polygon < end; ++polygon) {
+            size_t firstRing = polygons.polygonOffsets[polygon];
+            size_t lastRing = polygons.polygonOffsets[polygon + 1];
+            mapboxRings.resize(lastRing - firstRing);
+            for (size_t ring = firstRing; ring < lastRing; ++ring) {
+                auto &mapboxRing = mapboxRings[ring - firstRing];
+                mapboxRing.clear();
+                for (size_t i = polygons.ringOffsets[ring]; i < polygons.ringOffsets[ring + 1]; ++i) {
+                    const glm::dvec3 &position = m_mesh.positions[positionOffset + i];
+                    glm::dvec2 projectPosition = rangeTangentPlane.projectPointToNearestOnPlane(position);
+                    mapboxRing.emplace_back(projectPosition.x, projectPosition.y);
+                }
+            }
+
+            auto firstIndex = static_cast<uint32_t>(positionOffset + polygons.ringOffsets[firstRing]);
+            for (auto index : mapbox::earcut<uint32_t>(mapboxRings)) {
+                indices.emplace_back(index + firstIndex);
+            }
+        }
+    });
+
+    // stitch the ranges back in polygon order, so the output doesn't depend on the number of threads
+    for (const auto &indices : rangeIndices) {
+        m_mesh.indices.insert(m_mesh.indices.end(), indices.begin(), indices.end());
+    }
+}
+
+void CDBGeometryVectors::mergeClassesAttributes(const std::filesystem::path &CDBPath)
+{
+    // merge instance attributes with class attributes
+    auto classesAttributes = createClassesAttributes(*m_tile, CDBPath);
+    if (classesAttributes) {
+        m_instancesAttribs.mergeClassesAttributes(*classesAttributes);
+    }
+}
+
+void addPolygon(int featureID, const OGRPolygon *polygon, PolygonRings &polygons, Mesh &mesh)
 {
-    uint32_t currPositionSize = static_cast<uint32_t>(m_mesh.positions.size());
-    std::vector<std::vector<std::pair<double, double>>> mapboxRings;
     for (auto lineRing : *polygon) {
-        std::vector<std::pair<double, double>> mapboxRing;
         for (auto point : *lineRing) {
-            Core::Cartographic cartographic(glm::radians(point.getX()),
-                                            glm::radians(point.getY()),
-                                            point.getZ());
-            glm::dvec3 position = ellipsoid.cartographicToCartesian(cartographic);
-            glm::dvec2 projectPosition = tangentPlane.projectPointToNearestOnPlane(position);
-            mapboxRing.emplace_back(projectPosition.x, projectPosition.y);
+            polygons.cartographics.emplace_back(glm::radians(point.getX()),
+                                                glm::radians(point.getY()),
+                                                point.getZ());
+            mesh.batchIDs.emplace_back(featureID);
+        }
+
+        polygons.ringOffsets.emplace_back(polygons.cartographics.size());
+    }
+
+    polygons.polygonOffsets.emplace_back(polygons.ringOffsets.size() - 1);
+}
+
+void addPolygon(int featureID, const std::vector<ShapefilePart> &rings, PolygonRings &polygons, Mesh &mesh)
+{
+    for (const auto &ring : rings) {
+        for (size_t i = 0; i < ring.getPointCount(); ++i) {
+            polygons.cartographics.emplace_back(glm::radians(ring.getX(i)),
+                                                glm::radians(ring.getY(i)),
+                                                ring.getZ(i));
+            mesh.batchIDs.emplace_back(featureID);
+        }
+
+        polygons.ringOffsets.emplace_back(polygons.cartographics.size());
+    }
+
+    polygons.polygonOffsets.emplace_back(polygons.ringOffsets.size() - 1);
+}
+
+std::optional<MappedFile> readFile(const std::filesystem::path &file, FilePrefetcher *prefetcher)
+{
+    if (prefetcher) {
+        auto prefetchedFile = prefetcher->take(file);
+        if (prefetchedFile) {
+            return MappedFile::createFromBuffer(prefetchedFile->releaseData());
+        }
+    }
 
-            m_mesh.positions.emplace_back(position);
-            m_mesh.batchIDs.emplace_back(featureID);
-            m_mesh.aabb->merge(position);
+    return MappedFile::createFromFile(file);
+}
+
+// Shapefile polygons store outer rings clockwise and holes counter-clockwise in one flat list of parts.
+// Holes go to the outer ring that contains them, the same way OGR organizes polygon rings.
+std::vector<std::vector<ShapefilePart>> groupPolygonRings(const ShapefileRecord &record)
+{
+    std::vector<std::vector<ShapefilePart>> polygons;
+    if (record.getPartCount() == 1) {
+        polygons.emplace_back(std::vector<ShapefilePart>{record.getPart(0)});
+        return polygons;
+    }
+
+    std::vector<ShapefilePart> holes;
+    for (size_t i = 0; i < record.getPartCount(); ++i) {
+        auto ring = record.getPart(i);
+        if (computeRingSignedArea(ring) <= 0.0) {
+            polygons.emplace_back(std::vector<ShapefilePart>{ring});
+        } else {
+            holes.emplace_back(ring);
         }
+    }
+
+    for (const auto &hole : holes) {
+        auto polygon = std::find_if(polygons.begin(), polygons.end(), [&hole](const auto &rings) {
+            return isPointInRing(hole.getX(0), hole.getY(0), rings.front());
+        });
+
+        if (polygon != polygons.end()) {
+            polygon->emplace_back(hole);
+        } else {
+            polygons.emplace_back(std::vector<ShapefilePart>{hole});
+        }
+    }
 
-        mapboxRings.emplace_back(mapboxRing);
+    return polygons;
+}
+
+double computeRingSignedArea(const ShapefilePart &ring)
+{
+    double area = 0.0;
+    for (size_t i = 0; i + 1 < ring.getPointCount(); ++i) {
+        area += ring.getX(i) * ring.getY(i + 1) - ring.getX(i + 1) * ring.getY(i);
     }
 
-    auto indices = mapbox::earcut<uint32_t>(mapboxRings);
-    for (auto index : indices) {
-        index += currPositionSize;
-        m_mesh.indices.emplace_back(index);
+    return 0.5 * area;
+}
+
+bool isPointInRing(double x, double y, const ShapefilePart &ring)
+{
+    bool inside = false;
+    size_t pointCount = ring.getPointCount();
+    for (size_t i = 0, j = pointCount - 1; i < pointCount; j = i++) {
+        double xi = ring.getX(i);
+        double yi = ring.getY(i);
+        double xj = ring.getX(j);
+        double yj = ring.getY(j);
+        if ((yi > y) != (yj > y) && x < (xj - xi) * (y - yi) / (yj - yi) + xi) {
+            inside = !inside;
+        }
     }
+
+    return inside;
 }
 
 std::optional<CDBClassesAttributes> createClassesAttributes(const CDBTile &instancesTile,
@@ -241,6 +546,11 @@ std::optional<CDBClassesAttributes> createClassesAttributes(const CDBTile &insta
         return std::nullopt;
     }
 
+    auto attributesTable = DBFReader::createFromFile(classLevelPath);
+    if (attributesTable) {
+        return CDBClassesAttributes(*attributesTable, std::move(classVectorsTile));
+    }
+
     GDALDatasetUniquePtr dataset = GDALDatasetUniquePtr(
         (GDALDataset *) GDALOpenEx(classLevelPath.c_str(), GDAL_OF_VECTOR, nullptr, nullptr, nullptr));
     if (!dataset) {
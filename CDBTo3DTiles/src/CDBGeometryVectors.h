@@ -4,15 +4,31 @@
 #include "CDBTile.h"
 #include "Ellipsoid.h"
 #include "EllipsoidTangentPlane.h"
+#include "FilePrefetcher.h"
 #include "Scene.h"
+#include "ShapefileReader.h"
 #include "gdal_priv.h"
 
 namespace CDBTo3DTiles {
+// Polygon rings flattened into one array. Ring i spans [ringOffsets[i], ringOffsets[i + 1]) of cartographics
+// and polygon j spans rings [polygonOffsets[j], polygonOffsets[j + 1])
+struct PolygonRings
+{
+    std::vector<Core::Cartographic> cartographics;
+    std::vector<size_t> ringOffsets{0};
+    std::vector<size_t> polygonOffsets{0};
+};
+
 class CDBGeometryVectors
 {
 public:
     CDBGeometryVectors(GDALDatasetUniquePtr dataset, CDBTile tile, const std::filesystem::path &CDBPath);
 
+    CDBGeometryVectors(const ShapefileReader &shapefile,
+                       const DBFReader &attributesTable,
+                       CDBTile tile,
+                       const std::filesystem::path &CDBPath);
+
     inline const Mesh &getMesh() const noexcept { return m_mesh; }
 
     inline const CDBTile &getTile() const noexcept { return *m_tile; }
@@ -22,8 +38,10 @@ public:
         return m_instancesAttribs;
     }
 
+    // The attribute table and shapefile are taken from the prefetcher when it read them ahead
     static std::optional<CDBGeometryVectors> createFromFile(const std::filesystem::path &file,
-                                                            const std::filesystem::path &CDBPath);
+                                                            const std::filesystem::path &CDBPath,
+                                                            FilePrefetcher *prefetcher = nullptr);
 
 private:
     void createPoint(GDALDataset *vectorDataset);
@@ -32,10 +50,19 @@ private:
 
     void createPolygonOrMultiPolygon(GDALDataset *vectorDataset);
 
-    void createPolygon(int featureID,
-                       const OGRPolygon *polygon,
-                       const Core::Ellipsoid &ellipsoid,
-                       Core::EllipsoidTangentPlane &tangentPlane);
+    void createPoint(const ShapefileReader &shapefile, const DBFReader &attributesTable);
+
+    void createPolyline(const ShapefileReader &shapefile, const DBFReader &attributesTable);
+
+    void createPolygonOrMultiPolygon(const ShapefileReader &shapefile, const DBFReader &attributesTable);
+
+    void triangulatePolygons(const PolygonRings &polygons);
+
+    size_t appendPositions(const std::vector<Core::Cartographic> &cartographics);
+
+    void appendLineString(int featureID, const std::vector<Core::Cartographic> &cartographics);
+
+    void mergeClassesAttributes(const std::filesystem::path &CDBPath);
 
     Mesh m_mesh;
     CDBInstancesAttributes m_instancesAttribs;
@@ -7,4 +7,10 @@ CDBImagery::CDBImagery(GDALDatasetUniquePtr imageryDataset, const CDBTile &tile)
     , _tile{tile}
 {}
 
+CDBImagery::CDBImagery(GDALDatasetUniquePtr imageryDataset, const CDBTile &tile, PrefetchedFile source)
+    : _source{std::move(source)}
+    , _data{std::move(imageryDataset)}
+    , _tile{tile}
+{}
+
 } // namespace CDBTo3DTiles
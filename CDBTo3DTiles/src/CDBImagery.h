@@ -1,6 +1,7 @@
 #pragma once
 
 #include "CDBTileset.h"
+#include "FilePrefetcher.h"
 #include "gdal_priv.h"
 
 namespace CDBTo3DTiles {
@@ -9,6 +10,9 @@ class CDBImagery
 public:
     CDBImagery(GDALDatasetUniquePtr imageryDataset, const CDBTile &tile);
 
+    // The dataset was opened from the in-memory copy of a prefetched file, which is kept until it is closed
+    CDBImagery(GDALDatasetUniquePtr imageryDataset, const CDBTile &tile, PrefetchedFile source);
+
     inline const GDALDataset &getData() const noexcept { return *_data; }
 
     inline GDALDataset &getData() noexcept { return *_data; }
@@ -16,6 +20,8 @@ public:
     inline const CDBTile &getTile() const noexcept { return *_tile; }
 
 private:
+    // declared before the dataset, so it outlives it
+    std::optional<PrefetchedFile> _source;
     GDALDatasetUniquePtr _data;
     std::optional<CDBTile> _tile;
 };
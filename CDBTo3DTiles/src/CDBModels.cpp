@@ -7,6 +7,7 @@
 #include "glm/gtc/matrix_transform.hpp"
 #include "osg/Material"
 #include "osgDB/ReadFile"
+#include <limits>
 #include <unordered_set>
 
 namespace CDBTo3DTiles {
@@ -153,6 +154,27 @@ void CDBModel3DResult::finalize()
     }
 }
 
+size_t CDBModel3DResult::getSizeInBytes() const
+{
+    size_t sizeInBytes = 0;
+    for (const auto &mesh : m_meshes) {
+        sizeInBytes += mesh.indices.capacity() * sizeof(uint32_t);
+        sizeInBytes += mesh.positions.capacity() * sizeof(glm::dvec3);
+        sizeInBytes += mesh.positionRTCs.capacity() * sizeof(glm::vec3);
+        sizeInBytes += mesh.UVs.capacity() * sizeof(glm::vec2);
+        sizeInBytes += mesh.normals.capacity() * sizeof(glm::vec3);
+        sizeInBytes += mesh.batchIDs.capacity() * sizeof(float);
+    }
+
+    for (const auto &image : m_images) {
+        if (image) {
+            sizeInBytes += image->getTotalSizeInBytes();
+        }
+    }
+
+    return sizeInBytes;
+}
+
 void CDBModel3DResult::pushStateSet(osg::StateSet *ss)
 {
     if (ss != nullptr) {
@@ -340,38 +362,53 @@ void CDBModel3DResult::processGeometry(osg::Geometry &geometry, osg::Matrix matr
 
 CDBGTModelCache::CDBGTModelCache(const std::filesystem::path &CDBPath)
     : m_CDBPath{CDBPath}
+    , m_catalog{nullptr}
+    , m_cacheSizeInBytes{std::numeric_limits<size_t>::max()}
+    , m_cachedBytes{0}
 {}
 
+void CDBGTModelCache::setCatalog(const CDBCatalog *catalog)
+{
+    m_catalog = catalog;
+}
+
 const CDBModel3DResult *CDBGTModelCache::locateModel3D(const std::string &FACC,
                                                        const std::string &MODL,
                                                        int FSC,
                                                        std::string &modelKey) const
 {
     std::string key = getModelKey(FACC, MODL, FSC);
-    auto model = m_keyToModel.find(key);
-    if (model != m_keyToModel.end()) {
+    auto model = m_modelIndices.find(key);
+    if (model != m_modelIndices.end()) {
+        m_models.splice(m_models.begin(), m_models, model->second);
         modelKey = key;
-        return &model->second;
-    }
-
-    for (std::filesystem::directory_entry A_Cartegory : std::filesystem::directory_iterator(
-             m_CDBPath / CDB::GTModel / getCDBDatasetDirectoryName(CDBDataset::GTModelGeometry_500))) {
-        if (A_Cartegory.path().filename().string().front() == FACC[0]) {
-            for (std::filesystem::directory_entry B_Subcartegory :
-                 std::filesystem::directory_iterator(A_Cartegory)) {
-                if (B_Subcartegory.path().filename().string().front() == FACC[1]) {
-                    for (std::filesystem::directory_entry featureCodeDir :
-                         std::filesystem::directory_iterator(B_Subcartegory)) {
-                        if (featureCodeDir.path().filename().string().substr(0, 3) == FACC.substr(2, 3)) {
-                            osg::ref_ptr<osg::Node> geometry = osgDB::readRefNodeFile(featureCodeDir.path()
-                                                                                      / (key + ".flt"));
+        return &m_models.front().model;
+    }
+
+    const auto &catalog = getCatalog();
+    auto libraryPath = CDB::GTModel / getCDBDatasetDirectoryName(CDBDataset::GTModelGeometry_500);
+    for (const auto &A_Cartegory : catalog.getDirectories(libraryPath)) {
+        if (A_Cartegory.front() == FACC[0]) {
+            auto A_CartegoryPath = libraryPath / A_Cartegory;
+            for (const auto &B_Subcartegory : catalog.getDirectories(A_CartegoryPath)) {
+                if (B_Subcartegory.front() == FACC[1]) {
+                    auto B_SubcartegoryPath = A_CartegoryPath / B_Subcartegory;
+                    for (const auto &featureCodeDir : catalog.getDirectories(B_SubcartegoryPath)) {
+                        auto modelPath = B_SubcartegoryPath / featureCodeDir / (key + ".flt");
+                        if (featureCodeDir.substr(0, 3) == FACC.substr(2, 3)
+                            && catalog.isFileExist(modelPath)) {
+                            osg::ref_ptr<osg::Node> geometry = osgDB::readRefNodeFile(m_CDBPath / modelPath);
                             if (geometry) {
                                 CDBModel3DResult model3D;
                                 geometry->accept(model3D);
                                 model3D.finalize();
-                                m_keyToModel.insert({key, std::move(model3D)});
+                                size_t sizeInBytes = model3D.getSizeInBytes();
+                                m_models.push_front({key, sizeInBytes, std::move(model3D)});
+                                m_modelIndices.insert({key, m_models.begin()});
+                                m_cachedBytes += sizeInBytes;
+                                evict();
                                 modelKey = key;
-                                return &m_keyToModel[key];
+                                return &m_models.front().model;
                             }
                         }
                     }
@@ -383,11 +420,59 @@ const CDBModel3DResult *CDBGTModelCache::locateModel3D(const std::string &FACC,
     return nullptr;
 }
 
+const CDBCatalog &CDBGTModelCache::getCatalog() const
+{
+    if (m_catalog) {
+        return *m_catalog;
+    }
+
+    // only the model library is scanned when the cache is used without a CDB
+    if (!m_libraryCatalog) {
+        std::string library = CDB::GTModel.generic_string();
+        auto isInLibrary = [&library](const std::string &directory) {
+            return directory == library || directory.compare(0, library.size() + 1, library + "/") == 0;
+        };
+
+        m_libraryCatalog = CDBCatalog::createFromDirectory(m_CDBPath, 1, isInLibrary);
+    }
+
+    return *m_libraryCatalog;
+}
+
+void CDBGTModelCache::setCacheSizeInBytes(size_t cacheSizeInBytes)
+{
+    m_cacheSizeInBytes = cacheSizeInBytes;
+    evict();
+}
+
+void CDBGTModelCache::trim(size_t targetBytes)
+{
+    while (m_cachedBytes > targetBytes && !m_models.empty()) {
+        dropLeastRecentlyUsed();
+    }
+}
+
 std::string CDBGTModelCache::getModelKey(const std::string &FACC, const std::string &MODL, int FCC) const
 {
     return "D500_S001_T001_" + FACC + "_" + toStringWithZeroPadding(3, FCC) + "_" + MODL;
 }
 
+void CDBGTModelCache::evict() const
+{
+    // the model just read is always kept, since the caller is about to use it
+    while (m_cachedBytes > m_cacheSizeInBytes && m_models.size() > 1) {
+        dropLeastRecentlyUsed();
+    }
+}
+
+void CDBGTModelCache::dropLeastRecentlyUsed() const
+{
+    const auto &leastRecentlyUsed = m_models.back();
+    m_cachedBytes -= leastRecentlyUsed.sizeInBytes;
+    m_modelIndices.erase(leastRecentlyUsed.key);
+    m_models.pop_back();
+}
+
 CDBGTModels::CDBGTModels(CDBModelsAttributes attributes, CDBGTModelCache *cache)
     : m_cache{cache}
     , m_attributes{std::move(attributes)}
@@ -461,6 +546,11 @@ CDBGSModels::CDBGSModels(CDBModelsAttributes modelsAttributes,
     auto MODLs = stringAttribs.find("MODL");
     auto FSCs = integerAttribs.find("FSC");
 
+    std::vector<glm::dvec3> worldPositions(cartographicPositions.size());
+    ellipsoid.cartographicToCartesian(cartographicPositions.data(),
+                                      cartographicPositions.size(),
+                                      worldPositions.data());
+
     // extract attributes for this tile only
     size_t totalInputInstanceCount = instancesAttribs.getInstancesCount();
     std::vector<size_t> extractedInstances;
@@ -476,7 +566,7 @@ CDBGSModels::CDBGSModels(CDBModelsAttributes modelsAttributes,
             if (result.validNode()) {
                 // combine mesh
                 osg::ref_ptr<osg::Node> node = result.takeNode();
-                glm::dvec3 worldPosition = ellipsoid.cartographicToCartesian(cartographicPositions[i]);
+                const glm::dvec3 &worldPosition = worldPositions[i];
 
                 double orientation = 0.0;
                 if (i < orientations.size()) {
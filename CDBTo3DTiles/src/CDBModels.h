@@ -1,12 +1,15 @@
 #pragma once
 
 #include "CDBAttributes.h"
+#include "CDBCatalog.h"
 #include "Scene.h"
 #include "osg/NodeVisitor"
 #include "osg/StateSet"
 #include "osgDB/Archive"
+#include <list>
 #include <map>
 #include <stack>
+#include <unordered_map>
 
 namespace CDBTo3DTiles {
 class GeometryValueVisitor : public osg::ValueVisitor
@@ -142,6 +145,9 @@ public:
 
     inline const std::vector<osg::ref_ptr<osg::Image>> &getImages() const noexcept { return m_images; }
 
+    // Memory held by the meshes and images
+    size_t getSizeInBytes() const;
+
 private:
     struct CompareStateSet
     {
@@ -170,21 +176,56 @@ private:
     std::vector<osg::ref_ptr<osg::Image>> m_images;
 };
 
+// GTModels are read once and kept in a least recently used cache bounded by their size in bytes. The cache
+// is unbounded unless a size is set
 class CDBGTModelCache
 {
 public:
     CDBGTModelCache(const std::filesystem::path &CDBPath);
 
+    // Models are located through the catalog, which has to outlive the lookups. Without one, the cache scans
+    // the model library on the first lookup
+    void setCatalog(const CDBCatalog *catalog);
+
+    // The returned model stays valid until the next lookup or trim
     const CDBModel3DResult *locateModel3D(const std::string &FACC,
                                           const std::string &MODL,
                                           int FSC,
                                           std::string &modelKey) const;
 
+    void setCacheSizeInBytes(size_t cacheSizeInBytes);
+
+    inline size_t getCacheSizeInBytes() const noexcept { return m_cacheSizeInBytes; }
+
+    inline size_t getCachedBytes() const noexcept { return m_cachedBytes; }
+
+    // Drops least recently used models until the cache holds at most the given bytes, without changing its
+    // size. Used to give memory back under pressure
+    void trim(size_t targetBytes);
+
 private:
+    struct CacheEntry
+    {
+        std::string key;
+        size_t sizeInBytes;
+        CDBModel3DResult model;
+    };
+
     std::string getModelKey(const std::string &FACC, const std::string &MODL, int FCC) const;
 
+    void evict() const;
+
+    void dropLeastRecentlyUsed() const;
+
+    const CDBCatalog &getCatalog() const;
+
     std::filesystem::path m_CDBPath;
-    mutable std::map<std::string, CDBModel3DResult> m_keyToModel;
+    const CDBCatalog *m_catalog;
+    mutable std::optional<CDBCatalog> m_libraryCatalog;
+    size_t m_cacheSizeInBytes;
+    mutable size_t m_cachedBytes;
+    mutable std::list<CacheEntry> m_models;
+    mutable std::unordered_map<std::string, std::list<CacheEntry>::iterator> m_modelIndices;
 };
 
 class CDBGTModels
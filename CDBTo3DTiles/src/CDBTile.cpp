@@ -39,40 +39,10 @@ CDBTile::CDBTile(CDBGeoCell geoCell, CDBDataset dataset, int CS_1, int CS_2, int
     m_UREF = UREF;
     m_RREF = RREF;
     m_region = calcBoundRegion(*m_geoCell, m_level, m_UREF, m_RREF);
+    m_hasMeasuredHeights = false;
     m_path = convertToPath();
 }
 
-CDBTile::CDBTile(const CDBTile &other)
-    : m_customContentURI{other.m_customContentURI}
-    , m_region{other.m_region}
-    , m_path{other.m_path}
-    , m_geoCell{other.m_geoCell}
-    , m_dataset{other.m_dataset}
-    , m_CS_1{other.m_CS_1}
-    , m_CS_2{other.m_CS_2}
-    , m_level{other.m_level}
-    , m_UREF{other.m_UREF}
-    , m_RREF{other.m_RREF}
-{}
-
-CDBTile &CDBTile::operator=(const CDBTile &other)
-{
-    if (&other != this) {
-        m_customContentURI = other.m_customContentURI;
-        m_region = other.m_region;
-        m_path = other.m_path;
-        m_geoCell = other.m_geoCell;
-        m_dataset = other.m_dataset;
-        m_CS_1 = other.m_CS_1;
-        m_CS_2 = other.m_CS_2;
-        m_level = other.m_level;
-        m_UREF = other.m_UREF;
-        m_RREF = other.m_RREF;
-    }
-
-    return *this;
-}
-
 const std::filesystem::path *CDBTile::getCustomContentURI() const noexcept
 {
     return m_customContentURI ? &*m_customContentURI : nullptr;
@@ -83,6 +53,27 @@ void CDBTile::setCustomContentURI(const std::filesystem::path &customContentURI)
     m_customContentURI = customContentURI;
 }
 
+const float *CDBTile::getGeometricError() const noexcept
+{
+    return m_geometricError ? &*m_geometricError : nullptr;
+}
+
+void CDBTile::setGeometricError(float geometricError) noexcept
+{
+    m_geometricError = geometricError;
+}
+
+void CDBTile::expandHeights(double minimumHeight, double maximumHeight) noexcept
+{
+    if (m_hasMeasuredHeights) {
+        minimumHeight = glm::min(minimumHeight, m_region->getMinimumHeight());
+        maximumHeight = glm::max(maximumHeight, m_region->getMaximumHeight());
+    }
+
+    m_region = Core::BoundingRegion(m_region->getRectangle(), minimumHeight, maximumHeight);
+    m_hasMeasuredHeights = true;
+}
+
 std::string CDBTile::retrieveGeoCellDatasetFromTileName(const CDBTile &tile)
 {
     const auto &geoCell = tile.getGeoCell();
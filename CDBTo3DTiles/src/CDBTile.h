@@ -10,11 +10,11 @@ class CDBTile
 public:
     CDBTile(CDBGeoCell geoCell, CDBDataset dataset, int CS_1, int CS_2, int level, int UREF, int RREF);
 
-    CDBTile(const CDBTile &);
+    CDBTile(const CDBTile &) = default;
 
     CDBTile(CDBTile &&) noexcept = default;
 
-    CDBTile &operator=(const CDBTile &);
+    CDBTile &operator=(const CDBTile &) = default;
 
     CDBTile &operator=(CDBTile &&) noexcept = default;
 
@@ -36,14 +36,22 @@ public:
 
     inline int getRREF() const noexcept { return m_RREF; }
 
-    inline const std::vector<CDBTile *> &getChildren() const noexcept { return m_children; }
-
-    inline std::vector<CDBTile *> &getChildren() noexcept { return m_children; }
-
     const std::filesystem::path *getCustomContentURI() const noexcept;
 
     void setCustomContentURI(const std::filesystem::path &customContentURI) noexcept;
 
+    // Error in meters of the content compared to the full detail data of its area, if it was measured
+    const float *getGeometricError() const noexcept;
+
+    void setGeometricError(float geometricError) noexcept;
+
+    // True once the heights of the bound region come from content instead of the default of zero
+    inline bool hasMeasuredHeights() const noexcept { return m_hasMeasuredHeights; }
+
+    // Grows the height range of the bound region to include the given heights. The first call replaces the
+    // default heights, so tiles without content never widen the range of the tiles above them
+    void expandHeights(double minimumHeight, double maximumHeight) noexcept;
+
     static std::string retrieveGeoCellDatasetFromTileName(const CDBTile &tile);
 
     static std::optional<CDBTile> createParentTile(const CDBTile &tile);
@@ -84,8 +92,8 @@ private:
 
     std::filesystem::path convertToPath() const noexcept;
 
-    std::vector<CDBTile *> m_children;
     std::optional<std::filesystem::path> m_customContentURI;
+    std::optional<float> m_geometricError;
     std::optional<Core::BoundingRegion> m_region;
     std::filesystem::path m_path;
     std::optional<CDBGeoCell> m_geoCell;
@@ -95,6 +103,7 @@ private:
     int m_level;
     int m_UREF;
     int m_RREF;
+    bool m_hasMeasuredHeights;
 };
 } // namespace CDBTo3DTiles
 
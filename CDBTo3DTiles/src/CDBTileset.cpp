@@ -1,10 +1,10 @@
 #include "CDBTileset.h"
 #include "CDB.h"
-#include "glm/glm.hpp"
+#include <algorithm>
 
 namespace CDBTo3DTiles {
 
-static glm::ivec2 getQuadtreeRelativeChild(const CDBTile &tile, const CDBTile &root);
+static uint64_t interleaveBits(uint32_t x, uint32_t y);
 
 CDBTileset::CDBTileset()
     : m_rootLevel{-10}
@@ -24,7 +24,51 @@ const CDBTile *CDBTileset::getRoot() const
         return nullptr;
     }
 
-    return m_tiles.front().get();
+    return &m_tiles.front();
+}
+
+const CDBTile *CDBTileset::getTile(int level, int UREF, int RREF) const
+{
+    auto tileIndex = m_tileIndices.find(computeTileKey(level, UREF, RREF));
+    if (tileIndex == m_tileIndices.end()) {
+        return nullptr;
+    }
+
+    return &m_tiles[tileIndex->second];
+}
+
+std::array<const CDBTile *, 4> CDBTileset::getChildren(const CDBTile &tile) const
+{
+    std::array<const CDBTile *, 4> children{nullptr, nullptr, nullptr, nullptr};
+    size_t tileIndex = getTileIndex(tile);
+    if (tileIndex == NO_TILE) {
+        return children;
+    }
+
+    const auto &childIndices = m_children[tileIndex];
+    for (size_t i = 0; i < childIndices.size(); ++i) {
+        if (childIndices[i] != NO_TILE) {
+            children[i] = &m_tiles[childIndices[i]];
+        }
+    }
+
+    return children;
+}
+
+bool CDBTileset::isLeaf(const CDBTile &tile) const
+{
+    size_t tileIndex = getTileIndex(tile);
+    if (tileIndex == NO_TILE) {
+        return true;
+    }
+
+    for (auto child : m_children[tileIndex]) {
+        if (child != NO_TILE) {
+            return false;
+        }
+    }
+
+    return true;
 }
 
 CDBTile *CDBTileset::insertTile(const CDBTile &tile)
@@ -46,19 +90,47 @@ CDBTile *CDBTileset::insertTile(const CDBTile &tile)
         }
     }
 
-    if (m_tiles.empty()) {
-        auto cdbRoot = std::make_unique<CDBTile>(tile.getGeoCell(),
-                                                 tile.getDataset(),
-                                                 tile.getCS_1(),
-                                                 tile.getCS_2(),
-                                                 m_rootLevel,
-                                                 m_rootUREF,
-                                                 m_rootRREF);
+    uint32_t tileIndex = insertTileRecursively(tile, tile.getLevel(), tile.getUREF(), tile.getRREF());
+    auto &insertedTile = m_tiles[tileIndex];
+    auto customContentURI = tile.getCustomContentURI();
+    if (customContentURI) {
+        insertedTile.setCustomContentURI(*customContentURI);
+    }
+
+    auto geometricError = tile.getGeometricError();
+    if (geometricError) {
+        auto insertedGeometricError = insertedTile.getGeometricError();
+        if (insertedGeometricError) {
+            insertedTile.setGeometricError(std::max(*insertedGeometricError, *geometricError));
+        } else {
+            insertedTile.setGeometricError(*geometricError);
+        }
+    }
+
+    // heights of the content grow the bound region of the tile and of every ancestor of it, so each region
+    // covers the content of its whole subtree
+    if (tile.hasMeasuredHeights()) {
+        const auto &boundRegion = tile.getBoundRegion();
+        double minimumHeight = boundRegion.getMinimumHeight();
+        double maximumHeight = boundRegion.getMaximumHeight();
+        insertedTile.expandHeights(minimumHeight, maximumHeight);
+
+        int level = tile.getLevel();
+        int UREF = tile.getUREF();
+        int RREF = tile.getRREF();
+        while (level > m_rootLevel) {
+            if (level > 0) {
+                UREF >>= 1;
+                RREF >>= 1;
+            }
 
-        m_tiles.emplace_back(std::move(cdbRoot));
+            --level;
+            m_tiles[m_tileIndices.at(computeTileKey(level, UREF, RREF))].expandHeights(minimumHeight,
+                                                                                      maximumHeight);
+        }
     }
 
-    return insertTileRecursively(tile, m_tiles.front().get());
+    return &insertedTile;
 }
 
 const CDBTile *CDBTileset::getFitTile(Core::Cartographic cartographic) const
@@ -73,92 +145,96 @@ const CDBTile *CDBTileset::getFitTile(Core::Cartographic cartographic) const
         return nullptr;
     }
 
-    return getFitTile(root, cartographic);
-}
+    // walk down by picking the quadrant of the position at each level. A position on the border between two
+    // children goes to the south west one
+    uint32_t tileIndex = 0;
+    while (true) {
+        const auto &tile = m_tiles[tileIndex];
+        size_t childIndex = 0;
+        if (tile.getLevel() >= 0) {
+            const auto &tileRectangle = tile.getBoundRegion().getRectangle();
+            double middleLongitude = (tileRectangle.getWest() + tileRectangle.getEast()) / 2.0;
+            double middleLatitude = (tileRectangle.getSouth() + tileRectangle.getNorth()) / 2.0;
+            childIndex = static_cast<size_t>(cartographic.latitude > middleLatitude) * 2
+                         + static_cast<size_t>(cartographic.longitude > middleLongitude);
+        }
 
-glm::ivec2 getQuadtreeRelativeChild(const CDBTile &tile, const CDBTile &root)
-{
-    double powerOf2 = glm::pow(2, tile.getLevel() - root.getLevel() - 1);
-    int UREF = static_cast<int>(tile.getUREF() / powerOf2 - root.getUREF() * 2);
-    int RREF = static_cast<int>(tile.getRREF() / powerOf2 - root.getRREF() * 2);
-    return {RREF, UREF};
+        uint32_t child = m_children[tileIndex][childIndex];
+        if (child == NO_TILE) {
+            return &tile;
+        }
+
+        tileIndex = child;
+    }
 }
 
-const CDBTile *CDBTileset::getFitTile(const CDBTile *root, Core::Cartographic cartographic) const
+uint32_t CDBTileset::insertTileRecursively(const CDBTile &insert, int level, int UREF, int RREF)
 {
-    for (auto child : root->getChildren()) {
-        if (child) {
-            const auto &childRectangle = child->getBoundRegion().getRectangle();
-            if (childRectangle.contains(cartographic)) {
-                return getFitTile(child, cartographic);
-            }
+    uint64_t key = computeTileKey(level, UREF, RREF);
+    auto existingTile = m_tileIndices.find(key);
+    if (existingTile != m_tileIndices.end()) {
+        return existingTile->second;
+    }
+
+    // the parent is created first, so the root always ends up at the front. Only the missing ancestors are
+    // visited, which is usually none
+    uint32_t parentIndex = NO_TILE;
+    size_t childIndex = 0;
+    if (level > m_rootLevel) {
+        if (level > 0) {
+            parentIndex = insertTileRecursively(insert, level - 1, UREF >> 1, RREF >> 1);
+            childIndex = static_cast<size_t>((UREF & 1) * 2 + (RREF & 1));
+        } else {
+            parentIndex = insertTileRecursively(insert, level - 1, UREF, RREF);
         }
     }
 
-    return root;
+    auto tileIndex = static_cast<uint32_t>(m_tiles.size());
+    m_tiles.emplace_back(insert.getGeoCell(),
+                         insert.getDataset(),
+                         insert.getCS_1(),
+                         insert.getCS_2(),
+                         level,
+                         UREF,
+                         RREF);
+    m_children.push_back({NO_TILE, NO_TILE, NO_TILE, NO_TILE});
+    m_tileIndices.insert({key, tileIndex});
+    if (parentIndex != NO_TILE) {
+        m_children[parentIndex][childIndex] = tileIndex;
+    }
+
+    return tileIndex;
 }
 
-CDBTile *CDBTileset::insertTileRecursively(const CDBTile &insert, CDBTile *subTree)
+size_t CDBTileset::getTileIndex(const CDBTile &tile) const
 {
-    // we are at the right level here. Just copy the data over
-    if (insert.getLevel() == subTree->getLevel() && insert.getUREF() == subTree->getUREF()
-        && insert.getRREF() == subTree->getRREF()) {
-        auto customContentURI = insert.getCustomContentURI();
-        if (customContentURI) {
-            subTree->setCustomContentURI(*customContentURI);
-        }
-
-        return subTree;
-    }
-
-    // root has only one child if its level < 0
-    if (subTree->getLevel() < 0) {
-        if (subTree->getChildren().empty()) {
-            int childUREF = subTree->getUREF();
-            int childRREF = subTree->getRREF();
-            int childLevel = subTree->getLevel() + 1;
-            auto &children = subTree->getChildren();
-            const CDBGeoCell &geoCell = insert.getGeoCell();
-            auto child = std::make_unique<CDBTile>(geoCell,
-                                                   insert.getDataset(),
-                                                   insert.getCS_1(),
-                                                   insert.getCS_2(),
-                                                   childLevel,
-                                                   childUREF,
-                                                   childRREF);
-            children.emplace_back(child.get());
-            m_tiles.emplace_back(std::move(child));
-        }
-
-        return insertTileRecursively(insert, subTree->getChildren().back());
+    if (!m_tiles.empty() && &tile >= m_tiles.data() && &tile < m_tiles.data() + m_tiles.size()) {
+        return static_cast<size_t>(&tile - m_tiles.data());
     }
 
-    // For positive level, root is a quadtree.
-    // So we determine which child we will insert the tile to
-    auto &children = subTree->getChildren();
-    if (children.size() < 4) {
-        children.resize(4, nullptr);
+    auto tileIndex = m_tileIndices.find(computeTileKey(tile.getLevel(), tile.getUREF(), tile.getRREF()));
+    if (tileIndex == m_tileIndices.end()) {
+        return NO_TILE;
     }
 
-    glm::ivec2 relativeChild = getQuadtreeRelativeChild(insert, *subTree);
-    size_t childIdx = static_cast<size_t>(relativeChild.y * 2 + relativeChild.x);
-    if (children[childIdx] == nullptr) {
-        int childRREF = relativeChild.x + 2 * subTree->getRREF();
-        int childUREF = relativeChild.y + 2 * subTree->getUREF();
-        int childLevel = subTree->getLevel() + 1;
-        const CDBGeoCell &geoCell = insert.getGeoCell();
-        auto child = std::make_unique<CDBTile>(geoCell,
-                                               insert.getDataset(),
-                                               insert.getCS_1(),
-                                               insert.getCS_2(),
-                                               childLevel,
-                                               childUREF,
-                                               childRREF);
+    return tileIndex->second;
+}
+
+uint64_t CDBTileset::computeTileKey(int level, int UREF, int RREF)
+{
+    // levels start at -10, and UREF and RREF of level 23 fit in 23 bits each
+    return (static_cast<uint64_t>(level + 10) << 48)
+           | interleaveBits(static_cast<uint32_t>(RREF), static_cast<uint32_t>(UREF));
+}
 
-        children[childIdx] = child.get();
-        m_tiles.emplace_back(std::move(child));
+uint64_t interleaveBits(uint32_t x, uint32_t y)
+{
+    uint64_t result = 0;
+    for (uint32_t i = 0; i < 24; ++i) {
+        result |= static_cast<uint64_t>((x >> i) & 1) << (2 * i);
+        result |= static_cast<uint64_t>((y >> i) & 1) << (2 * i + 1);
     }
 
-    return insertTileRecursively(insert, children[childIdx]);
+    return result;
 }
 } // namespace CDBTo3DTiles
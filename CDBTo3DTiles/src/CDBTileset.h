@@ -2,12 +2,16 @@
 
 #include "CDBTile.h"
 #include "Cartographic.h"
-#include <memory>
+#include <array>
+#include <cstdint>
+#include <unordered_map>
 #include <vector>
 
 namespace CDBTo3DTiles {
 class CDBTile;
 
+// Quadtree of CDB tiles stored in one array. Every tile is found by its level, UREF and RREF in constant
+// time, and each tile keeps the array indices of its children instead of pointers to them
 class CDBTileset
 {
 public:
@@ -17,19 +21,35 @@ public:
 
     const CDBTile *getRoot() const;
 
+    const CDBTile *getTile(int level, int UREF, int RREF) const;
+
+    // Children are ordered south west, south east, north west and north east, with nullptr for the missing
+    // ones. Tiles with negative level only have the first child, since their child covers the same area
+    std::array<const CDBTile *, 4> getChildren(const CDBTile &tile) const;
+
+    bool isLeaf(const CDBTile &tile) const;
+
+    // Inserting a tile again keeps the larger of the geometric errors. Measured heights of the tile are added
+    // to the bound regions of it and its ancestors. The returned tile is only valid until the next insertion
     CDBTile *insertTile(const CDBTile &tile);
 
     const CDBTile *getFitTile(Core::Cartographic cartographic) const;
 
 private:
-    const CDBTile *getFitTile(const CDBTile *root, Core::Cartographic cartographic) const;
+    uint32_t insertTileRecursively(const CDBTile &insert, int level, int UREF, int RREF);
+
+    size_t getTileIndex(const CDBTile &tile) const;
+
+    static uint64_t computeTileKey(int level, int UREF, int RREF);
 
-    CDBTile *insertTileRecursively(const CDBTile &insert, CDBTile *subTree);
+    static constexpr uint32_t NO_TILE = UINT32_MAX;
 
     int m_rootLevel;
     int m_rootUREF;
     int m_rootRREF;
-    std::vector<std::unique_ptr<CDBTile>> m_tiles;
+    std::vector<CDBTile> m_tiles;
+    std::vector<std::array<uint32_t, 4>> m_children;
+    std::unordered_map<uint64_t, uint32_t> m_tileIndices;
 };
 
 } // namespace CDBTo3DTiles
@@ -1,11 +1,25 @@
 #include "CDBTo3DTiles.h"
+#include "ArchiveWriter.h"
+#include "BuildManifest.h"
 #include "CDB.h"
+#include "ContentHash.h"
+#include "ContentStore.h"
+#include "ConversionStats.h"
 #include "Gltf.h"
 #include "MathHelpers.h"
+#include "MemoryBudget.h"
+#include "OutputWriter.h"
 #include "TileFormatIO.h"
 #include "cpl_conv.h"
+#include "cpl_vsi.h"
 #include "gdal.h"
-#include "osgDB/WriteFile"
+#include "osgDB/Registry"
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <set>
+#include <sstream>
+#include <stdexcept>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -23,13 +37,43 @@ struct Converter::Impl
         , elevationLOD{false}
         , elevationDecimateError{0.01f}
         , elevationThresholdIndices{0.3f}
+        , dictionaryEncodeStrings{false}
+        , incremental{false}
+        , deduplicate{false}
+        , archive{false}
+        , implicitTiling{false}
+        , orientedBoundingBox{false}
+        , bilinearModelClamping{false}
+        , elevationCacheSize{ElevationSampler::DEFAULT_CACHE_SIZE}
+        , memoryBudgetSize{0}
+        , prefetchDepth{0}
+        , writerThreadCount{OutputWriter::DEFAULT_THREAD_COUNT}
+        , syncOutput{false}
+        , gzipOutput{false}
+        , shardIndex{0}
+        , shardCount{1}
         , cdbPath{cdbInputPath}
         , outputPath{output}
-    {
-        if (std::filesystem::exists(output)) {
-            std::filesystem::remove_all(output);
-        }
-    }
+    {}
+
+    BuildManifest createBuildManifest() const;
+
+    std::filesystem::path getManifestPath() const;
+
+    bool isInShard(const CDBGeoCell &geoCell) const;
+
+    void combineTilesets(const BuildManifest &manifest);
+
+    bool isGeoCellUpToDate(const BuildManifestGeoCell &convertedGeoCell,
+                           const std::vector<BuildManifestFile> &inputs) const;
+
+    void convertGeoCell(CDB &cdb, const CDBGeoCell &geoCell);
+
+    void createMemoryBudget(CDB &cdb);
+
+    void enforceMemoryBudget();
+
+    void createOutputWriter();
 
     void flushTilesetCollection(const CDBGeoCell &geoCell,
                                 std::unordered_map<CDBGeoCell, TilesetCollection> &tilesetCollections,
@@ -65,7 +109,9 @@ struct Converter::Impl
 
     void generateElevationNormal(Mesh &simplifed);
 
-    Texture createImageryTexture(CDBImagery &imagery, const std::filesystem::path &tilesetDirectory) const;
+    static void expandHeightsToMesh(const Mesh &mesh, CDBTile &cdbTile);
+
+    Texture createImageryTexture(CDBImagery &imagery, const std::filesystem::path &tilesetDirectory);
 
     void addVectorToTilesetCollection(const CDBGeometryVectors &vectors,
                                       const std::filesystem::path &collectionOutputDirectory,
@@ -74,12 +120,28 @@ struct Converter::Impl
     std::vector<Texture> writeModeTextures(const std::vector<Texture> &modelTextures,
                                            const std::vector<osg::ref_ptr<osg::Image>> &images,
                                            const std::filesystem::path &textureSubDir,
-                                           const std::filesystem::path &gltfPath);
+                                           const std::filesystem::path &tilesetDirectory,
+                                           const std::filesystem::path &gltfSubDir);
+
+    std::vector<Texture> storeModelTextures(const std::vector<Texture> &modelTextures,
+                                            const std::vector<osg::ref_ptr<osg::Image>> &images);
+
+    static bool encodeImage(const osg::Image &image, const std::string &extension, std::string &encoded);
 
     void addGTModelToTilesetCollection(const CDBGTModels &model, const std::filesystem::path &outputDirectory);
 
     void addGSModelToTilesetCollection(const CDBGSModels &model, const std::filesystem::path &outputDirectory);
 
+    void writeTilesetFile(const std::filesystem::path &tilesetDirectory,
+                          const std::filesystem::path &file,
+                          std::string content);
+
+    void writeToArchive(const std::filesystem::path &tilesetDirectory,
+                        const std::filesystem::path &file,
+                        const std::string &content);
+
+    std::filesystem::path getContentURI(const CDBTile &cdbTile, const std::string &extension) const;
+
     void createB3DMForTileset(tinygltf::Model &model,
                               CDBTile cdbTile,
                               const CDBInstancesAttributes *instancesAttribs,
@@ -88,6 +150,8 @@ struct Converter::Impl
 
     size_t hashComponentSelectors(int CS_1, int CS_2);
 
+    static CDBDataset getDatasetFromName(const std::string &datasetName);
+
     std::filesystem::path getTilesetDirectory(int CS_1,
                                               int CS_2,
                                               const std::filesystem::path &collectionOutputDirectory);
@@ -105,15 +169,42 @@ struct Converter::Impl
     static const std::string HYDROGRAPHY_NETWORK_PATH;
     static const std::string GTMODEL_PATH;
     static const std::string GSMODEL_PATH;
+    static const std::string ARCHIVE_EXTENSION;
     static const std::unordered_set<std::string> DATASET_PATHS;
+    static const double ELEVATION_CACHE_BUDGET_SHARE;
+    static const double GTMODEL_CACHE_BUDGET_SHARE;
+    static const double GDAL_CACHE_BUDGET_SHARE;
+    static const double OUTPUT_BUFFER_BUDGET_SHARE;
 
     bool elevationNormal;
     bool elevationLOD;
     float elevationDecimateError;
     float elevationThresholdIndices;
+    bool dictionaryEncodeStrings;
+    bool incremental;
+    bool deduplicate;
+    bool archive;
+    bool implicitTiling;
+    bool orientedBoundingBox;
+    bool bilinearModelClamping;
+    size_t elevationCacheSize;
+    size_t memoryBudgetSize;
+    size_t prefetchDepth;
+    size_t writerThreadCount;
+    bool syncOutput;
+    bool gzipOutput;
+    size_t shardIndex;
+    size_t shardCount;
+    CDBFilter filter;
     std::filesystem::path cdbPath;
     std::filesystem::path outputPath;
+    std::filesystem::path statsFile;
+    std::unique_ptr<ContentStore> contentStore;
+    std::unique_ptr<MemoryBudget> memoryBudget;
+    std::unique_ptr<OutputWriter> outputWriter;
+    std::unordered_map<std::string, ArchiveWriter> archives;
     std::vector<std::filesystem::path> defaultDatasetToCombine;
+    std::vector<std::array<double, 2>> defaultDatasetHeights;
     std::vector<std::vector<std::string>> requestedDatasetToCombine;
     std::unordered_set<std::string> processedModelTextures;
     std::unordered_map<CDBTile, Texture> processedParentImagery;
@@ -134,6 +225,7 @@ const std::string Converter::Impl::POWERLINE_NETWORK_PATH = "PowerlineNetwork";
 const std::string Converter::Impl::HYDROGRAPHY_NETWORK_PATH = "HydrographyNetwork";
 const std::string Converter::Impl::GTMODEL_PATH = "GTModels";
 const std::string Converter::Impl::GSMODEL_PATH = "GSModels";
+const std::string Converter::Impl::ARCHIVE_EXTENSION = ".3tz";
 const std::unordered_set<std::string> Converter::Impl::DATASET_PATHS = {ELEVATIONS_PATH,
                                                                         ROAD_NETWORK_PATH,
                                                                         RAILROAD_NETWORK_PATH,
@@ -142,6 +234,12 @@ const std::unordered_set<std::string> Converter::Impl::DATASET_PATHS = {ELEVATIO
                                                                         GTMODEL_PATH,
                                                                         GSMODEL_PATH};
 
+// the rest of the budget is left to the meshes, textures and tilesets of the tiles being converted
+const double Converter::Impl::ELEVATION_CACHE_BUDGET_SHARE = 0.25;
+const double Converter::Impl::GTMODEL_CACHE_BUDGET_SHARE = 0.25;
+const double Converter::Impl::GDAL_CACHE_BUDGET_SHARE = 0.125;
+const double Converter::Impl::OUTPUT_BUFFER_BUDGET_SHARE = 0.125;
+
 void Converter::Impl::flushTilesetCollection(
     const CDBGeoCell &geoCell,
     std::unordered_map<CDBGeoCell, TilesetCollection> &tilesetCollections,
@@ -158,18 +256,60 @@ void Converter::Impl::flushTilesetCollection(
                 continue;
             }
 
+            ScopedStageTimer timer("writeTileset");
             auto tilesetDirectory = CSToPaths.at(CSTotileset.first);
-            auto tilesetJsonPath = tilesetDirectory
-                                   / (CDBTile::retrieveGeoCellDatasetFromTileName(*root) + ".json");
+            std::filesystem::path tilesetJsonPath;
+
+            // elevation tiles have no batch table, so their tilesets don't need the dictionary extension
+            bool usesStringDictionary = dictionaryEncodeStrings
+                                        && root->getDataset() != CDBDataset::Elevation;
+            auto writeTileset = [&](std::ostream &os) {
+                if (!implicitTiling) {
+                    writeToTilesetJson(tileset, replace, os, orientedBoundingBox, usesStringDictionary);
+                    return;
+                }
+
+                auto writeSubtree = [&](const std::filesystem::path &subtreePath,
+                                        const std::string &subtree) {
+                    writeTilesetFile(tilesetDirectory, subtreePath, subtree);
+                };
 
-            // write to tileset.json file
-            std::ofstream fs(tilesetJsonPath);
-            writeToTilesetJson(tileset, replace, fs);
+                writeToImplicitTilesetJson(tileset, replace, os, writeSubtree, usesStringDictionary);
+            };
+
+            if (archive) {
+                // the archive is complete once its tileset is written
+                std::ostringstream ss;
+                writeTileset(ss);
+                writeToArchive(tilesetDirectory, "tileset.json", ss.str());
+
+                auto archiveWriter = archives.find(tilesetDirectory.string());
+                tilesetJsonPath = archiveWriter->second.getPath();
+                archiveWriter->second.close();
+                archives.erase(archiveWriter);
+            } else {
+                tilesetJsonPath = tilesetDirectory
+                                  / (CDBTile::retrieveGeoCellDatasetFromTileName(*root) + ".json");
+
+                // write to tileset.json file
+                std::ostringstream ss;
+                writeTileset(ss);
+                outputWriter->write(tilesetJsonPath, ss.str());
+            }
 
             // add tileset json path to be combined later for multiple geocell
             // remove the output root path to become relative path
             tilesetJsonPath = std::filesystem::relative(tilesetJsonPath, outputPath);
             defaultDatasetToCombine.emplace_back(tilesetJsonPath);
+
+            // the root region covers the content heights of the whole tileset
+            const auto &rootRegion = root->getBoundRegion();
+            defaultDatasetHeights.push_back({rootRegion.getMinimumHeight(), rootRegion.getMaximumHeight()});
+        }
+
+        // close archives whose tileset ended up empty
+        for (const auto &CSToPath : CSToPaths) {
+            archives.erase(CSToPath.second.string());
         }
 
         tilesetCollections.erase(geoCell);
@@ -187,6 +327,13 @@ void Converter::Impl::addElevationToTilesetCollection(CDBElevation &elevation,
     CDBTileset *tileset;
     getTileset(cdbTile, collectionOutputDirectory, elevationTilesets, tileset, tilesetDirectory);
 
+    // the parent tile shows the area of this tile at half of the resolution
+    auto parentTile = CDBTile::createParentTile(cdbTile);
+    if (parentTile) {
+        parentTile->setGeometricError(static_cast<float>(elevation.computeRefinementError()));
+        tileset->insertTile(*parentTile);
+    }
+
     if (currentImagery) {
         Texture imageryTexture = createImageryTexture(*currentImagery, tilesetDirectory);
         addElevationToTileset(elevation, &imageryTexture, cdb, tilesetDirectory, *tileset);
@@ -246,11 +393,28 @@ void Converter::Impl::addElevationToTileset(CDBElevation &elevation,
     size_t targetIndexCount = static_cast<size_t>(static_cast<float>(mesh.indices.size())
                                                   * elevationThresholdIndices);
     float targetError = elevationDecimateError;
-    Mesh simplifed = elevation.createSimplifiedMesh(targetIndexCount, targetError);
+    double simplificationError = 0.0;
+    Mesh simplifed;
+    {
+        ScopedStageTimer timer("simplifyElevation");
+        simplifed = elevation.createSimplifiedMesh(targetIndexCount, targetError, simplificationError);
+    }
+
     if (simplifed.positionRTCs.empty()) {
         simplifed = mesh;
+        simplificationError = 0.0;
+    }
+
+    // children with the same elevation can still have finer imagery, which is about one grid spacing finer
+    double geometricError = simplificationError;
+    if (imagery) {
+        geometricError = glm::max(geometricError, elevation.computeGridSpacing());
     }
 
+    CDBTile contentTile = cdbTile;
+    contentTile.setGeometricError(static_cast<float>(geometricError));
+    expandHeightsToMesh(simplifed, contentTile);
+
     if (elevationNormal) {
         generateElevationNormal(simplifed);
     }
@@ -264,10 +428,10 @@ void Converter::Impl::addElevationToTileset(CDBElevation &elevation,
         simplifed.material = 0;
 
         tinygltf::Model gltf = createGltf(simplifed, &material, imagery);
-        createB3DMForTileset(gltf, cdbTile, nullptr, tilesetDirectory, tileset);
+        createB3DMForTileset(gltf, contentTile, nullptr, tilesetDirectory, tileset);
     } else {
         tinygltf::Model gltf = createGltf(simplifed, nullptr, nullptr);
-        createB3DMForTileset(gltf, cdbTile, nullptr, tilesetDirectory, tileset);
+        createB3DMForTileset(gltf, contentTile, nullptr, tilesetDirectory, tileset);
     }
 
     if (cdbTile.getLevel() < 0) {
@@ -277,6 +441,31 @@ void Converter::Impl::addElevationToTileset(CDBElevation &elevation,
     }
 }
 
+void Converter::Impl::expandHeightsToMesh(const Mesh &mesh, CDBTile &cdbTile)
+{
+    if (mesh.positions.empty()) {
+        return;
+    }
+
+    std::vector<std::optional<Core::Cartographic>> cartographics(mesh.positions.size());
+    Core::Ellipsoid::WGS84.cartesianToCartographic(mesh.positions.data(),
+                                                   mesh.positions.size(),
+                                                   cartographics.data());
+
+    double minimumHeight = std::numeric_limits<double>::max();
+    double maximumHeight = std::numeric_limits<double>::lowest();
+    for (const auto &cartographic : cartographics) {
+        if (cartographic) {
+            minimumHeight = glm::min(minimumHeight, cartographic->height);
+            maximumHeight = glm::max(maximumHeight, cartographic->height);
+        }
+    }
+
+    if (minimumHeight <= maximumHeight) {
+        cdbTile.expandHeights(minimumHeight, maximumHeight);
+    }
+}
+
 void Converter::Impl::fillMissingPositiveLODElevation(const CDBElevation &elevation,
                                                       const Texture *currentImagery,
                                                       const CDB &cdb,
@@ -446,26 +635,42 @@ void Converter::Impl::addSubRegionElevationToTileset(CDBElevation &subRegion,
 }
 
 Texture Converter::Impl::createImageryTexture(CDBImagery &imagery,
-                                              const std::filesystem::path &tilesetOutputDirectory) const
+                                              const std::filesystem::path &tilesetOutputDirectory)
 {
     static const std::filesystem::path MODEL_TEXTURE_SUB_DIR = "Textures";
 
+    ScopedStageTimer timer("encodeImagery");
     const auto &tile = imagery.getTile();
     auto textureRelativePath = MODEL_TEXTURE_SUB_DIR / (tile.getRelativePath().filename().string() + ".jpeg");
-    auto textureAbsolutePath = tilesetOutputDirectory / textureRelativePath;
-    auto textureDirectory = tilesetOutputDirectory / MODEL_TEXTURE_SUB_DIR;
-    if (!std::filesystem::exists(textureDirectory)) {
-        std::filesystem::create_directories(textureDirectory);
-    }
-
     auto driver = (GDALDriver *) GDALGetDriverByName("jpeg");
-    if (driver) {
-        GDALDatasetUniquePtr jpegDataset = GDALDatasetUniquePtr(driver->CreateCopy(
-            textureAbsolutePath.string().c_str(), &imagery.getData(), false, nullptr, nullptr, nullptr));
-    }
 
     Texture texture;
     texture.uri = textureRelativePath;
+
+    // encode in memory, so imagery duplicated across tiles is only written once, and the texture is handed
+    // to the writer as a whole
+    std::string memoryFile = "/vsimem/" + textureRelativePath.filename().string();
+    if (driver) {
+        GDALDatasetUniquePtr jpegDataset = GDALDatasetUniquePtr(
+            driver->CreateCopy(memoryFile.c_str(), &imagery.getData(), false, nullptr, nullptr, nullptr));
+    }
+
+    vsi_l_offset jpegSize = 0;
+    GByte *jpeg = VSIGetMemFileBuffer(memoryFile.c_str(), &jpegSize, false);
+    timer.addBytesOut(static_cast<uint64_t>(jpegSize));
+    if (jpeg && contentStore) {
+        auto blob = contentStore->store(jpeg, static_cast<size_t>(jpegSize), ".jpeg");
+        texture.uri = (std::filesystem::path("..") / blob).generic_string();
+    } else if (jpeg) {
+        writeTilesetFile(tilesetOutputDirectory,
+                         textureRelativePath,
+                         std::string(reinterpret_cast<const char *>(jpeg), static_cast<size_t>(jpegSize)));
+    }
+
+    if (jpeg) {
+        VSIUnlink(memoryFile.c_str());
+    }
+
     texture.magFilter = TextureFilter::LINEAR;
     texture.minFilter = TextureFilter::LINEAR_MIPMAP_NEAREST;
 
@@ -487,8 +692,11 @@ void Converter::Impl::addVectorToTilesetCollection(
     CDBTileset *tileset;
     getTileset(cdbTile, collectionOutputDirectory, tilesetCollections, tileset, tilesetDirectory);
 
+    CDBTile contentTile = cdbTile;
+    expandHeightsToMesh(mesh, contentTile);
+
     tinygltf::Model gltf = createGltf(mesh, nullptr, nullptr);
-    createB3DMForTileset(gltf, cdbTile, &vectors.getInstancesAttributes(), tilesetDirectory, *tileset);
+    createB3DMForTileset(gltf, contentTile, &vectors.getInstancesAttributes(), tilesetDirectory, *tileset);
 }
 
 void Converter::Impl::addGTModelToTilesetCollection(const CDBGTModels &model,
@@ -503,32 +711,53 @@ void Converter::Impl::addGTModelToTilesetCollection(const CDBGTModels &model,
     CDBTileset *tileset;
     getTileset(cdbTile, collectionOutputDirectory, GTModelTilesets, tileset, tilesetDirectory);
 
-    // create gltf file
-    auto gltfOutputDIr = tilesetDirectory / MODEL_GLTF_SUB_DIR;
-    std::filesystem::create_directories(gltfOutputDIr);
-
     std::map<std::string, std::vector<int>> instances;
     const auto &modelsAttribs = model.getModelsAttributes();
     const auto &instancesAttribs = modelsAttribs.getInstancesAttributes();
+    const auto &cartographicPositions = modelsAttribs.getCartographicPositions();
+    const auto &scales = modelsAttribs.getScales();
     for (size_t i = 0; i < instancesAttribs.getInstancesCount(); ++i) {
         std::string modelKey;
         auto model3D = model.locateModel3D(i, modelKey);
         if (model3D) {
-            if (GTModelsToGltf.find(modelKey) == GTModelsToGltf.end()) {
+            // the instance can be rotated in any way, so its heights are bounded by the farthest corner of
+            // the model bounding boxes from the model origin
+            double modelRadius = 0.0;
+            for (const auto &mesh : model3D->getMeshes()) {
+                if (mesh.aabb) {
+                    glm::dvec3 farthestCorner = glm::max(glm::abs(mesh.aabb->min), glm::abs(mesh.aabb->max));
+                    modelRadius = glm::max(modelRadius, glm::length(farthestCorner));
+                }
+            }
+
+            const auto &scale = scales[i];
+            double maxScale = static_cast<double>(glm::max(scale.x, glm::max(scale.y, scale.z)));
+            double instanceRadius = modelRadius * maxScale;
+            double instanceHeight = cartographicPositions[i].height;
+            cdbTile.expandHeights(instanceHeight - instanceRadius, instanceHeight + instanceRadius);
+
+            // the glb is referred to relative to the tileset, so every tileset needs its own copy
+            std::string gltfKey = (tilesetDirectory / modelKey).string();
+            if (GTModelsToGltf.find(gltfKey) == GTModelsToGltf.end()) {
                 // write textures to files
                 auto textures = writeModeTextures(model3D->getTextures(),
                                                   model3D->getImages(),
                                                   MODEL_TEXTURE_SUB_DIR,
-                                                  gltfOutputDIr);
+                                                  tilesetDirectory,
+                                                  MODEL_GLTF_SUB_DIR);
 
                 // create gltf for the instance
                 tinygltf::Model gltf = createGltf(model3D->getMeshes(), model3D->getMaterials(), textures);
 
                 // write to glb
+                ScopedStageTimer gltfTimer("writeModelGltf");
                 tinygltf::TinyGLTF loader;
                 std::filesystem::path modelGltfURI = MODEL_GLTF_SUB_DIR / (modelKey + ".glb");
-                loader.WriteGltfSceneToFile(&gltf, tilesetDirectory / modelGltfURI, false, false, false, true);
-                GTModelsToGltf.insert({modelKey, modelGltfURI});
+                std::ostringstream ss;
+                loader.WriteGltfSceneToStream(&gltf, ss, false, true);
+                writeTilesetFile(tilesetDirectory, modelGltfURI, ss.str());
+
+                GTModelsToGltf.insert({gltfKey, modelGltfURI});
             }
 
             auto &instance = instances[modelKey];
@@ -537,18 +766,19 @@ void Converter::Impl::addGTModelToTilesetCollection(const CDBGTModels &model,
     }
 
     // write i3dm to cmpt
-    std::string cdbTileFilename = cdbTile.getRelativePath().filename().string();
-    std::filesystem::path cmpt = cdbTileFilename + std::string(".cmpt");
-    std::filesystem::path cmptFullPath = tilesetDirectory / cmpt;
-    std::ofstream fs(cmptFullPath, std::ios::binary);
-    auto instance = instances.begin();
-    writeToCMPT(static_cast<uint32_t>(instances.size()), fs, [&](std::ofstream &os, size_t) {
-        const auto &GltfURI = GTModelsToGltf[instance->first];
-        const auto &instanceIndices = instance->second;
-        size_t totalWrite = writeToI3DM(GltfURI, modelsAttribs, instanceIndices, os);
-        instance = std::next(instance);
-        return totalWrite;
-    });
+    ScopedStageTimer timer("writeCmpt");
+    std::filesystem::path cmpt = getContentURI(cdbTile, ".cmpt");
+    std::vector<TileBuffer> i3dms;
+    i3dms.reserve(instances.size());
+    for (const auto &instance : instances) {
+        const auto &GltfURI = GTModelsToGltf[(tilesetDirectory / instance.first).string()];
+        i3dms.emplace_back(createI3DM(GltfURI, modelsAttribs, instance.second, dictionaryEncodeStrings));
+    }
+
+    TileBuffer cmptTile = createCMPT(std::move(i3dms));
+    timer.addBytesOut(cmptTile.getByteLength());
+    ConversionStats::getInstance().addCounter("tiles", 1);
+    writeTilesetFile(tilesetDirectory, cmpt, cmptTile.toString());
 
     // add it to tileset
     cdbTile.setCustomContentURI(cmpt);
@@ -567,32 +797,43 @@ void Converter::Impl::addGSModelToTilesetCollection(const CDBGSModels &model,
     CDBTileset *tileset;
     getTileset(cdbTile, collectionOutputDirectory, GSModelTilesets, tileset, tilesetDirectory);
 
-    auto textures = writeModeTextures(model3D.getTextures(),
-                                      model3D.getImages(),
-                                      MODEL_TEXTURE_SUB_DIR,
-                                      tilesetDirectory);
+    std::vector<Texture> textures;
+    if (contentStore) {
+        textures = storeModelTextures(model3D.getTextures(), model3D.getImages());
+    } else {
+        textures = writeModeTextures(model3D.getTextures(),
+                                     model3D.getImages(),
+                                     MODEL_TEXTURE_SUB_DIR,
+                                     tilesetDirectory,
+                                     "");
+    }
+
+    CDBTile contentTile = cdbTile;
+    for (const auto &mesh : model3D.getMeshes()) {
+        expandHeightsToMesh(mesh, contentTile);
+    }
 
     auto gltf = createGltf(model3D.getMeshes(), model3D.getMaterials(), textures);
-    createB3DMForTileset(gltf, cdbTile, &model.getInstancesAttributes(), tilesetDirectory, *tileset);
+    createB3DMForTileset(gltf, contentTile, &model.getInstancesAttributes(), tilesetDirectory, *tileset);
 }
 
 std::vector<Texture> Converter::Impl::writeModeTextures(const std::vector<Texture> &modelTextures,
                                                         const std::vector<osg::ref_ptr<osg::Image>> &images,
                                                         const std::filesystem::path &textureSubDir,
-                                                        const std::filesystem::path &gltfPath)
+                                                        const std::filesystem::path &tilesetDirectory,
+                                                        const std::filesystem::path &gltfSubDir)
 {
-    auto textureDirectory = gltfPath / textureSubDir;
-    if (!std::filesystem::exists(textureDirectory)) {
-        std::filesystem::create_directories(textureDirectory);
-    }
-
+    auto gltfPath = tilesetDirectory / gltfSubDir;
     auto textures = modelTextures;
     for (size_t i = 0; i < modelTextures.size(); ++i) {
         auto textureRelativePath = textureSubDir / modelTextures[i].uri;
         auto textureAbsolutePath = gltfPath / textureSubDir / modelTextures[i].uri;
 
-        if (processedModelTextures.find(textureAbsolutePath) == processedModelTextures.end()) {
-            osgDB::writeImageFile(*images[i], textureAbsolutePath.string(), nullptr);
+        if (processedModelTextures.insert(textureAbsolutePath).second) {
+            std::string image;
+            if (encodeImage(*images[i], textureAbsolutePath.extension().string(), image)) {
+                writeTilesetFile(tilesetDirectory, gltfSubDir / textureRelativePath, std::move(image));
+            }
         }
 
         textures[i].uri = textureRelativePath.string();
@@ -601,25 +842,105 @@ std::vector<Texture> Converter::Impl::writeModeTextures(const std::vector<Textur
     return textures;
 }
 
+std::vector<Texture> Converter::Impl::storeModelTextures(const std::vector<Texture> &modelTextures,
+                                                         const std::vector<osg::ref_ptr<osg::Image>> &images)
+{
+    auto textures = modelTextures;
+    for (size_t i = 0; i < modelTextures.size(); ++i) {
+        auto extension = std::filesystem::path(modelTextures[i].uri).extension().string();
+        std::string image;
+        if (!encodeImage(*images[i], extension, image)) {
+            continue;
+        }
+
+        auto blob = contentStore->store(image.data(), image.size(), extension);
+        textures[i].uri = (std::filesystem::path("..") / blob).generic_string();
+    }
+
+    return textures;
+}
+
+bool Converter::Impl::encodeImage(const osg::Image &image, const std::string &extension, std::string &encoded)
+{
+    if (extension.empty()) {
+        return false;
+    }
+
+    auto writer = osgDB::Registry::instance()->getReaderWriterForExtension(extension.substr(1));
+    if (!writer) {
+        return false;
+    }
+
+    std::ostringstream ss;
+    if (!writer->writeImage(image, ss).success()) {
+        return false;
+    }
+
+    encoded = ss.str();
+    return true;
+}
+
+void Converter::Impl::writeTilesetFile(const std::filesystem::path &tilesetDirectory,
+                                       const std::filesystem::path &file,
+                                       std::string content)
+{
+    if (archive) {
+        writeToArchive(tilesetDirectory, file, content);
+        return;
+    }
+
+    outputWriter->write(tilesetDirectory / file, std::move(content));
+}
+
+void Converter::Impl::writeToArchive(const std::filesystem::path &tilesetDirectory,
+                                     const std::filesystem::path &file,
+                                     const std::string &content)
+{
+    auto archiveWriter = archives.try_emplace(tilesetDirectory.string(),
+                                              tilesetDirectory.string() + ARCHIVE_EXTENSION);
+    archiveWriter.first->second.addFile(file.generic_string(), content.data(), content.size());
+}
+
 void Converter::Impl::createB3DMForTileset(tinygltf::Model &gltf,
                                            CDBTile cdbTile,
                                            const CDBInstancesAttributes *instancesAttribs,
                                            const std::filesystem::path &outputDirectory,
                                            CDBTileset &tileset)
 {
-    // create b3dm file
-    std::string cdbTileFilename = cdbTile.getRelativePath().filename().string();
-    std::filesystem::path b3dm = cdbTileFilename + std::string(".b3dm");
-    std::filesystem::path b3dmFullPath = outputDirectory / b3dm;
+    ScopedStageTimer timer("writeB3dm");
+    ConversionStats::getInstance().addCounter("tiles", 1);
+    if (contentStore) {
+        // identical tiles share one blob, which the tile points to relative to the tileset
+        std::string b3dmContent = createB3DM(&gltf, instancesAttribs, dictionaryEncodeStrings).toString();
+        timer.addBytesOut(b3dmContent.size());
+        auto blob = contentStore->store(b3dmContent.data(), b3dmContent.size(), ".b3dm");
+        auto b3dm = (contentStore->getDirectory() / blob).lexically_relative(outputDirectory);
+        cdbTile.setCustomContentURI(b3dm.generic_string());
+        tileset.insertTile(cdbTile);
+        return;
+    }
 
-    // write to b3dm
-    std::ofstream fs(b3dmFullPath, std::ios::binary);
-    writeToB3DM(&gltf, instancesAttribs, fs);
+    // create b3dm file
+    std::filesystem::path b3dm = getContentURI(cdbTile, ".b3dm");
+    TileBuffer b3dmTile = createB3DM(&gltf, instancesAttribs, dictionaryEncodeStrings);
+    timer.addBytesOut(b3dmTile.getByteLength());
+    writeTilesetFile(outputDirectory, b3dm, b3dmTile.toString());
     cdbTile.setCustomContentURI(b3dm);
 
     tileset.insertTile(cdbTile);
 }
 
+std::filesystem::path Converter::Impl::getContentURI(const CDBTile &cdbTile,
+                                                     const std::string &extension) const
+{
+    // implicit tiling finds the content of a tile from its level and position
+    if (implicitTiling && cdbTile.getLevel() >= 0) {
+        return getImplicitTileContentURI(cdbTile, extension);
+    }
+
+    return cdbTile.getRelativePath().filename().string() + extension;
+}
+
 size_t Converter::Impl::hashComponentSelectors(int CS_1, int CS_2)
 {
     size_t CSHash = 0;
@@ -650,7 +971,6 @@ void Converter::Impl::getTileset(const CDBTile &cdbTile,
     auto CSPathIt = CSToPaths.find(CSHash);
     if (CSPathIt == CSToPaths.end()) {
         path = getTilesetDirectory(cdbTile.getCS_1(), cdbTile.getCS_2(), collectionOutputDirectory);
-        std::filesystem::create_directories(path);
         CSToPaths.insert({CSHash, path});
     } else {
         path = CSPathIt->second;
@@ -659,6 +979,321 @@ void Converter::Impl::getTileset(const CDBTile &cdbTile,
     tileset = &tilesetCollection.CSToTilesets[CSHash];
 }
 
+BuildManifest Converter::Impl::createBuildManifest() const
+{
+    BuildManifest manifest("elevationNormal=" + std::to_string(elevationNormal) + ";elevationLOD="
+                           + std::to_string(elevationLOD) + ";elevationDecimateError="
+                           + std::to_string(elevationDecimateError) + ";elevationThresholdIndices="
+                           + std::to_string(elevationThresholdIndices)
+                           + ";dictionaryEncodeStrings=" + std::to_string(dictionaryEncodeStrings)
+                           + ";deduplicate=" + std::to_string(deduplicate)
+                           + ";archive=" + std::to_string(archive)
+                           + ";gzip=" + std::to_string(gzipOutput)
+                           + ";implicitTiling=" + std::to_string(implicitTiling)
+                           + ";orientedBoundingBox=" + std::to_string(orientedBoundingBox)
+                           + ";bilinearModelClamping=" + std::to_string(bilinearModelClamping)
+                           + filter.getContentSettings());
+    // shards share the output directory, each of them only replaces the output of its own GeoCells
+    if (!incremental) {
+        if (shardCount == 1 && std::filesystem::exists(outputPath)) {
+            std::filesystem::remove_all(outputPath);
+        }
+
+        return manifest;
+    }
+
+    // GTModels and metadata are shared by every GeoCell, so a change to them invalidates the whole output
+    auto previousManifest = BuildManifest::createFromFile(getManifestPath());
+    const auto *previousSharedInputs = previousManifest ? &previousManifest->getSharedInputs() : nullptr;
+    auto sharedInputs = BuildManifest::collectInputFiles(cdbPath,
+                                                         cdbPath / CDB::GTModel,
+                                                         previousSharedInputs);
+    auto metadataInputs = BuildManifest::collectInputFiles(cdbPath,
+                                                           cdbPath / CDB::METADATA,
+                                                           previousSharedInputs);
+    sharedInputs.insert(sharedInputs.end(), metadataInputs.begin(), metadataInputs.end());
+
+    if (previousManifest && previousManifest->getSettings() == manifest.getSettings()
+        && previousManifest->getSharedInputs() == sharedInputs) {
+        return std::move(*previousManifest);
+    }
+
+    if (shardCount == 1 && std::filesystem::exists(outputPath)) {
+        std::filesystem::remove_all(outputPath);
+    }
+
+    manifest.setSharedInputs(std::move(sharedInputs));
+    return manifest;
+}
+
+std::filesystem::path Converter::Impl::getManifestPath() const
+{
+    if (shardCount == 1) {
+        return outputPath / BuildManifest::FILENAME;
+    }
+
+    return outputPath / BuildManifest::getShardFilename(shardIndex, shardCount);
+}
+
+bool Converter::Impl::isInShard(const CDBGeoCell &geoCell) const
+{
+    // hash the coordinates instead of counting GeoCells in traversal order, so every process agrees on the
+    // shard of a GeoCell without listing the whole CDB, and neighbouring GeoCells spread over the shards
+    int32_t coordinates[] = {geoCell.getLatitude(), geoCell.getLongitude()};
+    return computeContentHash(coordinates, sizeof(coordinates)) % shardCount == shardIndex;
+}
+
+void Converter::Impl::combineTilesets(const BuildManifest &manifest)
+{
+    std::map<std::string, std::vector<std::filesystem::path>> combinedTilesets;
+    std::map<std::string, std::vector<Core::BoundingRegion>> combinedTilesetsRegions;
+    std::map<std::string, Core::BoundingRegion> aggregateTilesetsRegion;
+
+    // get the converted dataset in each geocell to be combine. The manifest records the tilesets and their
+    // heights, so the converted tiles are not read again
+    for (const auto &convertedGeoCell : manifest.getGeoCells()) {
+        auto geoCell = CDBGeoCell::parseFromRelativePath(convertedGeoCell.first);
+        if (!geoCell) {
+            throw std::runtime_error("Build manifest has an invalid GeoCell "
+                                     + convertedGeoCell.first.string());
+        }
+
+        Core::GlobeRectangle geoCellRectangle = CDBTile::calcBoundRegion(*geoCell, -10, 0, 0).getRectangle();
+        const auto &tilesets = convertedGeoCell.second.tilesets;
+        const auto &heights = convertedGeoCell.second.tilesetHeights;
+        for (size_t i = 0; i < tilesets.size(); ++i) {
+            const auto &tilesetJsonPath = tilesets[i];
+            const auto &tilesetHeights = heights[i];
+            Core::BoundingRegion tilesetRegion(geoCellRectangle, tilesetHeights[0], tilesetHeights[1]);
+
+            // an archive takes the place of its tileset directory
+            auto tilesetDirectory = tilesetJsonPath.extension() == ARCHIVE_EXTENSION
+                                        ? tilesetJsonPath.parent_path() / tilesetJsonPath.stem()
+                                        : tilesetJsonPath.parent_path();
+            auto componentSelectors = tilesetDirectory.filename().string();
+            auto dataset = tilesetDirectory.parent_path().filename().string();
+            auto combinedTilesetName = dataset + "_" + componentSelectors;
+
+            combinedTilesets[combinedTilesetName].emplace_back(tilesetJsonPath);
+            combinedTilesetsRegions[combinedTilesetName].emplace_back(tilesetRegion);
+            auto tilesetAggregateRegion = aggregateTilesetsRegion.find(combinedTilesetName);
+            if (tilesetAggregateRegion == aggregateTilesetsRegion.end()) {
+                aggregateTilesetsRegion.insert({combinedTilesetName, tilesetRegion});
+            } else {
+                tilesetAggregateRegion->second = tilesetAggregateRegion->second.computeUnion(tilesetRegion);
+            }
+        }
+    }
+
+    // combine all the default tileset in each geocell into a global one
+    for (auto tileset : combinedTilesets) {
+        std::ostringstream ss;
+        combineTilesetJson(tileset.second, combinedTilesetsRegions[tileset.first], ss);
+        outputWriter->write(outputPath / (tileset.first + ".json"), ss.str());
+    }
+
+    // combine the requested tilesets
+    for (const auto &tilesets : requestedDatasetToCombine) {
+        std::string combinedTilesetName;
+        if (requestedDatasetToCombine.size() > 1) {
+            for (const auto &tileset : tilesets) {
+                combinedTilesetName += tileset;
+            }
+            combinedTilesetName += ".json";
+        } else {
+            combinedTilesetName = "tileset.json";
+        }
+
+        std::vector<std::filesystem::path> existTilesets;
+        std::vector<Core::BoundingRegion> regions;
+        regions.reserve(tilesets.size());
+        for (const auto &tileset : tilesets) {
+            auto tilesetRegion = aggregateTilesetsRegion.find(tileset);
+            if (tilesetRegion != aggregateTilesetsRegion.end()) {
+                existTilesets.emplace_back(tilesetRegion->first + ".json");
+                regions.emplace_back(tilesetRegion->second);
+            }
+        }
+
+        std::ostringstream ss;
+        combineTilesetJson(existTilesets, regions, ss);
+        outputWriter->write(outputPath / combinedTilesetName, ss.str());
+    }
+}
+
+CDBDataset Converter::Impl::getDatasetFromName(const std::string &datasetName)
+{
+    static const std::unordered_map<std::string, CDBDataset> DATASETS
+        = {{ELEVATIONS_PATH, CDBDataset::Elevation},
+           {ROAD_NETWORK_PATH, CDBDataset::RoadNetwork},
+           {RAILROAD_NETWORK_PATH, CDBDataset::RailRoadNetwork},
+           {POWERLINE_NETWORK_PATH, CDBDataset::PowerlineNetwork},
+           {HYDROGRAPHY_NETWORK_PATH, CDBDataset::HydrographyNetwork},
+           {GTMODEL_PATH, CDBDataset::GTFeature},
+           {GSMODEL_PATH, CDBDataset::GSFeature}};
+
+    auto dataset = DATASETS.find(datasetName);
+    if (dataset == DATASETS.end()) {
+        std::string errorMessage = "Unrecognize dataset: " + datasetName + "\n";
+        errorMessage += "Correct dataset names are: \n";
+        for (const auto &requiredDataset : DATASET_PATHS) {
+            errorMessage += requiredDataset + "\n";
+        }
+
+        throw std::runtime_error(errorMessage);
+    }
+
+    return dataset->second;
+}
+
+bool Converter::Impl::isGeoCellUpToDate(const BuildManifestGeoCell &convertedGeoCell,
+                                        const std::vector<BuildManifestFile> &inputs) const
+{
+    if (convertedGeoCell.inputs != inputs) {
+        return false;
+    }
+
+    for (const auto &tileset : convertedGeoCell.tilesets) {
+        if (!std::filesystem::exists(outputPath / tileset)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void Converter::Impl::convertGeoCell(CDB &cdb, const CDBGeoCell &geoCell)
+{
+    // create directories for converted GeoCell
+    std::filesystem::path geoCellRelativePath = geoCell.getRelativePath();
+    std::filesystem::path geoCellAbsolutePath = outputPath / geoCellRelativePath;
+    std::filesystem::path elevationDir = geoCellAbsolutePath / ELEVATIONS_PATH;
+    std::filesystem::path GTModelDir = geoCellAbsolutePath / GTMODEL_PATH;
+    std::filesystem::path GSModelDir = geoCellAbsolutePath / GSMODEL_PATH;
+    std::filesystem::path roadNetworkDir = geoCellAbsolutePath / ROAD_NETWORK_PATH;
+    std::filesystem::path railRoadNetworkDir = geoCellAbsolutePath / RAILROAD_NETWORK_PATH;
+    std::filesystem::path powerlineNetworkDir = geoCellAbsolutePath / POWERLINE_NETWORK_PATH;
+    std::filesystem::path hydrographyNetworkDir = geoCellAbsolutePath / HYDROGRAPHY_NETWORK_PATH;
+
+    // the time of each dataset is recorded under its own scope, so the stages it runs are reported with it
+    auto &stats = ConversionStats::getInstance();
+    std::optional<ScopedStageTimer> datasetTimer;
+    auto beginDataset = [&](const std::string &dataset) {
+        datasetTimer.reset();
+        enforceMemoryBudget();
+        stats.setScope(geoCellRelativePath.generic_string(), dataset);
+        datasetTimer.emplace("total");
+    };
+
+    // process elevation
+    beginDataset(ELEVATIONS_PATH);
+    cdb.forEachElevationTile(geoCell, [&](CDBElevation elevation) {
+        addElevationToTilesetCollection(elevation, cdb, elevationDir);
+        enforceMemoryBudget();
+    });
+    flushTilesetCollection(geoCell, elevationTilesets);
+    std::unordered_map<CDBTile, Texture>().swap(processedParentImagery);
+
+    // process road network
+    beginDataset(ROAD_NETWORK_PATH);
+    cdb.forEachRoadNetworkTile(geoCell, [&](const CDBGeometryVectors &roadNetwork) {
+        addVectorToTilesetCollection(roadNetwork, roadNetworkDir, roadNetworkTilesets);
+    });
+    flushTilesetCollection(geoCell, roadNetworkTilesets);
+
+    // process railroad network
+    beginDataset(RAILROAD_NETWORK_PATH);
+    cdb.forEachRailRoadNetworkTile(geoCell, [&](const CDBGeometryVectors &railRoadNetwork) {
+        addVectorToTilesetCollection(railRoadNetwork, railRoadNetworkDir, railRoadNetworkTilesets);
+    });
+    flushTilesetCollection(geoCell, railRoadNetworkTilesets);
+
+    // process powerline network
+    beginDataset(POWERLINE_NETWORK_PATH);
+    cdb.forEachPowerlineNetworkTile(geoCell, [&](const CDBGeometryVectors &powerlineNetwork) {
+        addVectorToTilesetCollection(powerlineNetwork, powerlineNetworkDir, powerlineNetworkTilesets);
+    });
+    flushTilesetCollection(geoCell, powerlineNetworkTilesets);
+
+    // process hydrography network
+    beginDataset(HYDROGRAPHY_NETWORK_PATH);
+    cdb.forEachHydrographyNetworkTile(geoCell, [&](const CDBGeometryVectors &hydrographyNetwork) {
+        addVectorToTilesetCollection(hydrographyNetwork, hydrographyNetworkDir, hydrographyNetworkTilesets);
+    });
+    flushTilesetCollection(geoCell, hydrographyNetworkTilesets);
+
+    // process GTModel
+    beginDataset(GTMODEL_PATH);
+    cdb.forEachGTModelTile(geoCell, [&](CDBGTModels GTModel) {
+        addGTModelToTilesetCollection(GTModel, GTModelDir);
+        enforceMemoryBudget();
+    });
+    flushTilesetCollection(geoCell, GTModelTilesets);
+
+    // process GSModel
+    beginDataset(GSMODEL_PATH);
+    cdb.forEachGSModelTile(geoCell, [&](CDBGSModels GSModel) {
+        addGSModelToTilesetCollection(GSModel, GSModelDir);
+        enforceMemoryBudget();
+    });
+    flushTilesetCollection(geoCell, GSModelTilesets, false);
+    datasetTimer.reset();
+    stats.setScope("", "");
+    enforceMemoryBudget();
+}
+
+void Converter::Impl::createMemoryBudget(CDB &cdb)
+{
+    // caches are sized to their share of the budget up front, and shrunk further whenever the process goes
+    // over the budget
+    memoryBudget = std::make_unique<MemoryBudget>(memoryBudgetSize);
+    ElevationSampler &elevationSampler = cdb.getElevationSampler();
+    CDBGTModelCache &GTModelCache = cdb.getGTModelCache();
+    elevationSampler.setCacheSizeInBytes(
+        std::min(elevationCacheSize, memoryBudget->getShare(ELEVATION_CACHE_BUDGET_SHARE)));
+    GTModelCache.setCacheSizeInBytes(memoryBudget->getShare(GTMODEL_CACHE_BUDGET_SHARE));
+    if (memoryBudget->isLimited()) {
+        GDALSetCacheMax64(static_cast<GIntBig>(memoryBudget->getShare(GDAL_CACHE_BUDGET_SHARE)));
+    }
+
+    memoryBudget->addConsumer(
+        "elevationCache",
+        [&elevationSampler]() { return elevationSampler.getCachedBytes(); },
+        [&elevationSampler](size_t targetBytes) { elevationSampler.trim(targetBytes); });
+    memoryBudget->addConsumer(
+        "GTModelCache",
+        [&GTModelCache]() { return GTModelCache.getCachedBytes(); },
+        [&GTModelCache](size_t targetBytes) { GTModelCache.trim(targetBytes); });
+}
+
+void Converter::Impl::enforceMemoryBudget()
+{
+    // only between tiles, when no model or grid handed out by the caches is still in use
+    if (memoryBudget) {
+        memoryBudget->enforce();
+    }
+}
+
+void Converter::Impl::createOutputWriter()
+{
+    // files waiting to be written take their share of the budget, and are written out under pressure
+    size_t maxPendingBytes = OutputWriter::DEFAULT_MAX_PENDING_BYTES;
+    if (memoryBudget) {
+        maxPendingBytes = std::min(maxPendingBytes, memoryBudget->getShare(OUTPUT_BUFFER_BUDGET_SHARE));
+    }
+
+    outputWriter = std::make_unique<OutputWriter>(writerThreadCount, maxPendingBytes);
+    outputWriter->setSyncFiles(syncOutput);
+    outputWriter->setGzipFiles(gzipOutput);
+    if (memoryBudget) {
+        OutputWriter &writer = *outputWriter;
+        memoryBudget->addConsumer(
+            "outputWriter",
+            [&writer]() { return writer.getPendingBytes(); },
+            [&writer](size_t targetBytes) { writer.drain(targetBytes); });
+    }
+}
+
 Converter::Converter(const std::filesystem::path &CDBPath, const std::filesystem::path &outputPath)
 {
     m_impl = std::make_unique<Impl>(CDBPath, outputPath);
@@ -683,16 +1318,7 @@ void Converter::combineDataset(const std::vector<std::string> &datasets)
                                      "Selector 1}_{Component Selector 2}");
         }
 
-        auto datasetName = dataset.substr(0, datasetNamePos);
-        if (m_impl->DATASET_PATHS.find(datasetName) == m_impl->DATASET_PATHS.end()) {
-            std::string errorMessage = "Unrecognize dataset: " + datasetName + "\n";
-            errorMessage += "Correct dataset names are: \n";
-            for (const auto &requiredDataset : m_impl->DATASET_PATHS) {
-                errorMessage += requiredDataset + "\n";
-            }
-
-            throw std::runtime_error(errorMessage);
-        }
+        Impl::getDatasetFromName(dataset.substr(0, datasetNamePos));
 
         auto CS_1Pos = dataset.find("_", datasetNamePos + 1);
         if (CS_1Pos == std::string::npos) {
@@ -732,125 +1358,382 @@ void Converter::setElevationDecimateError(float elevationDecimateError)
     m_impl->elevationDecimateError = elevationDecimateError;
 }
 
+void Converter::setDictionaryEncodeStrings(bool dictionaryEncodeStrings)
+{
+    m_impl->dictionaryEncodeStrings = dictionaryEncodeStrings;
+}
+
+void Converter::setIncremental(bool incremental)
+{
+    m_impl->incremental = incremental;
+}
+
+void Converter::setDeduplicate(bool deduplicate)
+{
+    m_impl->deduplicate = deduplicate;
+}
+
+void Converter::setArchive(bool archive)
+{
+    m_impl->archive = archive;
+}
+
+void Converter::setImplicitTiling(bool implicitTiling)
+{
+    m_impl->implicitTiling = implicitTiling;
+}
+
+void Converter::setOrientedBoundingBox(bool orientedBoundingBox)
+{
+    m_impl->orientedBoundingBox = orientedBoundingBox;
+}
+
+void Converter::setBilinearModelClamping(bool bilinearModelClamping)
+{
+    m_impl->bilinearModelClamping = bilinearModelClamping;
+}
+
+void Converter::setElevationCacheSize(size_t elevationCacheSize)
+{
+    m_impl->elevationCacheSize = elevationCacheSize;
+}
+
+void Converter::setMemoryBudget(size_t memoryBudget)
+{
+    m_impl->memoryBudgetSize = memoryBudget;
+}
+
+void Converter::setPrefetchDepth(size_t prefetchDepth)
+{
+    m_impl->prefetchDepth = prefetchDepth;
+}
+
+void Converter::setWriterThreads(size_t writerThreadCount)
+{
+    m_impl->writerThreadCount = writerThreadCount;
+}
+
+void Converter::setSyncOutput(bool syncOutput)
+{
+    m_impl->syncOutput = syncOutput;
+}
+
+void Converter::setGzipOutput(bool gzipOutput)
+{
+    m_impl->gzipOutput = gzipOutput;
+}
+
+void Converter::setShard(size_t shardIndex, size_t shardCount)
+{
+    if (shardCount == 0 || shardIndex >= shardCount) {
+        throw std::runtime_error("Shard " + std::to_string(shardIndex) + " of " + std::to_string(shardCount)
+                                 + " does not exist. Shards are numbered from 0 to the shard count - 1");
+    }
+
+    m_impl->shardIndex = shardIndex;
+    m_impl->shardCount = shardCount;
+}
+
+void Converter::setRegion(double west, double south, double east, double north)
+{
+    m_impl->filter.setRectangle(west, south, east, north);
+}
+
+void Converter::addGeoCell(const std::string &geoCellName)
+{
+    auto geoCell = CDBGeoCell::parseFromName(geoCellName);
+    if (!geoCell) {
+        throw std::runtime_error("Wrong GeoCell format: " + geoCellName
+                                 + ". Required format should be: {N|S}{Latitude}{E|W}{Longitude}, "
+                                   "e.g. N32W119");
+    }
+
+    m_impl->filter.addGeoCell(*geoCell);
+}
+
+void Converter::setDatasets(const std::vector<std::string> &datasets)
+{
+    for (const auto &dataset : datasets) {
+        m_impl->filter.addDataset(Impl::getDatasetFromName(dataset));
+    }
+}
+
+void Converter::setLevelRange(int minLevel, int maxLevel)
+{
+    m_impl->filter.setLevelRange(minLevel, maxLevel);
+}
+
+void Converter::setLevelRange(const std::string &dataset, int minLevel, int maxLevel)
+{
+    m_impl->filter.setLevelRange(Impl::getDatasetFromName(dataset), minLevel, maxLevel);
+}
+
+void Converter::setStatsFile(const std::filesystem::path &statsFile)
+{
+    m_impl->statsFile = statsFile;
+}
+
 void Converter::convert()
 {
+    if (m_impl->archive && m_impl->deduplicate) {
+        throw std::runtime_error("Deduplicated output is shared between tilesets and cannot be archived");
+    }
+
+    if (m_impl->implicitTiling && m_impl->deduplicate) {
+        throw std::runtime_error(
+            "Deduplicated output is named by its content, which implicit tiling cannot refer to");
+    }
+
+    auto &stats = ConversionStats::getInstance();
+    if (!m_impl->statsFile.empty()) {
+        stats.setEnabled(true);
+    }
+
     CDB cdb(m_impl->cdbPath);
-    std::map<std::string, std::vector<std::filesystem::path>> combinedTilesets;
-    std::map<std::string, std::vector<Core::BoundingRegion>> combinedTilesetsRegions;
-    std::map<std::string, Core::BoundingRegion> aggregateTilesetsRegion;
+    cdb.setFilter(m_impl->filter);
+    cdb.setPrefetchDepth(m_impl->prefetchDepth);
+    const CDBCatalog &catalog = cdb.getCatalog();
+    std::cout << "Scanned " << catalog.getFileCount() << " files in " << catalog.getDirectoryCount()
+              << " directories of the CDB in " << catalog.getScanSeconds() << " seconds\n";
+    ElevationSampler &elevationSampler = cdb.getElevationSampler();
+    elevationSampler.setBilinear(m_impl->bilinearModelClamping);
+    m_impl->createMemoryBudget(cdb);
+    m_impl->createOutputWriter();
+    BuildManifest manifest = m_impl->createBuildManifest();
+    std::filesystem::path manifestPath = m_impl->getManifestPath();
+    std::set<std::filesystem::path> visitedGeoCells;
+    if (m_impl->incremental || m_impl->shardCount > 1) {
+        std::filesystem::create_directories(m_impl->outputPath);
+    }
+
+    if (m_impl->deduplicate) {
+        auto contentStoreDirectory = m_impl->outputPath / ContentStore::DIRECTORY_NAME;
+        m_impl->contentStore = std::make_unique<ContentStore>(contentStoreDirectory, *m_impl->outputWriter);
+    }
 
     cdb.forEachGeoCell([&](CDBGeoCell geoCell) {
-        // create directories for converted GeoCell
+        if (!m_impl->isInShard(geoCell)) {
+            return;
+        }
+
         std::filesystem::path geoCellRelativePath = geoCell.getRelativePath();
-        std::filesystem::path geoCellAbsolutePath = m_impl->outputPath / geoCellRelativePath;
-        std::filesystem::path elevationDir = geoCellAbsolutePath / Impl::ELEVATIONS_PATH;
-        std::filesystem::path GTModelDir = geoCellAbsolutePath / Impl::GTMODEL_PATH;
-        std::filesystem::path GSModelDir = geoCellAbsolutePath / Impl::GSMODEL_PATH;
-        std::filesystem::path roadNetworkDir = geoCellAbsolutePath / Impl::ROAD_NETWORK_PATH;
-        std::filesystem::path railRoadNetworkDir = geoCellAbsolutePath / Impl::RAILROAD_NETWORK_PATH;
-        std::filesystem::path powerlineNetworkDir = geoCellAbsolutePath / Impl::POWERLINE_NETWORK_PATH;
-        std::filesystem::path hydrographyNetworkDir = geoCellAbsolutePath / Impl::HYDROGRAPHY_NETWORK_PATH;
-
-        // process elevation
-        cdb.forEachElevationTile(geoCell, [&](CDBElevation elevation) {
-            m_impl->addElevationToTilesetCollection(elevation, cdb, elevationDir);
-        });
-        m_impl->flushTilesetCollection(geoCell, m_impl->elevationTilesets);
-        std::unordered_map<CDBTile, Texture>().swap(m_impl->processedParentImagery);
-
-        // process road network
-        cdb.forEachRoadNetworkTile(geoCell, [&](const CDBGeometryVectors &roadNetwork) {
-            m_impl->addVectorToTilesetCollection(roadNetwork, roadNetworkDir, m_impl->roadNetworkTilesets);
-        });
-        m_impl->flushTilesetCollection(geoCell, m_impl->roadNetworkTilesets);
-
-        // process railroad network
-        cdb.forEachRailRoadNetworkTile(geoCell, [&](const CDBGeometryVectors &railRoadNetwork) {
-            m_impl->addVectorToTilesetCollection(railRoadNetwork,
-                                                 railRoadNetworkDir,
-                                                 m_impl->railRoadNetworkTilesets);
-        });
-        m_impl->flushTilesetCollection(geoCell, m_impl->railRoadNetworkTilesets);
-
-        // process powerline network
-        cdb.forEachPowerlineNetworkTile(geoCell, [&](const CDBGeometryVectors &powerlineNetwork) {
-            m_impl->addVectorToTilesetCollection(powerlineNetwork,
-                                                 powerlineNetworkDir,
-                                                 m_impl->powerlineNetworkTilesets);
-        });
-        m_impl->flushTilesetCollection(geoCell, m_impl->powerlineNetworkTilesets);
-
-        // process hydrography network
-        cdb.forEachHydrographyNetworkTile(geoCell, [&](const CDBGeometryVectors &hydrographyNetwork) {
-            m_impl->addVectorToTilesetCollection(hydrographyNetwork,
-                                                 hydrographyNetworkDir,
-                                                 m_impl->hydrographyNetworkTilesets);
-        });
-        m_impl->flushTilesetCollection(geoCell, m_impl->hydrographyNetworkTilesets);
-
-        // process GTModel
-        cdb.forEachGTModelTile(geoCell, [&](CDBGTModels GTModel) {
-            m_impl->addGTModelToTilesetCollection(GTModel, GTModelDir);
-        });
-        m_impl->flushTilesetCollection(geoCell, m_impl->GTModelTilesets);
-
-        // process GSModel
-        cdb.forEachGSModelTile(geoCell, [&](CDBGSModels GSModel) {
-            m_impl->addGSModelToTilesetCollection(GSModel, GSModelDir);
-        });
-        m_impl->flushTilesetCollection(geoCell, m_impl->GSModelTilesets, false);
-
-        // get the converted dataset in each geocell to be combine at the end
-        Core::BoundingRegion geoCellRegion = CDBTile::calcBoundRegion(geoCell, -10, 0, 0);
-        for (auto tilesetJsonPath : m_impl->defaultDatasetToCombine) {
-            auto componentSelectors = tilesetJsonPath.parent_path().filename().string();
-            auto dataset = tilesetJsonPath.parent_path().parent_path().filename().string();
-            auto combinedTilesetName = dataset + "_" + componentSelectors;
+        visitedGeoCells.insert(geoCellRelativePath);
+
+        if (m_impl->incremental) {
+            // skip GeoCells whose inputs are unchanged since they were last converted. Otherwise drop
+            // the GeoCell from the manifest first, so a run interrupted in the middle of it redoes it
+            const auto *convertedGeoCell = manifest.getGeoCell(geoCellRelativePath);
+            auto inputs = BuildManifest::collectInputFiles(m_impl->cdbPath,
+                                                           m_impl->cdbPath / geoCellRelativePath,
+                                                           convertedGeoCell ? &convertedGeoCell->inputs
+                                                                            : nullptr);
+            if (!convertedGeoCell || !m_impl->isGeoCellUpToDate(*convertedGeoCell, inputs)) {
+                if (convertedGeoCell) {
+                    manifest.removeGeoCell(geoCellRelativePath);
+                    manifest.writeToFile(manifestPath);
+                }
 
-            combinedTilesets[combinedTilesetName].emplace_back(tilesetJsonPath);
-            combinedTilesetsRegions[combinedTilesetName].emplace_back(geoCellRegion);
-            auto tilesetAggregateRegion = aggregateTilesetsRegion.find(combinedTilesetName);
-            if (tilesetAggregateRegion == aggregateTilesetsRegion.end()) {
-                aggregateTilesetsRegion.insert({combinedTilesetName, geoCellRegion});
-            } else {
-                tilesetAggregateRegion->second = tilesetAggregateRegion->second.computeUnion(geoCellRegion);
+                std::filesystem::remove_all(m_impl->outputPath / geoCellRelativePath);
+                m_impl->convertGeoCell(cdb, geoCell);
+
+                // the manifest only records the GeoCell once its files are on disk
+                m_impl->outputWriter->flush();
+                manifest.setGeoCell(geoCellRelativePath,
+                                    {std::move(inputs),
+                                     m_impl->defaultDatasetToCombine,
+                                     m_impl->defaultDatasetHeights});
+                manifest.writeToFile(manifestPath);
             }
+        } else {
+            if (m_impl->shardCount > 1) {
+                std::filesystem::remove_all(m_impl->outputPath / geoCellRelativePath);
+            }
+
+            m_impl->convertGeoCell(cdb, geoCell);
+            manifest.setGeoCell(geoCellRelativePath,
+                                {{}, m_impl->defaultDatasetToCombine, m_impl->defaultDatasetHeights});
         }
+
         std::vector<std::filesystem::path>().swap(m_impl->defaultDatasetToCombine);
+        std::vector<std::array<double, 2>>().swap(m_impl->defaultDatasetHeights);
     });
 
-    // combine all the default tileset in each geocell into a global one
-    for (auto tileset : combinedTilesets) {
-        std::ofstream fs(m_impl->outputPath / (tileset.first + ".json"));
-        combineTilesetJson(tileset.second, combinedTilesetsRegions[tileset.first], fs);
-    }
+    if (m_impl->incremental) {
+        // remove the output of GeoCells that no longer exist in the CDB. GeoCells left out by the filter keep
+        // their earlier output, so a region can be refreshed on its own. They are skipped before the catalog
+        // is asked, since the catalog doesn't list the latitude directories the filter leaves out
+        std::vector<std::filesystem::path> removedGeoCells;
+        for (const auto &geoCell : manifest.getGeoCells()) {
+            if (visitedGeoCells.find(geoCell.first) != visitedGeoCells.end()) {
+                continue;
+            }
 
-    // combine the requested tilesets
-    for (const auto &tilesets : m_impl->requestedDatasetToCombine) {
-        std::string combinedTilesetName;
-        if (m_impl->requestedDatasetToCombine.size() > 1) {
-            for (const auto &tileset : tilesets) {
-                combinedTilesetName += tileset;
+            auto parsedGeoCell = CDBGeoCell::parseFromRelativePath(geoCell.first);
+            if (parsedGeoCell && !m_impl->filter.isGeoCellIncluded(*parsedGeoCell)) {
+                continue;
             }
-            combinedTilesetName += ".json";
-        } else {
-            combinedTilesetName = "tileset.json";
-        }
 
-        std::vector<std::filesystem::path> existTilesets;
-        std::vector<Core::BoundingRegion> regions;
-        regions.reserve(tilesets.size());
-        for (const auto &tileset : tilesets) {
-            auto tilesetRegion = aggregateTilesetsRegion.find(tileset);
-            if (tilesetRegion != aggregateTilesetsRegion.end()) {
-                existTilesets.emplace_back(tilesetRegion->first + ".json");
-                regions.emplace_back(tilesetRegion->second);
+            if (!catalog.isDirectoryExist(geoCell.first)) {
+                removedGeoCells.emplace_back(geoCell.first);
             }
         }
 
-        std::ofstream fs(m_impl->outputPath / combinedTilesetName);
-        combineTilesetJson(existTilesets, regions, fs);
+        for (const auto &geoCell : removedGeoCells) {
+            std::filesystem::remove_all(m_impl->outputPath / geoCell);
+            manifest.removeGeoCell(geoCell);
+        }
+    }
+
+    if (m_impl->incremental || m_impl->shardCount > 1) {
+        m_impl->outputWriter->flush();
+        manifest.writeToFile(manifestPath);
+    }
+
+    // the tilesets of a shard are combined with the other shards by merge
+    if (m_impl->shardCount > 1) {
+        std::cout << "Converted shard " << m_impl->shardIndex << " of " << m_impl->shardCount << ": "
+                  << manifest.getGeoCells().size() << " GeoCells. Merge once every shard is converted\n";
+    } else {
+        ScopedStageTimer combineTimer("combineTilesets");
+        m_impl->combineTilesets(manifest);
+    }
+
+    {
+        ScopedStageTimer flushTimer("flushOutput");
+        m_impl->outputWriter->flush();
+    }
+
+    const auto &outputWriter = *m_impl->outputWriter;
+    std::cout << "Output: wrote " << outputWriter.getFileCount() << " files, "
+              << outputWriter.getBytesWritten() << " bytes, into " << outputWriter.getDirectoryCount()
+              << " directories on " << outputWriter.getThreadCount()
+              << " threads. Conversion waited for the writer " << outputWriter.getStallCount() << " times\n";
+    if (outputWriter.getGzipFileCount() > 0) {
+        std::cout << "Gzip: compressed " << outputWriter.getGzipFileCount() << " files from "
+                  << outputWriter.getGzipBytesIn() << " to " << outputWriter.getGzipBytesOut() << " bytes\n";
+    }
+
+    if (m_impl->contentStore) {
+        const auto &contentStore = *m_impl->contentStore;
+        std::cout << "Deduplicated output: " << contentStore.getDuplicateCount() << " of "
+                  << contentStore.getDuplicateCount() + contentStore.getUniqueCount()
+                  << " files were identical to an earlier one. Wrote " << contentStore.getBytesWritten()
+                  << " bytes, saved " << contentStore.getBytesSaved() << " bytes\n";
+        stats.addCounter("uniqueFiles", contentStore.getUniqueCount());
+        stats.addCounter("duplicateFiles", contentStore.getDuplicateCount());
+        m_impl->contentStore.reset();
+    }
+
+    size_t elevationHitCount = elevationSampler.getHitCount();
+    size_t elevationLookupCount = elevationHitCount + elevationSampler.getMissCount();
+    if (elevationLookupCount > 0) {
+        std::cout << "Elevation cache: " << elevationHitCount << " of " << elevationLookupCount
+                  << " model clamping lookups (" << elevationHitCount * 100 / elevationLookupCount
+                  << "%) reused decoded elevation. Peak memory use " << elevationSampler.getPeakCachedBytes()
+                  << " of " << elevationSampler.getCacheSizeInBytes() << " bytes\n";
+    }
+
+    const FilePrefetcher *prefetcher = cdb.getPrefetcher();
+    if (prefetcher) {
+        size_t prefetchHitCount = prefetcher->getHitCount() + prefetcher->getWaitCount();
+        std::cout << "Prefetch: " << prefetchHitCount << " of " << prefetchHitCount + prefetcher->getMissCount()
+                  << " source files were read ahead, " << prefetcher->getWaitCount()
+                  << " of them still being read when needed. " << prefetcher->getDiscardCount()
+                  << " files read ahead were not used. At most " << prefetcher->getPeakPendingCount()
+                  << " files were queued at once\n";
+    }
+
+    const auto &memoryBudget = *m_impl->memoryBudget;
+    if (memoryBudget.isLimited()) {
+        std::cout << "Memory budget: peak use " << memoryBudget.getPeakUsedBytes() << " of "
+                  << memoryBudget.getBudgetInBytes() << " bytes. Caches were shrunk "
+                  << memoryBudget.getPressureCount() << " times to stay within it\n";
+    }
+
+    if (stats.isEnabled()) {
+        stats.addCounter("elevationCacheHits", elevationSampler.getHitCount());
+        stats.addCounter("elevationCacheMisses", elevationSampler.getMissCount());
+        stats.addCounter("memoryPressureEvents", memoryBudget.getPressureCount());
+        stats.addCounter("scannedFiles", catalog.getFileCount());
+        stats.addCounter("scannedDirectories", catalog.getDirectoryCount());
+        stats.addCounter("writtenFiles", outputWriter.getFileCount());
+        stats.addCounter("writtenBytes", outputWriter.getBytesWritten());
+        stats.addCounter("writerStalls", outputWriter.getStallCount());
+        stats.addCounter("gzipFiles", outputWriter.getGzipFileCount());
+        stats.addCounter("gzipBytes", outputWriter.getGzipBytesOut());
+        if (prefetcher) {
+            stats.addCounter("prefetchHits", prefetcher->getHitCount());
+            stats.addCounter("prefetchWaits", prefetcher->getWaitCount());
+            stats.addCounter("prefetchMisses", prefetcher->getMissCount());
+            stats.addCounter("prefetchBytes", prefetcher->getBytesTaken());
+        }
+
+        std::ofstream fs(m_impl->statsFile);
+        stats.writeToJson(fs);
+        stats.writeSummary(std::cout);
+        stats.setEnabled(false);
+    }
+
+    m_impl->outputWriter.reset();
+    m_impl->memoryBudget.reset();
+}
+
+void Converter::merge()
+{
+    if (!std::filesystem::is_directory(m_impl->outputPath)) {
+        throw std::runtime_error(m_impl->outputPath.string() + " directory does not exist");
+    }
+
+    std::map<size_t, std::filesystem::path> shardManifests;
+    size_t shardCount = 0;
+    for (const auto &entry : std::filesystem::directory_iterator(m_impl->outputPath)) {
+        auto shard = BuildManifest::parseShardFilename(entry.path().filename().string());
+        if (!shard) {
+            continue;
+        }
+
+        if (shardCount != 0 && shard->second != shardCount) {
+            throw std::runtime_error("Found manifests of conversions split into " + std::to_string(shardCount)
+                                     + " and " + std::to_string(shard->second) + " shards");
+        }
+
+        shardCount = shard->second;
+        shardManifests.insert({shard->first, entry.path()});
     }
+
+    if (shardManifests.empty()) {
+        throw std::runtime_error("No shard manifests found in " + m_impl->outputPath.string());
+    }
+
+    std::optional<BuildManifest> manifest;
+    for (size_t i = 0; i < shardCount; ++i) {
+        auto shardManifest = shardManifests.find(i);
+        if (shardManifest == shardManifests.end()) {
+            throw std::runtime_error("Shard " + std::to_string(i) + " of " + std::to_string(shardCount)
+                                     + " has not been converted");
+        }
+
+        auto shard = BuildManifest::createFromFile(shardManifest->second);
+        if (!shard) {
+            throw std::runtime_error("Cannot read shard manifest " + shardManifest->second.string());
+        }
+
+        if (manifest) {
+            manifest->merge(*shard);
+        } else {
+            manifest = std::move(shard);
+        }
+    }
+
+    m_impl->createOutputWriter();
+    m_impl->combineTilesets(*manifest);
+    m_impl->outputWriter->flush();
+    m_impl->outputWriter.reset();
+
+    // when the shards were converted incrementally, an incremental conversion of the whole CDB carries on
+    // from the merged manifest
+    manifest->writeToFile(m_impl->outputPath / BuildManifest::FILENAME);
+    std::cout << "Merged " << shardCount << " shards: " << manifest->getGeoCells().size() << " GeoCells\n";
 }
 
 USE_OSGPLUGIN(png)
@@ -0,0 +1,259 @@
+#include "ContentHash.h"
+#include <cstring>
+
+namespace CDBTo3DTiles {
+
+static const uint64_t PRIME_1 = 11400714785074694791ull;
+static const uint64_t PRIME_2 = 14029467366897019727ull;
+static const uint64_t PRIME_3 = 1609587929392839161ull;
+static const uint64_t PRIME_4 = 9650029242287828579ull;
+static const uint64_t PRIME_5 = 2870177450012600261ull;
+
+static uint64_t rotateLeft(uint64_t value, int bits) noexcept;
+
+static uint64_t read64(const uint8_t *data) noexcept;
+
+static uint32_t read32(const uint8_t *data) noexcept;
+
+static uint64_t round(uint64_t accumulator, uint64_t input) noexcept;
+
+static uint64_t mergeRound(uint64_t hash, uint64_t accumulator) noexcept;
+
+static const std::array<std::array<uint32_t, 256>, 8> &getCRC32Tables() noexcept;
+
+static void processMD5Block(const uint8_t *block, std::array<uint32_t, 4> &state) noexcept;
+
+uint64_t computeContentHash(const void *data, size_t size, uint64_t seed) noexcept
+{
+    const uint8_t *current = static_cast<const uint8_t *>(data);
+    const uint8_t *end = current + size;
+
+    uint64_t hash;
+    if (size >= 32) {
+        uint64_t accumulator1 = seed + PRIME_1 + PRIME_2;
+        uint64_t accumulator2 = seed + PRIME_2;
+        uint64_t accumulator3 = seed;
+        uint64_t accumulator4 = seed - PRIME_1;
+
+        // four independent lanes of 8 bytes each, so the loop isn't bound by the multiply latency
+        const uint8_t *stripeEnd = end - 32;
+        do {
+            accumulator1 = round(accumulator1, read64(current));
+            accumulator2 = round(accumulator2, read64(current + 8));
+            accumulator3 = round(accumulator3, read64(current + 16));
+            accumulator4 = round(accumulator4, read64(current + 24));
+            current += 32;
+        } while (current <= stripeEnd);
+
+        hash = rotateLeft(accumulator1, 1) + rotateLeft(accumulator2, 7) + rotateLeft(accumulator3, 12)
+               + rotateLeft(accumulator4, 18);
+        hash = mergeRound(hash, accumulator1);
+        hash = mergeRound(hash, accumulator2);
+        hash = mergeRound(hash, accumulator3);
+        hash = mergeRound(hash, accumulator4);
+    } else {
+        hash = seed + PRIME_5;
+    }
+
+    hash += static_cast<uint64_t>(size);
+
+    while (current + 8 <= end) {
+        hash ^= round(0, read64(current));
+        hash = rotateLeft(hash, 27) * PRIME_1 + PRIME_4;
+        current += 8;
+    }
+
+    if (current + 4 <= end) {
+        hash ^= static_cast<uint64_t>(read32(current)) * PRIME_1;
+        hash = rotateLeft(hash, 23) * PRIME_2 + PRIME_3;
+        current += 4;
+    }
+
+    while (current < end) {
+        hash ^= static_cast<uint64_t>(*current) * PRIME_5;
+        hash = rotateLeft(hash, 11) * PRIME_1;
+        ++current;
+    }
+
+    hash ^= hash >> 33;
+    hash *= PRIME_2;
+    hash ^= hash >> 29;
+    hash *= PRIME_3;
+    hash ^= hash >> 32;
+
+    return hash;
+}
+
+uint32_t computeCRC32(const void *data, size_t size, uint32_t crc) noexcept
+{
+    const auto &tables = getCRC32Tables();
+    const uint8_t *current = static_cast<const uint8_t *>(data);
+    const uint8_t *end = current + size;
+
+    // slicing by 8 bytes at a time, archives are written at disk speed
+    crc = ~crc;
+    while (current + 8 <= end) {
+        uint32_t low = read32(current) ^ crc;
+        uint32_t high = read32(current + 4);
+        crc = tables[7][low & 0xff] ^ tables[6][(low >> 8) & 0xff] ^ tables[5][(low >> 16) & 0xff]
+              ^ tables[4][low >> 24] ^ tables[3][high & 0xff] ^ tables[2][(high >> 8) & 0xff]
+              ^ tables[1][(high >> 16) & 0xff] ^ tables[0][high >> 24];
+        current += 8;
+    }
+
+    while (current < end) {
+        crc = tables[0][(crc ^ *current) & 0xff] ^ (crc >> 8);
+        ++current;
+    }
+
+    return ~crc;
+}
+
+std::array<uint8_t, 16> computeMD5(const void *data, size_t size) noexcept
+{
+    std::array<uint32_t, 4> state = {0x67452301u, 0xefcdab89u, 0x98badcfeu, 0x10325476u};
+    const uint8_t *current = static_cast<const uint8_t *>(data);
+    size_t remaining = size;
+    while (remaining >= 64) {
+        processMD5Block(current, state);
+        current += 64;
+        remaining -= 64;
+    }
+
+    // pad with a single 1 bit, zeroes and the message length in bits
+    uint8_t tail[128] = {};
+    std::memcpy(tail, current, remaining);
+    tail[remaining] = 0x80;
+    size_t tailSize = remaining < 56 ? 64 : 128;
+    uint64_t bitCount = static_cast<uint64_t>(size) * 8;
+    for (size_t i = 0; i < 8; ++i) {
+        tail[tailSize - 8 + i] = static_cast<uint8_t>(bitCount >> (8 * i));
+    }
+
+    processMD5Block(tail, state);
+    if (tailSize == 128) {
+        processMD5Block(tail + 64, state);
+    }
+
+    std::array<uint8_t, 16> digest;
+    for (size_t i = 0; i < digest.size(); ++i) {
+        digest[i] = static_cast<uint8_t>(state[i / 4] >> (8 * (i % 4)));
+    }
+
+    return digest;
+}
+
+uint64_t rotateLeft(uint64_t value, int bits) noexcept
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+uint64_t read64(const uint8_t *data) noexcept
+{
+    // the hash is defined on little endian words, which is what every platform we build for uses
+    uint64_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+uint32_t read32(const uint8_t *data) noexcept
+{
+    uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+uint64_t round(uint64_t accumulator, uint64_t input) noexcept
+{
+    accumulator += input * PRIME_2;
+    accumulator = rotateLeft(accumulator, 31);
+    return accumulator * PRIME_1;
+}
+
+uint64_t mergeRound(uint64_t hash, uint64_t accumulator) noexcept
+{
+    hash ^= round(0, accumulator);
+    return hash * PRIME_1 + PRIME_4;
+}
+
+const std::array<std::array<uint32_t, 256>, 8> &getCRC32Tables() noexcept
+{
+    static const std::array<std::array<uint32_t, 256>, 8> tables = []() {
+        std::array<std::array<uint32_t, 256>, 8> crcTables;
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc & 1) ? (crc >> 1) ^ 0xedb88320u : crc >> 1;
+            }
+
+            crcTables[0][i] = crc;
+        }
+
+        for (size_t table = 1; table < crcTables.size(); ++table) {
+            for (size_t i = 0; i < 256; ++i) {
+                uint32_t previous = crcTables[table - 1][i];
+                crcTables[table][i] = (previous >> 8) ^ crcTables[0][previous & 0xff];
+            }
+        }
+
+        return crcTables;
+    }();
+
+    return tables;
+}
+
+void processMD5Block(const uint8_t *block, std::array<uint32_t, 4> &state) noexcept
+{
+    static const uint32_t SINES[64] = {
+        0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+        0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+        0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+        0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+        0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+        0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+        0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+        0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391};
+    static const int SHIFTS[64] = {7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22,
+                                   5, 9,  14, 20, 5, 9,  14, 20, 5, 9,  14, 20, 5, 9,  14, 20,
+                                   4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23,
+                                   6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21};
+
+    uint32_t words[16];
+    for (size_t i = 0; i < 16; ++i) {
+        words[i] = read32(block + i * 4);
+    }
+
+    uint32_t a = state[0];
+    uint32_t b = state[1];
+    uint32_t c = state[2];
+    uint32_t d = state[3];
+    for (uint32_t i = 0; i < 64; ++i) {
+        uint32_t f;
+        uint32_t g;
+        if (i < 16) {
+            f = (b & c) | (~b & d);
+            g = i;
+        } else if (i < 32) {
+            f = (d & b) | (~d & c);
+            g = (5 * i + 1) % 16;
+        } else if (i < 48) {
+            f = b ^ c ^ d;
+            g = (3 * i + 5) % 16;
+        } else {
+            f = c ^ (b | ~d);
+            g = (7 * i) % 16;
+        }
+
+        uint32_t rotated = a + f + SINES[i] + words[g];
+        a = d;
+        d = c;
+        c = b;
+        b += (rotated << SHIFTS[i]) | (rotated >> (32 - SHIFTS[i]));
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+}
+} // namespace CDBTo3DTiles
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace CDBTo3DTiles {
+// XXH64 of the buffer. Used to detect identical files, not for security
+uint64_t computeContentHash(const void *data, size_t size, uint64_t seed = 0) noexcept;
+
+// CRC-32 as used by zip. Pass the previous result to continue over more data
+uint32_t computeCRC32(const void *data, size_t size, uint32_t crc = 0) noexcept;
+
+// MD5, which 3D Tiles archives use to index their entries
+std::array<uint8_t, 16> computeMD5(const void *data, size_t size) noexcept;
+} // namespace CDBTo3DTiles
@@ -0,0 +1,100 @@
+#include "ContentStore.h"
+#include "ContentHash.h"
+#include "MappedFile.h"
+#include "OutputWriter.h"
+#include <algorithm>
+#include <cstring>
+
+namespace CDBTo3DTiles {
+
+static std::string convertHashToHex(uint64_t hash);
+
+const std::filesystem::path ContentStore::DIRECTORY_NAME = "Blobs";
+
+ContentStore::ContentStore(const std::filesystem::path &directory, OutputWriter &outputWriter)
+    : m_directory{directory}
+    , m_outputWriter{outputWriter}
+    , m_uniqueCount{0}
+    , m_duplicateCount{0}
+    , m_bytesWritten{0}
+    , m_bytesSaved{0}
+{}
+
+std::filesystem::path ContentStore::store(const void *data, size_t size, const std::string &extension)
+{
+    uint64_t hash = computeContentHash(data, size);
+    std::string hashHex = convertHashToHex(hash);
+    std::string subDirectory = hashHex.substr(0, 2);
+    auto &candidates = m_blobs[hash];
+
+    // A matching hash is confirmed against the stored bytes before the blob is shared, so a collision
+    // costs a read instead of silently pointing a tile at the wrong content. Colliding payloads get a suffix.
+    // Blobs left in the directory by an earlier run are picked up the same way
+    for (size_t collision = 0;; ++collision) {
+        std::string filename = hashHex;
+        if (collision > 0) {
+            filename += "_" + std::to_string(collision);
+        }
+
+        std::filesystem::path blobPath = std::filesystem::path(subDirectory) / (filename + extension);
+        std::filesystem::path blobAbsolutePath = m_directory / blobPath;
+
+        auto candidate = std::find_if(candidates.begin(), candidates.end(), [&](const Blob &blob) {
+            return blob.path == blobPath;
+        });
+        if (candidate != candidates.end()) {
+            if (candidate->size == size) {
+                // a blob stored earlier in this run may still be waiting to be written
+                m_outputWriter.waitForFile(blobAbsolutePath);
+                if (isSameContent(blobAbsolutePath, data, size)) {
+                    ++m_duplicateCount;
+                    m_bytesSaved += size;
+                    return blobPath;
+                }
+            }
+
+            continue;
+        }
+
+        if (std::filesystem::exists(blobAbsolutePath)) {
+            uint64_t blobSize = static_cast<uint64_t>(std::filesystem::file_size(blobAbsolutePath));
+            candidates.push_back({blobSize, blobPath});
+            if (blobSize == size && isSameContent(blobAbsolutePath, data, size)) {
+                ++m_duplicateCount;
+                m_bytesSaved += size;
+                return blobPath;
+            }
+
+            continue;
+        }
+
+        // failed writes are reported when the output writer is flushed
+        m_outputWriter.write(blobAbsolutePath, std::string(static_cast<const char *>(data), size));
+        candidates.push_back({size, blobPath});
+        ++m_uniqueCount;
+        m_bytesWritten += size;
+        return blobPath;
+    }
+}
+
+bool ContentStore::isSameContent(const std::filesystem::path &blob, const void *data, size_t size) const
+{
+    auto blobFile = MappedFile::createFromFile(blob);
+    if (!blobFile || blobFile->getSize() != size) {
+        return false;
+    }
+
+    return size == 0 || std::memcmp(blobFile->getData(), data, size) == 0;
+}
+
+std::string convertHashToHex(uint64_t hash)
+{
+    static const char DIGITS[] = "0123456789abcdef";
+    std::string hex(16, '0');
+    for (size_t i = 0; i < hex.size(); ++i) {
+        hex[hex.size() - 1 - i] = DIGITS[(hash >> (4 * i)) & 0xf];
+    }
+
+    return hex;
+}
+} // namespace CDBTo3DTiles
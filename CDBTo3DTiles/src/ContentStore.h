@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace CDBTo3DTiles {
+class OutputWriter;
+
+// Stores payloads once under the hash of their content, and writes them through the output writer like
+// every other output file. Blobs are never deleted, so blobs of tiles an incremental conversion replaced
+// stay in the directory until it is removed and the whole CDB is converted again
+class ContentStore
+{
+public:
+    ContentStore(const std::filesystem::path &directory, OutputWriter &outputWriter);
+
+    inline const std::filesystem::path &getDirectory() const noexcept { return m_directory; }
+
+    inline size_t getUniqueCount() const noexcept { return m_uniqueCount; }
+
+    inline size_t getDuplicateCount() const noexcept { return m_duplicateCount; }
+
+    // Bytes of the unique payloads handed to the output writer
+    inline uint64_t getBytesWritten() const noexcept { return m_bytesWritten; }
+
+    inline uint64_t getBytesSaved() const noexcept { return m_bytesSaved; }
+
+    // Writes the payload unless an identical one is already stored. Returns the path of the blob relative
+    // to the store directory. Every blob is exactly one directory deep, so a blob refers to another one
+    // with "../" followed by this path
+    std::filesystem::path store(const void *data, size_t size, const std::string &extension);
+
+    static const std::filesystem::path DIRECTORY_NAME;
+
+private:
+    struct Blob
+    {
+        uint64_t size;
+        std::filesystem::path path;
+    };
+
+    bool isSameContent(const std::filesystem::path &blob, const void *data, size_t size) const;
+
+    std::filesystem::path m_directory;
+    OutputWriter &m_outputWriter;
+    std::unordered_map<uint64_t, std::vector<Blob>> m_blobs;
+    size_t m_uniqueCount;
+    size_t m_duplicateCount;
+    uint64_t m_bytesWritten;
+    uint64_t m_bytesSaved;
+};
+} // namespace CDBTo3DTiles
@@ -0,0 +1,426 @@
+#include "ConversionStats.h"
+#include "nlohmann/json.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <unordered_map>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+namespace CDBTo3DTiles {
+
+// stages of a dataset that are printed in the summary, the rest are only in the report
+static const size_t SUMMARY_STAGE_COUNT = 5;
+
+static const char *DATASET_STAGE = "total";
+
+struct StageKey
+{
+    uint32_t scope;
+    const char *name;
+};
+
+struct StageKeyHash
+{
+    size_t operator()(const StageKey &key) const noexcept
+    {
+        return std::hash<const char *>()(key.name) ^ (static_cast<size_t>(key.scope) << 1);
+    }
+};
+
+static bool operator==(const StageKey &lhs, const StageKey &rhs) noexcept;
+
+// the owning thread locks the table to record into it, and the report locks it to read it
+struct ConversionStats::ThreadTable
+{
+    std::mutex mutex;
+    std::unordered_map<StageKey, StageStats, StageKeyHash> stages;
+    std::unordered_map<StageKey, uint64_t, StageKeyHash> counters;
+    uint64_t busyNanoseconds = 0;
+    int openTimers = 0;
+};
+
+// frees the table of a thread when the thread ends, after its stats are folded into the exited threads
+struct ConversionStats::ThreadTableHolder
+{
+    ThreadTable *table = nullptr;
+
+    ~ThreadTableHolder() noexcept
+    {
+        if (table != nullptr) {
+            ConversionStats::getInstance().releaseThreadTable(table);
+        }
+    }
+};
+
+struct ScopeStats
+{
+    std::map<std::string, StageStats> stages;
+    std::map<std::string, uint64_t> counters;
+};
+
+// GeoCell to dataset to the stats recorded for it
+using MergedStats = std::map<std::string, std::map<std::string, ScopeStats>>;
+
+static void mergeStage(StageStats &merged, const StageStats &stage);
+
+static nlohmann::json convertScopeToJson(const ScopeStats &scope);
+
+static double toSeconds(uint64_t nanoseconds);
+
+static double toMebibytes(uint64_t bytes);
+
+ConversionStats &ConversionStats::getInstance()
+{
+    static ConversionStats stats;
+    return stats;
+}
+
+ConversionStats::ConversionStats()
+    : m_enabled{false}
+    , m_scope{0}
+    , m_start{std::chrono::steady_clock::now()}
+    , m_scopes{{"", ""}}
+    , m_exitedThreadsTable{std::make_unique<ThreadTable>()}
+    , m_exitedThreadCount{0}
+{}
+
+ConversionStats::~ConversionStats() noexcept {}
+
+void ConversionStats::setEnabled(bool enabled)
+{
+    if (enabled) {
+        // the tables are emptied instead of freed, since threads keep pointers to them
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto &table : m_threadTables) {
+            std::lock_guard<std::mutex> tableLock(table->mutex);
+            table->stages.clear();
+            table->counters.clear();
+            table->busyNanoseconds = 0;
+        }
+
+        m_exitedThreadsTable = std::make_unique<ThreadTable>();
+        m_exitedThreadCount = 0;
+
+        m_scopes.resize(1);
+        m_scope.store(0, std::memory_order_relaxed);
+        m_start = std::chrono::steady_clock::now();
+    }
+
+    m_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void ConversionStats::setScope(const std::string &geoCell, const std::string &dataset)
+{
+    if (!isEnabled()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto scope = std::find(m_scopes.begin(), m_scopes.end(), std::make_pair(geoCell, dataset));
+    if (scope == m_scopes.end()) {
+        scope = m_scopes.emplace(m_scopes.end(), geoCell, dataset);
+    }
+
+    m_scope.store(static_cast<uint32_t>(scope - m_scopes.begin()), std::memory_order_relaxed);
+}
+
+void ConversionStats::recordStage(const char *stage,
+                                  uint64_t nanoseconds,
+                                  uint64_t bytesIn,
+                                  uint64_t bytesOut)
+{
+    if (!isEnabled()) {
+        return;
+    }
+
+    auto &table = getThreadTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+    auto &stats = table.stages[{m_scope.load(std::memory_order_relaxed), stage}];
+    ++stats.calls;
+    stats.nanoseconds += nanoseconds;
+    stats.bytesIn += bytesIn;
+    stats.bytesOut += bytesOut;
+}
+
+void ConversionStats::addCounter(const char *counter, uint64_t value)
+{
+    if (!isEnabled()) {
+        return;
+    }
+
+    auto &table = getThreadTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+    table.counters[{m_scope.load(std::memory_order_relaxed), counter}] += value;
+}
+
+void ConversionStats::writeToJson(std::ostream &os) const
+{
+    os << std::setw(4) << createReport() << std::endl;
+}
+
+void ConversionStats::writeSummary(std::ostream &os) const
+{
+    auto reportJson = createReport();
+    auto flags = os.flags();
+    os << std::fixed << std::setprecision(3);
+    os << "Conversion stats: " << reportJson["seconds"].get<double>() << " s, peak memory "
+       << toMebibytes(reportJson["peakResidentSetBytes"].get<uint64_t>()) << " MiB, "
+       << reportJson["threads"].size() + reportJson["exitedThreads"]["count"].get<uint64_t>()
+       << " threads recorded\n";
+
+    for (const auto &dataset : reportJson["datasets"].items()) {
+        const auto &stages = dataset.value()["stages"];
+        os << "  " << dataset.key();
+        if (stages.contains(DATASET_STAGE)) {
+            os << ": " << stages[DATASET_STAGE]["seconds"].get<double>() << " s";
+        }
+
+        for (const auto &counter : dataset.value()["counters"].items()) {
+            os << ", " << counter.value().get<uint64_t>() << " " << counter.key();
+        }
+
+        os << "\n";
+
+        // slowest stages first. Stages can run inside each other, so their times don't add up to the total
+        std::vector<std::pair<double, std::string>> stageTimes;
+        for (const auto &stage : stages.items()) {
+            if (stage.key() != DATASET_STAGE) {
+                stageTimes.emplace_back(stage.value()["seconds"].get<double>(), stage.key());
+            }
+        }
+
+        std::sort(stageTimes.rbegin(), stageTimes.rend());
+        stageTimes.resize(std::min(stageTimes.size(), SUMMARY_STAGE_COUNT));
+        for (const auto &stageTime : stageTimes) {
+            const auto &stage = stages[stageTime.second];
+            os << "    " << std::left << std::setw(24) << stageTime.second << std::right << std::setw(10)
+               << stage["calls"].get<uint64_t>() << " calls " << std::setw(12) << stageTime.first << " s "
+               << std::setw(12) << toMebibytes(stage["bytesIn"].get<uint64_t>()) << " MiB in "
+               << std::setw(12) << toMebibytes(stage["bytesOut"].get<uint64_t>()) << " MiB out\n";
+        }
+    }
+
+    os.flags(flags);
+}
+
+uint64_t ConversionStats::getPeakResidentSetSize()
+{
+#ifndef _WIN32
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+
+#ifdef __APPLE__
+    return static_cast<uint64_t>(usage.ru_maxrss);
+#else
+    // Linux reports it in kilobytes
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+#else
+    return 0;
+#endif
+}
+
+ConversionStats::ThreadTable &ConversionStats::getThreadTable()
+{
+    static thread_local ThreadTableHolder holder;
+    if (holder.table == nullptr) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_threadTables.emplace_back(std::make_unique<ThreadTable>());
+        holder.table = m_threadTables.back().get();
+    }
+
+    return *holder.table;
+}
+
+void ConversionStats::releaseThreadTable(ThreadTable *table) noexcept
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto threadTable = std::find_if(m_threadTables.begin(),
+                                    m_threadTables.end(),
+                                    [table](const std::unique_ptr<ThreadTable> &ownedTable) {
+                                        return ownedTable.get() == table;
+                                    });
+    if (threadTable == m_threadTables.end()) {
+        return;
+    }
+
+    for (const auto &stage : table->stages) {
+        mergeStage(m_exitedThreadsTable->stages[stage.first], stage.second);
+    }
+
+    for (const auto &counter : table->counters) {
+        m_exitedThreadsTable->counters[counter.first] += counter.second;
+    }
+
+    // threads that never recorded a stage are not counted, the same as in the report
+    if (!table->stages.empty()) {
+        m_exitedThreadsTable->busyNanoseconds += table->busyNanoseconds;
+        ++m_exitedThreadCount;
+    }
+
+    m_threadTables.erase(threadTable);
+}
+
+nlohmann::json ConversionStats::createReport() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    MergedStats merged;
+    auto mergeTable = [&](const ThreadTable &table) {
+        uint64_t calls = 0;
+        for (const auto &stage : table.stages) {
+            const auto &scope = m_scopes[stage.first.scope];
+            mergeStage(merged[scope.first][scope.second].stages[stage.first.name], stage.second);
+            calls += stage.second.calls;
+        }
+
+        for (const auto &counter : table.counters) {
+            const auto &scope = m_scopes[counter.first.scope];
+            merged[scope.first][scope.second].counters[counter.first.name] += counter.second;
+        }
+
+        return calls;
+    };
+
+    nlohmann::json threadsJson = nlohmann::json::array();
+    for (const auto &table : m_threadTables) {
+        std::lock_guard<std::mutex> tableLock(table->mutex);
+        uint64_t calls = mergeTable(*table);
+        if (calls > 0) {
+            threadsJson.push_back({{"calls", calls}, {"seconds", toSeconds(table->busyNanoseconds)}});
+        }
+    }
+
+    // threads that ended are reported together, since parallel loops start new threads every time
+    uint64_t exitedThreadsCalls = mergeTable(*m_exitedThreadsTable);
+    nlohmann::json exitedThreadsJson = {{"count", m_exitedThreadCount},
+                                        {"calls", exitedThreadsCalls},
+                                        {"seconds", toSeconds(m_exitedThreadsTable->busyNanoseconds)}};
+
+    // datasets add up over all the GeoCells. Stats recorded outside of a GeoCell belong to the whole run
+    std::map<std::string, ScopeStats> datasets;
+    nlohmann::json geoCellsJson = nlohmann::json::object();
+    nlohmann::json runJson = nlohmann::json::object();
+    for (const auto &geoCell : merged) {
+        for (const auto &dataset : geoCell.second) {
+            if (geoCell.first.empty()) {
+                runJson = convertScopeToJson(dataset.second);
+                continue;
+            }
+
+            geoCellsJson[geoCell.first][dataset.first] = convertScopeToJson(dataset.second);
+            auto &total = datasets[dataset.first];
+            for (const auto &stage : dataset.second.stages) {
+                mergeStage(total.stages[stage.first], stage.second);
+            }
+
+            for (const auto &counter : dataset.second.counters) {
+                total.counters[counter.first] += counter.second;
+            }
+        }
+    }
+
+    nlohmann::json datasetsJson = nlohmann::json::object();
+    for (const auto &dataset : datasets) {
+        datasetsJson[dataset.first] = convertScopeToJson(dataset.second);
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()
+                                                                         - m_start);
+    nlohmann::json reportJson;
+    reportJson["seconds"] = toSeconds(static_cast<uint64_t>(elapsed.count()));
+    reportJson["peakResidentSetBytes"] = getPeakResidentSetSize();
+    reportJson["run"] = runJson;
+    reportJson["datasets"] = datasetsJson;
+    reportJson["geoCells"] = geoCellsJson;
+    reportJson["threads"] = threadsJson;
+    reportJson["exitedThreads"] = exitedThreadsJson;
+    return reportJson;
+}
+
+ScopedStageTimer::ScopedStageTimer(const char *stage)
+    : m_stage{stage}
+    , m_bytesIn{0}
+    , m_bytesOut{0}
+    , m_enabled{ConversionStats::getInstance().isEnabled()}
+{
+    if (m_enabled) {
+        ++ConversionStats::getInstance().getThreadTable().openTimers;
+        m_start = std::chrono::steady_clock::now();
+    }
+}
+
+ScopedStageTimer::~ScopedStageTimer() noexcept
+{
+    if (!m_enabled) {
+        return;
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()
+                                                                         - m_start);
+    auto nanoseconds = static_cast<uint64_t>(elapsed.count());
+    auto &stats = ConversionStats::getInstance();
+    auto &table = stats.getThreadTable();
+
+    // only the outermost timer of a thread counts towards its busy time, so nested stages count once
+    if (--table.openTimers == 0) {
+        std::lock_guard<std::mutex> lock(table.mutex);
+        table.busyNanoseconds += nanoseconds;
+    }
+
+    stats.recordStage(m_stage, nanoseconds, m_bytesIn, m_bytesOut);
+}
+
+void ScopedStageTimer::addInputFile(const std::filesystem::path &file)
+{
+    if (m_enabled) {
+        std::error_code error;
+        auto size = std::filesystem::file_size(file, error);
+        if (!error) {
+            m_bytesIn += static_cast<uint64_t>(size);
+        }
+    }
+}
+
+bool operator==(const StageKey &lhs, const StageKey &rhs) noexcept
+{
+    return lhs.scope == rhs.scope && lhs.name == rhs.name;
+}
+
+void mergeStage(StageStats &merged, const StageStats &stage)
+{
+    merged.calls += stage.calls;
+    merged.nanoseconds += stage.nanoseconds;
+    merged.bytesIn += stage.bytesIn;
+    merged.bytesOut += stage.bytesOut;
+}
+
+nlohmann::json convertScopeToJson(const ScopeStats &scope)
+{
+    nlohmann::json scopeJson;
+    scopeJson["stages"] = nlohmann::json::object();
+    for (const auto &stage : scope.stages) {
+        scopeJson["stages"][stage.first] = {{"calls", stage.second.calls},
+                                            {"seconds", toSeconds(stage.second.nanoseconds)},
+                                            {"bytesIn", stage.second.bytesIn},
+                                            {"bytesOut", stage.second.bytesOut}};
+    }
+
+    scopeJson["counters"] = scope.counters;
+    return scopeJson;
+}
+
+double toSeconds(uint64_t nanoseconds)
+{
+    return static_cast<double>(nanoseconds) / 1e9;
+}
+
+double toMebibytes(uint64_t bytes)
+{
+    return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
+} // namespace CDBTo3DTiles
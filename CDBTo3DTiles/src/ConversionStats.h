@@ -0,0 +1,110 @@
+#pragma once
+
+#include "nlohmann/json_fwd.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace CDBTo3DTiles {
+struct StageStats
+{
+    uint64_t calls = 0;
+    uint64_t nanoseconds = 0;
+    uint64_t bytesIn = 0;
+    uint64_t bytesOut = 0;
+};
+
+// Times and counters of the conversion stages, grouped by the GeoCell and dataset being converted. Every
+// thread records into its own table, behind a lock of its own that is only contended while a report is
+// written. A thread folds its table into the stats of the exited threads when it ends, and the tables are
+// merged when the report is written, which can happen while other threads still record. Nothing is
+// recorded until stats are enabled
+class ConversionStats
+{
+public:
+    static ConversionStats &getInstance();
+
+    inline bool isEnabled() const noexcept { return m_enabled.load(std::memory_order_relaxed); }
+
+    // Enabling clears what was recorded before and restarts the wall clock of the report
+    void setEnabled(bool enabled);
+
+    // Stages and counters recorded from now on, on any thread, belong to this GeoCell and dataset
+    void setScope(const std::string &geoCell, const std::string &dataset);
+
+    // Stage and counter names must be string literals, since the tables keep the pointers
+    void recordStage(const char *stage, uint64_t nanoseconds, uint64_t bytesIn, uint64_t bytesOut);
+
+    void addCounter(const char *counter, uint64_t value);
+
+    void writeToJson(std::ostream &os) const;
+
+    // Prints the time of each dataset and its slowest stages
+    void writeSummary(std::ostream &os) const;
+
+    // Returns 0 where the platform doesn't report it
+    static uint64_t getPeakResidentSetSize();
+
+private:
+    friend class ScopedStageTimer;
+
+    struct ThreadTable;
+
+    struct ThreadTableHolder;
+
+    ConversionStats();
+
+    ~ConversionStats() noexcept;
+
+    ThreadTable &getThreadTable();
+
+    void releaseThreadTable(ThreadTable *table) noexcept;
+
+    nlohmann::json createReport() const;
+
+    std::atomic<bool> m_enabled;
+    std::atomic<uint32_t> m_scope;
+    std::chrono::steady_clock::time_point m_start;
+    mutable std::mutex m_mutex;
+    std::vector<std::pair<std::string, std::string>> m_scopes;
+    std::vector<std::unique_ptr<ThreadTable>> m_threadTables;
+    std::unique_ptr<ThreadTable> m_exitedThreadsTable;
+    uint64_t m_exitedThreadCount;
+};
+
+// Records the time from its construction to its destruction as one call of a stage of the current scope
+class ScopedStageTimer
+{
+public:
+    explicit ScopedStageTimer(const char *stage);
+
+    ScopedStageTimer(const ScopedStageTimer &) = delete;
+
+    ScopedStageTimer &operator=(const ScopedStageTimer &) = delete;
+
+    ~ScopedStageTimer() noexcept;
+
+    inline bool isEnabled() const noexcept { return m_enabled; }
+
+    inline void addBytesIn(uint64_t bytes) noexcept { m_bytesIn += bytes; }
+
+    inline void addBytesOut(uint64_t bytes) noexcept { m_bytesOut += bytes; }
+
+    // Adds the size of the file to the bytes read. The file is only looked up when stats are enabled
+    void addInputFile(const std::filesystem::path &file);
+
+private:
+    const char *m_stage;
+    std::chrono::steady_clock::time_point m_start;
+    uint64_t m_bytesIn;
+    uint64_t m_bytesOut;
+    bool m_enabled;
+};
+} // namespace CDBTo3DTiles
@@ -0,0 +1,188 @@
+#include "DBFReader.h"
+#include "cpl_conv.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace CDBTo3DTiles {
+
+static constexpr size_t DBF_HEADER_SIZE = 32;
+static constexpr size_t DBF_FIELD_DESCRIPTOR_SIZE = 32;
+static constexpr uint8_t DBF_HEADER_TERMINATOR = 0x0D;
+static constexpr uint8_t DBF_DELETED_RECORD = '*';
+
+static uint32_t readUInt32LE(const uint8_t *data)
+{
+    return static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8)
+           | (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+}
+
+static uint16_t readUInt16LE(const uint8_t *data)
+{
+    return static_cast<uint16_t>(data[0] | (data[1] << 8));
+}
+
+static std::string_view trimSpaces(std::string_view value)
+{
+    size_t begin = value.find_first_not_of(' ');
+    if (begin == std::string_view::npos) {
+        return {};
+    }
+
+    size_t end = value.find_last_not_of(' ');
+    return value.substr(begin, end - begin + 1);
+}
+
+// Map dBase native types to the types OGR's shapefile driver reports, so attributes
+// decoded here end up in the same integer, double and string columns as before
+static std::optional<DBFFieldType> getFieldType(char nativeType, size_t width, size_t decimals)
+{
+    switch (nativeType) {
+    case 'N':
+    case 'F':
+        if (decimals == 0 && width < 10) {
+            return DBFFieldType::Integer;
+        } else if (decimals == 0 && width < 19) {
+            return DBFFieldType::Integer64;
+        }
+
+        return DBFFieldType::Real;
+    case 'D':
+        return DBFFieldType::Date;
+    case 'C':
+    case 'L':
+        return DBFFieldType::String;
+    default:
+        return std::nullopt;
+    }
+}
+
+DBFReader::DBFReader(MappedFile file,
+                     size_t recordCount,
+                     size_t headerLength,
+                     size_t recordLength,
+                     std::vector<DBFField> fields)
+    : m_file{std::move(file)}
+    , m_recordCount{recordCount}
+    , m_headerLength{headerLength}
+    , m_recordLength{recordLength}
+    , m_fields{std::move(fields)}
+{}
+
+bool DBFReader::isRecordDeleted(size_t record) const noexcept
+{
+    return record < m_recordCount
+           && m_file.getData()[m_headerLength + record * m_recordLength] == DBF_DELETED_RECORD;
+}
+
+std::string_view DBFReader::getFieldValue(size_t record, const DBFField &field) const noexcept
+{
+    const char *recordData = reinterpret_cast<const char *>(m_file.getData() + m_headerLength
+                                                            + record * m_recordLength);
+    std::string_view value(recordData + field.offset, field.width);
+
+    // values are padded with spaces and may be terminated early by a null character
+    size_t nullTerminator = value.find('\0');
+    if (nullTerminator != std::string_view::npos) {
+        value = value.substr(0, nullTerminator);
+    }
+
+    return trimSpaces(value);
+}
+
+int DBFReader::getFieldAsInteger(size_t record, const DBFField &field) const noexcept
+{
+    char buffer[32];
+    auto value = getFieldValue(record, field);
+    size_t length = std::min(value.size(), sizeof(buffer) - 1);
+    std::memcpy(buffer, value.data(), length);
+    buffer[length] = '\0';
+
+    // out of range values are clamped, the same as OGR does
+    GIntBig integer = CPLAtoGIntBig(buffer);
+    integer = std::max<GIntBig>(integer, std::numeric_limits<int>::min());
+    integer = std::min<GIntBig>(integer, std::numeric_limits<int>::max());
+    return static_cast<int>(integer);
+}
+
+double DBFReader::getFieldAsDouble(size_t record, const DBFField &field) const noexcept
+{
+    char buffer[64];
+    auto value = getFieldValue(record, field);
+    size_t length = std::min(value.size(), sizeof(buffer) - 1);
+    std::memcpy(buffer, value.data(), length);
+    buffer[length] = '\0';
+
+    // the decimal separator is always a period, whatever the locale of the process
+    return CPLAtof(buffer);
+}
+
+std::string DBFReader::getFieldAsString(size_t record, const DBFField &field) const
+{
+    return std::string(getFieldValue(record, field));
+}
+
+std::optional<DBFReader> DBFReader::createFromFile(const std::filesystem::path &file)
+{
+    auto mappedFile = MappedFile::createFromFile(file);
+    if (!mappedFile) {
+        return std::nullopt;
+    }
+
+    return createFromMappedFile(std::move(*mappedFile));
+}
+
+std::optional<DBFReader> DBFReader::createFromMappedFile(MappedFile file)
+{
+    if (file.getSize() < DBF_HEADER_SIZE) {
+        return std::nullopt;
+    }
+
+    const uint8_t *data = file.getData();
+    size_t fileSize = file.getSize();
+    size_t recordCount = readUInt32LE(data + 4);
+    size_t headerLength = readUInt16LE(data + 8);
+    size_t recordLength = readUInt16LE(data + 10);
+    if (headerLength < DBF_HEADER_SIZE + 1 || headerLength > fileSize || recordLength == 0) {
+        return std::nullopt;
+    }
+
+    // the table may be truncated, so only trust records that are fully inside the file
+    recordCount = std::min(recordCount, (fileSize - headerLength) / recordLength);
+
+    std::vector<DBFField> fields;
+    size_t fieldOffset = 1;
+    for (size_t descriptor = DBF_HEADER_SIZE; descriptor + DBF_FIELD_DESCRIPTOR_SIZE <= headerLength;
+         descriptor += DBF_FIELD_DESCRIPTOR_SIZE) {
+        const uint8_t *fieldDescriptor = data + descriptor;
+        if (fieldDescriptor[0] == DBF_HEADER_TERMINATOR) {
+            break;
+        }
+
+        const char *name = reinterpret_cast<const char *>(fieldDescriptor);
+        size_t nameLength = strnlen(name, 11);
+        char nativeType = static_cast<char>(fieldDescriptor[11]);
+        size_t width = fieldDescriptor[16];
+        size_t decimals = fieldDescriptor[17];
+
+        // only numeric fields have a decimal count. Other fields use it as the high byte of the width
+        if (nativeType != 'N' && nativeType != 'F') {
+            width += decimals * 256;
+            decimals = 0;
+        }
+
+        if (fieldOffset + width > recordLength) {
+            return std::nullopt;
+        }
+
+        auto type = getFieldType(nativeType, width, decimals);
+        if (type) {
+            fields.emplace_back(DBFField{std::string(name, nameLength), *type, fieldOffset, width, decimals});
+        }
+
+        fieldOffset += width;
+    }
+
+    return DBFReader(std::move(file), recordCount, headerLength, recordLength, std::move(fields));
+}
+} // namespace CDBTo3DTiles
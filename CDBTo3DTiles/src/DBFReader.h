@@ -0,0 +1,64 @@
+#pragma once
+
+#include "MappedFile.h"
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace CDBTo3DTiles {
+enum class DBFFieldType
+{
+    Integer,
+    Integer64,
+    Real,
+    String,
+    Date,
+};
+
+struct DBFField
+{
+    std::string name;
+    DBFFieldType type;
+    size_t offset;
+    size_t width;
+    size_t decimals;
+};
+
+class DBFReader
+{
+public:
+    inline size_t getRecordCount() const noexcept { return m_recordCount; }
+
+    inline const std::vector<DBFField> &getFields() const noexcept { return m_fields; }
+
+    // Records past the end of the table are not deleted
+    bool isRecordDeleted(size_t record) const noexcept;
+
+    std::string_view getFieldValue(size_t record, const DBFField &field) const noexcept;
+
+    int getFieldAsInteger(size_t record, const DBFField &field) const noexcept;
+
+    double getFieldAsDouble(size_t record, const DBFField &field) const noexcept;
+
+    std::string getFieldAsString(size_t record, const DBFField &field) const;
+
+    static std::optional<DBFReader> createFromFile(const std::filesystem::path &file);
+
+    static std::optional<DBFReader> createFromMappedFile(MappedFile file);
+
+private:
+    DBFReader(MappedFile file,
+              size_t recordCount,
+              size_t headerLength,
+              size_t recordLength,
+              std::vector<DBFField> fields);
+
+    MappedFile m_file;
+    size_t m_recordCount;
+    size_t m_headerLength;
+    size_t m_recordLength;
+    std::vector<DBFField> m_fields;
+};
+} // namespace CDBTo3DTiles
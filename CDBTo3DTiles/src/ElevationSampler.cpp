@@ -0,0 +1,235 @@
+#include "ElevationSampler.h"
+#include "gdal_priv.h"
+#include "glm/glm.hpp"
+#include <algorithm>
+
+namespace CDBTo3DTiles {
+
+// a missing or unreadable tile is cached too, so it is only looked up once
+static const size_t GRID_ENTRY_SIZE = sizeof(ElevationGrid) + sizeof(CDBTile);
+
+const size_t ElevationSampler::DEFAULT_CACHE_SIZE = 256 * 1024 * 1024;
+
+ElevationGrid::ElevationGrid(size_t width, size_t height, std::vector<float> heights)
+    : m_width{width}
+    , m_height{height}
+    , m_heights{std::move(heights)}
+{}
+
+double ElevationGrid::sampleNearest(const Core::GlobeRectangle &rectangle,
+                                    const Core::Cartographic &point) const
+{
+    double gapX = rectangle.computeWidth() / static_cast<double>(m_width);
+    double gapY = rectangle.computeHeight() / static_cast<double>(m_height);
+    double maxX = static_cast<double>(m_width - 1);
+    double maxY = static_cast<double>(m_height - 1);
+
+    double x = glm::clamp(glm::floor((point.longitude - rectangle.getWest()) / gapX), 0.0, maxX);
+    double y = glm::clamp(glm::floor((point.latitude - rectangle.getSouth()) / gapY), 0.0, maxY);
+    size_t column = static_cast<size_t>(x);
+    size_t row = m_height - static_cast<size_t>(y) - 1;
+
+    return static_cast<double>(m_heights[row * m_width + column]);
+}
+
+double ElevationGrid::sampleBilinear(const Core::GlobeRectangle &rectangle,
+                                     const Core::Cartographic &point) const
+{
+    double gapX = rectangle.computeWidth() / static_cast<double>(m_width);
+    double gapY = rectangle.computeHeight() / static_cast<double>(m_height);
+    double maxX = static_cast<double>(m_width - 1);
+    double maxY = static_cast<double>(m_height - 1);
+
+    // heights are at the pixel centers, so positions within half a pixel of the edge use the edge pixel
+    double x = glm::clamp((point.longitude - rectangle.getWest()) / gapX - 0.5, 0.0, maxX);
+    double y = glm::clamp((rectangle.getNorth() - point.latitude) / gapY - 0.5, 0.0, maxY);
+    size_t column = static_cast<size_t>(x);
+    size_t row = static_cast<size_t>(y);
+    size_t nextColumn = glm::min(column + 1, m_width - 1);
+    size_t nextRow = glm::min(row + 1, m_height - 1);
+    double tx = x - static_cast<double>(column);
+    double ty = y - static_cast<double>(row);
+
+    double top = glm::mix(static_cast<double>(m_heights[row * m_width + column]),
+                          static_cast<double>(m_heights[row * m_width + nextColumn]),
+                          tx);
+    double bottom = glm::mix(static_cast<double>(m_heights[nextRow * m_width + column]),
+                             static_cast<double>(m_heights[nextRow * m_width + nextColumn]),
+                             tx);
+
+    return glm::mix(top, bottom, ty);
+}
+
+std::optional<ElevationGrid> ElevationGrid::createFromFile(const std::filesystem::path &file)
+{
+    GDALDatasetUniquePtr rasterData = GDALDatasetUniquePtr(
+        (GDALDataset *) GDALOpen(file.c_str(), GDALAccess::GA_ReadOnly));
+    if (rasterData == nullptr || rasterData->GetRasterCount() < 1) {
+        return std::nullopt;
+    }
+
+    auto heightBand = rasterData->GetRasterBand(1);
+    int rasterXSize = heightBand->GetXSize();
+    int rasterYSize = heightBand->GetYSize();
+    if (rasterXSize <= 0 || rasterYSize <= 0) {
+        return std::nullopt;
+    }
+
+    size_t width = static_cast<size_t>(rasterXSize);
+    size_t height = static_cast<size_t>(rasterYSize);
+    std::vector<float> heights(width * height);
+    if (heightBand->RasterIO(GDALRWFlag::GF_Read,
+                             0,
+                             0,
+                             rasterXSize,
+                             rasterYSize,
+                             heights.data(),
+                             rasterXSize,
+                             rasterYSize,
+                             GDALDataType::GDT_Float32,
+                             0,
+                             0)
+        != CE_None) {
+        return std::nullopt;
+    }
+
+    return ElevationGrid(width, height, std::move(heights));
+}
+
+ElevationSampler::ElevationSampler(const std::filesystem::path &CDBPath, size_t cacheSizeInBytes)
+    : m_CDBPath{CDBPath}
+    , m_cacheSizeInBytes{cacheSizeInBytes}
+    , m_cachedBytes{0}
+    , m_peakCachedBytes{0}
+    , m_hitCount{0}
+    , m_missCount{0}
+    , m_bilinear{false}
+{}
+
+void ElevationSampler::setCacheSizeInBytes(size_t cacheSizeInBytes)
+{
+    m_cacheSizeInBytes = cacheSizeInBytes;
+    evict();
+}
+
+std::shared_ptr<const ElevationGrid> ElevationSampler::getGrid(const CDBTile &elevationTile)
+{
+    auto gridIndex = m_gridIndices.find(elevationTile);
+    if (gridIndex != m_gridIndices.end()) {
+        ++m_hitCount;
+        m_grids.splice(m_grids.begin(), m_grids, gridIndex->second);
+        return gridIndex->second->second;
+    }
+
+    ++m_missCount;
+    std::shared_ptr<const ElevationGrid> grid;
+    auto elevationFile = m_CDBPath / (elevationTile.getRelativePath().string() + ".tif");
+    auto decodedGrid = ElevationGrid::createFromFile(elevationFile);
+    if (decodedGrid) {
+        grid = std::make_shared<const ElevationGrid>(std::move(*decodedGrid));
+    }
+
+    cacheGrid(elevationTile, grid);
+
+    return grid;
+}
+
+void ElevationSampler::insertGrid(const CDBTile &elevationTile, std::shared_ptr<const ElevationGrid> grid)
+{
+    auto gridIndex = m_gridIndices.find(elevationTile);
+    if (gridIndex != m_gridIndices.end()) {
+        if (gridIndex->second->second) {
+            m_cachedBytes -= gridIndex->second->second->getSizeInBytes();
+        }
+
+        m_cachedBytes -= GRID_ENTRY_SIZE;
+        m_grids.erase(gridIndex->second);
+        m_gridIndices.erase(gridIndex);
+    }
+
+    cacheGrid(elevationTile, std::move(grid));
+}
+
+bool ElevationSampler::sampleHeights(const CDBTile &elevationTile,
+                                     std::vector<Core::Cartographic> &points,
+                                     const std::vector<size_t> &indices)
+{
+    auto grid = getGrid(elevationTile);
+    if (grid == nullptr) {
+        return false;
+    }
+
+    const auto &rectangle = elevationTile.getBoundRegion().getRectangle();
+    for (auto i : indices) {
+        points[i].height = sample(*grid, rectangle, points[i]);
+    }
+
+    return true;
+}
+
+bool ElevationSampler::sampleHeights(const CDBTile &elevationTile, std::vector<Core::Cartographic> &points)
+{
+    auto grid = getGrid(elevationTile);
+    if (grid == nullptr) {
+        return false;
+    }
+
+    const auto &rectangle = elevationTile.getBoundRegion().getRectangle();
+    for (auto &point : points) {
+        point.height = sample(*grid, rectangle, point);
+    }
+
+    return true;
+}
+
+double ElevationSampler::sample(const ElevationGrid &grid,
+                                const Core::GlobeRectangle &rectangle,
+                                const Core::Cartographic &point) const
+{
+    if (m_bilinear) {
+        return grid.sampleBilinear(rectangle, point);
+    }
+
+    return grid.sampleNearest(rectangle, point);
+}
+
+void ElevationSampler::cacheGrid(const CDBTile &elevationTile, std::shared_ptr<const ElevationGrid> grid)
+{
+    if (grid) {
+        m_cachedBytes += grid->getSizeInBytes();
+    }
+
+    m_cachedBytes += GRID_ENTRY_SIZE;
+    m_grids.emplace_front(elevationTile, std::move(grid));
+    m_gridIndices.insert({elevationTile, m_grids.begin()});
+    evict();
+    m_peakCachedBytes = std::max(m_peakCachedBytes, m_cachedBytes);
+}
+
+void ElevationSampler::trim(size_t targetBytes)
+{
+    while (m_cachedBytes > targetBytes && !m_grids.empty()) {
+        dropLeastRecentlyUsed();
+    }
+}
+
+void ElevationSampler::evict()
+{
+    // the grid just added is always kept, even when it alone is over the budget
+    while (m_cachedBytes > m_cacheSizeInBytes && m_grids.size() > 1) {
+        dropLeastRecentlyUsed();
+    }
+}
+
+void ElevationSampler::dropLeastRecentlyUsed()
+{
+    const auto &leastRecentlyUsed = m_grids.back();
+    if (leastRecentlyUsed.second) {
+        m_cachedBytes -= leastRecentlyUsed.second->getSizeInBytes();
+    }
+
+    m_cachedBytes -= GRID_ENTRY_SIZE;
+    m_gridIndices.erase(leastRecentlyUsed.first);
+    m_grids.pop_back();
+}
+} // namespace CDBTo3DTiles
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "CDBTile.h"
+#include "Cartographic.h"
+#include <cstddef>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace CDBTo3DTiles {
+// Heights of an elevation raster decoded once, stored row by row from the north edge like the raster itself
+class ElevationGrid
+{
+public:
+    ElevationGrid(size_t width, size_t height, std::vector<float> heights);
+
+    inline size_t getWidth() const noexcept { return m_width; }
+
+    inline size_t getHeight() const noexcept { return m_height; }
+
+    inline const std::vector<float> &getHeights() const noexcept { return m_heights; }
+
+    inline size_t getSizeInBytes() const noexcept { return m_heights.size() * sizeof(float); }
+
+    // Height of the pixel the point falls in. Points outside the rectangle use the closest edge pixel
+    double sampleNearest(const Core::GlobeRectangle &rectangle, const Core::Cartographic &point) const;
+
+    // Height interpolated between the centers of the four pixels around the point
+    double sampleBilinear(const Core::GlobeRectangle &rectangle, const Core::Cartographic &point) const;
+
+    static std::optional<ElevationGrid> createFromFile(const std::filesystem::path &file);
+
+private:
+    size_t m_width;
+    size_t m_height;
+    std::vector<float> m_heights;
+};
+
+// Samples the heights of points from CDB elevation tiles. Every tile is decoded once into a grid, and grids
+// are kept in a least recently used cache bounded by their size in bytes. Batches of points on the same tile
+// are read straight from the grid instead of one raster read per point
+class ElevationSampler
+{
+public:
+    ElevationSampler(const std::filesystem::path &CDBPath, size_t cacheSizeInBytes);
+
+    inline void setBilinear(bool bilinear) noexcept { m_bilinear = bilinear; }
+
+    inline bool isBilinear() const noexcept { return m_bilinear; }
+
+    void setCacheSizeInBytes(size_t cacheSizeInBytes);
+
+    inline size_t getCacheSizeInBytes() const noexcept { return m_cacheSizeInBytes; }
+
+    inline size_t getCachedBytes() const noexcept { return m_cachedBytes; }
+
+    inline size_t getPeakCachedBytes() const noexcept { return m_peakCachedBytes; }
+
+    inline size_t getCachedGridCount() const noexcept { return m_grids.size(); }
+
+    inline size_t getHitCount() const noexcept { return m_hitCount; }
+
+    inline size_t getMissCount() const noexcept { return m_missCount; }
+
+    // Returns nullptr if the tile has no readable elevation. The grid stays valid after it leaves the cache
+    std::shared_ptr<const ElevationGrid> getGrid(const CDBTile &elevationTile);
+
+    // Caches a grid decoded somewhere else, such as by the elevation conversion. It counts as neither a hit
+    // nor a miss
+    void insertGrid(const CDBTile &elevationTile, std::shared_ptr<const ElevationGrid> grid);
+
+    // Sets the height of the points at the given indices. Returns false and leaves the points untouched if
+    // the tile has no readable elevation
+    bool sampleHeights(const CDBTile &elevationTile,
+                       std::vector<Core::Cartographic> &points,
+                       const std::vector<size_t> &indices);
+
+    bool sampleHeights(const CDBTile &elevationTile, std::vector<Core::Cartographic> &points);
+
+    // Drops least recently used grids until the cache holds at most the given bytes, without changing its
+    // size. Used to give memory back under pressure
+    void trim(size_t targetBytes);
+
+    static const size_t DEFAULT_CACHE_SIZE;
+
+private:
+    using CacheEntry = std::pair<CDBTile, std::shared_ptr<const ElevationGrid>>;
+
+    double sample(const ElevationGrid &grid,
+                  const Core::GlobeRectangle &rectangle,
+                  const Core::Cartographic &point) const;
+
+    void cacheGrid(const CDBTile &elevationTile, std::shared_ptr<const ElevationGrid> grid);
+
+    void evict();
+
+    void dropLeastRecentlyUsed();
+
+    std::filesystem::path m_CDBPath;
+    size_t m_cacheSizeInBytes;
+    size_t m_cachedBytes;
+    size_t m_peakCachedBytes;
+    size_t m_hitCount;
+    size_t m_missCount;
+    bool m_bilinear;
+    std::list<CacheEntry> m_grids;
+    std::unordered_map<CDBTile, std::list<CacheEntry>::iterator> m_gridIndices;
+};
+} // namespace CDBTo3DTiles
@@ -0,0 +1,231 @@
+#include "FilePrefetcher.h"
+#include "cpl_vsi.h"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+
+namespace CDBTo3DTiles {
+
+static const std::string GDAL_PATH_PREFIX = "/vsimem/prefetch/";
+
+static std::atomic<uint64_t> nextGDALPathId{0};
+
+PrefetchedFile::PrefetchedFile(const std::filesystem::path &file, std::vector<uint8_t> data)
+    : m_file{file}
+    , m_data{std::move(data)}
+{}
+
+PrefetchedFile::PrefetchedFile(PrefetchedFile &&other) noexcept
+    : m_file{std::move(other.m_file)}
+    , m_data{std::move(other.m_data)}
+    , m_GDALPath{std::move(other.m_GDALPath)}
+{
+    // the moved buffer keeps its address, so the registered in-memory file stays valid
+    other.m_GDALPath.clear();
+}
+
+PrefetchedFile::~PrefetchedFile() noexcept
+{
+    unregister();
+}
+
+PrefetchedFile &PrefetchedFile::operator=(PrefetchedFile &&other) noexcept
+{
+    if (&other != this) {
+        unregister();
+        m_file = std::move(other.m_file);
+        m_data = std::move(other.m_data);
+        m_GDALPath = std::move(other.m_GDALPath);
+        other.m_GDALPath.clear();
+    }
+
+    return *this;
+}
+
+std::vector<uint8_t> PrefetchedFile::releaseData() noexcept
+{
+    unregister();
+    return std::move(m_data);
+}
+
+const std::string &PrefetchedFile::getGDALPath()
+{
+    if (m_GDALPath.empty()) {
+        // keep the file name, GDAL picks drivers by extension
+        m_GDALPath = GDAL_PATH_PREFIX + std::to_string(nextGDALPathId++) + "/" + m_file.filename().string();
+        VSILFILE *file = VSIFileFromMemBuffer(m_GDALPath.c_str(),
+                                              m_data.data(),
+                                              static_cast<vsi_l_offset>(m_data.size()),
+                                              false);
+        if (file) {
+            VSIFCloseL(file);
+        }
+    }
+
+    return m_GDALPath;
+}
+
+void PrefetchedFile::unregister() noexcept
+{
+    if (!m_GDALPath.empty()) {
+        VSIUnlink(m_GDALPath.c_str());
+        m_GDALPath.clear();
+    }
+}
+
+FilePrefetcher::FilePrefetcher(size_t threadCount)
+    : m_stopping{false}
+    , m_hitCount{0}
+    , m_waitCount{0}
+    , m_missCount{0}
+    , m_discardCount{0}
+    , m_bytesTaken{0}
+    , m_peakPendingCount{0}
+{
+    threadCount = std::max<size_t>(threadCount, 1);
+    m_threads.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        m_threads.emplace_back(&FilePrefetcher::work, this);
+    }
+}
+
+FilePrefetcher::~FilePrefetcher() noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+
+    m_queueCondition.notify_all();
+    for (auto &thread : m_threads) {
+        thread.join();
+    }
+}
+
+void FilePrefetcher::prefetch(const std::filesystem::path &file)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto entry = m_entries.find(file.string());
+        if (entry != m_entries.end()) {
+            // a file discarded while it was read is wanted again
+            entry->second.discarded = false;
+            return;
+        }
+
+        m_entries.emplace(file.string(), Entry());
+        m_queue.emplace_back(file);
+        m_peakPendingCount = std::max(m_peakPendingCount, m_entries.size());
+    }
+
+    m_queueCondition.notify_one();
+}
+
+std::optional<PrefetchedFile> FilePrefetcher::take(const std::filesystem::path &file)
+{
+    std::string key = file.string();
+    std::unique_lock<std::mutex> lock(m_mutex);
+    auto entry = m_entries.find(key);
+
+    // the caller reads a file nobody started on sooner than the threads reach it behind the queued files.
+    // A file discarded while it is read is dropped by its thread, or found gone
+    if (entry == m_entries.end() || !entry->second.started || entry->second.discarded) {
+        if (entry != m_entries.end()) {
+            m_entries.erase(entry);
+        }
+
+        ++m_missCount;
+        return std::nullopt;
+    }
+
+    bool waited = !entry->second.done;
+    m_doneCondition.wait(lock, [&]() { return m_entries.at(key).done; });
+
+    entry = m_entries.find(key);
+    std::optional<PrefetchedFile> prefetchedFile;
+    if (entry->second.failed) {
+        ++m_missCount;
+    } else {
+        m_bytesTaken += entry->second.data.size();
+        ++(waited ? m_waitCount : m_hitCount);
+        prefetchedFile.emplace(file, std::move(entry->second.data));
+    }
+
+    m_entries.erase(entry);
+    return prefetchedFile;
+}
+
+void FilePrefetcher::discard(const std::filesystem::path &file)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto entry = m_entries.find(file.string());
+    if (entry == m_entries.end()) {
+        return;
+    }
+
+    ++m_discardCount;
+
+    // the thread reading the file drops it once it is done
+    if (entry->second.started && !entry->second.done) {
+        entry->second.discarded = true;
+    } else {
+        m_entries.erase(entry);
+    }
+}
+
+void FilePrefetcher::work()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_queueCondition.wait(lock, [this]() { return m_stopping || !m_queue.empty(); });
+        if (m_stopping) {
+            return;
+        }
+
+        std::filesystem::path file = std::move(m_queue.front());
+        m_queue.pop_front();
+
+        // files taken or discarded before they were started are left in the queue
+        std::string key = file.string();
+        auto entry = m_entries.find(key);
+        if (entry == m_entries.end() || entry->second.started) {
+            continue;
+        }
+
+        entry->second.started = true;
+        lock.unlock();
+        std::vector<uint8_t> data;
+        bool isRead = readFile(file, data);
+        lock.lock();
+
+        // the file may have been taken or discarded meanwhile, and queued again after that
+        entry = m_entries.find(key);
+        if (entry == m_entries.end() || !entry->second.started) {
+            continue;
+        }
+
+        if (entry->second.discarded) {
+            m_entries.erase(entry);
+            continue;
+        }
+
+        entry->second.done = true;
+        entry->second.failed = !isRead;
+        entry->second.data = std::move(data);
+        m_doneCondition.notify_all();
+    }
+}
+
+bool FilePrefetcher::readFile(const std::filesystem::path &file, std::vector<uint8_t> &data)
+{
+    std::ifstream fs(file, std::ios::binary | std::ios::ate);
+    if (!fs) {
+        return false;
+    }
+
+    data.resize(static_cast<size_t>(fs.tellg()));
+    fs.seekg(0, std::ios::beg);
+    fs.read(reinterpret_cast<char *>(data.data()), static_cast<std::streamsize>(data.size()));
+    return static_cast<bool>(fs);
+}
+} // namespace CDBTo3DTiles
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace CDBTo3DTiles {
+// The content of a file read ahead by FilePrefetcher. GDAL opens it by the path of an in-memory file, which
+// stays registered for as long as this object lives
+class PrefetchedFile
+{
+public:
+    PrefetchedFile(const std::filesystem::path &file, std::vector<uint8_t> data);
+
+    PrefetchedFile(const PrefetchedFile &) = delete;
+
+    PrefetchedFile(PrefetchedFile &&other) noexcept;
+
+    ~PrefetchedFile() noexcept;
+
+    PrefetchedFile &operator=(const PrefetchedFile &) = delete;
+
+    PrefetchedFile &operator=(PrefetchedFile &&other) noexcept;
+
+    inline const std::filesystem::path &getFile() const noexcept { return m_file; }
+
+    inline const std::vector<uint8_t> &getData() const noexcept { return m_data; }
+
+    // Hands the content over, e.g. to a MappedFile. The in-memory file is unregistered
+    std::vector<uint8_t> releaseData() noexcept;
+
+    // Registers the content as an in-memory file on the first call and returns its path
+    const std::string &getGDALPath();
+
+private:
+    void unregister() noexcept;
+
+    std::filesystem::path m_file;
+    std::vector<uint8_t> m_data;
+    std::string m_GDALPath;
+};
+
+// Reads files on background threads ahead of their use, so the converter decodes one tile while the files
+// of the next tiles are read from disk. Files are read whole into memory, and are held until they are taken
+// or discarded
+class FilePrefetcher
+{
+public:
+    explicit FilePrefetcher(size_t threadCount);
+
+    FilePrefetcher(const FilePrefetcher &) = delete;
+
+    FilePrefetcher &operator=(const FilePrefetcher &) = delete;
+
+    ~FilePrefetcher() noexcept;
+
+    // Queues the file to be read. Files queued already are left alone
+    void prefetch(const std::filesystem::path &file);
+
+    // Hands over a prefetched file, waiting for it if it is being read. Returns nothing for files that were
+    // not prefetched, not read yet or could not be read, which the caller then reads itself
+    std::optional<PrefetchedFile> take(const std::filesystem::path &file);
+
+    // Drops a prefetched file that was not used
+    void discard(const std::filesystem::path &file);
+
+    inline size_t getThreadCount() const noexcept { return m_threads.size(); }
+
+    // Files taken after they were read
+    inline size_t getHitCount() const noexcept { return m_hitCount; }
+
+    // Files taken while they were being read
+    inline size_t getWaitCount() const noexcept { return m_waitCount; }
+
+    // Files asked for that were not ready to take
+    inline size_t getMissCount() const noexcept { return m_missCount; }
+
+    // Files read ahead that were discarded without being taken
+    inline size_t getDiscardCount() const noexcept { return m_discardCount; }
+
+    inline uint64_t getBytesTaken() const noexcept { return m_bytesTaken; }
+
+    // The most files queued or held at once
+    inline size_t getPeakPendingCount() const noexcept { return m_peakPendingCount; }
+
+private:
+    struct Entry
+    {
+        bool started = false;
+        bool done = false;
+        bool failed = false;
+        bool discarded = false;
+        std::vector<uint8_t> data;
+    };
+
+    void work();
+
+    static bool readFile(const std::filesystem::path &file, std::vector<uint8_t> &data);
+
+    std::mutex m_mutex;
+    std::condition_variable m_queueCondition;
+    std::condition_variable m_doneCondition;
+    std::deque<std::filesystem::path> m_queue;
+    std::unordered_map<std::string, Entry> m_entries;
+    std::vector<std::thread> m_threads;
+    bool m_stopping;
+    size_t m_hitCount;
+    size_t m_waitCount;
+    size_t m_missCount;
+    size_t m_discardCount;
+    uint64_t m_bytesTaken;
+    size_t m_peakPendingCount;
+};
+} // namespace CDBTo3DTiles
@@ -0,0 +1,131 @@
+#include "MappedFile.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#endif
+
+namespace CDBTo3DTiles {
+
+MappedFile::MappedFile(const uint8_t *data, size_t size, bool mapped) noexcept
+    : m_data{data}
+    , m_size{size}
+    , m_mapped{mapped}
+{}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : m_data{other.m_data}
+    , m_size{other.m_size}
+    , m_mapped{other.m_mapped}
+    , m_buffer{std::move(other.m_buffer)}
+{
+    if (!m_mapped) {
+        m_data = m_buffer.data();
+    }
+
+    other.m_data = nullptr;
+    other.m_size = 0;
+    other.m_mapped = false;
+}
+
+MappedFile::~MappedFile() noexcept
+{
+    release();
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+{
+    if (&other != this) {
+        release();
+        m_data = other.m_data;
+        m_size = other.m_size;
+        m_mapped = other.m_mapped;
+        m_buffer = std::move(other.m_buffer);
+        if (!m_mapped) {
+            m_data = m_buffer.data();
+        }
+
+        other.m_data = nullptr;
+        other.m_size = 0;
+        other.m_mapped = false;
+    }
+
+    return *this;
+}
+
+void MappedFile::release() noexcept
+{
+#ifndef _WIN32
+    if (m_mapped && m_data) {
+        munmap(const_cast<uint8_t *>(m_data), m_size);
+    }
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+    m_mapped = false;
+    m_buffer.clear();
+}
+
+std::optional<MappedFile> MappedFile::createFromFile(const std::filesystem::path &file)
+{
+#ifndef _WIN32
+    int fd = open(file.c_str(), O_RDONLY);
+    if (fd == -1) {
+        return std::nullopt;
+    }
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) == -1) {
+        close(fd);
+        return std::nullopt;
+    }
+
+    size_t size = static_cast<size_t>(fileStat.st_size);
+    if (size == 0) {
+        close(fd);
+        return MappedFile(nullptr, 0, false);
+    }
+
+    void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // the mapping keeps its own reference to the file
+    close(fd);
+    if (data == MAP_FAILED) {
+        return std::nullopt;
+    }
+
+    // attribute and geometry files are decoded front to back
+    madvise(data, size, MADV_SEQUENTIAL);
+
+    return MappedFile(static_cast<const uint8_t *>(data), size, true);
+#else
+    std::ifstream fs(file, std::ios::binary | std::ios::ate);
+    if (!fs) {
+        return std::nullopt;
+    }
+
+    MappedFile mappedFile(nullptr, 0, false);
+    mappedFile.m_buffer.resize(static_cast<size_t>(fs.tellg()));
+    fs.seekg(0, std::ios::beg);
+    fs.read(reinterpret_cast<char *>(mappedFile.m_buffer.data()),
+            static_cast<std::streamsize>(mappedFile.m_buffer.size()));
+    mappedFile.m_data = mappedFile.m_buffer.data();
+    mappedFile.m_size = mappedFile.m_buffer.size();
+    return mappedFile;
+#endif
+}
+
+MappedFile MappedFile::createFromBuffer(std::vector<uint8_t> buffer)
+{
+    MappedFile mappedFile(nullptr, 0, false);
+    mappedFile.m_buffer = std::move(buffer);
+    mappedFile.m_data = mappedFile.m_buffer.data();
+    mappedFile.m_size = mappedFile.m_buffer.size();
+    return mappedFile;
+}
+} // namespace CDBTo3DTiles
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+namespace CDBTo3DTiles {
+class MappedFile
+{
+public:
+    MappedFile(const MappedFile &) = delete;
+
+    MappedFile(MappedFile &&other) noexcept;
+
+    ~MappedFile() noexcept;
+
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    MappedFile &operator=(MappedFile &&other) noexcept;
+
+    inline const uint8_t *getData() const noexcept { return m_data; }
+
+    inline size_t getSize() const noexcept { return m_size; }
+
+    static std::optional<MappedFile> createFromFile(const std::filesystem::path &file);
+
+    // Wraps content already read into memory, so it is decoded like a file mapped from disk
+    static MappedFile createFromBuffer(std::vector<uint8_t> buffer);
+
+private:
+    MappedFile(const uint8_t *data, size_t size, bool mapped) noexcept;
+
+    void release() noexcept;
+
+    const uint8_t *m_data;
+    size_t m_size;
+    bool m_mapped;
+    std::vector<uint8_t> m_buffer;
+};
+} // namespace CDBTo3DTiles
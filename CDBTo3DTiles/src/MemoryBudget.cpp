@@ -0,0 +1,148 @@
+#include "MemoryBudget.h"
+#include <algorithm>
+#include <fstream>
+#include <limits>
+
+#if defined(__APPLE__)
+#include <mach/mach.h>
+#elif defined(__linux__)
+#include <unistd.h>
+#endif
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+namespace CDBTo3DTiles {
+
+// part of the budget the caches are shrunk down to, so the next tiles don't go over it again right away
+static const double LOW_WATER_FRACTION = 0.9;
+
+MemoryBudget::MemoryBudget(size_t budgetInBytes, MeasureFunction measureUsedBytes)
+    : m_budgetInBytes{budgetInBytes}
+    , m_lowWaterBytes{static_cast<size_t>(static_cast<double>(budgetInBytes) * LOW_WATER_FRACTION)}
+    , m_measureUsedBytes{std::move(measureUsedBytes)}
+    , m_shrunkUsedBytes{0}
+    , m_pressureCount{0}
+    , m_peakUsedBytes{0}
+{}
+
+size_t MemoryBudget::getShare(double fraction) const
+{
+    if (!isLimited()) {
+        return std::numeric_limits<size_t>::max();
+    }
+
+    return static_cast<size_t>(static_cast<double>(m_budgetInBytes) * fraction);
+}
+
+void MemoryBudget::addConsumer(const std::string &name, MeasureFunction measure, ShrinkFunction shrink)
+{
+    m_consumers.push_back({name, std::move(measure), std::move(shrink)});
+}
+
+size_t MemoryBudget::getConsumedBytes() const
+{
+    size_t consumedBytes = 0;
+    for (const auto &consumer : m_consumers) {
+        consumedBytes += consumer.measure();
+    }
+
+    return consumedBytes;
+}
+
+size_t MemoryBudget::getUsedBytes() const
+{
+    if (m_measureUsedBytes) {
+        return m_measureUsedBytes();
+    }
+
+    auto anonymousResidentSize = static_cast<size_t>(getAnonymousResidentSize());
+    if (anonymousResidentSize == 0) {
+        return getConsumedBytes();
+    }
+
+    return anonymousResidentSize;
+}
+
+bool MemoryBudget::enforce()
+{
+    if (!isLimited()) {
+        return true;
+    }
+
+    size_t usedBytes = getUsedBytes();
+    m_peakUsedBytes = std::max(m_peakUsedBytes, usedBytes);
+    if (usedBytes <= m_budgetInBytes) {
+        m_shrunkUsedBytes = 0;
+        return true;
+    }
+
+    // what was left over the budget after the last shrink is held outside of the caches
+    if (usedBytes <= m_shrunkUsedBytes + (m_budgetInBytes - m_lowWaterBytes)) {
+        return false;
+    }
+
+    ++m_pressureCount;
+
+    // shrink the largest consumers first, so the small caches that are cheap to keep survive
+    std::vector<std::pair<size_t, const Consumer *>> consumers;
+    consumers.reserve(m_consumers.size());
+    for (const auto &consumer : m_consumers) {
+        consumers.emplace_back(consumer.measure(), &consumer);
+    }
+
+    std::sort(consumers.begin(), consumers.end(), [](const auto &lhs, const auto &rhs) {
+        return lhs.first > rhs.first;
+    });
+
+    size_t excessBytes = usedBytes - m_lowWaterBytes;
+    for (const auto &consumer : consumers) {
+        if (excessBytes == 0) {
+            break;
+        }
+
+        size_t releasedBytes = std::min(consumer.first, excessBytes);
+        consumer.second->shrink(consumer.first - releasedBytes);
+        excessBytes -= releasedBytes;
+    }
+
+#ifdef __GLIBC__
+    // freed memory stays in the heap of the process unless it is handed back
+    if (excessBytes < usedBytes - m_lowWaterBytes) {
+        malloc_trim(0);
+    }
+#endif
+
+    m_shrunkUsedBytes = getUsedBytes();
+    return m_shrunkUsedBytes <= m_budgetInBytes;
+}
+
+uint64_t MemoryBudget::getAnonymousResidentSize()
+{
+#if defined(__APPLE__)
+    // the footprint leaves out clean pages of mapped files
+    task_vm_info_data_t info;
+    mach_msg_type_number_t count = TASK_VM_INFO_COUNT;
+    if (task_info(mach_task_self(), TASK_VM_INFO, reinterpret_cast<task_info_t>(&info), &count)
+        != KERN_SUCCESS) {
+        return 0;
+    }
+
+    return static_cast<uint64_t>(info.phys_footprint);
+#elif defined(__linux__)
+    // the second field is the resident size and the third the resident pages backed by files, in pages
+    std::ifstream fs("/proc/self/statm");
+    uint64_t totalPages = 0;
+    uint64_t residentPages = 0;
+    uint64_t sharedPages = 0;
+    if (!(fs >> totalPages >> residentPages >> sharedPages) || sharedPages > residentPages) {
+        return 0;
+    }
+
+    return (residentPages - sharedPages) * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+#else
+    return 0;
+#endif
+}
+} // namespace CDBTo3DTiles
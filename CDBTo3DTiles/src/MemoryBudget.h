@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace CDBTo3DTiles {
+// Keeps the converter within a memory budget. The caches register how to measure and shrink themselves, and
+// whenever the anonymous resident memory of the process goes over the budget they are shrunk, largest first,
+// until the process is back at the low-water mark below the budget. Pages of mapped input files are not
+// counted, since the kernel drops them by itself. After a shrink the caches are only shrunk again once the
+// process has grown by the gap between the budget and the low-water mark, so memory the caches can't give
+// back doesn't shrink them on every call. A budget of 0 is unlimited
+class MemoryBudget
+{
+public:
+    using MeasureFunction = std::function<size_t()>;
+
+    // Drops entries until the consumer holds at most the given bytes
+    using ShrinkFunction = std::function<void(size_t targetBytes)>;
+
+    // The used bytes are the anonymous resident memory of the process unless another measure is given
+    explicit MemoryBudget(size_t budgetInBytes, MeasureFunction measureUsedBytes = nullptr);
+
+    inline size_t getBudgetInBytes() const noexcept { return m_budgetInBytes; }
+
+    inline bool isLimited() const noexcept { return m_budgetInBytes != 0; }
+
+    // The part of the budget a cache is sized to. Unlimited budgets give unlimited shares
+    size_t getShare(double fraction) const;
+
+    void addConsumer(const std::string &name, MeasureFunction measure, ShrinkFunction shrink);
+
+    // Bytes held by all consumers
+    size_t getConsumedBytes() const;
+
+    // The anonymous resident memory of the process, or the bytes held by the consumers where the platform
+    // doesn't report it
+    size_t getUsedBytes() const;
+
+    // Returns false if the process is still over the budget after every consumer was shrunk
+    bool enforce();
+
+    inline size_t getPressureCount() const noexcept { return m_pressureCount; }
+
+    inline size_t getPeakUsedBytes() const noexcept { return m_peakUsedBytes; }
+
+    // Resident memory that isn't backed by a file. Returns 0 where the platform doesn't report it
+    static uint64_t getAnonymousResidentSize();
+
+private:
+    struct Consumer
+    {
+        std::string name;
+        MeasureFunction measure;
+        ShrinkFunction shrink;
+    };
+
+    size_t m_budgetInBytes;
+    size_t m_lowWaterBytes;
+    MeasureFunction m_measureUsedBytes;
+    size_t m_shrunkUsedBytes;
+    size_t m_pressureCount;
+    size_t m_peakUsedBytes;
+    std::vector<Consumer> m_consumers;
+};
+} // namespace CDBTo3DTiles
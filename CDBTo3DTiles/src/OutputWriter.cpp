@@ -0,0 +1,360 @@
+#include "OutputWriter.h"
+#include "cpl_vsi.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <set>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#endif
+
+namespace CDBTo3DTiles {
+
+// images gain nothing from being compressed again
+static const std::unordered_set<std::string> COMPRESSED_EXTENSIONS = {".jpeg", ".jpg", ".png", ".jp2"};
+
+static std::atomic<uint64_t> nextGzipId{0};
+
+const std::string OutputWriter::GZIP_EXTENSION = ".gz";
+
+#ifdef __linux__
+// larger files get their blocks reserved before they are written, so they are laid out in one extent
+static const size_t PREALLOCATE_THRESHOLD = 1024 * 1024;
+#endif
+
+OutputWriter::OutputWriter(size_t threadCount, size_t maxPendingBytes)
+    : m_maxPendingBytes{maxPendingBytes}
+    , m_pendingBytes{0}
+    , m_fileCount{0}
+    , m_bytesWritten{0}
+    , m_stallCount{0}
+    , m_gzipFileCount{0}
+    , m_gzipBytesIn{0}
+    , m_gzipBytesOut{0}
+    , m_syncFiles{false}
+    , m_gzipFiles{false}
+    , m_stopping{false}
+{
+    threadCount = std::max<size_t>(threadCount, 1);
+    m_threads.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        m_threads.emplace_back(&OutputWriter::work, this);
+    }
+}
+
+OutputWriter::~OutputWriter() noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+
+    m_queueCondition.notify_all();
+    for (auto &thread : m_threads) {
+        thread.join();
+    }
+}
+
+void OutputWriter::write(const std::filesystem::path &file, std::string content)
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        // a file larger than the limit is still taken once nothing else is pending
+        size_t size = content.size();
+        auto isRoomLeft = [&]() { return m_pendingBytes == 0 || m_pendingBytes + size <= m_maxPendingBytes; };
+        if (!isRoomLeft()) {
+            ++m_stallCount;
+            m_doneCondition.wait(lock, isRoomLeft);
+        }
+
+        m_pendingBytes += size;
+        m_queue.push_back({file, std::move(content)});
+    }
+
+    m_queueCondition.notify_one();
+}
+
+void OutputWriter::drain(size_t targetBytes)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_doneCondition.wait(lock, [&]() { return m_pendingBytes <= targetBytes; });
+}
+
+void OutputWriter::waitForFile(const std::filesystem::path &file)
+{
+    std::string key = file.string();
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_doneCondition.wait(lock, [&]() {
+        return m_writingFiles.find(key) == m_writingFiles.end()
+               && std::none_of(m_queue.begin(), m_queue.end(), [&](const PendingFile &pending) {
+                      return pending.file == file;
+                  });
+    });
+}
+
+void OutputWriter::flush()
+{
+    std::vector<std::filesystem::path> unsyncedFiles;
+    std::vector<std::string> errors;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_doneCondition.wait(lock, [this]() { return m_queue.empty() && m_writingFiles.empty(); });
+        unsyncedFiles.swap(m_unsyncedFiles);
+        errors.swap(m_errors);
+    }
+
+    // new files are only durable once the directories naming them are synced as well
+    std::set<std::filesystem::path> directories;
+    for (const auto &file : unsyncedFiles) {
+        if (!syncFile(file)) {
+            errors.emplace_back("Cannot sync " + file.string());
+        }
+
+        directories.insert(file.parent_path());
+    }
+
+    for (const auto &directory : directories) {
+        syncFile(directory);
+    }
+
+    if (!errors.empty()) {
+        std::string message = errors.front();
+        if (errors.size() > 1) {
+            message += " and " + std::to_string(errors.size() - 1) + " other files";
+        }
+
+        throw std::runtime_error(message);
+    }
+}
+
+size_t OutputWriter::getPendingBytes() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pendingBytes;
+}
+
+size_t OutputWriter::getFileCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_fileCount;
+}
+
+uint64_t OutputWriter::getBytesWritten() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_bytesWritten;
+}
+
+size_t OutputWriter::getDirectoryCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_createdDirectories.size();
+}
+
+size_t OutputWriter::getStallCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stallCount;
+}
+
+size_t OutputWriter::getGzipFileCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_gzipFileCount;
+}
+
+uint64_t OutputWriter::getGzipBytesIn() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_gzipBytesIn;
+}
+
+uint64_t OutputWriter::getGzipBytesOut() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_gzipBytesOut;
+}
+
+void OutputWriter::work()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        // a file is left in the queue while another thread writes an earlier content of it
+        auto pendingFile = m_queue.end();
+        m_queueCondition.wait(lock, [&]() {
+            pendingFile = std::find_if(m_queue.begin(), m_queue.end(), [this](const PendingFile &pending) {
+                return m_writingFiles.find(pending.file.string()) == m_writingFiles.end();
+            });
+            return pendingFile != m_queue.end() || (m_stopping && m_queue.empty());
+        });
+
+        if (pendingFile == m_queue.end()) {
+            return;
+        }
+
+        PendingFile pending = std::move(*pendingFile);
+        m_queue.erase(pendingFile);
+        std::string key = pending.file.string();
+        bool isGzipped = m_gzipFiles && isCompressible(pending.file);
+        m_writingFiles.insert(key);
+        lock.unlock();
+
+        bool isWritten = createDirectory(pending.file.parent_path())
+                         && writeFile(pending.file, pending.content);
+
+        // the copy is compressed from the buffer just written, so the file is never read back
+        std::filesystem::path gzipFile = key + GZIP_EXTENSION;
+        std::string compressed;
+        bool isGzipWritten = isWritten && isGzipped && compressGzip(pending.content, compressed)
+                             && writeFile(gzipFile, compressed);
+
+        lock.lock();
+        m_writingFiles.erase(key);
+        m_pendingBytes -= pending.content.size();
+        if (isWritten) {
+            ++m_fileCount;
+            m_bytesWritten += pending.content.size();
+            if (m_syncFiles) {
+                m_unsyncedFiles.emplace_back(std::move(pending.file));
+            }
+        } else {
+            m_errors.emplace_back("Cannot write " + key);
+        }
+
+        if (isGzipWritten) {
+            ++m_gzipFileCount;
+            m_gzipBytesIn += pending.content.size();
+            m_gzipBytesOut += compressed.size();
+            if (m_syncFiles) {
+                m_unsyncedFiles.emplace_back(std::move(gzipFile));
+            }
+        } else if (isWritten && isGzipped) {
+            m_errors.emplace_back("Cannot compress " + key);
+        }
+
+        m_doneCondition.notify_all();
+        m_queueCondition.notify_all();
+    }
+}
+
+bool OutputWriter::createDirectory(const std::filesystem::path &directory)
+{
+    std::string key = directory.string();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (key.empty() || m_createdDirectories.find(key) != m_createdDirectories.end()) {
+            return true;
+        }
+    }
+
+    // another thread may create the same directory meanwhile
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error && !std::filesystem::is_directory(directory)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_createdDirectories.insert(key);
+    return true;
+}
+
+bool OutputWriter::writeFile(const std::filesystem::path &file, const std::string &content)
+{
+#ifndef _WIN32
+    int fd = open(file.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    if (fd < 0) {
+        return false;
+    }
+
+#ifdef __linux__
+    // unlike posix_fallocate, this doesn't fall back to writing zeros on file systems that can't reserve
+    if (content.size() >= PREALLOCATE_THRESHOLD) {
+        fallocate(fd, 0, 0, static_cast<off_t>(content.size()));
+    }
+#endif
+
+    const char *data = content.data();
+    size_t remaining = content.size();
+    while (remaining > 0) {
+        ssize_t written = ::write(fd, data, remaining);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            break;
+        }
+
+        data += written;
+        remaining -= static_cast<size_t>(written);
+    }
+
+    bool isClosed = close(fd) == 0;
+    return isClosed && remaining == 0;
+#else
+    std::ofstream fs(file, std::ios::binary);
+    fs.write(content.data(), static_cast<std::streamsize>(content.size()));
+    return static_cast<bool>(fs);
+#endif
+}
+
+bool OutputWriter::isCompressible(const std::filesystem::path &file)
+{
+    std::string extension = file.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+
+    return extension != GZIP_EXTENSION
+           && COMPRESSED_EXTENSIONS.find(extension) == COMPRESSED_EXTENSIONS.end();
+}
+
+bool OutputWriter::compressGzip(const std::string &content, std::string &compressed)
+{
+    // GDAL writes the gzip header and trailer, into a memory file private to the thread
+    std::string memoryFile = "/vsimem/gzip/" + std::to_string(nextGzipId++) + GZIP_EXTENSION;
+    VSILFILE *file = VSIFOpenL(("/vsigzip/" + memoryFile).c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+
+    bool isCompressed = VSIFWriteL(content.data(), 1, content.size(), file) == content.size();
+    isCompressed = VSIFCloseL(file) == 0 && isCompressed;
+
+    vsi_l_offset compressedSize = 0;
+    GByte *buffer = VSIGetMemFileBuffer(memoryFile.c_str(), &compressedSize, true);
+    if (!buffer) {
+        return false;
+    }
+
+    compressed.assign(reinterpret_cast<const char *>(buffer), static_cast<size_t>(compressedSize));
+    VSIFree(buffer);
+    return isCompressed;
+}
+
+bool OutputWriter::syncFile(const std::filesystem::path &file)
+{
+#ifndef _WIN32
+    int fd = open(file.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    bool isSynced = fsync(fd) == 0;
+    close(fd);
+    return isSynced;
+#else
+    // files are left to the system cache on Windows
+    (void) file;
+    return true;
+#endif
+}
+} // namespace CDBTo3DTiles
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace CDBTo3DTiles {
+// Writes output files on background threads, so the conversion hands over a complete file and goes on
+// with the next tile. Every file is written with a single write, and the directories of the files are
+// created once. Gzip copies of the files are compressed on the same threads. Failed writes are reported by
+// flush
+class OutputWriter
+{
+public:
+    // Files waiting to be written hold at most this many bytes before write waits for the threads
+    static constexpr size_t DEFAULT_MAX_PENDING_BYTES = 256 * 1024 * 1024;
+
+    static constexpr size_t DEFAULT_THREAD_COUNT = 4;
+
+    explicit OutputWriter(size_t threadCount, size_t maxPendingBytes = DEFAULT_MAX_PENDING_BYTES);
+
+    OutputWriter(const OutputWriter &) = delete;
+
+    OutputWriter &operator=(const OutputWriter &) = delete;
+
+    // Waits for the files still pending. Errors are lost, flush first to get them
+    ~OutputWriter() noexcept;
+
+    // Written files are synced to disk by flush, in one batch instead of one file at a time
+    inline void setSyncFiles(bool syncFiles) noexcept { m_syncFiles = syncFiles; }
+
+    // Every file is also written gzip compressed next to it, with .gz appended to its name, so a web server
+    // can send it as is. Images, which are compressed already, are left out
+    inline void setGzipFiles(bool gzipFiles) noexcept { m_gzipFiles = gzipFiles; }
+
+    inline size_t getThreadCount() const noexcept { return m_threads.size(); }
+
+    // Replaces the file if it exists. A file handed over again is written after the earlier content
+    void write(const std::filesystem::path &file, std::string content);
+
+    // Waits until the files waiting to be written hold at most the given bytes
+    void drain(size_t targetBytes);
+
+    // Waits until every content handed over for the file is written, or failed to be written
+    void waitForFile(const std::filesystem::path &file);
+
+    // Waits for every file handed over so far and syncs them if requested. Throws if a file couldn't be
+    // written since the last flush
+    void flush();
+
+    size_t getPendingBytes() const;
+
+    size_t getFileCount() const;
+
+    uint64_t getBytesWritten() const;
+
+    size_t getDirectoryCount() const;
+
+    // Number of times write waited because too many bytes were pending
+    size_t getStallCount() const;
+
+    size_t getGzipFileCount() const;
+
+    // Bytes of the files that were compressed, and of their gzip copies
+    uint64_t getGzipBytesIn() const;
+
+    uint64_t getGzipBytesOut() const;
+
+    static const std::string GZIP_EXTENSION;
+
+private:
+    struct PendingFile
+    {
+        std::filesystem::path file;
+        std::string content;
+    };
+
+    void work();
+
+    bool createDirectory(const std::filesystem::path &directory);
+
+    static bool writeFile(const std::filesystem::path &file, const std::string &content);
+
+    static bool syncFile(const std::filesystem::path &file);
+
+    static bool isCompressible(const std::filesystem::path &file);
+
+    static bool compressGzip(const std::string &content, std::string &compressed);
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_queueCondition;
+    std::condition_variable m_doneCondition;
+    std::deque<PendingFile> m_queue;
+    std::vector<std::thread> m_threads;
+    std::unordered_set<std::string> m_writingFiles;
+    std::unordered_set<std::string> m_createdDirectories;
+    std::vector<std::filesystem::path> m_unsyncedFiles;
+    std::vector<std::string> m_errors;
+    size_t m_maxPendingBytes;
+    size_t m_pendingBytes;
+    size_t m_fileCount;
+    uint64_t m_bytesWritten;
+    size_t m_stallCount;
+    size_t m_gzipFileCount;
+    uint64_t m_gzipBytesIn;
+    uint64_t m_gzipBytesOut;
+    bool m_syncFiles;
+    bool m_gzipFiles;
+    bool m_stopping;
+};
+} // namespace CDBTo3DTiles
@@ -0,0 +1,235 @@
+#include "ShapefileReader.h"
+
+namespace CDBTo3DTiles {
+
+static constexpr size_t SHP_HEADER_SIZE = 100;
+static constexpr size_t SHP_RECORD_HEADER_SIZE = 8;
+static constexpr int32_t SHP_FILE_CODE = 9994;
+
+static int32_t readInt32BE(const uint8_t *data)
+{
+    return static_cast<int32_t>((static_cast<uint32_t>(data[0]) << 24)
+                                | (static_cast<uint32_t>(data[1]) << 16)
+                                | (static_cast<uint32_t>(data[2]) << 8) | static_cast<uint32_t>(data[3]));
+}
+
+static int32_t readInt32LE(const uint8_t *data)
+{
+    return static_cast<int32_t>(static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8)
+                                | (static_cast<uint32_t>(data[2]) << 16)
+                                | (static_cast<uint32_t>(data[3]) << 24));
+}
+
+static bool isPointShape(ShapeType shapeType)
+{
+    return shapeType == ShapeType::Point || shapeType == ShapeType::PointZ || shapeType == ShapeType::PointM;
+}
+
+static bool isMultiPointShape(ShapeType shapeType)
+{
+    return shapeType == ShapeType::MultiPoint || shapeType == ShapeType::MultiPointZ
+           || shapeType == ShapeType::MultiPointM;
+}
+
+static bool isPolyShape(ShapeType shapeType)
+{
+    return shapeType == ShapeType::PolyLine || shapeType == ShapeType::PolyLineZ
+           || shapeType == ShapeType::PolyLineM || shapeType == ShapeType::Polygon
+           || shapeType == ShapeType::PolygonZ || shapeType == ShapeType::PolygonM;
+}
+
+static bool hasZ(ShapeType shapeType)
+{
+    return shapeType == ShapeType::PointZ || shapeType == ShapeType::MultiPointZ
+           || shapeType == ShapeType::PolyLineZ || shapeType == ShapeType::PolygonZ;
+}
+
+static std::optional<ShapeType> toShapeType(int32_t nativeType)
+{
+    auto shapeType = static_cast<ShapeType>(nativeType);
+    if (shapeType == ShapeType::Null || isPointShape(shapeType) || isMultiPointShape(shapeType)
+        || isPolyShape(shapeType)) {
+        return shapeType;
+    }
+
+    return std::nullopt;
+}
+
+static bool isRecordValid(const uint8_t *content, size_t contentLength, ShapeType fileShapeType)
+{
+    if (contentLength < 4) {
+        return false;
+    }
+
+    auto shapeType = toShapeType(readInt32LE(content));
+    if (!shapeType || (*shapeType != ShapeType::Null && *shapeType != fileShapeType)) {
+        return false;
+    }
+
+    if (*shapeType == ShapeType::Null) {
+        return true;
+    }
+
+    // Z values follow the XY points and a Z range. M values are optional and never read
+    size_t ZSize = 0;
+    if (isPointShape(*shapeType)) {
+        return contentLength >= 4 + 16 + (hasZ(*shapeType) ? 8 : 0);
+    } else if (isMultiPointShape(*shapeType)) {
+        if (contentLength < 40) {
+            return false;
+        }
+
+        int32_t pointCount = readInt32LE(content + 36);
+        if (pointCount < 0) {
+            return false;
+        }
+
+        ZSize = hasZ(*shapeType) ? 16 + 8 * static_cast<size_t>(pointCount) : 0;
+        return contentLength >= 40 + 16 * static_cast<size_t>(pointCount) + ZSize;
+    }
+
+    if (contentLength < 44) {
+        return false;
+    }
+
+    int32_t partCount = readInt32LE(content + 36);
+    int32_t pointCount = readInt32LE(content + 40);
+    if (partCount < 0 || pointCount < 0) {
+        return false;
+    }
+
+    ZSize = hasZ(*shapeType) ? 16 + 8 * static_cast<size_t>(pointCount) : 0;
+    size_t partsSize = 4 * static_cast<size_t>(partCount);
+    if (contentLength < 44 + partsSize + 16 * static_cast<size_t>(pointCount) + ZSize) {
+        return false;
+    }
+
+    // parts must start at the first point and never run backward or past the end
+    int32_t previousPartStart = -1;
+    for (int32_t i = 0; i < partCount; ++i) {
+        int32_t partStart = readInt32LE(content + 44 + 4 * static_cast<size_t>(i));
+        if ((i == 0 && partStart != 0) || partStart <= previousPartStart || partStart >= pointCount) {
+            return false;
+        }
+
+        previousPartStart = partStart;
+    }
+
+    return true;
+}
+
+ShapefileRecord::ShapefileRecord(ShapeType shapeType,
+                                 const uint8_t *parts,
+                                 size_t partCount,
+                                 const uint8_t *XYs,
+                                 const uint8_t *Zs,
+                                 size_t pointCount) noexcept
+    : m_shapeType{shapeType}
+    , m_parts{parts}
+    , m_partCount{partCount}
+    , m_XYs{XYs}
+    , m_Zs{Zs}
+    , m_pointCount{pointCount}
+{}
+
+ShapefilePart ShapefileRecord::getPart(size_t part) const noexcept
+{
+    size_t start = getPartStart(part);
+    size_t end = part + 1 < m_partCount ? getPartStart(part + 1) : m_pointCount;
+    return ShapefilePart(m_XYs + 16 * start, m_Zs == nullptr ? nullptr : m_Zs + 8 * start, end - start);
+}
+
+size_t ShapefileRecord::getPartStart(size_t part) const noexcept
+{
+    if (m_parts == nullptr) {
+        return 0;
+    }
+
+    return static_cast<size_t>(readInt32LE(m_parts + 4 * part));
+}
+
+ShapefileReader::ShapefileReader(MappedFile file, ShapeType shapeType, std::vector<size_t> recordOffsets)
+    : m_file{std::move(file)}
+    , m_shapeType{shapeType}
+    , m_recordOffsets{std::move(recordOffsets)}
+{}
+
+ShapefileRecord ShapefileReader::getRecord(size_t record) const noexcept
+{
+    const uint8_t *content = m_file.getData() + m_recordOffsets[record];
+    auto shapeType = static_cast<ShapeType>(readInt32LE(content));
+    if (shapeType == ShapeType::Null) {
+        return ShapefileRecord(shapeType, nullptr, 0, nullptr, nullptr, 0);
+    }
+
+    if (isPointShape(shapeType)) {
+        const uint8_t *XYs = content + 4;
+        const uint8_t *Zs = hasZ(shapeType) ? XYs + 16 : nullptr;
+        return ShapefileRecord(shapeType, nullptr, 1, XYs, Zs, 1);
+    }
+
+    if (isMultiPointShape(shapeType)) {
+        size_t pointCount = static_cast<size_t>(readInt32LE(content + 36));
+        const uint8_t *XYs = content + 40;
+        const uint8_t *Zs = hasZ(shapeType) ? XYs + 16 * pointCount + 16 : nullptr;
+        return ShapefileRecord(shapeType, nullptr, 1, XYs, Zs, pointCount);
+    }
+
+    size_t partCount = static_cast<size_t>(readInt32LE(content + 36));
+    size_t pointCount = static_cast<size_t>(readInt32LE(content + 40));
+    const uint8_t *parts = content + 44;
+    const uint8_t *XYs = parts + 4 * partCount;
+    const uint8_t *Zs = hasZ(shapeType) ? XYs + 16 * pointCount + 16 : nullptr;
+    return ShapefileRecord(shapeType, parts, partCount, XYs, Zs, pointCount);
+}
+
+std::optional<ShapefileReader> ShapefileReader::createFromFile(const std::filesystem::path &file)
+{
+    auto mappedFile = MappedFile::createFromFile(file);
+    if (!mappedFile) {
+        return std::nullopt;
+    }
+
+    return createFromMappedFile(std::move(*mappedFile));
+}
+
+std::optional<ShapefileReader> ShapefileReader::createFromMappedFile(MappedFile file)
+{
+    if (file.getSize() < SHP_HEADER_SIZE) {
+        return std::nullopt;
+    }
+
+    const uint8_t *data = file.getData();
+    size_t fileSize = file.getSize();
+    if (readInt32BE(data) != SHP_FILE_CODE) {
+        return std::nullopt;
+    }
+
+    auto shapeType = toShapeType(readInt32LE(data + 32));
+    if (!shapeType) {
+        return std::nullopt;
+    }
+
+    // validate every record up front, so geometry can be read afterward without bound checks
+    std::vector<size_t> recordOffsets;
+    size_t recordHeader = SHP_HEADER_SIZE;
+    while (recordHeader + SHP_RECORD_HEADER_SIZE <= fileSize) {
+        int32_t contentLengthInWords = readInt32BE(data + recordHeader + 4);
+        size_t contentOffset = recordHeader + SHP_RECORD_HEADER_SIZE;
+        if (contentLengthInWords < 0) {
+            return std::nullopt;
+        }
+
+        size_t contentLength = 2 * static_cast<size_t>(contentLengthInWords);
+        if (contentOffset + contentLength > fileSize
+            || !isRecordValid(data + contentOffset, contentLength, *shapeType)) {
+            return std::nullopt;
+        }
+
+        recordOffsets.emplace_back(contentOffset);
+        recordHeader = contentOffset + contentLength;
+    }
+
+    return ShapefileReader(std::move(file), *shapeType, std::move(recordOffsets));
+}
+} // namespace CDBTo3DTiles
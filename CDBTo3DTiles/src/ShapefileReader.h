@@ -0,0 +1,110 @@
+#pragma once
+
+#include "MappedFile.h"
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+namespace CDBTo3DTiles {
+enum class ShapeType
+{
+    Null = 0,
+    Point = 1,
+    PolyLine = 3,
+    Polygon = 5,
+    MultiPoint = 8,
+    PointZ = 11,
+    PolyLineZ = 13,
+    PolygonZ = 15,
+    MultiPointZ = 18,
+    PointM = 21,
+    PolyLineM = 23,
+    PolygonM = 25,
+    MultiPointM = 28,
+};
+
+class ShapefilePart
+{
+public:
+    ShapefilePart(const uint8_t *XYs, const uint8_t *Zs, size_t pointCount) noexcept
+        : m_XYs{XYs}
+        , m_Zs{Zs}
+        , m_pointCount{pointCount}
+    {}
+
+    inline size_t getPointCount() const noexcept { return m_pointCount; }
+
+    inline double getX(size_t point) const noexcept { return readDouble(m_XYs + point * 16); }
+
+    inline double getY(size_t point) const noexcept { return readDouble(m_XYs + point * 16 + 8); }
+
+    inline double getZ(size_t point) const noexcept
+    {
+        return m_Zs == nullptr ? 0.0 : readDouble(m_Zs + point * 8);
+    }
+
+private:
+    // shapefile coordinates are little endian and not necessarily aligned to 8 bytes
+    static inline double readDouble(const uint8_t *data) noexcept
+    {
+        double value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    const uint8_t *m_XYs;
+    const uint8_t *m_Zs;
+    size_t m_pointCount;
+};
+
+class ShapefileRecord
+{
+public:
+    ShapefileRecord(ShapeType shapeType,
+                    const uint8_t *parts,
+                    size_t partCount,
+                    const uint8_t *XYs,
+                    const uint8_t *Zs,
+                    size_t pointCount) noexcept;
+
+    inline ShapeType getShapeType() const noexcept { return m_shapeType; }
+
+    inline size_t getPartCount() const noexcept { return m_partCount; }
+
+    inline size_t getPointCount() const noexcept { return m_pointCount; }
+
+    ShapefilePart getPart(size_t part) const noexcept;
+
+private:
+    size_t getPartStart(size_t part) const noexcept;
+
+    ShapeType m_shapeType;
+    const uint8_t *m_parts;
+    size_t m_partCount;
+    const uint8_t *m_XYs;
+    const uint8_t *m_Zs;
+    size_t m_pointCount;
+};
+
+class ShapefileReader
+{
+public:
+    inline ShapeType getShapeType() const noexcept { return m_shapeType; }
+
+    inline size_t getRecordCount() const noexcept { return m_recordOffsets.size(); }
+
+    ShapefileRecord getRecord(size_t record) const noexcept;
+
+    static std::optional<ShapefileReader> createFromFile(const std::filesystem::path &file);
+
+    static std::optional<ShapefileReader> createFromMappedFile(MappedFile file);
+
+private:
+    ShapefileReader(MappedFile file, ShapeType shapeType, std::vector<size_t> recordOffsets);
+
+    MappedFile m_file;
+    ShapeType m_shapeType;
+    std::vector<size_t> m_recordOffsets;
+};
+} // namespace CDBTo3DTiles
@@ -1,21 +1,81 @@
 #include "TileFormatIO.h"
 #include "Ellipsoid.h"
+#include "Transforms.h"
 #include "glm/gtc/matrix_access.hpp"
 #include "nlohmann/json.hpp"
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
 
 namespace CDBTo3DTiles {
 
 static float MAX_GEOMETRIC_ERROR = 300000.0f;
 
+static const char *STRING_DICTIONARY_EXTENSION = "CDB_string_dictionary";
+
+static const int MAX_SUBTREE_LEVELS = 6;
+
+static const char *SUBTREE_URI = "Subtrees/{level}_{x}_{y}.subtree";
+
+using SubtreeWriter = std::function<void(const std::filesystem::path &, const std::string &)>;
+
+struct ImplicitSubtree
+{
+    std::vector<uint8_t> tileAvailability;
+    std::vector<uint8_t> contentAvailability;
+    std::vector<uint8_t> childSubtreeAvailability;
+    uint64_t tileCount = 0;
+    uint64_t contentCount = 0;
+    uint64_t childSubtreeCount = 0;
+};
+
 static void createBatchTable(const CDBInstancesAttributes *instancesAttribs,
+                             bool dictionaryEncodeStrings,
                              std::string &batchTableJson,
                              std::vector<uint8_t> &batchTableBuffer);
 
-static void convertTilesetToJson(const CDBTile &tile, float geometricError, nlohmann::json &json);
+static void addDictionaryEncodedStrings(const std::string &name,
+                                        const std::vector<std::string> &values,
+                                        const std::vector<int> *instanceIndices,
+                                        nlohmann::json &batchTableJson,
+                                        std::vector<uint8_t> &batchTableBuffer);
+
+static void writeTilesetJson(const CDBTileset &tileset,
+                             bool replace,
+                             bool orientedBoundingBox,
+                             bool dictionaryEncodeStrings,
+                             const SubtreeWriter *writeSubtree,
+                             std::ostream &fs);
+
+static void convertTilesetToJson(const CDBTileset &tileset,
+                                 const CDBTile &tile,
+                                 float geometricError,
+                                 bool orientedBoundingBox,
+                                 const SubtreeWriter *writeSubtree,
+                                 nlohmann::json &json);
+
+static std::array<double, 12> computeOrientedBoundingBox(const Core::BoundingRegion &region);
+
+static void convertImplicitTileToJson(const CDBTileset &tileset,
+                                      const CDBTile &root,
+                                      const SubtreeWriter &writeSubtree,
+                                      nlohmann::json &json);
+
+static std::string writeSubtreeToString(const ImplicitSubtree &subtree, int subtreeLevels, bool hasContent);
+
+static bool setAvailable(std::vector<uint8_t> &bitstream, uint64_t bit);
+
+static uint64_t computeMortonIndex(uint32_t x, uint32_t y);
+
+static uint64_t computeTileCount(int levels);
 
 void combineTilesetJson(const std::vector<std::filesystem::path> &tilesetJsonPaths,
                         const std::vector<Core::BoundingRegion> &regions,
-                        std::ofstream &fs)
+                        std::ostream &fs)
 {
     nlohmann::json tilesetJson;
     tilesetJson["asset"] = {{"version", "1.0"}};
@@ -63,29 +123,78 @@ void combineTilesetJson(const std::vector<std::filesystem::path> &tilesetJsonPat
     fs << tilesetJson << std::endl;
 }
 
-void writeToTilesetJson(const CDBTileset &tileset, bool replace, std::ofstream &fs)
+void writeToTilesetJson(const CDBTileset &tileset,
+                        bool replace,
+                        std::ostream &fs,
+                        bool orientedBoundingBox,
+                        bool dictionaryEncodeStrings)
 {
-    nlohmann::json tilesetJson;
-    tilesetJson["asset"] = {{"version", "1.0"}};
-    tilesetJson["root"] = nlohmann::json::object();
-    if (replace) {
-        tilesetJson["root"]["refine"] = "REPLACE";
-    } else {
-        tilesetJson["root"]["refine"] = "ADD";
+    writeTilesetJson(tileset, replace, orientedBoundingBox, dictionaryEncodeStrings, nullptr, fs);
+}
+
+void writeToImplicitTilesetJson(
+    const CDBTileset &tileset,
+    bool replace,
+    std::ostream &fs,
+    std::function<void(const std::filesystem::path &subtreePath, const std::string &subtree)> writeSubtree,
+    bool dictionaryEncodeStrings)
+{
+    writeTilesetJson(tileset, replace, false, dictionaryEncodeStrings, &writeSubtree, fs);
+}
+
+std::filesystem::path getImplicitTileContentURI(const CDBTile &tile, const std::string &extension)
+{
+    return CDBTile::retrieveGeoCellDatasetFromTileName(tile) + "_L" + std::to_string(tile.getLevel()) + "_U"
+           + std::to_string(tile.getUREF()) + "_R" + std::to_string(tile.getRREF()) + extension;
+}
+
+TileBuffer::TileBuffer()
+    : m_byteLength{0}
+{}
+
+void TileBuffer::append(std::string part)
+{
+    m_byteLength += part.size();
+    m_parts.emplace_back(std::move(part));
+}
+
+void TileBuffer::append(const void *data, size_t size)
+{
+    append(std::string(static_cast<const char *>(data), size));
+}
+
+void TileBuffer::append(TileBuffer &&tile)
+{
+    m_byteLength += tile.m_byteLength;
+    m_parts.insert(m_parts.end(),
+                   std::make_move_iterator(tile.m_parts.begin()),
+                   std::make_move_iterator(tile.m_parts.end()));
+    tile.m_parts.clear();
+    tile.m_byteLength = 0;
+}
+
+void TileBuffer::write(std::ostream &fs) const
+{
+    for (const auto &part : m_parts) {
+        fs.write(part.data(), static_cast<std::streamsize>(part.size()));
     }
+}
 
-    auto root = tileset.getRoot();
-    if (root) {
-        convertTilesetToJson(*root, MAX_GEOMETRIC_ERROR, tilesetJson["root"]);
-        tilesetJson["geometricError"] = tilesetJson["root"]["geometricError"];
-        fs << tilesetJson << std::endl;
+std::string TileBuffer::toString() const
+{
+    std::string buffer;
+    buffer.reserve(m_byteLength);
+    for (const auto &part : m_parts) {
+        buffer += part;
     }
+
+    return buffer;
 }
 
-size_t writeToI3DM(std::string GltfURI,
-                   const CDBModelsAttributes &modelsAttribs,
-                   const std::vector<int> &attribIndices,
-                   std::ofstream &fs)
+TileBuffer createI3DM(std::string GltfURI,
+                      const CDBModelsAttributes &modelsAttribs,
+                      const std::vector<int> &attribIndices,
+                      bool dictionaryEncodeStrings)
 {
     const auto &cdbTile = modelsAttribs.getTile();
     const auto &instancesAttribs = modelsAttribs.getInstancesAttributes();
@@ -115,13 +224,22 @@ size_t writeToI3DM(std::string GltfURI,
     featureTableJson["NORMAL_UP"] = {{"byteOffset", normalUpOffset}};
     featureTableJson["NORMAL_RIGHT"] = {{"byteOffset", normalRightOffset}};
 
+    // convert all instance positions at once
+    std::vector<Core::Cartographic> instanceCartographics;
+    instanceCartographics.reserve(totalInstances);
+    for (auto instanceIdx : attribIndices) {
+        instanceCartographics.emplace_back(cartographicPositions[static_cast<size_t>(instanceIdx)]);
+    }
+
+    std::vector<glm::dvec3> worldPositions(totalInstances);
+    ellipsoid.cartographicToCartesian(instanceCartographics.data(), totalInstances, worldPositions.data());
+
     // create feature table binary
-    std::vector<unsigned char> featureTableBuffer;
-    featureTableBuffer.resize(
-        roundUp(totalPositionSize + totalScaleSize + totalNormalUpSize + totalNormalRightSize, 8));
+    std::string featureTableBuffer(
+        roundUp(totalPositionSize + totalScaleSize + totalNormalUpSize + totalNormalRightSize, 8), '\0');
     for (size_t i = 0; i < attribIndices.size(); ++i) {
         size_t instanceIdx = static_cast<size_t>(attribIndices[i]);
-        glm::dvec3 worldPosition = ellipsoid.cartographicToCartesian(cartographicPositions[instanceIdx]);
+        const glm::dvec3 &worldPosition = worldPositions[i];
         glm::vec3 positionRTC = worldPosition - center;
 
         glm::dmat4 rotation = calculateModelOrientation(worldPosition, orientation[instanceIdx]);
@@ -155,23 +273,25 @@ size_t writeToI3DM(std::string GltfURI,
     std::vector<unsigned char> batchTableBuffer(totalIntSize + totalDoubleSize);
 
     nlohmann::json batchTableJson;
-    batchTableJson["CNAM"] = nlohmann::json::array();
-    for (auto idx : attribIndices) {
-        batchTableJson["CNAM"].emplace_back(CNAMs[static_cast<size_t>(idx)]);
-    }
-
-    for (auto pair : stringAttribs) {
-        if (batchTableJson.find(pair.first) == batchTableJson.end()) {
-            batchTableJson[pair.first] = nlohmann::json::array();
+    if (!dictionaryEncodeStrings) {
+        batchTableJson["CNAM"] = nlohmann::json::array();
+        for (auto idx : attribIndices) {
+            batchTableJson["CNAM"].emplace_back(CNAMs[static_cast<size_t>(idx)]);
         }
 
-        for (auto idx : attribIndices) {
-            batchTableJson[pair.first].emplace_back(pair.second[static_cast<size_t>(idx)]);
+        for (const auto &pair : stringAttribs) {
+            if (batchTableJson.find(pair.first) == batchTableJson.end()) {
+                batchTableJson[pair.first] = nlohmann::json::array();
+            }
+
+            for (auto idx : attribIndices) {
+                batchTableJson[pair.first].emplace_back(pair.second[static_cast<size_t>(idx)]);
+            }
         }
     }
 
     size_t batchTableOffset = 0;
-    for (auto pair : integerAttribs) {
+    for (const auto &pair : integerAttribs) {
         batchTableJson[pair.first]["byteOffset"] = batchTableOffset;
         batchTableJson[pair.first]["type"] = "SCALAR";
         batchTableJson[pair.first]["componentType"] = "INT";
@@ -183,7 +303,7 @@ size_t writeToI3DM(std::string GltfURI,
     }
 
     batchTableOffset = roundUp(batchTableOffset, 8);
-    for (auto pair : doubleAttribs) {
+    for (const auto &pair : doubleAttribs) {
         batchTableJson[pair.first]["byteOffset"] = batchTableOffset;
         batchTableJson[pair.first]["type"] = "SCALAR";
         batchTableJson[pair.first]["componentType"] = "DOUBLE";
@@ -194,6 +314,18 @@ size_t writeToI3DM(std::string GltfURI,
         }
     }
 
+    // string columns are appended after the numeric columns as indices into a per tile dictionary
+    if (dictionaryEncodeStrings) {
+        addDictionaryEncodedStrings("CNAM", CNAMs, &attribIndices, batchTableJson, batchTableBuffer);
+        for (const auto &pair : stringAttribs) {
+            addDictionaryEncodedStrings(pair.first,
+                                        pair.second,
+                                        &attribIndices,
+                                        batchTableJson,
+                                        batchTableBuffer);
+        }
+    }
+
     // create header
     std::string featureTableString = featureTableJson.dump();
     size_t headerToRoundUp = sizeof(I3dmHeader) + featureTableString.size();
@@ -222,30 +354,28 @@ size_t writeToI3DM(std::string GltfURI,
     header.batchTableBinByteLength = static_cast<uint32_t>(batchTableBuffer.size());
     header.gltfFormat = 0;
 
-    fs.write(reinterpret_cast<const char *>(&header), sizeof(I3dmHeader));
-    fs.write(featureTableString.data(), static_cast<std::streamsize>(featureTableString.size()));
-    fs.write(reinterpret_cast<const char *>(featureTableBuffer.data()), static_cast<std::streamsize>(featureTableBuffer.size()));
-
-    fs.write(batchTableString.data(), static_cast<std::streamsize>(batchTableString.size()));
-    fs.write(reinterpret_cast<const char *>(batchTableBuffer.data()), static_cast<std::streamsize>(batchTableBuffer.size()));
-
-    fs.write(GltfURI.data(), static_cast<std::streamsize>(GltfURI.size()));
-
-    return header.byteLength;
+    TileBuffer tile;
+    tile.append(&header, sizeof(I3dmHeader));
+    tile.append(std::move(featureTableString));
+    tile.append(std::move(featureTableBuffer));
+    tile.append(std::move(batchTableString));
+    tile.append(batchTableBuffer.data(), batchTableBuffer.size());
+    tile.append(std::move(GltfURI));
+    return tile;
 }
 
-void writeToB3DM(tinygltf::Model *gltf, const CDBInstancesAttributes *instancesAttribs, std::ofstream &fs)
+TileBuffer createB3DM(tinygltf::Model *gltf,
+                      const CDBInstancesAttributes *instancesAttribs,
+                      bool dictionaryEncodeStrings)
 {
     // create glb
-    std::stringstream ss;
+    std::ostringstream ss;
     tinygltf::TinyGLTF gltfIO;
     gltfIO.WriteGltfSceneToStream(gltf, ss, false, true);
 
     // put glb into buffer
-    ss.seekp(0, std::ios::end);
-    std::stringstream::pos_type offset = ss.tellp();
-    std::vector<uint8_t> glbBuffer(roundUp(static_cast<size_t>(offset), 8), 0);
-    ss.read(reinterpret_cast<char *>(glbBuffer.data()), static_cast<std::streamsize>(glbBuffer.size()));
+    std::string glbBuffer = ss.str();
+    glbBuffer.resize(roundUp(glbBuffer.size(), 8), '\0');
 
     // create feature table
     size_t numOfBatchID = 0;
@@ -259,7 +389,7 @@ void writeToB3DM(tinygltf::Model *gltf, const CDBInstancesAttributes *instancesA
     // create batch table
     std::string batchTableHeader;
     std::vector<uint8_t> batchTableBuffer;
-    createBatchTable(instancesAttribs, batchTableHeader, batchTableBuffer);
+    createBatchTable(instancesAttribs, dictionaryEncodeStrings, batchTableHeader, batchTableBuffer);
 
     // create header
     B3dmHeader header;
@@ -278,18 +408,16 @@ void writeToB3DM(tinygltf::Model *gltf, const CDBInstancesAttributes *instancesA
     header.batchTableJsonByteLength = static_cast<uint32_t>(batchTableHeader.size());
     header.batchTableBinByteLength = static_cast<uint32_t>(batchTableBuffer.size());
 
-    fs.write(reinterpret_cast<const char *>(&header), sizeof(B3dmHeader));
-    fs.write(featureTableString.data(), static_cast<std::streamsize>(featureTableString.size()));
-
-    fs.write(batchTableHeader.data(), static_cast<std::streamsize>(batchTableHeader.size()));
-    fs.write(reinterpret_cast<const char *>(batchTableBuffer.data()), static_cast<std::streamsize>(batchTableBuffer.size()));
-
-    fs.write(reinterpret_cast<const char *>(glbBuffer.data()), static_cast<std::streamsize>(glbBuffer.size()));
+    TileBuffer tile;
+    tile.append(&header, sizeof(B3dmHeader));
+    tile.append(std::move(featureTableString));
+    tile.append(std::move(batchTableHeader));
+    tile.append(batchTableBuffer.data(), batchTableBuffer.size());
+    tile.append(std::move(glbBuffer));
+    return tile;
 }
 
-void writeToCMPT(uint32_t numOfTiles,
-                 std::ofstream &fs,
-                 std::function<uint32_t(std::ofstream &, size_t tileIdx)> writeToTileFormat)
+TileBuffer createCMPT(std::vector<TileBuffer> tiles)
 {
     CmptHeader header;
     header.magic[0] = 'c';
@@ -297,19 +425,42 @@ void writeToCMPT(uint32_t numOfTiles,
     header.magic[2] = 'p';
     header.magic[3] = 't';
     header.version = 1;
-    header.titleLength = numOfTiles;
+    header.titleLength = static_cast<uint32_t>(tiles.size());
     header.byteLength = sizeof(header);
+    for (const auto &tile : tiles) {
+        header.byteLength += static_cast<uint32_t>(tile.getByteLength());
+    }
 
-    fs.write(reinterpret_cast<char *>(&header), sizeof(header));
-    for (size_t i = 0; i < numOfTiles; ++i) {
-        header.byteLength += writeToTileFormat(fs, i);
+    TileBuffer cmpt;
+    cmpt.append(&header, sizeof(header));
+    for (auto &tile : tiles) {
+        cmpt.append(std::move(tile));
     }
 
-    fs.seekp(0, std::ios::beg);
-    fs.write(reinterpret_cast<char *>(&header), sizeof(header));
+    return cmpt;
+}
+
+size_t writeToI3DM(std::string GltfURI,
+                   const CDBModelsAttributes &modelsAttribs,
+                   const std::vector<int> &attribIndices,
+                   std::ostream &fs,
+                   bool dictionaryEncodeStrings)
+{
+    auto tile = createI3DM(std::move(GltfURI), modelsAttribs, attribIndices, dictionaryEncodeStrings);
+    tile.write(fs);
+    return tile.getByteLength();
+}
+
+void writeToB3DM(tinygltf::Model *gltf,
+                 const CDBInstancesAttributes *instancesAttribs,
+                 std::ostream &fs,
+                 bool dictionaryEncodeStrings)
+{
+    createB3DM(gltf, instancesAttribs, dictionaryEncodeStrings).write(fs);
 }
 
 void createBatchTable(const CDBInstancesAttributes *instancesAttribs,
+                      bool dictionaryEncodeStrings,
                       std::string &batchTableJsonStr,
                       std::vector<uint8_t> &batchTableBuffer)
 {
@@ -325,12 +476,14 @@ void createBatchTable(const CDBInstancesAttributes *instancesAttribs,
 
         batchTableBuffer.resize(totalIntegerSize + totalDoubleSize);
 
-        // Special keys of CDB attributes that map to class attribute
-        batchTableJson["CNAM"] = CNAMs;
+        if (!dictionaryEncodeStrings) {
+            // Special keys of CDB attributes that map to class attribute
+            batchTableJson["CNAM"] = CNAMs;
 
-        // Per instance attributes
-        for (const auto &keyValue : stringAttribs) {
-            batchTableJson[keyValue.first] = keyValue.second;
+            // Per instance attributes
+            for (const auto &keyValue : stringAttribs) {
+                batchTableJson[keyValue.first] = keyValue.second;
+            }
         }
 
         size_t batchTableOffset = 0;
@@ -356,24 +509,154 @@ void createBatchTable(const CDBInstancesAttributes *instancesAttribs,
             batchTableOffset += batchTableSize;
         }
 
+        if (dictionaryEncodeStrings) {
+            addDictionaryEncodedStrings("CNAM", CNAMs, nullptr, batchTableJson, batchTableBuffer);
+            for (const auto &keyValue : stringAttribs) {
+                addDictionaryEncodedStrings(keyValue.first,
+                                            keyValue.second,
+                                            nullptr,
+                                            batchTableJson,
+                                            batchTableBuffer);
+            }
+        }
+
         batchTableJsonStr = batchTableJson.dump();
         batchTableJsonStr += std::string(roundUp(batchTableJsonStr.size(), 8) - batchTableJsonStr.size(), ' ');
     }
 }
 
-void convertTilesetToJson(const CDBTile &tile, float geometricError, nlohmann::json &json)
+template<typename IndexType>
+static void writeDictionaryIndices(const std::vector<uint32_t> &indices, uint8_t *dst)
+{
+    for (size_t i = 0; i < indices.size(); ++i) {
+        IndexType index = static_cast<IndexType>(indices[i]);
+        std::memcpy(dst + i * sizeof(IndexType), &index, sizeof(IndexType));
+    }
+}
+
+void addDictionaryEncodedStrings(const std::string &name,
+                                 const std::vector<std::string> &values,
+                                 const std::vector<int> *instanceIndices,
+                                 nlohmann::json &batchTableJson,
+                                 std::vector<uint8_t> &batchTableBuffer)
+{
+    // collect the unique values in the order they first appear, so the dictionary is deterministic
+    size_t count = instanceIndices ? instanceIndices->size() : values.size();
+    std::vector<uint32_t> indices;
+    indices.reserve(count);
+    std::vector<std::string_view> dictionary;
+    std::unordered_map<std::string_view, uint32_t> valueToIndex;
+    for (size_t i = 0; i < count; ++i) {
+        size_t valueIdx = instanceIndices ? static_cast<size_t>((*instanceIndices)[i]) : i;
+        std::string_view value = values[valueIdx];
+        auto inserted = valueToIndex.insert({value, static_cast<uint32_t>(dictionary.size())});
+        if (inserted.second) {
+            dictionary.emplace_back(value);
+        }
+
+        indices.emplace_back(inserted.first->second);
+    }
+
+    // use the smallest component type that can address the whole dictionary
+    size_t componentSize;
+    const char *componentType;
+    if (dictionary.size() <= 0xFF + 1) {
+        componentSize = sizeof(uint8_t);
+        componentType = "UNSIGNED_BYTE";
+    } else if (dictionary.size() <= 0xFFFF + 1) {
+        componentSize = sizeof(uint16_t);
+        componentType = "UNSIGNED_SHORT";
+    } else {
+        componentSize = sizeof(uint32_t);
+        componentType = "UNSIGNED_INT";
+    }
+
+    size_t byteOffset = batchTableBuffer.size();
+    batchTableBuffer.resize(roundUp(byteOffset + count * componentSize, 8), 0);
+    if (componentSize == sizeof(uint8_t)) {
+        writeDictionaryIndices<uint8_t>(indices, batchTableBuffer.data() + byteOffset);
+    } else if (componentSize == sizeof(uint16_t)) {
+        writeDictionaryIndices<uint16_t>(indices, batchTableBuffer.data() + byteOffset);
+    } else {
+        writeDictionaryIndices<uint32_t>(indices, batchTableBuffer.data() + byteOffset);
+    }
+
+    batchTableJson[name]["byteOffset"] = byteOffset;
+    batchTableJson[name]["type"] = "SCALAR";
+    batchTableJson[name]["componentType"] = componentType;
+
+    auto &dictionaryJson = batchTableJson["extensions"][STRING_DICTIONARY_EXTENSION][name];
+    dictionaryJson = nlohmann::json::array();
+    for (auto value : dictionary) {
+        dictionaryJson.emplace_back(std::string(value));
+    }
+}
+
+void writeTilesetJson(const CDBTileset &tileset,
+                      bool replace,
+                      bool orientedBoundingBox,
+                      bool dictionaryEncodeStrings,
+                      const SubtreeWriter *writeSubtree,
+                      std::ostream &fs)
+{
+    nlohmann::json tilesetJson;
+    tilesetJson["asset"] = {{"version", writeSubtree ? "1.1" : "1.0"}};
+
+    // clients that can't decode the dictionaries would show the indices in place of the strings
+    if (dictionaryEncodeStrings) {
+        tilesetJson["extensionsUsed"] = nlohmann::json::array({STRING_DICTIONARY_EXTENSION});
+        tilesetJson["extensionsRequired"] = nlohmann::json::array({STRING_DICTIONARY_EXTENSION});
+    }
+
+    tilesetJson["root"] = nlohmann::json::object();
+    if (replace) {
+        tilesetJson["root"]["refine"] = "REPLACE";
+    } else {
+        tilesetJson["root"]["refine"] = "ADD";
+    }
+
+    auto root = tileset.getRoot();
+    if (root) {
+        convertTilesetToJson(tileset,
+                             *root,
+                             MAX_GEOMETRIC_ERROR,
+                             orientedBoundingBox,
+                             writeSubtree,
+                             tilesetJson["root"]);
+        tilesetJson["geometricError"] = tilesetJson["root"]["geometricError"];
+        fs << tilesetJson << std::endl;
+    }
+}
+
+void convertTilesetToJson(const CDBTileset &tileset,
+                          const CDBTile &tile,
+                          float geometricError,
+                          bool orientedBoundingBox,
+                          const SubtreeWriter *writeSubtree,
+                          nlohmann::json &json)
 {
     const auto &boundRegion = tile.getBoundRegion();
     const auto &rectangle = boundRegion.getRectangle();
-    json["boundingVolume"] = {{"region",
-                               {
-                                   rectangle.getWest(),
-                                   rectangle.getSouth(),
-                                   rectangle.getEast(),
-                                   rectangle.getNorth(),
-                                   boundRegion.getMinimumHeight(),
-                                   boundRegion.getMaximumHeight(),
-                               }}};
+    if (orientedBoundingBox) {
+        json["boundingVolume"] = {{"box", computeOrientedBoundingBox(boundRegion)}};
+    } else {
+        json["boundingVolume"] = {{"region",
+                                   {
+                                       rectangle.getWest(),
+                                       rectangle.getSouth(),
+                                       rectangle.getEast(),
+                                       rectangle.getNorth(),
+                                       boundRegion.getMinimumHeight(),
+                                       boundRegion.getMaximumHeight(),
+                                   }}};
+    }
+
+    // level 0 covers the GeoCell and every level below it splits into four, which is an implicit quadtree
+    if (writeSubtree && tile.getLevel() == 0) {
+        json["geometricError"] = geometricError;
+        convertImplicitTileToJson(tileset, tile, *writeSubtree, json);
+        return;
+    }
 
     auto contentURI = tile.getCustomContentURI();
     if (contentURI) {
@@ -381,22 +664,283 @@ void convertTilesetToJson(const CDBTile &tile, float geometricError, nlohmann::j
         json["content"]["uri"] = *contentURI;
     }
 
-   const std::vector<CDBTile *> &children = tile.getChildren();
-
-    if (children.empty()) {
+    if (tileset.isLeaf(tile)) {
         json["geometricError"] = 0.0f;
     } else {
-        json["geometricError"] = geometricError;
-
-        for (auto child : children) {
+        float childrenGeometricError = 0.0f;
+        for (auto child : tileset.getChildren(tile)) {
             if (child == nullptr) {
                 continue;
             }
 
             nlohmann::json childJson = nlohmann::json::object();
-            convertTilesetToJson(*child, geometricError / 2.0f, childJson);
+            convertTilesetToJson(tileset,
+                                 *child,
+                                 geometricError / 2.0f,
+                                 orientedBoundingBox,
+                                 writeSubtree,
+                                 childJson);
+            float childGeometricError = childJson["geometricError"].get<float>();
+            childrenGeometricError = std::max(childrenGeometricError, childGeometricError);
             json["children"].emplace_back(childJson);
         }
+
+        // use the error measured for the tile when there is one, even when the tile has no content of its
+        // own. Other tiles halve the error of the parent. A tile never has less error than its children
+        const float *measuredGeometricError = tile.getGeometricError();
+        if (measuredGeometricError) {
+            json["geometricError"] = std::max(*measuredGeometricError, childrenGeometricError);
+        } else {
+            json["geometricError"] = std::max(geometricError, childrenGeometricError);
+        }
+    }
+}
+
+std::array<double, 12> computeOrientedBoundingBox(const Core::BoundingRegion &region)
+{
+    // the box is aligned with the east north up frame at the center of the region. For regions smaller than a
+    // hemisphere, every axis reaches its extremes at the corners, the edge midpoints or the center of the
+    // rectangle, so sampling those at both heights bounds the whole region
+    const auto &ellipsoid = Core::Ellipsoid::WGS84;
+    const auto &rectangle = region.getRectangle();
+    auto center = rectangle.computeCenter();
+    glm::dvec3 origin = ellipsoid.cartographicToCartesian(center);
+    glm::dmat4 frame = Core::Transforms::eastNorthUpToFixedFrame(origin, ellipsoid);
+    glm::dvec3 axes[3] = {glm::dvec3(frame[0]), glm::dvec3(frame[1]), glm::dvec3(frame[2])};
+
+    glm::dvec3 minimum(std::numeric_limits<double>::max());
+    glm::dvec3 maximum(std::numeric_limits<double>::lowest());
+    double longitudes[3] = {rectangle.getWest(), center.longitude, rectangle.getEast()};
+    double latitudes[3] = {rectangle.getSouth(), center.latitude, rectangle.getNorth()};
+    double heights[2] = {region.getMinimumHeight(), region.getMaximumHeight()};
+    for (double longitude : longitudes) {
+        for (double latitude : latitudes) {
+            for (double height : heights) {
+                Core::Cartographic cartographic(longitude, latitude, height);
+                glm::dvec3 position = ellipsoid.cartographicToCartesian(cartographic);
+                for (glm::length_t i = 0; i < 3; ++i) {
+                    double distance = glm::dot(position - origin, axes[i]);
+                    minimum[i] = glm::min(minimum[i], distance);
+                    maximum[i] = glm::max(maximum[i], distance);
+                }
+            }
+        }
     }
+
+    glm::dvec3 boxCenter = origin;
+    glm::dvec3 halfExtents = (maximum - minimum) / 2.0;
+    for (glm::length_t i = 0; i < 3; ++i) {
+        boxCenter += axes[i] * ((minimum[i] + maximum[i]) / 2.0);
+    }
+
+    glm::dvec3 xHalfAxis = axes[0] * halfExtents.x;
+    glm::dvec3 yHalfAxis = axes[1] * halfExtents.y;
+    glm::dvec3 zHalfAxis = axes[2] * halfExtents.z;
+    return {boxCenter.x,
+            boxCenter.y,
+            boxCenter.z,
+            xHalfAxis.x,
+            xHalfAxis.y,
+            xHalfAxis.z,
+            yHalfAxis.x,
+            yHalfAxis.y,
+            yHalfAxis.z,
+            zHalfAxis.x,
+            zHalfAxis.y,
+            zHalfAxis.z};
+}
+
+void convertImplicitTileToJson(const CDBTileset &tileset,
+                               const CDBTile &root,
+                               const SubtreeWriter &writeSubtree,
+                               nlohmann::json &json)
+{
+    // find the depth of the tree and the content type. Every tile of a tileset has the same type of content
+    int availableLevels = 0;
+    std::string contentExtension;
+    std::vector<const CDBTile *> tiles{&root};
+    while (!tiles.empty()) {
+        const CDBTile *tile = tiles.back();
+        tiles.pop_back();
+        availableLevels = std::max(availableLevels, tile->getLevel() + 1);
+        auto contentURI = tile->getCustomContentURI();
+        if (contentURI && contentExtension.empty()) {
+            contentExtension = contentURI->extension().string();
+        }
+
+        for (auto child : tileset.getChildren(*tile)) {
+            if (child) {
+                tiles.emplace_back(child);
+            }
+        }
+    }
+
+    // Tiles are grouped into subtrees of subtreeLevels levels. A tile on the first level of a subtree is
+    // the root of it and also marks the subtree available in its parent subtree
+    int subtreeLevels = std::min(availableLevels, MAX_SUBTREE_LEVELS);
+    uint64_t subtreeTileCount = computeTileCount(subtreeLevels);
+    uint64_t childSubtreeCount = computeTileCount(subtreeLevels + 1) - subtreeTileCount;
+    std::map<std::tuple<int, uint32_t, uint32_t>, ImplicitSubtree> subtrees;
+    auto getSubtree = [&](int level, uint32_t x, uint32_t y) -> ImplicitSubtree & {
+        auto subtree = subtrees.try_emplace({level, x, y});
+        if (subtree.second) {
+            subtree.first->second.tileAvailability.resize(roundUp(subtreeTileCount, 8) / 8);
+            subtree.first->second.contentAvailability.resize(roundUp(subtreeTileCount, 8) / 8);
+            subtree.first->second.childSubtreeAvailability.resize(roundUp(childSubtreeCount, 8) / 8);
+        }
+
+        return subtree.first->second;
+    };
+
+    tiles.emplace_back(&root);
+    while (!tiles.empty()) {
+        const CDBTile *tile = tiles.back();
+        tiles.pop_back();
+
+        int level = tile->getLevel();
+        auto x = static_cast<uint32_t>(tile->getRREF());
+        auto y = static_cast<uint32_t>(tile->getUREF());
+        int subtreeLevel = level / subtreeLevels * subtreeLevels;
+        int localLevel = level - subtreeLevel;
+        uint32_t subtreeX = x >> localLevel;
+        uint32_t subtreeY = y >> localLevel;
+
+        auto &subtree = getSubtree(subtreeLevel, subtreeX, subtreeY);
+        uint64_t bit = computeTileCount(localLevel)
+                       + computeMortonIndex(x - (subtreeX << localLevel), y - (subtreeY << localLevel));
+        subtree.tileCount += setAvailable(subtree.tileAvailability, bit);
+        if (tile->getCustomContentURI()) {
+            subtree.contentCount += setAvailable(subtree.contentAvailability, bit);
+        }
+
+        if (localLevel == 0 && level > 0) {
+            uint32_t parentX = x >> subtreeLevels;
+            uint32_t parentY = y >> subtreeLevels;
+            auto &parent = getSubtree(subtreeLevel - subtreeLevels, parentX, parentY);
+            uint64_t childBit = computeMortonIndex(x - (parentX << subtreeLevels),
+                                                   y - (parentY << subtreeLevels));
+            parent.childSubtreeCount += setAvailable(parent.childSubtreeAvailability, childBit);
+        }
+
+        for (auto child : tileset.getChildren(*tile)) {
+            if (child) {
+                tiles.emplace_back(child);
+            }
+        }
+    }
+
+    bool hasContent = !contentExtension.empty();
+    for (const auto &subtree : subtrees) {
+        std::string subtreePath = "Subtrees/" + std::to_string(std::get<0>(subtree.first)) + "_"
+                                  + std::to_string(std::get<1>(subtree.first)) + "_"
+                                  + std::to_string(std::get<2>(subtree.first)) + ".subtree";
+        writeSubtree(subtreePath, writeSubtreeToString(subtree.second, subtreeLevels, hasContent));
+    }
+
+    if (hasContent) {
+        json["content"] = nlohmann::json::object();
+        json["content"]["uri"] = CDBTile::retrieveGeoCellDatasetFromTileName(root) + "_L{level}_U{y}_R{x}"
+                                 + contentExtension;
+    }
+
+    json["implicitTiling"] = {{"subdivisionScheme", "QUADTREE"},
+                              {"subtreeLevels", subtreeLevels},
+                              {"availableLevels", availableLevels},
+                              {"subtrees", {{"uri", SUBTREE_URI}}}};
+}
+
+std::string writeSubtreeToString(const ImplicitSubtree &subtree, int subtreeLevels, bool hasContent)
+{
+    uint64_t tileCount = computeTileCount(subtreeLevels);
+    uint64_t childSubtreeCount = computeTileCount(subtreeLevels + 1) - tileCount;
+
+    // bitstreams that are all zeros or all ones are written as constants instead
+    nlohmann::json subtreeJson;
+    std::vector<uint8_t> buffer;
+    auto bufferViews = nlohmann::json::array();
+    auto addAvailability = [&](const std::vector<uint8_t> &bitstream,
+                               uint64_t availableCount,
+                               uint64_t bitCount,
+                               nlohmann::json &availabilityJson) {
+        availabilityJson["availableCount"] = availableCount;
+        if (availableCount == 0 || availableCount == bitCount) {
+            availabilityJson["constant"] = availableCount == 0 ? 0 : 1;
+            return;
+        }
+
+        availabilityJson["bitstream"] = bufferViews.size();
+        bufferViews.push_back(
+            {{"buffer", 0}, {"byteOffset", buffer.size()}, {"byteLength", bitstream.size()}});
+        buffer.insert(buffer.end(), bitstream.begin(), bitstream.end());
+        buffer.resize(roundUp(buffer.size(), 8), 0);
+    };
+
+    addAvailability(subtree.tileAvailability, subtree.tileCount, tileCount, subtreeJson["tileAvailability"]);
+    if (hasContent) {
+        nlohmann::json contentAvailabilityJson;
+        addAvailability(subtree.contentAvailability,
+                        subtree.contentCount,
+                        tileCount,
+                        contentAvailabilityJson);
+        subtreeJson["contentAvailability"] = nlohmann::json::array({contentAvailabilityJson});
+    }
+
+    addAvailability(subtree.childSubtreeAvailability,
+                    subtree.childSubtreeCount,
+                    childSubtreeCount,
+                    subtreeJson["childSubtreeAvailability"]);
+
+    if (!buffer.empty()) {
+        subtreeJson["buffers"] = {{{"byteLength", buffer.size()}}};
+        subtreeJson["bufferViews"] = bufferViews;
+    }
+
+    std::string jsonString = subtreeJson.dump();
+    jsonString.resize(roundUp(jsonString.size(), 8), ' ');
+
+    SubtreeHeader header;
+    header.magic[0] = 's';
+    header.magic[1] = 'u';
+    header.magic[2] = 'b';
+    header.magic[3] = 't';
+    header.version = 1;
+    header.jsonByteLength = jsonString.size();
+    header.binaryByteLength = buffer.size();
+
+    std::string subtreeString;
+    subtreeString.reserve(sizeof(header) + jsonString.size() + buffer.size());
+    subtreeString.append(reinterpret_cast<const char *>(&header), sizeof(header));
+    subtreeString.append(jsonString);
+    subtreeString.append(buffer.begin(), buffer.end());
+    return subtreeString;
+}
+
+bool setAvailable(std::vector<uint8_t> &bitstream, uint64_t bit)
+{
+    auto &byte = bitstream[bit / 8];
+    auto mask = static_cast<uint8_t>(1 << (bit % 8));
+    if (byte & mask) {
+        return false;
+    }
+
+    byte = static_cast<uint8_t>(byte | mask);
+    return true;
+}
+
+uint64_t computeMortonIndex(uint32_t x, uint32_t y)
+{
+    uint64_t index = 0;
+    for (uint32_t i = 0; i < 32; ++i) {
+        index |= static_cast<uint64_t>((x >> i) & 1) << (2 * i);
+        index |= static_cast<uint64_t>((y >> i) & 1) << (2 * i + 1);
+    }
+
+    return index;
+}
+
+uint64_t computeTileCount(int levels)
+{
+    // number of tiles in a full quadtree with the given number of levels: (4^levels - 1) / 3
+    return ((uint64_t(1) << (2 * levels)) - 1) / 3;
 }
 } // namespace CDBTo3DTiles
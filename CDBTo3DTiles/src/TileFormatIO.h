@@ -41,21 +41,89 @@ struct CmptHeader
     uint32_t titleLength;
 };
 
+struct SubtreeHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint64_t jsonByteLength;
+    uint64_t binaryByteLength;
+};
+
+// A tile as the buffers it is made of, in the order they are written. Its byte length is known before any
+// of it is written, so a tile holding it fills in its header up front and is written to any stream, seekable
+// or not, in one pass
+class TileBuffer
+{
+public:
+    TileBuffer();
+
+    inline size_t getByteLength() const noexcept { return m_byteLength; }
+
+    inline const std::vector<std::string> &getParts() const noexcept { return m_parts; }
+
+    void append(std::string part);
+
+    void append(const void *data, size_t size);
+
+    // Takes the parts of the tile, which stay as they are
+    void append(TileBuffer &&tile);
+
+    void write(std::ostream &fs) const;
+
+    // Gathers the parts into one buffer
+    std::string toString() const;
+
+private:
+    std::vector<std::string> m_parts;
+    size_t m_byteLength;
+};
+
 void combineTilesetJson(const std::vector<std::filesystem::path> &tilesetJsonPaths,
                         const std::vector<Core::BoundingRegion> &regions,
-                        std::ofstream &fs);
+                        std::ostream &fs);
+
+// Bounding volumes are regions, or boxes oriented with the surface when orientedBoundingBox is set. Both are
+// as tight as the measured heights of the tiles allow. When the contents are written with
+// dictionaryEncodeStrings, the tileset requires the CDB_string_dictionary extension
+void writeToTilesetJson(const CDBTileset &tileset,
+                        bool replace,
+                        std::ostream &fs,
+                        bool orientedBoundingBox = false,
+                        bool dictionaryEncodeStrings = false);
 
-void writeToTilesetJson(const CDBTileset &tileset, bool replace, std::ofstream &fs);
+// Writes the quadtree from level 0 down with 3D Tiles implicit tiling. The tiles with negative levels stay
+// explicit, since they all cover the whole GeoCell. Every subtree is passed to writeSubtree with its path
+// relative to the tileset. Contents below level 0 must be named with getImplicitTileContentURI
+void writeToImplicitTilesetJson(
+    const CDBTileset &tileset,
+    bool replace,
+    std::ostream &fs,
+    std::function<void(const std::filesystem::path &subtreePath, const std::string &subtree)> writeSubtree,
+    bool dictionaryEncodeStrings = false);
+
+std::filesystem::path getImplicitTileContentURI(const CDBTile &tile, const std::string &extension);
+
+TileBuffer createI3DM(std::string GltfURI,
+                      const CDBModelsAttributes &modelsAttribs,
+                      const std::vector<int> &attribIndices,
+                      bool dictionaryEncodeStrings = false);
+
+TileBuffer createB3DM(tinygltf::Model *gltf,
+                      const CDBInstancesAttributes *instancesAttribs,
+                      bool dictionaryEncodeStrings = false);
+
+// The header is written from the sizes of the tiles, which are taken without being copied
+TileBuffer createCMPT(std::vector<TileBuffer> tiles);
 
 size_t writeToI3DM(std::string GltfURI,
                    const CDBModelsAttributes &modelsAttribs,
                    const std::vector<int> &attribIndices,
-                   std::ofstream &fs);
-
-void writeToB3DM(tinygltf::Model *gltf, const CDBInstancesAttributes *instancesAttribs, std::ofstream &fs);
+                   std::ostream &fs,
+                   bool dictionaryEncodeStrings = false);
 
-void writeToCMPT(uint32_t numOfTiles,
-                 std::ofstream &fs,
-                 std::function<uint32_t(std::ofstream &fs, size_t tileIdx)> writeToTileFormat);
+void writeToB3DM(tinygltf::Model *gltf,
+                 const CDBInstancesAttributes *instancesAttribs,
+                 std::ostream &fs,
+                 bool dictionaryEncodeStrings = false);
 
 } // namespace CDBTo3DTiles
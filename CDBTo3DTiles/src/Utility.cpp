@@ -0,0 +1,126 @@
+#include "Utility.h"
+#include <condition_variable>
+#include <mutex>
+
+namespace CDBTo3DTiles {
+
+// Threads that run the ranges of one call at a time. They sleep between calls, so tiles don't pay for
+// starting and joining threads
+class RangeWorkers
+{
+public:
+    explicit RangeWorkers(size_t threadCount);
+
+    RangeWorkers(const RangeWorkers &) = delete;
+
+    RangeWorkers &operator=(const RangeWorkers &) = delete;
+
+    ~RangeWorkers() noexcept;
+
+    // Returns false without running anything if another call is using the workers
+    bool tryRun(size_t rangeCount, const std::function<void(size_t)> &runRange);
+
+private:
+    void work();
+
+    void runNextRanges(std::unique_lock<std::mutex> &lock);
+
+    std::mutex m_runMutex;
+    std::mutex m_mutex;
+    std::condition_variable m_rangeCondition;
+    std::condition_variable m_doneCondition;
+    std::vector<std::thread> m_threads;
+    const std::function<void(size_t)> *m_runRange;
+    size_t m_rangeCount;
+    size_t m_nextRange;
+    size_t m_doneRangeCount;
+    bool m_stopping;
+};
+
+RangeWorkers::RangeWorkers(size_t threadCount)
+    : m_runRange{nullptr}
+    , m_rangeCount{0}
+    , m_nextRange{0}
+    , m_doneRangeCount{0}
+    , m_stopping{false}
+{
+    m_threads.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        m_threads.emplace_back(&RangeWorkers::work, this);
+    }
+}
+
+RangeWorkers::~RangeWorkers() noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+
+    m_rangeCondition.notify_all();
+    for (auto &thread : m_threads) {
+        thread.join();
+    }
+}
+
+bool RangeWorkers::tryRun(size_t rangeCount, const std::function<void(size_t)> &runRange)
+{
+    std::unique_lock<std::mutex> runLock(m_runMutex, std::try_to_lock);
+    if (!runLock.owns_lock()) {
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_runRange = &runRange;
+    m_rangeCount = rangeCount;
+    m_nextRange = 0;
+    m_doneRangeCount = 0;
+    m_rangeCondition.notify_all();
+
+    // the calling thread takes ranges as well, instead of sleeping until the workers are done
+    runNextRanges(lock);
+    m_doneCondition.wait(lock, [this]() { return m_doneRangeCount == m_rangeCount; });
+    m_runRange = nullptr;
+    return true;
+}
+
+void RangeWorkers::work()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_rangeCondition.wait(lock, [this]() { return m_stopping || m_nextRange < m_rangeCount; });
+        if (m_stopping) {
+            return;
+        }
+
+        runNextRanges(lock);
+    }
+}
+
+void RangeWorkers::runNextRanges(std::unique_lock<std::mutex> &lock)
+{
+    while (m_nextRange < m_rangeCount) {
+        size_t range = m_nextRange++;
+        lock.unlock();
+        (*m_runRange)(range);
+        lock.lock();
+
+        if (++m_doneRangeCount == m_rangeCount) {
+            m_doneCondition.notify_all();
+        }
+    }
+}
+
+void runRangesOnWorkers(size_t rangeCount, const std::function<void(size_t)> &runRange)
+{
+    // the calling thread runs ranges too, so one thread less is started
+    static RangeWorkers workers(std::max<size_t>(std::thread::hardware_concurrency(), 1) - 1);
+    if (workers.tryRun(rangeCount, runRange)) {
+        return;
+    }
+
+    for (size_t range = 0; range < rangeCount; ++range) {
+        runRange(range);
+    }
+}
+} // namespace CDBTo3DTiles
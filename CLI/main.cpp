@@ -2,10 +2,28 @@
 #include "CDBTo3DTiles.h"
 #include "Utility.h"
 #include "cxxopts.hpp"
+#include <algorithm>
+#include <array>
+#include <cctype>
 #include <iostream>
+#include <stdexcept>
+
+static const std::string DEFAULT_COMBINE = "Elevation_1_1,GSModels_1_1,GTModels_2_1,GTModels_1_1";
+
+static int merge(int argc, char **argv);
+
+static std::pair<size_t, size_t> parseShard(const std::string &shard);
+
+static std::array<double, 4> parseRegion(const std::string &region);
+
+static void setLevelRange(CDBTo3DTiles::Converter &converter, const std::string &levelRange);
 
 int main(int argc, char **argv)
 {
+    if (argc > 1 && std::string(argv[1]) == "merge") {
+        return merge(argc - 1, argv + 1);
+    }
+
     cxxopts::Options options("CDBConverter", "Convert CDB to 3D Tiles");
 
     // clang-format off
@@ -20,7 +38,7 @@ int main(int argc, char **argv)
             "Combine converted datasets into one tileset. Each dataset format is {DatasetName}_{ComponentSelector1}_{ComponentSelector2}. "
             "Repeat this option to group different dataset into different tilesets. "
             "E.g: --combine=Elevation_1_1,GSModels_1_1 --combine=GTModels_2_1,GTModels_1_1 will combine Elevation_1_1 and GSModels_1_1 into one tileset. GTModels_2_1 and GTModels_1_1 will be combined into a different tileset",
-            cxxopts::value<std::vector<std::string>>()->default_value("Elevation_1_1,GSModels_1_1,GTModels_2_1,GTModels_1_1"))
+            cxxopts::value<std::vector<std::string>>()->default_value(DEFAULT_COMBINE))
         ("elevation-normal",
             "Generate elevation normal",
             cxxopts::value<bool>()->default_value("false"))
@@ -33,6 +51,63 @@ int main(int argc, char **argv)
         ("elevation-threshold-indices",
             "Set target percent of indices when decimating elevation mesh",
             cxxopts::value<float>()->default_value("0.3"))
+        ("dictionary-encode-strings",
+            "Write string attributes in batch tables as binary indices into a per tile dictionary of unique values. The tilesets then require the CDB_string_dictionary extension, so only clients that support it can load them",
+            cxxopts::value<bool>()->default_value("false"))
+        ("incremental",
+            "Keep the existing output and only convert GeoCells whose input files changed since the last run. A build manifest in the output directory records the inputs and outputs of each converted GeoCell, so an interrupted conversion resumes from the last completed GeoCell",
+            cxxopts::value<bool>()->default_value("false"))
+        ("deduplicate",
+            "Store byte identical b3dm tiles and textures once in a shared Blobs directory and point the tilesets at them. Reports the number of bytes saved. Blobs of tiles replaced by --incremental are kept",
+            cxxopts::value<bool>()->default_value("false"))
+        ("archive",
+            "Pack every tileset with its tiles and textures into a single .3tz archive instead of writing loose files. Cannot be combined with --deduplicate",
+            cxxopts::value<bool>()->default_value("false"))
+        ("implicit-tiling",
+            "Write the quadtree of each tileset from level 0 down as 3D Tiles implicit tiling, with tile availability in .subtree files and a template content URI, instead of listing every tile in the tileset json. Cannot be combined with --deduplicate",
+            cxxopts::value<bool>()->default_value("false"))
+        ("oriented-bounding-box",
+            "Write the bounding volume of each tile as a box oriented with the surface instead of a region. Tiles written with --implicit-tiling keep their regions",
+            cxxopts::value<bool>()->default_value("false"))
+        ("bilinear-model-clamping",
+            "Clamp GTModel and GSModel instances to the elevation interpolated between the four closest elevation samples instead of the elevation sample they fall in",
+            cxxopts::value<bool>()->default_value("false"))
+        ("elevation-cache-size",
+            "Set the memory in megabytes for keeping decoded elevation tiles between the elevation conversion and model clamping. Least recently used tiles are dropped over this size",
+            cxxopts::value<size_t>()->default_value("256"))
+        ("memory-budget",
+            "Set the memory in megabytes the converter tries to stay within, 0 for no limit. The elevation and GTModel caches and the GDAL raster cache are sized to a share of it, and the caches are shrunk whenever the process goes over it",
+            cxxopts::value<size_t>()->default_value("0"))
+        ("prefetch-depth",
+            "Read the source files of this many elevation and vector tiles on background threads ahead of the tile being converted, 0 to read every file when it is needed. Helps most on network and cold storage",
+            cxxopts::value<size_t>()->default_value("0"))
+        ("writer-threads",
+            "Write the output files on this many background threads while the next tiles are converted. Each file is written in one go, and its directory is created once",
+            cxxopts::value<size_t>()->default_value("4"))
+        ("sync-output",
+            "Sync the output files to disk in one batch before the conversion finishes, so they survive a crash of the machine",
+            cxxopts::value<bool>()->default_value("false"))
+        ("gzip",
+            "Also write a gzip compressed copy of every tile and tileset file next to it, with .gz appended to its name, for web servers that send pre-compressed files. The copies are compressed on the writer threads. Images and archives are not compressed",
+            cxxopts::value<bool>()->default_value("false"))
+        ("region",
+            "Convert only the GeoCells overlapping a rectangle given as {West},{South},{East},{North} in degrees, e.g. --region=-117.3,32.6,-117.1,32.8. GeoCells outside of it keep their earlier output with --incremental",
+            cxxopts::value<std::string>())
+        ("geocells",
+            "Convert only the GeoCells in a comma separated list, e.g. N32W118,N32W119, along with the GeoCells in --region",
+            cxxopts::value<std::string>())
+        ("datasets",
+            "Convert only the datasets in a comma separated list, e.g. Elevation,GTModels",
+            cxxopts::value<std::string>())
+        ("lod-range",
+            "Convert only the levels of detail in a range given as {MinLOD}:{MaxLOD}, e.g. --lod-range=-10:8. Prefix the range with a dataset name to limit that dataset alone, e.g. --lod-range=GTModels:0:4. Repeat this option to give datasets different ranges",
+            cxxopts::value<std::vector<std::string>>())
+        ("shard",
+            "Convert only the GeoCells of one shard, given as {ShardIndex}/{ShardCount} with shards numbered from 0, e.g. 0/4. Shards can run as separate processes writing to the same output directory. Each writes a shard manifest instead of the combined tilesets, and \"CDBConverter merge -o output\" combines them once every shard is converted",
+            cxxopts::value<std::string>())
+        ("stats",
+            "Write the time, bytes read and written and call count of each conversion stage, per GeoCell and dataset, to a JSON file, and print the slowest stages after conversion",
+            cxxopts::value<std::string>())
         ("h, help", "Print usage");
     // clang-format on
 
@@ -51,6 +126,20 @@ int main(int argc, char **argv)
             bool elevationLOD = result["elevation-lod"].as<bool>();
             float elevationDecimateError = result["elevation-decimate-error"].as<float>();
             float elevationThresholdIndices = result["elevation-threshold-indices"].as<float>();
+            bool dictionaryEncodeStrings = result["dictionary-encode-strings"].as<bool>();
+            bool incremental = result["incremental"].as<bool>();
+            bool deduplicate = result["deduplicate"].as<bool>();
+            bool archive = result["archive"].as<bool>();
+            bool implicitTiling = result["implicit-tiling"].as<bool>();
+            bool orientedBoundingBox = result["oriented-bounding-box"].as<bool>();
+            bool bilinearModelClamping = result["bilinear-model-clamping"].as<bool>();
+            size_t elevationCacheSize = result["elevation-cache-size"].as<size_t>();
+            size_t memoryBudget = result["memory-budget"].as<size_t>();
+            size_t prefetchDepth = result["prefetch-depth"].as<size_t>();
+            size_t writerThreads = result["writer-threads"].as<size_t>();
+            bool syncOutput = result["sync-output"].as<bool>();
+            bool gzipOutput = result["gzip"].as<bool>();
+            std::string statsFile = result.count("stats") ? result["stats"].as<std::string>() : "";
             std::vector<std::string> combinedDatasets = result["combine"].as<std::vector<std::string>>();
 
             CDBTo3DTiles::GlobalInitializer initializer;
@@ -59,6 +148,47 @@ int main(int argc, char **argv)
             converter.setElevationLODOnly(elevationLOD);
             converter.setElevationDecimateError(elevationDecimateError);
             converter.setElevationThresholdIndices(elevationThresholdIndices);
+            converter.setDictionaryEncodeStrings(dictionaryEncodeStrings);
+            converter.setIncremental(incremental);
+            converter.setDeduplicate(deduplicate);
+            converter.setArchive(archive);
+            converter.setImplicitTiling(implicitTiling);
+            converter.setOrientedBoundingBox(orientedBoundingBox);
+            converter.setBilinearModelClamping(bilinearModelClamping);
+            converter.setElevationCacheSize(elevationCacheSize * 1024 * 1024);
+            converter.setMemoryBudget(memoryBudget * 1024 * 1024);
+            converter.setPrefetchDepth(prefetchDepth);
+            converter.setWriterThreads(writerThreads);
+            converter.setSyncOutput(syncOutput);
+            converter.setGzipOutput(gzipOutput);
+            converter.setStatsFile(statsFile);
+            if (result.count("region")) {
+                auto region = parseRegion(result["region"].as<std::string>());
+                converter.setRegion(region[0], region[1], region[2], region[3]);
+            }
+
+            if (result.count("geocells")) {
+                auto geoCells = CDBTo3DTiles::splitString(result["geocells"].as<std::string>(), ",");
+                for (const auto &geoCell : geoCells) {
+                    converter.addGeoCell(geoCell);
+                }
+            }
+
+            if (result.count("datasets")) {
+                converter.setDatasets(CDBTo3DTiles::splitString(result["datasets"].as<std::string>(), ","));
+            }
+
+            if (result.count("lod-range")) {
+                for (const auto &levelRange : result["lod-range"].as<std::vector<std::string>>()) {
+                    setLevelRange(converter, levelRange);
+                }
+            }
+
+            if (result.count("shard")) {
+                auto shard = parseShard(result["shard"].as<std::string>());
+                converter.setShard(shard.first, shard.second);
+            }
+
             for (const auto &combined : combinedDatasets) {
                 converter.combineDataset(CDBTo3DTiles::splitString(combined, ","));
             }
@@ -74,3 +204,104 @@ int main(int argc, char **argv)
 
     return 0;
 }
+
+int merge(int argc, char **argv)
+{
+    cxxopts::Options options("CDBConverter merge",
+                             "Combine the shards of a conversion into the tilesets of the whole conversion");
+
+    // clang-format off
+    options.add_options()
+        ("o, output",
+            "3D Tiles output directory the shards were converted to",
+            cxxopts::value<std::string>())
+        ("combine",
+            "Combine converted datasets into one tileset, the same as when converting without shards",
+            cxxopts::value<std::vector<std::string>>()->default_value(DEFAULT_COMBINE))
+        ("h, help", "Print usage");
+    // clang-format on
+
+    auto result = options.parse(argc, argv);
+    if (result.count("help") || !result.count("output")) {
+        std::cout << options.help() << "\n";
+        return 0;
+    }
+
+    try {
+        std::filesystem::path outputPath = result["output"].as<std::string>();
+        std::vector<std::string> combinedDatasets = result["combine"].as<std::vector<std::string>>();
+
+        CDBTo3DTiles::GlobalInitializer initializer;
+        CDBTo3DTiles::Converter converter("", outputPath);
+        for (const auto &combined : combinedDatasets) {
+            converter.combineDataset(CDBTo3DTiles::splitString(combined, ","));
+        }
+
+        converter.merge();
+    } catch (const std::exception &e) {
+        std::cout << "An error has occured: " << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
+
+std::pair<size_t, size_t> parseShard(const std::string &shard)
+{
+    auto isNumber = [](const std::string &text) {
+        return !text.empty() && std::all_of(text.begin(), text.end(), [](char c) {
+            return std::isdigit(static_cast<unsigned char>(c)) != 0;
+        });
+    };
+
+    auto indexAndCount = CDBTo3DTiles::splitString(shard, "/");
+    if (indexAndCount.size() != 2 || !isNumber(indexAndCount[0]) || !isNumber(indexAndCount[1])) {
+        throw std::runtime_error("Wrong shard format. Required format should be: {ShardIndex}/{ShardCount}");
+    }
+
+    return {std::stoul(indexAndCount[0]), std::stoul(indexAndCount[1])};
+}
+
+std::array<double, 4> parseRegion(const std::string &region)
+{
+    auto bounds = CDBTo3DTiles::splitString(region, ",");
+    if (bounds.size() != 4) {
+        throw std::runtime_error("Wrong region format. Required format should be: "
+                                 "{West},{South},{East},{North}");
+    }
+
+    std::array<double, 4> rectangle;
+    for (size_t i = 0; i < bounds.size(); ++i) {
+        try {
+            rectangle[i] = std::stod(bounds[i]);
+        } catch (const std::exception &) {
+            throw std::runtime_error("Region bound " + bounds[i] + " has to be a number");
+        }
+    }
+
+    return rectangle;
+}
+
+void setLevelRange(CDBTo3DTiles::Converter &converter, const std::string &levelRange)
+{
+    auto parts = CDBTo3DTiles::splitString(levelRange, ":");
+    if (parts.size() != 2 && parts.size() != 3) {
+        throw std::runtime_error("Wrong LOD range format. Required format should be: {MinLOD}:{MaxLOD} or "
+                                 "{DatasetName}:{MinLOD}:{MaxLOD}");
+    }
+
+    int minLevel;
+    int maxLevel;
+    try {
+        minLevel = std::stoi(parts[parts.size() - 2]);
+        maxLevel = std::stoi(parts[parts.size() - 1]);
+    } catch (const std::exception &) {
+        throw std::runtime_error("LOD range " + levelRange + " has to be given as numbers");
+    }
+
+    if (parts.size() == 3) {
+        converter.setLevelRange(parts[0], minLevel, maxLevel);
+    } else {
+        converter.setLevelRange(minLevel, maxLevel);
+    }
+}
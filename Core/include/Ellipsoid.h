@@ -24,6 +24,22 @@ public:
 
     std::optional<Cartographic> cartesianToCartographic(const glm::dvec3 &cartesian) const;
 
+    // Batched conversions. They use SIMD when the CPU supports it and stay within a few ULP of the
+    // single point conversion
+    void cartographicToCartesian(const Cartographic *cartographics,
+                                 size_t count,
+                                 glm::dvec3 *cartesians) const;
+
+    void cartographicToCartesian(const double *longitudes,
+                                 const double *latitudes,
+                                 const double *heights,
+                                 size_t count,
+                                 glm::dvec3 *cartesians) const;
+
+    void cartesianToCartographic(const glm::dvec3 *cartesians,
+                                 size_t count,
+                                 std::optional<Cartographic> *cartographics) const;
+
     std::optional<glm::dvec3> scaleToGeodeticSurface(const glm::dvec3 &cartesian) const;
 
     double getMaximumRadius() const;
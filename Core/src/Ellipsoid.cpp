@@ -1,8 +1,12 @@
 #include "Ellipsoid.h"
+#include "EllipsoidBatch.h"
 #include "MathHelpers.h"
 
 namespace Core {
 
+static_assert(sizeof(Cartographic) == 3 * sizeof(double), "Cartographic must be three packed doubles");
+static_assert(sizeof(glm::dvec3) == 3 * sizeof(double), "glm::dvec3 must be three packed doubles");
+
 const Ellipsoid Ellipsoid::WGS84 = Ellipsoid(6378137.0, 6378137.0, 6356752.3142451793);
 
 Ellipsoid::Ellipsoid(double x, double y, double z)
@@ -60,6 +64,51 @@ std::optional<Cartographic> Ellipsoid::cartesianToCartographic(const glm::dvec3
     return Cartographic(longitude, latitude, height);
 }
 
+void Ellipsoid::cartographicToCartesian(const Cartographic *cartographics,
+                                        size_t count,
+                                        glm::dvec3 *cartesians) const
+{
+    if (count == 0) {
+        return;
+    }
+
+    EllipsoidBatch::cartographicToCartesian(&m_radiiSquared[0],
+                                            &cartographics->longitude,
+                                            &cartographics->latitude,
+                                            &cartographics->height,
+                                            sizeof(Cartographic) / sizeof(double),
+                                            count,
+                                            &cartesians->x);
+}
+
+void Ellipsoid::cartographicToCartesian(const double *longitudes,
+                                        const double *latitudes,
+                                        const double *heights,
+                                        size_t count,
+                                        glm::dvec3 *cartesians) const
+{
+    if (count == 0) {
+        return;
+    }
+
+    EllipsoidBatch::cartographicToCartesian(&m_radiiSquared[0],
+                                            longitudes,
+                                            latitudes,
+                                            heights,
+                                            1,
+                                            count,
+                                            &cartesians->x);
+}
+
+void Ellipsoid::cartesianToCartographic(const glm::dvec3 *cartesians,
+                                        size_t count,
+                                        std::optional<Cartographic> *cartographics) const
+{
+    for (size_t i = 0; i < count; ++i) {
+        cartographics[i] = cartesianToCartographic(cartesians[i]);
+    }
+}
+
 std::optional<glm::dvec3> Ellipsoid::scaleToGeodeticSurface(const glm::dvec3 &cartesian) const
 {
     double positionX = cartesian.x;
@@ -0,0 +1,90 @@
+#include "EllipsoidBatch.h"
+#include <cmath>
+
+#if defined(CORE_ENABLE_AVX2) && defined(_MSC_VER)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace Core {
+namespace EllipsoidBatch {
+
+#ifdef CORE_ENABLE_AVX2
+static bool isAVX2Supported()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+
+    // the OS has to save the YMM registers as well
+    __cpuid(info, 1);
+    if ((info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+void cartographicToCartesian(const double *radiiSquared,
+                             const double *longitudes,
+                             const double *latitudes,
+                             const double *heights,
+                             size_t stride,
+                             size_t count,
+                             double *cartesians)
+{
+#ifdef CORE_ENABLE_AVX2
+    static const bool useAVX2 = isAVX2Supported();
+    if (useAVX2) {
+        cartographicToCartesianAVX2(radiiSquared, longitudes, latitudes, heights, stride, count, cartesians);
+        return;
+    }
+#endif
+
+    cartographicToCartesianScalar(radiiSquared, longitudes, latitudes, heights, stride, count, cartesians);
+}
+
+// Same operations in the same order as Ellipsoid::cartographicToCartesian, so results are bit identical
+void cartographicToCartesianScalar(const double *radiiSquared,
+                                   const double *longitudes,
+                                   const double *latitudes,
+                                   const double *heights,
+                                   size_t stride,
+                                   size_t count,
+                                   double *cartesians)
+{
+    for (size_t i = 0; i < count; ++i) {
+        double longitude = longitudes[i * stride];
+        double latitude = latitudes[i * stride];
+        double height = heights[i * stride];
+
+        double cosLatitude = std::cos(latitude);
+        double nx = cosLatitude * std::cos(longitude);
+        double ny = cosLatitude * std::sin(longitude);
+        double nz = std::sin(latitude);
+        double inverseLength = 1.0 / std::sqrt(nx * nx + ny * ny + nz * nz);
+        nx *= inverseLength;
+        ny *= inverseLength;
+        nz *= inverseLength;
+
+        double kx = radiiSquared[0] * nx;
+        double ky = radiiSquared[1] * ny;
+        double kz = radiiSquared[2] * nz;
+        double gamma = std::sqrt(nx * kx + ny * ky + nz * kz);
+
+        double *cartesian = cartesians + i * 3;
+        cartesian[0] = kx / gamma + nx * height;
+        cartesian[1] = ky / gamma + ny * height;
+        cartesian[2] = kz / gamma + nz * height;
+    }
+}
+} // namespace EllipsoidBatch
+} // namespace Core
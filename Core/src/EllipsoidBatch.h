@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+
+namespace Core {
+namespace EllipsoidBatch {
+// Converts count (longitude, latitude, height) triples to interleaved XYZ cartesians. Inputs are read
+// with the given stride in doubles, so the same kernel serves arrays of Cartographic and separate arrays
+void cartographicToCartesian(const double *radiiSquared,
+                             const double *longitudes,
+                             const double *latitudes,
+                             const double *heights,
+                             size_t stride,
+                             size_t count,
+                             double *cartesians);
+
+void cartographicToCartesianScalar(const double *radiiSquared,
+                                   const double *longitudes,
+                                   const double *latitudes,
+                                   const double *heights,
+                                   size_t stride,
+                                   size_t count,
+                                   double *cartesians);
+
+#ifdef CORE_ENABLE_AVX2
+void cartographicToCartesianAVX2(const double *radiiSquared,
+                                 const double *longitudes,
+                                 const double *latitudes,
+                                 const double *heights,
+                                 size_t stride,
+                                 size_t count,
+                                 double *cartesians);
+#endif
+} // namespace EllipsoidBatch
+} // namespace Core
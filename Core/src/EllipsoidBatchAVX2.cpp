@@ -0,0 +1,158 @@
+#include "EllipsoidBatch.h"
+#include <immintrin.h>
+
+namespace Core {
+namespace EllipsoidBatch {
+
+// Cody-Waite split of pi/2, so reducing by multiples of pi/2 is exact for the angles used here
+static constexpr double PI_OVER_TWO_1 = 1.57079625129699707031E0;
+static constexpr double PI_OVER_TWO_2 = 7.54978941586159635335E-8;
+static constexpr double PI_OVER_TWO_3 = 5.39030285815811905290E-15;
+static constexpr double TWO_OVER_PI = 6.36619772367581382433E-1;
+
+// Lanes beyond this are converted with the scalar kernel, where libm does the full range reduction
+static constexpr double MAX_REDUCIBLE_ANGLE = 1.0e5;
+
+static inline __m256d polynomial(__m256d x, const double *coefficients, int count)
+{
+    __m256d result = _mm256_set1_pd(coefficients[0]);
+    for (int i = 1; i < count; ++i) {
+        result = _mm256_add_pd(_mm256_mul_pd(result, x), _mm256_set1_pd(coefficients[i]));
+    }
+
+    return result;
+}
+
+// Minimax polynomials from Cephes for sin and cos on [-pi/4, pi/4]
+static inline void sinCos(__m256d x, __m256d &sine, __m256d &cosine)
+{
+    static const double sinCoefficients[] = {1.58962301576546568060E-10,
+                                             -2.50507477628578072866E-8,
+                                             2.75573136213857245213E-6,
+                                             -1.98412698295895385996E-4,
+                                             8.33333333332211858878E-3,
+                                             -1.66666666666666307295E-1};
+    static const double cosCoefficients[] = {-1.13585365213876817300E-11,
+                                             2.08757008419747316778E-9,
+                                             -2.75573141792967388112E-7,
+                                             2.48015872888517045348E-5,
+                                             -1.38888888888730564116E-3,
+                                             4.16666666666665929218E-2};
+
+    __m256d quadrant = _mm256_round_pd(_mm256_mul_pd(x, _mm256_set1_pd(TWO_OVER_PI)),
+                                       _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256d r = _mm256_sub_pd(x, _mm256_mul_pd(quadrant, _mm256_set1_pd(PI_OVER_TWO_1)));
+    r = _mm256_sub_pd(r, _mm256_mul_pd(quadrant, _mm256_set1_pd(PI_OVER_TWO_2)));
+    r = _mm256_sub_pd(r, _mm256_mul_pd(quadrant, _mm256_set1_pd(PI_OVER_TWO_3)));
+
+    __m256d z = _mm256_mul_pd(r, r);
+    __m256d s = _mm256_add_pd(r, _mm256_mul_pd(_mm256_mul_pd(r, z), polynomial(z, sinCoefficients, 6)));
+    __m256d c = _mm256_add_pd(_mm256_sub_pd(_mm256_set1_pd(1.0), _mm256_mul_pd(_mm256_set1_pd(0.5), z)),
+                              _mm256_mul_pd(_mm256_mul_pd(z, z), polynomial(z, cosCoefficients, 6)));
+
+    // sin(x) is s, c, -s, -c and cos(x) is c, -s, -c, s for quadrants 0 to 3
+    __m256i quadrantBits = _mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(quadrant));
+    __m256i one = _mm256_set1_epi64x(1);
+    __m256i two = _mm256_set1_epi64x(2);
+    __m256d swap = _mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_and_si256(quadrantBits, one), one));
+    __m256d negateSine = _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_and_si256(quadrantBits, two), 62));
+    __m256d negateCosine = _mm256_castsi256_pd(
+        _mm256_slli_epi64(_mm256_and_si256(_mm256_add_epi64(quadrantBits, one), two), 62));
+
+    sine = _mm256_xor_pd(_mm256_blendv_pd(s, c, swap), negateSine);
+    cosine = _mm256_xor_pd(_mm256_blendv_pd(c, s, swap), negateCosine);
+}
+
+static inline __m256d load(const double *values, size_t stride)
+{
+    if (stride == 1) {
+        return _mm256_loadu_pd(values);
+    }
+
+    return _mm256_set_pd(values[3 * stride], values[2 * stride], values[stride], values[0]);
+}
+
+static inline bool isReducible(__m256d x)
+{
+    __m256d absolute = _mm256_andnot_pd(_mm256_set1_pd(-0.0), x);
+    __m256d reducible = _mm256_cmp_pd(absolute, _mm256_set1_pd(MAX_REDUCIBLE_ANGLE), _CMP_LE_OQ);
+    return _mm256_movemask_pd(reducible) == 0xF;
+}
+
+void cartographicToCartesianAVX2(const double *radiiSquared,
+                                 const double *longitudes,
+                                 const double *latitudes,
+                                 const double *heights,
+                                 size_t stride,
+                                 size_t count,
+                                 double *cartesians)
+{
+    __m256d radiiSquaredX = _mm256_set1_pd(radiiSquared[0]);
+    __m256d radiiSquaredY = _mm256_set1_pd(radiiSquared[1]);
+    __m256d radiiSquaredZ = _mm256_set1_pd(radiiSquared[2]);
+    __m256d one = _mm256_set1_pd(1.0);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256d longitude = load(longitudes + i * stride, stride);
+        __m256d latitude = load(latitudes + i * stride, stride);
+        __m256d height = load(heights + i * stride, stride);
+        if (!isReducible(longitude) || !isReducible(latitude)) {
+            cartographicToCartesianScalar(radiiSquared,
+                                          longitudes + i * stride,
+                                          latitudes + i * stride,
+                                          heights + i * stride,
+                                          stride,
+                                          4,
+                                          cartesians + i * 3);
+            continue;
+        }
+
+        __m256d sinLongitude, cosLongitude, sinLatitude, cosLatitude;
+        sinCos(longitude, sinLongitude, cosLongitude);
+        sinCos(latitude, sinLatitude, cosLatitude);
+
+        __m256d nx = _mm256_mul_pd(cosLatitude, cosLongitude);
+        __m256d ny = _mm256_mul_pd(cosLatitude, sinLongitude);
+        __m256d nz = sinLatitude;
+        __m256d lengthSquared = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(nx, nx), _mm256_mul_pd(ny, ny)),
+                                              _mm256_mul_pd(nz, nz));
+        __m256d inverseLength = _mm256_div_pd(one, _mm256_sqrt_pd(lengthSquared));
+        nx = _mm256_mul_pd(nx, inverseLength);
+        ny = _mm256_mul_pd(ny, inverseLength);
+        nz = _mm256_mul_pd(nz, inverseLength);
+
+        __m256d kx = _mm256_mul_pd(radiiSquaredX, nx);
+        __m256d ky = _mm256_mul_pd(radiiSquaredY, ny);
+        __m256d kz = _mm256_mul_pd(radiiSquaredZ, nz);
+        __m256d gammaSquared = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(nx, kx), _mm256_mul_pd(ny, ky)),
+                                             _mm256_mul_pd(nz, kz));
+        __m256d gamma = _mm256_sqrt_pd(gammaSquared);
+
+        __m256d x = _mm256_add_pd(_mm256_div_pd(kx, gamma), _mm256_mul_pd(nx, height));
+        __m256d y = _mm256_add_pd(_mm256_div_pd(ky, gamma), _mm256_mul_pd(ny, height));
+        __m256d z = _mm256_add_pd(_mm256_div_pd(kz, gamma), _mm256_mul_pd(nz, height));
+
+        // interleave the four XYZ results
+        alignas(32) double xs[4], ys[4], zs[4];
+        _mm256_store_pd(xs, x);
+        _mm256_store_pd(ys, y);
+        _mm256_store_pd(zs, z);
+        double *cartesian = cartesians + i * 3;
+        for (size_t j = 0; j < 4; ++j) {
+            cartesian[j * 3] = xs[j];
+            cartesian[j * 3 + 1] = ys[j];
+            cartesian[j * 3 + 2] = zs[j];
+        }
+    }
+
+    cartographicToCartesianScalar(radiiSquared,
+                                  longitudes + i * stride,
+                                  latitudes + i * stride,
+                                  heights + i * stride,
+                                  stride,
+                                  count - i,
+                                  cartesians + i * 3);
+}
+} // namespace EllipsoidBatch
+} // namespace Core
@@ -0,0 +1,101 @@
+#include "ArchiveReader.h"
+#include "ArchiveWriter.h"
+#include "CDBTo3DTiles.h"
+#include "Config.h"
+#include "catch2/catch.hpp"
+#include "nlohmann/json.hpp"
+#include <fstream>
+
+using namespace CDBTo3DTiles;
+
+TEST_CASE("Test archive round trips files through the index", "[Archive]")
+{
+    std::filesystem::path output = "Archive";
+    std::filesystem::remove_all(output);
+
+    std::string tileset = "{\"asset\":{\"version\":\"1.0\"}}";
+    std::string tile(1000, 'b');
+    {
+        ArchiveWriter writer(output / "tileset.3tz");
+        writer.addFile("tileset.json", tileset.data(), tileset.size());
+        writer.addFile("Gltf/model.glb", "old", 3);
+        writer.addFile("Gltf/model.glb", tile.data(), tile.size());
+        writer.addFile("empty.b3dm", nullptr, 0);
+        REQUIRE_THROWS_AS(writer.addFile(ArchiveWriter::INDEX_FILENAME, "", 0), std::runtime_error);
+    }
+
+    auto reader = ArchiveReader::createFromFile(output / "tileset.3tz");
+    REQUIRE(reader);
+    REQUIRE(reader->getFileCount() == 3);
+    REQUIRE(reader->getFile("tileset.json") == std::string_view(tileset));
+    REQUIRE(reader->getFile("empty.b3dm") == std::string_view());
+    REQUIRE(reader->getFile("missing.b3dm") == std::nullopt);
+
+    // the file added last replaces the earlier one with the same path
+    REQUIRE(reader->getFile("Gltf/model.glb") == std::string_view(tile));
+
+    SECTION("Test archive without index is rejected")
+    {
+        std::ofstream fs(output / "invalid.3tz", std::ios::binary);
+        fs << "not an archive";
+        fs.close();
+        REQUIRE(ArchiveReader::createFromFile(output / "invalid.3tz") == std::nullopt);
+    }
+
+    std::filesystem::remove_all(output);
+}
+
+TEST_CASE("Test converter packs each tileset into an archive", "[Archive]")
+{
+    std::filesystem::path input = dataPath / "CombineTilesets";
+    std::filesystem::path output = "ArchiveOutput";
+    std::filesystem::remove_all(output);
+
+    Converter converter(input, output);
+    converter.setArchive(true);
+    converter.convert();
+
+    std::filesystem::path archive = output / "Tiles" / "N32" / "W119" / "Elevation" / "1_1.3tz";
+    REQUIRE(std::filesystem::exists(archive));
+    REQUIRE(!std::filesystem::exists(output / "Tiles" / "N32" / "W119" / "Elevation" / "1_1"));
+
+    auto reader = ArchiveReader::createFromFile(archive);
+    REQUIRE(reader);
+
+    auto tilesetJson = reader->getFile("tileset.json");
+    REQUIRE(tilesetJson);
+    auto tileset = nlohmann::json::parse(tilesetJson->begin(), tilesetJson->end());
+
+    // every tile content of the tileset is stored next to it in the archive
+    std::vector<nlohmann::json> tiles{tileset["root"]};
+    size_t contentCount = 0;
+    while (!tiles.empty()) {
+        auto tile = tiles.back();
+        tiles.pop_back();
+        if (tile.contains("content")) {
+            REQUIRE(reader->getFile(tile["content"]["uri"].get<std::string>()));
+            ++contentCount;
+        }
+
+        for (const auto &child : tile["children"]) {
+            tiles.emplace_back(child);
+        }
+    }
+
+    REQUIRE(contentCount > 0);
+
+    // the combined tileset refers to the archive in place of the tileset json
+    std::ifstream fs(output / "Elevation_1_1.json");
+    auto combinedTileset = nlohmann::json::parse(fs);
+    REQUIRE(combinedTileset["root"]["children"][0]["content"]["uri"] == "Tiles/N32/W119/Elevation/1_1.3tz");
+
+    SECTION("Test archive cannot be combined with deduplication")
+    {
+        Converter deduplicatedConverter(input, output);
+        deduplicatedConverter.setArchive(true);
+        deduplicatedConverter.setDeduplicate(true);
+        REQUIRE_THROWS_AS(deduplicatedConverter.convert(), std::runtime_error);
+    }
+
+    std::filesystem::remove_all(output);
+}
@@ -0,0 +1,319 @@
+#include "BuildManifest.h"
+#include "CDBTo3DTiles.h"
+#include "Config.h"
+#include "catch2/catch.hpp"
+#include "nlohmann/json.hpp"
+#include <fstream>
+
+using namespace CDBTo3DTiles;
+
+// copies the GeoCell directory under the given latitude, renaming the tiles after the new GeoCell
+static void copyGeoCellToLatitude(const std::filesystem::path &CDBPath,
+                                  const std::string &latitude,
+                                  const std::string &longitude,
+                                  const std::string &newLatitude)
+{
+    std::filesystem::path geoCellPath = CDBPath / "Tiles" / latitude / longitude;
+    std::filesystem::path newGeoCellPath = CDBPath / "Tiles" / newLatitude / longitude;
+    std::string geoCellName = latitude + longitude;
+    for (const auto &entry : std::filesystem::recursive_directory_iterator(geoCellPath)) {
+        auto newPath = newGeoCellPath / std::filesystem::relative(entry.path(), geoCellPath);
+        if (entry.is_directory()) {
+            std::filesystem::create_directories(newPath);
+            continue;
+        }
+
+        std::string filename = newPath.filename().string();
+        if (filename.compare(0, geoCellName.size(), geoCellName) == 0) {
+            filename = newLatitude + longitude + filename.substr(geoCellName.size());
+        }
+
+        std::filesystem::create_directories(newPath.parent_path());
+        std::filesystem::copy_file(entry.path(), newPath.parent_path() / filename);
+    }
+}
+
+TEST_CASE("Test build manifest round trips to file", "[BuildManifest]")
+{
+    std::filesystem::path output = "BuildManifest";
+    std::filesystem::remove_all(output);
+    std::filesystem::create_directories(output);
+
+    BuildManifest manifest("elevationNormal=1");
+    manifest.setSharedInputs({{"GTModel/model.flt", 12, 34, 56}});
+
+    BuildManifestGeoCell geoCell;
+    geoCell.inputs = {{"Tiles/N32/W119/elevation.tif", 1, 2, 3}, {"Tiles/N32/W119/imagery.jp2", 4, 5, 6}};
+    geoCell.tilesets = {"Tiles/N32/W119/Elevation/1_1/N32W119_D001_S001_T001.json"};
+    geoCell.tilesetHeights = {{-12.5, 1432.0}};
+    manifest.setGeoCell("Tiles/N32/W119", geoCell);
+    manifest.writeToFile(output / BuildManifest::FILENAME);
+
+    auto readManifest = BuildManifest::createFromFile(output / BuildManifest::FILENAME);
+    REQUIRE(readManifest);
+    REQUIRE(readManifest->getSettings() == "elevationNormal=1");
+    REQUIRE(readManifest->getSharedInputs() == manifest.getSharedInputs());
+    REQUIRE(readManifest->getGeoCells().size() == 1);
+
+    const auto *readGeoCell = readManifest->getGeoCell("Tiles/N32/W119");
+    REQUIRE(readGeoCell != nullptr);
+    REQUIRE(readGeoCell->inputs == geoCell.inputs);
+    REQUIRE(readGeoCell->tilesets == geoCell.tilesets);
+    REQUIRE(readGeoCell->tilesetHeights == geoCell.tilesetHeights);
+    REQUIRE(readManifest->getGeoCell("Tiles/N32/W118") == nullptr);
+
+    SECTION("Test corrupted manifest is ignored")
+    {
+        std::ofstream fs(output / BuildManifest::FILENAME);
+        fs << "{\"version\": 1, \"settings\": ";
+        fs.close();
+        REQUIRE(BuildManifest::createFromFile(output / BuildManifest::FILENAME) == std::nullopt);
+    }
+
+    std::filesystem::remove_all(output);
+}
+
+TEST_CASE("Test build manifest only hashes changed input files", "[BuildManifest]")
+{
+    std::filesystem::path root = "BuildManifestInputs";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root / "Tiles" / "N32");
+    {
+        std::ofstream fs(root / "Tiles" / "N32" / "b.dbf");
+        fs << "attributes";
+    }
+    {
+        std::ofstream fs(root / "Tiles" / "a.tif");
+        fs << "elevation";
+    }
+
+    auto inputs = BuildManifest::collectInputFiles(root, root / "Tiles", nullptr);
+    REQUIRE(inputs.size() == 2);
+    REQUIRE(inputs[0].path == std::filesystem::path("Tiles/N32/b.dbf"));
+    REQUIRE(inputs[1].path == std::filesystem::path("Tiles/a.tif"));
+    REQUIRE(inputs[1].size == 9);
+    REQUIRE(inputs[1].contentHash == BuildManifest::hashFileContent(root / "Tiles" / "a.tif"));
+
+    // unchanged size and time stamp reuse the recorded hash instead of reading the file
+    auto recorded = inputs;
+    recorded[1].contentHash = 42;
+    auto unchanged = BuildManifest::collectInputFiles(root, root / "Tiles", &recorded);
+    REQUIRE(unchanged[1].contentHash == 42);
+
+    // a different size forces the file to be read again
+    recorded[1].size = 1;
+    auto changed = BuildManifest::collectInputFiles(root, root / "Tiles", &recorded);
+    REQUIRE(changed[1].contentHash == inputs[1].contentHash);
+
+    REQUIRE(BuildManifest::collectInputFiles(root, root / "Metadata", nullptr).empty());
+
+    std::filesystem::remove_all(root);
+}
+
+TEST_CASE("Test incremental conversion only reconverts changed GeoCells", "[BuildManifest]")
+{
+    std::filesystem::path input = "BuildManifestCDB";
+    std::filesystem::path output = "BuildManifestOutput";
+    std::filesystem::remove_all(input);
+    std::filesystem::remove_all(output);
+    std::filesystem::copy(dataPath / "CombineTilesets", input, std::filesystem::copy_options::recursive);
+
+    {
+        Converter converter(input, output);
+        converter.setIncremental(true);
+        converter.convert();
+    }
+
+    auto manifest = BuildManifest::createFromFile(output / BuildManifest::FILENAME);
+    REQUIRE(manifest);
+    REQUIRE(manifest->getGeoCells().size() == 2);
+    const auto *elevationGeoCell = manifest->getGeoCell("Tiles/N32/W119");
+    REQUIRE(elevationGeoCell != nullptr);
+    REQUIRE(!elevationGeoCell->inputs.empty());
+    REQUIRE(!elevationGeoCell->tilesets.empty());
+
+    std::filesystem::path elevationTileset = output / elevationGeoCell->tilesets.front();
+    std::filesystem::path GTModelTileset = output / manifest->getGeoCell("Tiles/N32/W118")->tilesets.front();
+    REQUIRE(std::filesystem::exists(elevationTileset));
+    REQUIRE(std::filesystem::exists(GTModelTileset));
+
+    SECTION("Test unchanged GeoCells are skipped")
+    {
+        // mark the output, so it is possible to tell whether the GeoCell is converted again
+        std::filesystem::path marker = output / "Tiles" / "N32" / "W119" / "marker";
+        std::ofstream(marker).close();
+
+        Converter converter(input, output);
+        converter.setIncremental(true);
+        converter.convert();
+
+        REQUIRE(std::filesystem::exists(marker));
+        REQUIRE(std::filesystem::exists(output / "Elevation_1_1.json"));
+        REQUIRE(std::filesystem::exists(output / "GTModels_2_1.json"));
+    }
+
+    SECTION("Test GeoCells with missing output are reconverted")
+    {
+        std::filesystem::path marker = output / "Tiles" / "N32" / "W118" / "marker";
+        std::ofstream(marker).close();
+        std::filesystem::remove(elevationTileset);
+
+        Converter converter(input, output);
+        converter.setIncremental(true);
+        converter.convert();
+
+        REQUIRE(std::filesystem::exists(elevationTileset));
+        REQUIRE(std::filesystem::exists(marker));
+    }
+
+    SECTION("Test output of removed GeoCells is deleted")
+    {
+        std::filesystem::remove_all(input / "Tiles" / "N32" / "W118");
+
+        Converter converter(input, output);
+        converter.setIncremental(true);
+        converter.convert();
+
+        REQUIRE(!std::filesystem::exists(output / "Tiles" / "N32" / "W118"));
+        REQUIRE(!std::filesystem::exists(GTModelTileset));
+        REQUIRE(std::filesystem::exists(elevationTileset));
+
+        auto updatedManifest = BuildManifest::createFromFile(output / BuildManifest::FILENAME);
+        REQUIRE(updatedManifest);
+        REQUIRE(updatedManifest->getGeoCells().size() == 1);
+    }
+
+    SECTION("Test changed settings convert everything again")
+    {
+        std::filesystem::path marker = output / "Tiles" / "N32" / "W119" / "marker";
+        std::ofstream(marker).close();
+
+        Converter converter(input, output);
+        converter.setIncremental(true);
+        converter.setGenerateElevationNormal(true);
+        converter.convert();
+
+        REQUIRE(!std::filesystem::exists(marker));
+        REQUIRE(std::filesystem::exists(elevationTileset));
+    }
+
+    std::filesystem::remove_all(input);
+    std::filesystem::remove_all(output);
+}
+
+TEST_CASE("Test incremental conversion keeps GeoCells in latitudes left out by the filter", "[BuildManifest]")
+{
+    std::filesystem::path input = "BuildManifestFilteredCDB";
+    std::filesystem::path output = "BuildManifestFilteredOutput";
+    std::filesystem::remove_all(input);
+    std::filesystem::remove_all(output);
+    std::filesystem::copy(dataPath / "CombineTilesets", input, std::filesystem::copy_options::recursive);
+    copyGeoCellToLatitude(input, "N32", "W118", "N33");
+    copyGeoCellToLatitude(input, "N32", "W118", "N34");
+
+    {
+        Converter converter(input, output);
+        converter.setIncremental(true);
+        converter.convert();
+    }
+
+    auto manifest = BuildManifest::createFromFile(output / BuildManifest::FILENAME);
+    REQUIRE(manifest);
+    REQUIRE(manifest->getGeoCells().size() == 4);
+
+    // the filter spans N32 and N33, so N34 is not in the catalog at all
+    std::filesystem::remove_all(input / "Tiles" / "N33" / "W118");
+    {
+        Converter converter(input, output);
+        converter.setIncremental(true);
+        converter.addGeoCell("N32W119");
+        converter.addGeoCell("N33W118");
+        converter.convert();
+    }
+
+    REQUIRE(std::filesystem::exists(output / "Tiles" / "N32" / "W118"));
+    REQUIRE(std::filesystem::exists(output / "Tiles" / "N34" / "W118"));
+    REQUIRE(!std::filesystem::exists(output / "Tiles" / "N33" / "W118"));
+
+    auto updatedManifest = BuildManifest::createFromFile(output / BuildManifest::FILENAME);
+    REQUIRE(updatedManifest);
+    REQUIRE(updatedManifest->getGeoCells().size() == 3);
+    REQUIRE(updatedManifest->getGeoCell("Tiles/N34/W118") != nullptr);
+    REQUIRE(updatedManifest->getGeoCell("Tiles/N33/W118") == nullptr);
+
+    std::filesystem::remove_all(input);
+    std::filesystem::remove_all(output);
+}
+
+TEST_CASE("Test shard manifests are named by their shard", "[BuildManifest]")
+{
+    auto filename = BuildManifest::getShardFilename(2, 4);
+    REQUIRE(filename != BuildManifest::FILENAME);
+    REQUIRE(BuildManifest::parseShardFilename(filename.string()) == std::make_pair<size_t, size_t>(2, 4));
+    REQUIRE(BuildManifest::parseShardFilename(BuildManifest::FILENAME.string()) == std::nullopt);
+    REQUIRE(BuildManifest::parseShardFilename("manifest.shard-4-of-4.json") == std::nullopt);
+    REQUIRE(BuildManifest::parseShardFilename("manifest.shard-a-of-4.json") == std::nullopt);
+
+    BuildManifest manifest("elevationNormal=1");
+    manifest.setGeoCell("Tiles/N32/W119", {});
+
+    BuildManifest shard("elevationNormal=1");
+    shard.setGeoCell("Tiles/N32/W118", {});
+    manifest.merge(shard);
+    REQUIRE(manifest.getGeoCells().size() == 2);
+
+    REQUIRE_THROWS_WITH(manifest.merge(shard), "GeoCell Tiles/N32/W118 was converted by more than one shard");
+    REQUIRE_THROWS(manifest.merge(BuildManifest("elevationNormal=0")));
+}
+
+TEST_CASE("Test merged shards combine the same tilesets as one conversion", "[BuildManifest]")
+{
+    std::filesystem::path input = dataPath / "CombineTilesets";
+    std::filesystem::path output = "BuildManifestShards";
+    std::filesystem::path expectedOutput = "BuildManifestNoShards";
+    std::filesystem::remove_all(output);
+    std::filesystem::remove_all(expectedOutput);
+
+    {
+        Converter converter(input, expectedOutput);
+        converter.convert();
+    }
+
+    for (size_t i = 0; i < 2; ++i) {
+        Converter converter(input, output);
+        converter.setShard(i, 2);
+        converter.convert();
+        REQUIRE(std::filesystem::exists(output / BuildManifest::getShardFilename(i, 2)));
+    }
+
+    REQUIRE(!std::filesystem::exists(output / "Elevation_1_1.json"));
+
+    {
+        Converter converter("", output);
+        converter.merge();
+    }
+
+    auto manifest = BuildManifest::createFromFile(output / BuildManifest::FILENAME);
+    REQUIRE(manifest);
+    REQUIRE(manifest->getGeoCells().size() == 2);
+
+    for (const auto &tileset : {"Elevation_1_1.json", "GTModels_2_1.json", "GTModels_1_1.json"}) {
+        std::ifstream fs(output / tileset);
+        std::ifstream expectedFs(expectedOutput / tileset);
+        REQUIRE(fs);
+        REQUIRE(expectedFs);
+        REQUIRE(nlohmann::json::parse(fs) == nlohmann::json::parse(expectedFs));
+    }
+
+    SECTION("Test merge fails until every shard is converted")
+    {
+        std::filesystem::remove(output / BuildManifest::getShardFilename(1, 2));
+        Converter converter("", output);
+        REQUIRE_THROWS_WITH(converter.merge(), "Shard 1 of 2 has not been converted");
+    }
+
+    REQUIRE_THROWS(Converter(input, output).setShard(2, 2));
+
+    std::filesystem::remove_all(output);
+    std::filesystem::remove_all(expectedOutput);
+}
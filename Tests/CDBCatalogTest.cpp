@@ -0,0 +1,100 @@
+#include "CDB.h"
+#include "CDBCatalog.h"
+#include "Config.h"
+#include "catch2/catch.hpp"
+#include <algorithm>
+
+using namespace CDBTo3DTiles;
+
+static size_t countFiles(const std::filesystem::path &directory)
+{
+    size_t fileCount = 0;
+    for (const auto &entry : std::filesystem::recursive_directory_iterator(directory)) {
+        if (entry.is_regular_file()) {
+            ++fileCount;
+        }
+    }
+
+    return fileCount;
+}
+
+TEST_CASE("Test catalog lists the CDB", "[CDBCatalog]")
+{
+    std::filesystem::path CDBPath = dataPath / "RoadNetwork";
+    std::filesystem::path tileDirectory = "Tiles/N32/W118/201_RoadNetwork/LC/U0";
+
+    SECTION("Test every file is listed whatever the thread count")
+    {
+        size_t fileCount = countFiles(CDBPath);
+        auto catalog = CDBCatalog::createFromDirectory(CDBPath, 1);
+        REQUIRE(catalog.getFileCount() == fileCount);
+        REQUIRE(CDBCatalog::createFromDirectory(CDBPath, 8).getFileCount() == fileCount);
+        REQUIRE(catalog.getScanSeconds() >= 0.0);
+    }
+
+    SECTION("Test entries are grouped by directory and sorted")
+    {
+        auto catalog = CDBCatalog::createFromDirectory(CDBPath, 4);
+        REQUIRE(catalog.isDirectoryExist(""));
+        REQUIRE(catalog.isDirectoryExist("Tiles"));
+        REQUIRE(catalog.getDirectories("Tiles") == std::vector<std::string>{"N32"});
+
+        const auto &files = catalog.getFiles(tileDirectory);
+        REQUIRE(!files.empty());
+        REQUIRE(std::is_sorted(files.begin(), files.end()));
+        REQUIRE(catalog.getDirectories(tileDirectory).empty());
+        REQUIRE(catalog.isFileExist(tileDirectory / "N32W118_D201_S002_T003_LC05_U0_R0.dbf"));
+        REQUIRE(!catalog.isFileExist(tileDirectory / "N32W118_D201_S002_T003_LC05_U0_R1.dbf"));
+        REQUIRE(!catalog.isFileExist(tileDirectory));
+        REQUIRE(!catalog.isDirectoryExist(tileDirectory / "N32W118_D201_S002_T003_LC05_U0_R0.dbf"));
+    }
+
+    SECTION("Test missing directory has no entries")
+    {
+        auto catalog = CDBCatalog::createFromDirectory(CDBPath, 4);
+        REQUIRE(!catalog.isDirectoryExist("Tiles/N33"));
+        REQUIRE(catalog.getDirectories("Tiles/N33").empty());
+        REQUIRE(catalog.getFiles("Tiles/N33").empty());
+    }
+
+    SECTION("Test missing root gives an empty catalog")
+    {
+        auto catalog = CDBCatalog::createFromDirectory(dataPath / "Missing", 4);
+        REQUIRE(!catalog.isDirectoryExist(""));
+        REQUIRE(catalog.getDirectoryCount() == 0);
+        REQUIRE(catalog.getFileCount() == 0);
+    }
+
+    SECTION("Test filtered directories are listed without their content")
+    {
+        auto catalog = CDBCatalog::createFromDirectory(CDBPath, 4, [](const std::string &directory) {
+            return directory != "Tiles/N32";
+        });
+
+        REQUIRE(catalog.isDirectoryExist("Tiles/N32"));
+        REQUIRE(catalog.getDirectories("Tiles/N32").empty());
+        REQUIRE(!catalog.isFileExist(tileDirectory / "N32W118_D201_S002_T003_LC05_U0_R0.dbf"));
+    }
+}
+
+TEST_CASE("Test CDB scans only the GeoCells of its filter", "[CDBCatalog]")
+{
+    std::filesystem::path CDBPath = dataPath / "CombineTilesets";
+    CDB cdb(CDBPath);
+    REQUIRE(cdb.getCatalog().getDirectories("Tiles/N32") == std::vector<std::string>{"W118", "W119"});
+    REQUIRE(!cdb.getCatalog().getDirectories("Tiles/N32/W118").empty());
+
+    CDBFilter filter;
+    filter.addGeoCell(CDBGeoCell(32, -119));
+    cdb.setFilter(filter);
+    REQUIRE(cdb.getCatalog().isDirectoryExist("Tiles/N32/W118"));
+    REQUIRE(cdb.getCatalog().getDirectories("Tiles/N32/W118").empty());
+    REQUIRE(!cdb.getCatalog().getDirectories("Tiles/N32/W119").empty());
+
+    // the model library is outside of the GeoCells and always scanned
+    REQUIRE(cdb.getCatalog().isDirectoryExist("GTModel/500_GTModelGeometry"));
+
+    std::vector<CDBGeoCell> geoCells;
+    cdb.forEachGeoCell([&](CDBGeoCell geoCell) { geoCells.emplace_back(geoCell); });
+    REQUIRE(geoCells == std::vector<CDBGeoCell>{CDBGeoCell(32, -119)});
+}
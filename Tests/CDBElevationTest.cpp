@@ -114,6 +114,12 @@ TEST_CASE("Test create elevation from file", "[CDBElevation]")
         REQUIRE(mesh.UVs.size() == 289);
         REQUIRE(mesh.normals.size() == 0);
 
+        // heights are kept for model clamping
+        const auto &heightGrid = elevation->getHeightGrid();
+        REQUIRE(heightGrid != nullptr);
+        REQUIRE(heightGrid->getWidth() == 16);
+        REQUIRE(heightGrid->getHeight() == 16);
+
         // Check tile
         const auto &cdbTile = elevation->getTile();
         REQUIRE(cdbTile.getGeoCell() == CDBGeoCell(34, -119));
@@ -153,6 +159,27 @@ TEST_CASE("Test create elevation from file", "[CDBElevation]")
     }
 }
 
+TEST_CASE("Test measure geometric error of an elevation", "[CDBElevation]")
+{
+    auto elevation = CDBElevation::createFromFile(dataPath / "Elevation"
+                                                  / "N34W119_D001_S001_T001_LC06_U0_R0.tif");
+    REQUIRE(elevation != std::nullopt);
+    size_t indexCount = elevation->getUniformGridMesh().indices.size();
+
+    // keeping every triangle loses nothing
+    double fullError = -1.0;
+    auto full = elevation->createSimplifiedMesh(indexCount, 0.0f, fullError);
+    REQUIRE(full.indices.size() == indexCount);
+    REQUIRE(fullError == Approx(0.0).margin(0.01));
+
+    double simplifiedError = -1.0;
+    elevation->createSimplifiedMesh(indexCount / 10, 1.0f, simplifiedError);
+    REQUIRE(simplifiedError >= fullError);
+
+    REQUIRE(elevation->computeRefinementError() >= 0.0);
+    REQUIRE(elevation->computeGridSpacing() > 0.0);
+}
+
 TEST_CASE("Test create sub region of an elevation", "[CDBElevation]")
 {
     // 16x16 mesh
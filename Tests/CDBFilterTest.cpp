@@ -0,0 +1,135 @@
+#include "CDBFilter.h"
+#include "CDBTo3DTiles.h"
+#include "Config.h"
+#include "catch2/catch.hpp"
+
+using namespace CDBTo3DTiles;
+
+TEST_CASE("Test filter includes everything by default", "[CDBFilter]")
+{
+    CDBFilter filter;
+    REQUIRE(filter.isLatitudeIncluded(-90));
+    REQUIRE(filter.isGeoCellIncluded(CDBGeoCell(32, -119)));
+    REQUIRE(filter.isDatasetIncluded(CDBDataset::Elevation));
+    REQUIRE(filter.isLevelIncluded(CDBDataset::Elevation, CDBFilter::MIN_LEVEL));
+    REQUIRE(filter.isLevelIncluded(CDBDataset::GTFeature, CDBFilter::MAX_LEVEL));
+    REQUIRE(filter.getContentSettings().empty());
+}
+
+TEST_CASE("Test filter by GeoCells", "[CDBFilter]")
+{
+    CDBFilter filter;
+
+    SECTION("Test GeoCells overlapping the region are included")
+    {
+        filter.setRectangle(-118.5, 32.5, -117.5, 32.75);
+        REQUIRE(filter.isLatitudeIncluded(32));
+        REQUIRE(!filter.isLatitudeIncluded(33));
+        REQUIRE(!filter.isLatitudeIncluded(31));
+        REQUIRE(filter.isGeoCellIncluded(CDBGeoCell(32, -119)));
+        REQUIRE(filter.isGeoCellIncluded(CDBGeoCell(32, -118)));
+        REQUIRE(!filter.isGeoCellIncluded(CDBGeoCell(32, -117)));
+        REQUIRE(!filter.isGeoCellIncluded(CDBGeoCell(32, -120)));
+    }
+
+    SECTION("Test GeoCells wider than a degree overlap by their extent")
+    {
+        filter.setRectangle(11.5, 60.5, 11.75, 60.75);
+        REQUIRE(filter.isGeoCellIncluded(CDBGeoCell(60, 10)));
+        REQUIRE(!filter.isGeoCellIncluded(CDBGeoCell(60, 12)));
+    }
+
+    SECTION("Test listed GeoCells are included along with the region")
+    {
+        filter.setRectangle(-118.5, 32.5, -117.5, 32.75);
+        filter.addGeoCell(CDBGeoCell(40, 10));
+        REQUIRE(filter.isLatitudeIncluded(40));
+        REQUIRE(filter.isGeoCellIncluded(CDBGeoCell(40, 10)));
+        REQUIRE(!filter.isGeoCellIncluded(CDBGeoCell(40, 11)));
+        REQUIRE(filter.isGeoCellIncluded(CDBGeoCell(32, -118)));
+    }
+
+    REQUIRE_THROWS(filter.setRectangle(1.0, 0.0, 0.0, 1.0));
+    REQUIRE(filter.getContentSettings().empty());
+}
+
+TEST_CASE("Test filter by datasets and levels", "[CDBFilter]")
+{
+    CDBFilter filter;
+    filter.addDataset(CDBDataset::Elevation);
+    filter.addDataset(CDBDataset::GTFeature);
+    filter.setLevelRange(-10, 8);
+    filter.setLevelRange(CDBDataset::GTFeature, 0, 4);
+
+    REQUIRE(filter.isDatasetIncluded(CDBDataset::Elevation));
+    REQUIRE(filter.isDatasetIncluded(CDBDataset::GTFeature));
+    REQUIRE(!filter.isDatasetIncluded(CDBDataset::RoadNetwork));
+    REQUIRE(filter.isLevelIncluded(CDBDataset::Elevation, 8));
+    REQUIRE(!filter.isLevelIncluded(CDBDataset::Elevation, 9));
+    REQUIRE(!filter.isLevelIncluded(CDBDataset::GTFeature, -1));
+    REQUIRE(filter.isLevelIncluded(CDBDataset::GTFeature, 4));
+    REQUIRE(filter.getLevelRange(CDBDataset::GTFeature) == std::make_pair(0, 4));
+    REQUIRE(filter.getContentSettings() == ";datasets=1,101,;levels=-10:8;levels101=0:4");
+
+    REQUIRE_THROWS(filter.setLevelRange(2, 1));
+}
+
+TEST_CASE("Test converter only converts the filtered GeoCells and datasets", "[CDBFilter]")
+{
+    std::filesystem::path input = dataPath / "CombineTilesets";
+    std::filesystem::path output = "CDBFilter";
+    std::filesystem::remove_all(output);
+
+    SECTION("Test GeoCell filter")
+    {
+        Converter converter(input, output);
+        converter.addGeoCell("N32W119");
+        converter.convert();
+
+        REQUIRE(std::filesystem::exists(output / "Elevation_1_1.json"));
+        REQUIRE(!std::filesystem::exists(output / "GTModels_2_1.json"));
+        REQUIRE(!std::filesystem::exists(output / "Tiles" / "N32" / "W118"));
+    }
+
+    SECTION("Test region filter")
+    {
+        Converter converter(input, output);
+        converter.setRegion(-117.75, 32.25, -117.25, 32.75);
+        converter.convert();
+
+        REQUIRE(!std::filesystem::exists(output / "Elevation_1_1.json"));
+        REQUIRE(std::filesystem::exists(output / "GTModels_2_1.json"));
+    }
+
+    SECTION("Test dataset filter")
+    {
+        Converter converter(input, output);
+        converter.setDatasets({"GTModels"});
+        converter.convert();
+
+        REQUIRE(!std::filesystem::exists(output / "Elevation_1_1.json"));
+        REQUIRE(!std::filesystem::exists(output / "RoadNetwork_2_3.json"));
+        REQUIRE(std::filesystem::exists(output / "GTModels_2_1.json"));
+    }
+
+    SECTION("Test level filter")
+    {
+        Converter converter(input, output);
+        converter.setLevelRange("Elevation", 0, 23);
+        converter.convert();
+
+        // the test elevation only has negative levels
+        REQUIRE(!std::filesystem::exists(output / "Elevation_1_1.json"));
+        REQUIRE(std::filesystem::exists(output / "GTModels_2_1.json"));
+    }
+
+    SECTION("Test invalid filters")
+    {
+        Converter converter(input, output);
+        REQUIRE_THROWS(converter.addGeoCell("N32"));
+        REQUIRE_THROWS(converter.setDatasets({"Imagery"}));
+        REQUIRE_THROWS(converter.setLevelRange("SASS", 0, 1));
+    }
+
+    std::filesystem::remove_all(output);
+}
@@ -2,10 +2,45 @@
 #include "CDBTo3DTiles.h"
 #include "Config.h"
 #include "catch2/catch.hpp"
+#include "ogrsf_frmts.h"
+#include <algorithm>
 #include <filesystem>
+#include <fstream>
 
 using namespace CDBTo3DTiles;
 
+// the attributes read from the dBase table match what OGR reads field by field
+static void checkAttributesMatchOGR(const CDBInstancesAttributes &attributes,
+                                    const std::filesystem::path &file)
+{
+    GDALDatasetUniquePtr dataset = GDALDatasetUniquePtr(
+        (GDALDataset *) GDALOpenEx(file.c_str(), GDAL_OF_VECTOR, nullptr, nullptr, nullptr));
+    REQUIRE(dataset != nullptr);
+
+    CDBInstancesAttributes expectedAttributes;
+    for (int i = 0; i < dataset->GetLayerCount(); ++i) {
+        for (const auto &feature : *dataset->GetLayer(i)) {
+            expectedAttributes.addInstanceFeature(*feature);
+        }
+    }
+
+    REQUIRE(expectedAttributes.getInstancesCount() > 0);
+    REQUIRE(attributes.getCNAMs() == expectedAttributes.getCNAMs());
+
+    // class attributes are merged in afterwards, so only the fields of the instances are compared
+    for (const auto &field : expectedAttributes.getIntegerAttribs()) {
+        REQUIRE(attributes.getIntegerAttribs().at(field.first) == field.second);
+    }
+
+    for (const auto &field : expectedAttributes.getDoubleAttribs()) {
+        REQUIRE(attributes.getDoubleAttribs().at(field.first) == field.second);
+    }
+
+    for (const auto &field : expectedAttributes.getStringAttribs()) {
+        REQUIRE(attributes.getStringAttribs().at(field.first) == field.second);
+    }
+}
+
 TEST_CASE("Test create CDBGeometryVector", "[CDBGeometryVectors]")
 {
     SECTION("Test valid file with line geometry")
@@ -113,6 +148,9 @@ TEST_CASE("Test create CDBGeometryVector", "[CDBGeometryVectors]")
         REQUIRE(mesh.positionRTCs.size() > 0);
         REQUIRE(mesh.normals.size() == 0);
         REQUIRE(mesh.UVs.size() == 0);
+        REQUIRE(mesh.indices.size() % 3 == 0);
+        REQUIRE(mesh.batchIDs.size() == mesh.positions.size());
+        REQUIRE(std::is_sorted(mesh.batchIDs.begin(), mesh.batchIDs.end()));
 
         // check instance attributes share the same class attribute
         auto attribsInstances = vector->getInstancesAttributes();
@@ -158,3 +196,76 @@ TEST_CASE("Test create CDBGeometryVector", "[CDBGeometryVectors]")
     }
 }
 
+TEST_CASE("Test shapefile geometry matches OGR geometry", "[CDBGeometryVectors]")
+{
+    std::filesystem::path CDBPaths[] = {
+        dataPath / "RoadNetwork",
+        dataPath / "HydrographyNetwork",
+        dataPath / "GSFeature",
+    };
+
+    std::filesystem::path vectorFiles[] = {
+        CDBPaths[0] / "Tiles" / "N32" / "W118" / "201_RoadNetwork" / "LC" / "U0"
+            / "N32W118_D201_S002_T003_LC05_U0_R0.dbf",
+        CDBPaths[1] / "Tiles" / "N32" / "W118" / "204_HydrographyNetwork" / "LC" / "U0"
+            / "N32W118_D204_S002_T005_LC06_U0_R0.dbf",
+        CDBPaths[2] / "Tiles" / "N32" / "W118" / "100_GSFeature" / "LC" / "U0"
+            / "N32W118_D100_S004_T001_LC01_U0_R0.dbf",
+    };
+
+    for (size_t i = 0; i < std::size(vectorFiles); ++i) {
+        auto vector = CDBGeometryVectors::createFromFile(vectorFiles[i], CDBPaths[i]);
+        REQUIRE(vector != std::nullopt);
+
+        GDALDatasetUniquePtr dataset = GDALDatasetUniquePtr(
+            (GDALDataset *) GDALOpenEx(vectorFiles[i].c_str(), GDAL_OF_VECTOR, nullptr, nullptr, nullptr));
+        REQUIRE(dataset != nullptr);
+        CDBGeometryVectors expectedVector(std::move(dataset), vector->getTile(), CDBPaths[i]);
+
+        const auto &mesh = vector->getMesh();
+        const auto &expectedMesh = expectedVector.getMesh();
+        REQUIRE(mesh.primitiveType == expectedMesh.primitiveType);
+        REQUIRE(mesh.positions == expectedMesh.positions);
+        REQUIRE(mesh.positionRTCs == expectedMesh.positionRTCs);
+        REQUIRE(mesh.indices == expectedMesh.indices);
+        REQUIRE(mesh.batchIDs == expectedMesh.batchIDs);
+        checkAttributesMatchOGR(vector->getInstancesAttributes(), vectorFiles[i]);
+    }
+}
+
+TEST_CASE("Test shapefile geometry skips records deleted in the attribute table", "[CDBGeometryVectors]")
+{
+    std::filesystem::path CDBPath = "DeletedRecordsCDB";
+    std::filesystem::remove_all(CDBPath);
+    std::filesystem::copy(dataPath / "RoadNetwork", CDBPath, std::filesystem::copy_options::recursive);
+    std::filesystem::path vectorFile = CDBPath / "Tiles" / "N32" / "W118" / "201_RoadNetwork" / "LC" / "U0"
+                                       / "N32W118_D201_S002_T003_LC05_U0_R0.dbf";
+
+    // the first byte of a record is its deletion flag
+    {
+        std::fstream fs(vectorFile, std::ios::in | std::ios::out | std::ios::binary);
+        char headerLength[2];
+        fs.seekg(8);
+        fs.read(headerLength, sizeof(headerLength));
+        fs.seekp(static_cast<uint8_t>(headerLength[0]) | static_cast<uint8_t>(headerLength[1]) << 8);
+        fs.put('*');
+    }
+
+    auto vector = CDBGeometryVectors::createFromFile(vectorFile, CDBPath);
+    REQUIRE(vector != std::nullopt);
+
+    GDALDatasetUniquePtr dataset = GDALDatasetUniquePtr(
+        (GDALDataset *) GDALOpenEx(vectorFile.c_str(), GDAL_OF_VECTOR, nullptr, nullptr, nullptr));
+    REQUIRE(dataset != nullptr);
+    CDBGeometryVectors expectedVector(std::move(dataset), vector->getTile(), CDBPath);
+
+    const auto &mesh = vector->getMesh();
+    const auto &expectedMesh = expectedVector.getMesh();
+    REQUIRE(vector->getInstancesAttributes().getInstancesCount() == 7);
+    REQUIRE(mesh.positions == expectedMesh.positions);
+    REQUIRE(mesh.batchIDs == expectedMesh.batchIDs);
+    REQUIRE(mesh.batchIDs.back() == 6);
+    checkAttributesMatchOGR(vector->getInstancesAttributes(), vectorFile);
+
+    std::filesystem::remove_all(CDBPath);
+}
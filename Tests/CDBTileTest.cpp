@@ -50,7 +50,6 @@ TEST_CASE("Test CDBTile constructor", "[CDBTile]")
         REQUIRE(tile.getLevel() == -10);
         REQUIRE(tile.getUREF() == 0);
         REQUIRE(tile.getRREF() == 0);
-        REQUIRE(tile.getChildren().size() == 0);
         REQUIRE(tile.getCustomContentURI() == nullptr);
     }
 
@@ -95,13 +94,10 @@ TEST_CASE("Test CDBTile constructor", "[CDBTile]")
 
 TEST_CASE("Test CDBTile copy constructor", "[CDBTile]")
 {
-    // Create a child tile for tested tile below
     CDBGeoCell geoCell(32, -118);
-    std::unique_ptr<CDBTile> child = std::make_unique<CDBTile>(geoCell, CDBDataset::Elevation, 1, 2, -9, 0, 0);
 
     // Create parent tile. Test to make sure it has good properties
     CDBTile tile(geoCell, CDBDataset::Elevation, 1, 2, -10, 0, 0);
-    tile.getChildren().emplace_back(child.get());
 
     double boundNorth = glm::radians(32.0 + geoCell.getLatitudeExtentInDegree());
     double boundWest = glm::radians(-118.0);
@@ -124,10 +120,9 @@ TEST_CASE("Test CDBTile copy constructor", "[CDBTile]")
     REQUIRE(tile.getLevel() == -10);
     REQUIRE(tile.getUREF() == 0);
     REQUIRE(tile.getRREF() == 0);
-    REQUIRE(tile.getChildren().front() == child.get());
     REQUIRE(tile.getCustomContentURI() == nullptr);
 
-    // Create copy tile. Make sure all the properties are the same except children
+    // Create copy tile. Make sure all the properties are the same
     CDBTile copiedTile = tile;
     const BoundingRegion &copiedRegion = copiedTile.getBoundRegion();
     const GlobeRectangle &copiedRectangle = copiedRegion.getRectangle();
@@ -147,19 +142,15 @@ TEST_CASE("Test CDBTile copy constructor", "[CDBTile]")
     REQUIRE(copiedTile.getLevel() == -10);
     REQUIRE(copiedTile.getUREF() == 0);
     REQUIRE(copiedTile.getRREF() == 0);
-    REQUIRE(copiedTile.getChildren().size() == 0);
     REQUIRE(copiedTile.getCustomContentURI() == nullptr);
 }
 
 TEST_CASE("Test CDBTile move constructor", "[CDBTile]")
 {
-    // Create a child tile for tested tile below
     CDBGeoCell geoCell(32, -118);
-    std::unique_ptr<CDBTile> child = std::make_unique<CDBTile>(geoCell, CDBDataset::Elevation, 1, 2, -9, 0, 0);
 
     // Create parent tile.
     CDBTile tile(geoCell, CDBDataset::Elevation, 1, 2, -10, 0, 0);
-    tile.getChildren().emplace_back(child.get());
 
     // Move tile to the new one. Make sure the moved tile has all the property of the previous tile
     CDBTile movedTile(std::move(tile));
@@ -186,21 +177,17 @@ TEST_CASE("Test CDBTile move constructor", "[CDBTile]")
     REQUIRE(movedTile.getLevel() == -10);
     REQUIRE(movedTile.getUREF() == 0);
     REQUIRE(movedTile.getRREF() == 0);
-    REQUIRE(movedTile.getChildren().front() == child.get());
     REQUIRE(movedTile.getCustomContentURI() == nullptr);
 }
 
 TEST_CASE("Test CDBTile copy assignment", "[CDBTile]")
 {
-    // Create a child tile for tested tile below
     CDBGeoCell geoCell(32, -118);
-    std::unique_ptr<CDBTile> child = std::make_unique<CDBTile>(geoCell, CDBDataset::Elevation, 1, 2, -9, 0, 0);
 
     // Create parent tile.
     CDBTile tile(geoCell, CDBDataset::Elevation, 1, 2, -10, 0, 0);
-    tile.getChildren().emplace_back(child.get());
 
-    // copy tile to the new one. Make sure the copied tile don't have any children
+    // copy tile to the new one. Make sure the copied tile has all the property of the previous tile
     CDBTile copiedTile(geoCell, CDBDataset::Elevation, 1, 1, -8, 0, 0);
     copiedTile = tile;
 
@@ -226,19 +213,15 @@ TEST_CASE("Test CDBTile copy assignment", "[CDBTile]")
     REQUIRE(copiedTile.getLevel() == -10);
     REQUIRE(copiedTile.getUREF() == 0);
     REQUIRE(copiedTile.getRREF() == 0);
-    REQUIRE(copiedTile.getChildren().size() == 0);
     REQUIRE(copiedTile.getCustomContentURI() == nullptr);
 }
 
 TEST_CASE("Test CDBTile move assignment", "[CDBTile]")
 {
-    // Create a child tile for tested tile below
     CDBGeoCell geoCell(32, -118);
-    std::unique_ptr<CDBTile> child = std::make_unique<CDBTile>(geoCell, CDBDataset::Elevation, 1, 2, -9, 0, 0);
 
     // Create parent tile.
     CDBTile tile(geoCell, CDBDataset::Elevation, 1, 2, -10, 0, 0);
-    tile.getChildren().emplace_back(child.get());
 
     // Move tile to the new one. Make sure the moved tile has all the property of the previous tile
     CDBTile movedTile(geoCell, CDBDataset::Elevation, 1, 1, -8, 0, 0);
@@ -266,7 +249,6 @@ TEST_CASE("Test CDBTile move assignment", "[CDBTile]")
     REQUIRE(movedTile.getLevel() == -10);
     REQUIRE(movedTile.getUREF() == 0);
     REQUIRE(movedTile.getRREF() == 0);
-    REQUIRE(movedTile.getChildren().front() == child.get());
     REQUIRE(movedTile.getCustomContentURI() == nullptr);
 }
 
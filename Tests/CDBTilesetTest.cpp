@@ -4,7 +4,10 @@
 using namespace CDBTo3DTiles;
 using namespace Core;
 
-static void checkTileInsertedSuccessfully(const CDBTile *node, const CDBTile &tileToCheck, bool &seeNode)
+static void checkTileInsertedSuccessfully(const CDBTileset &tileset,
+                                          const CDBTile *node,
+                                          const CDBTile &tileToCheck,
+                                          bool &seeNode)
 {
     if (node == nullptr) {
         return;
@@ -19,15 +22,15 @@ static void checkTileInsertedSuccessfully(const CDBTile *node, const CDBTile &ti
         return;
     }
 
-    for (auto child : node->getChildren()) {
-        checkTileInsertedSuccessfully(child, tileToCheck, seeNode);
+    for (auto child : tileset.getChildren(*node)) {
+        checkTileInsertedSuccessfully(tileset, child, tileToCheck, seeNode);
     }
 }
 
-static bool isNodeInTree(const CDBTile *node, const CDBTile &tileToCheck)
+static bool isNodeInTree(const CDBTileset &tileset, const CDBTile &tileToCheck)
 {
     bool seeNode = false;
-    checkTileInsertedSuccessfully(node, tileToCheck, seeNode);
+    checkTileInsertedSuccessfully(tileset, tileset.getRoot(), tileToCheck, seeNode);
     return seeNode;
 }
 
@@ -42,12 +45,12 @@ TEST_CASE("Test insertion", "[CDBTileset]")
         CDBGeoCell geoCell(32, -118);
         CDBTile root(geoCell, CDBDataset::Elevation, 1, 1, -10, 0, 0);
         REQUIRE(tileset.insertTile(root) != nullptr);
-        REQUIRE(isNodeInTree(tileset.getRoot(), root));
+        REQUIRE(isNodeInTree(tileset, root));
 
         // insert tile not root
         CDBTile tile(geoCell, CDBDataset::Elevation, 1, 1, 10, 0, 0);
         REQUIRE(tileset.insertTile(tile) != nullptr);
-        REQUIRE(isNodeInTree(tileset.getRoot(), tile));
+        REQUIRE(isNodeInTree(tileset, tile));
     }
 
     SECTION("Insert with constructor that specify root level, UREF, and RREF")
@@ -58,11 +61,11 @@ TEST_CASE("Test insertion", "[CDBTileset]")
         CDBGeoCell geoCell(32, -118);
         CDBTile root(geoCell, CDBDataset::Elevation, 1, 1, 3, 0, 0);
         REQUIRE(tileset.insertTile(root) != nullptr);
-        REQUIRE(isNodeInTree(tileset.getRoot(), root));
+        REQUIRE(isNodeInTree(tileset, root));
 
         CDBTile tile(geoCell, CDBDataset::Elevation, 1, 1, 10, 0, 0);
         REQUIRE(tileset.insertTile(tile) != nullptr);
-        REQUIRE(isNodeInTree(tileset.getRoot(), tile));
+        REQUIRE(isNodeInTree(tileset, tile));
     }
 
     SECTION("Insert invalid node ")
@@ -140,3 +143,80 @@ TEST_CASE("Test get fit tile", "[CDBTileset]")
         REQUIRE(fitTile == nullptr);
     }
 }
+
+TEST_CASE("Test looking up tiles by level and position", "[CDBTileset]")
+{
+    CDBTileset tileset;
+    CDBGeoCell geoCell(32, -118);
+    CDBTile tile(geoCell, CDBDataset::Elevation, 1, 1, 2, 3, 1);
+    tile.setCustomContentURI("tile.b3dm");
+    tileset.insertTile(tile);
+    tileset.insertTile(CDBTile(geoCell, CDBDataset::Elevation, 1, 1, 2, 0, 0));
+
+    // every ancestor is created once, with the root at the front
+    REQUIRE(tileset.getRoot()->getLevel() == -10);
+    const CDBTile *inserted = tileset.getTile(2, 3, 1);
+    REQUIRE(inserted != nullptr);
+    REQUIRE(*inserted == tile);
+    REQUIRE(*inserted->getCustomContentURI() == "tile.b3dm");
+    REQUIRE(tileset.getTile(2, 1, 3) == nullptr);
+    REQUIRE(tileset.isLeaf(*inserted));
+
+    const CDBTile *parent = tileset.getTile(1, 1, 0);
+    REQUIRE(parent != nullptr);
+    REQUIRE(parent->getCustomContentURI() == nullptr);
+    REQUIRE(!tileset.isLeaf(*parent));
+
+    // the child at UREF 3 and RREF 1 is the north east one of its parent
+    auto children = tileset.getChildren(*parent);
+    REQUIRE(children[0] == nullptr);
+    REQUIRE(children[1] == nullptr);
+    REQUIRE(children[2] == nullptr);
+    REQUIRE(children[3] == inserted);
+
+    // negative levels only have one child
+    auto negativeChildren = tileset.getChildren(*tileset.getRoot());
+    REQUIRE(negativeChildren[0] == tileset.getTile(-9, 0, 0));
+    REQUIRE(negativeChildren[1] == nullptr);
+
+    // copies of a tile find their children the same way
+    auto copiedChildren = tileset.getChildren(CDBTile(geoCell, CDBDataset::Elevation, 1, 1, 1, 1, 0));
+    REQUIRE(copiedChildren[3] == inserted);
+
+    // inserting the same tile again only updates its content
+    tile.setCustomContentURI("updated.b3dm");
+    REQUIRE(tileset.insertTile(tile) == tileset.getTile(2, 3, 1));
+    REQUIRE(*tileset.getTile(2, 3, 1)->getCustomContentURI() == "updated.b3dm");
+}
+
+TEST_CASE("Test measured heights grow the regions of ancestors", "[CDBTileset]")
+{
+    CDBTileset tileset;
+    CDBGeoCell geoCell(32, -118);
+    CDBTile low(geoCell, CDBDataset::Elevation, 1, 1, 2, 3, 1);
+    low.expandHeights(-20.0, 150.0);
+    low.expandHeights(10.0, 80.0);
+    REQUIRE(low.getBoundRegion().getMinimumHeight() == Approx(-20.0));
+    REQUIRE(low.getBoundRegion().getMaximumHeight() == Approx(150.0));
+
+    CDBTile high(geoCell, CDBDataset::Elevation, 1, 1, 2, 0, 0);
+    high.expandHeights(300.0, 900.0);
+    tileset.insertTile(low);
+    tileset.insertTile(high);
+    tileset.insertTile(CDBTile(geoCell, CDBDataset::Elevation, 1, 1, 3, 0, 0));
+
+    const auto *parent = tileset.getTile(1, 1, 0);
+    REQUIRE(parent->hasMeasuredHeights());
+    REQUIRE(parent->getBoundRegion().getMinimumHeight() == Approx(-20.0));
+    REQUIRE(parent->getBoundRegion().getMaximumHeight() == Approx(150.0));
+
+    const auto *root = tileset.getRoot();
+    REQUIRE(root->getBoundRegion().getMinimumHeight() == Approx(-20.0));
+    REQUIRE(root->getBoundRegion().getMaximumHeight() == Approx(900.0));
+
+    // tiles without content keep the default heights
+    const auto *empty = tileset.getTile(3, 0, 0);
+    REQUIRE(!empty->hasMeasuredHeights());
+    REQUIRE(empty->getBoundRegion().getMinimumHeight() == 0.0);
+    REQUIRE(empty->getBoundRegion().getMaximumHeight() == 0.0);
+}
@@ -0,0 +1,126 @@
+#include "CDBTo3DTiles.h"
+#include "Config.h"
+#include "ContentHash.h"
+#include "ContentStore.h"
+#include "OutputWriter.h"
+#include "catch2/catch.hpp"
+#include "nlohmann/json.hpp"
+#include <fstream>
+
+using namespace CDBTo3DTiles;
+
+static void checkContentURIsExist(const nlohmann::json &tile, const std::filesystem::path &tilesetDirectory)
+{
+    if (tile.contains("content")) {
+        std::string uri = tile["content"]["uri"];
+        REQUIRE(std::filesystem::exists(tilesetDirectory / uri));
+    }
+
+    if (tile.contains("children")) {
+        for (const auto &child : tile["children"]) {
+            checkContentURIsExist(child, tilesetDirectory);
+        }
+    }
+}
+
+TEST_CASE("Test content hash matches XXH64", "[ContentStore]")
+{
+    std::string empty;
+    REQUIRE(computeContentHash(empty.data(), empty.size()) == 0xef46db3751d8e999ull);
+
+    std::string abc = "abc";
+    REQUIRE(computeContentHash(abc.data(), abc.size()) == 0x44bc2cf5ad770999ull);
+
+    // longer than one 32 bytes stripe
+    std::string sentence = "Nobody inspects the spammish repetition";
+    REQUIRE(computeContentHash(sentence.data(), sentence.size()) == 0xfbcea83c8a378bf1ull);
+}
+
+TEST_CASE("Test content store writes identical payloads once", "[ContentStore]")
+{
+    std::filesystem::path output = "ContentStore";
+    std::filesystem::remove_all(output);
+
+    std::string tile = "b3dm payload";
+    std::string otherTile = "another b3dm payload";
+    OutputWriter writer(2);
+
+    {
+        ContentStore store(output, writer);
+        auto blob = store.store(tile.data(), tile.size(), ".b3dm");
+        REQUIRE(blob.extension() == ".b3dm");
+        REQUIRE(blob.parent_path().filename() == blob.filename().string().substr(0, 2));
+
+        // the duplicate is compared with the blob once the writer has written it
+        REQUIRE(store.store(tile.data(), tile.size(), ".b3dm") == blob);
+        REQUIRE(std::filesystem::file_size(output / blob) == tile.size());
+        REQUIRE(store.store(otherTile.data(), otherTile.size(), ".b3dm") != blob);
+
+        // the same bytes under another format are kept apart
+        auto jpeg = store.store(tile.data(), tile.size(), ".jpeg");
+        REQUIRE(jpeg != blob);
+        REQUIRE(jpeg.parent_path() == blob.parent_path());
+
+        REQUIRE(store.getUniqueCount() == 3);
+        REQUIRE(store.getDuplicateCount() == 1);
+        REQUIRE(store.getBytesWritten() == 2 * tile.size() + otherTile.size());
+        REQUIRE(store.getBytesSaved() == tile.size());
+
+        writer.flush();
+        REQUIRE(writer.getFileCount() == 3);
+        REQUIRE(writer.getBytesWritten() == store.getBytesWritten());
+    }
+
+    SECTION("Test blobs of an earlier run are reused")
+    {
+        ContentStore store(output, writer);
+        store.store(tile.data(), tile.size(), ".b3dm");
+        REQUIRE(store.getUniqueCount() == 0);
+        REQUIRE(store.getDuplicateCount() == 1);
+        REQUIRE(store.getBytesSaved() == tile.size());
+    }
+
+    SECTION("Test blob with the same name but different content is not reused")
+    {
+        ContentStore store(output, writer);
+        auto blob = store.store(tile.data(), tile.size(), ".b3dm");
+        writer.flush();
+        {
+            std::ofstream fs(output / blob, std::ios::binary);
+            fs << "corrupted";
+        }
+
+        ContentStore otherStore(output, writer);
+        auto newBlob = otherStore.store(tile.data(), tile.size(), ".b3dm");
+        writer.flush();
+        REQUIRE(newBlob != blob);
+        REQUIRE(std::filesystem::file_size(output / newBlob) == tile.size());
+        REQUIRE(otherStore.getUniqueCount() == 1);
+    }
+
+    std::filesystem::remove_all(output);
+}
+
+TEST_CASE("Test deduplicated conversion points tilesets at shared blobs", "[ContentStore]")
+{
+    std::filesystem::path input = dataPath / "ElevationMoreLODNegativeImagery";
+    std::filesystem::path output = "ContentStoreConversion";
+    std::filesystem::path elevationOutputDir = output / "Tiles" / "N32" / "W118" / "Elevation" / "1_1";
+
+    Converter converter(input, output);
+    converter.setDeduplicate(true);
+    converter.convert();
+
+    // tiles and textures are only written to the blob directory
+    REQUIRE(std::filesystem::exists(output / ContentStore::DIRECTORY_NAME));
+    REQUIRE(!std::filesystem::exists(elevationOutputDir / "Textures"));
+
+    std::filesystem::path tilesetPath = elevationOutputDir / "N32W118_D001_S001_T001.json";
+    REQUIRE(std::filesystem::exists(tilesetPath));
+
+    std::ifstream fs(tilesetPath);
+    nlohmann::json tilesetJson = nlohmann::json::parse(fs);
+    checkContentURIsExist(tilesetJson["root"], elevationOutputDir);
+
+    std::filesystem::remove_all(output);
+}
@@ -0,0 +1,105 @@
+#include "ConversionStats.h"
+#include "catch2/catch.hpp"
+#include "nlohmann/json.hpp"
+#include <sstream>
+#include <thread>
+
+using namespace CDBTo3DTiles;
+
+TEST_CASE("Test conversion stats report", "[ConversionStats]")
+{
+    auto &stats = ConversionStats::getInstance();
+
+    SECTION("Test nothing is recorded when disabled")
+    {
+        stats.setEnabled(false);
+        {
+            ScopedStageTimer timer("readElevation");
+            REQUIRE(!timer.isEnabled());
+        }
+
+        stats.setEnabled(true);
+        std::stringstream ss;
+        stats.writeToJson(ss);
+        stats.setEnabled(false);
+
+        auto reportJson = nlohmann::json::parse(ss.str());
+        REQUIRE(reportJson["run"].empty());
+        REQUIRE(reportJson["datasets"].empty());
+        REQUIRE(reportJson["threads"].empty());
+    }
+
+    SECTION("Test stages are grouped by GeoCell and dataset")
+    {
+        stats.setEnabled(true);
+        stats.setScope("N32/W119", "Elevation");
+        {
+            ScopedStageTimer total("total");
+            ScopedStageTimer timer("writeB3dm");
+            timer.addBytesIn(10);
+            timer.addBytesOut(20);
+            stats.addCounter("tiles", 2);
+        }
+
+        stats.setScope("N33/W119", "Elevation");
+        std::thread thread([]() {
+            ScopedStageTimer timer("writeB3dm");
+            timer.addBytesOut(30);
+        });
+        thread.join();
+
+        stats.setScope("", "");
+        stats.recordStage("combineTilesets", 1000, 0, 0);
+
+        std::stringstream ss;
+        stats.writeToJson(ss);
+        stats.setEnabled(false);
+
+        auto reportJson = nlohmann::json::parse(ss.str());
+        const auto &elevation = reportJson["geoCells"]["N32/W119"]["Elevation"];
+        REQUIRE(elevation["stages"]["writeB3dm"]["calls"] == 1);
+        REQUIRE(elevation["stages"]["writeB3dm"]["bytesIn"] == 10);
+        REQUIRE(elevation["stages"]["writeB3dm"]["bytesOut"] == 20);
+        REQUIRE(elevation["stages"]["total"]["calls"] == 1);
+        REQUIRE(elevation["counters"]["tiles"] == 2);
+
+        const auto &datasetElevation = reportJson["datasets"]["Elevation"];
+        REQUIRE(datasetElevation["stages"]["writeB3dm"]["calls"] == 2);
+        REQUIRE(datasetElevation["stages"]["writeB3dm"]["bytesOut"] == 50);
+
+        REQUIRE(reportJson["run"]["stages"]["combineTilesets"]["calls"] == 1);
+        REQUIRE(reportJson["run"]["stages"]["combineTilesets"]["seconds"] == Approx(1e-6));
+        REQUIRE(reportJson["threads"].size() == 1);
+        REQUIRE(reportJson["exitedThreads"]["count"] == 1);
+        REQUIRE(reportJson["exitedThreads"]["calls"] == 1);
+        REQUIRE(reportJson["seconds"].get<double>() >= 0.0);
+    }
+
+    SECTION("Test report is written while threads record")
+    {
+        stats.setEnabled(true);
+        stats.setScope("N32/W119", "Elevation");
+        std::thread thread([]() {
+            for (int i = 0; i < 10000; ++i) {
+                ScopedStageTimer timer("writeB3dm");
+                ConversionStats::getInstance().addCounter("tiles", 1);
+            }
+        });
+
+        for (int i = 0; i < 10; ++i) {
+            std::stringstream ss;
+            stats.writeToJson(ss);
+        }
+
+        thread.join();
+
+        std::stringstream ss;
+        stats.writeToJson(ss);
+        stats.setEnabled(false);
+
+        auto reportJson = nlohmann::json::parse(ss.str());
+        const auto &elevation = reportJson["geoCells"]["N32/W119"]["Elevation"];
+        REQUIRE(elevation["stages"]["writeB3dm"]["calls"] == 10000);
+        REQUIRE(elevation["counters"]["tiles"] == 10000);
+    }
+}
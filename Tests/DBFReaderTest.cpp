@@ -0,0 +1,132 @@
+#include "CDBAttributes.h"
+#include "CDBTo3DTiles.h"
+#include "Config.h"
+#include "DBFReader.h"
+#include "catch2/catch.hpp"
+#include <clocale>
+#include <filesystem>
+
+using namespace CDBTo3DTiles;
+
+static CDBInstancesAttributes readAttributesWithOGR(const std::filesystem::path &file)
+{
+    CDBInstancesAttributes instancesAttribs;
+    GDALDatasetUniquePtr dataset = GDALDatasetUniquePtr(
+        (GDALDataset *) GDALOpenEx(file.c_str(), GDAL_OF_VECTOR, nullptr, nullptr, nullptr));
+    REQUIRE(dataset != nullptr);
+    for (int i = 0; i < dataset->GetLayerCount(); ++i) {
+        OGRLayer *layer = dataset->GetLayer(i);
+        for (const auto &feature : *layer) {
+            instancesAttribs.addInstanceFeature(*feature);
+        }
+    }
+
+    return instancesAttribs;
+}
+
+TEST_CASE("Test reading dBase attribute table", "[DBFReader]")
+{
+    SECTION("Test attributes match the ones decoded by OGR")
+    {
+        std::filesystem::path files[] = {
+            dataPath / "RoadNetwork" / "Tiles" / "N32" / "W118" / "201_RoadNetwork" / "LC" / "U0"
+                / "N32W118_D201_S002_T003_LC05_U0_R0.dbf",
+            dataPath / "RoadNetwork" / "Tiles" / "N32" / "W118" / "201_RoadNetwork" / "LC" / "U0"
+                / "N32W118_D201_S002_T004_LC05_U0_R0.dbf",
+            dataPath / "GSModelsWithGTModelTexture" / "Tiles" / "N32" / "W118" / "100_GSFeature" / "LC"
+                / "U0" / "N32W118_D100_S001_T001_LC06_U0_R0.dbf",
+        };
+
+        for (const auto &file : files) {
+            auto attributesTable = DBFReader::createFromFile(file);
+            REQUIRE(attributesTable != std::nullopt);
+
+            CDBInstancesAttributes instancesAttribs;
+            instancesAttribs.addInstancesFeatures(*attributesTable);
+
+            CDBInstancesAttributes expectedAttribs = readAttributesWithOGR(file);
+            REQUIRE(instancesAttribs.getInstancesCount() == expectedAttribs.getInstancesCount());
+            REQUIRE(instancesAttribs.getCNAMs() == expectedAttribs.getCNAMs());
+            REQUIRE(instancesAttribs.getIntegerAttribs() == expectedAttribs.getIntegerAttribs());
+            REQUIRE(instancesAttribs.getDoubleAttribs() == expectedAttribs.getDoubleAttribs());
+            REQUIRE(instancesAttribs.getStringAttribs() == expectedAttribs.getStringAttribs());
+        }
+    }
+
+    SECTION("Test decimals are read the same in every locale")
+    {
+        std::filesystem::path file = dataPath / "GTModels" / "Tiles" / "N32" / "W118" / "101_GTFeature"
+                                     / "L00" / "U0" / "N32W118_D101_S001_T001_L00_U0_R0.dbf";
+        auto attributesTable = DBFReader::createFromFile(file);
+        REQUIRE(attributesTable != std::nullopt);
+
+        CDBInstancesAttributes instancesAttribs;
+        instancesAttribs.addInstancesFeatures(*attributesTable);
+
+        // locales with a decimal comma are only tested where one is installed
+        std::string locale = std::setlocale(LC_NUMERIC, nullptr);
+        for (const char *commaLocale : {"de_DE.UTF-8", "fr_FR.UTF-8", "de_DE", "fr_FR"}) {
+            if (std::setlocale(LC_NUMERIC, commaLocale) != nullptr) {
+                CDBInstancesAttributes commaInstancesAttribs;
+                commaInstancesAttribs.addInstancesFeatures(*attributesTable);
+                std::setlocale(LC_NUMERIC, locale.c_str());
+                REQUIRE(commaInstancesAttribs.getDoubleAttribs() == instancesAttribs.getDoubleAttribs());
+                break;
+            }
+        }
+
+        REQUIRE(instancesAttribs.getDoubleAttribs().at("SCALx").size() == 1);
+    }
+
+    SECTION("Test non existing file")
+    {
+        REQUIRE(DBFReader::createFromFile(dataPath / "NonExistent.dbf") == std::nullopt);
+    }
+}
+
+TEST_CASE("Test model attributes read from the shapefile match OGR", "[DBFReader]")
+{
+    std::filesystem::path CDBPaths[] = {
+        dataPath / "GSModelsWithGTModelTexture",
+        dataPath / "GTModels",
+    };
+
+    std::filesystem::path files[] = {
+        CDBPaths[0] / "Tiles" / "N32" / "W118" / "100_GSFeature" / "L00" / "U0"
+            / "N32W118_D100_S001_T001_L00_U0_R0.dbf",
+        CDBPaths[1] / "Tiles" / "N32" / "W118" / "101_GTFeature" / "L00" / "U0"
+            / "N32W118_D101_S001_T001_L00_U0_R0.dbf",
+    };
+
+    for (size_t i = 0; i < std::size(files); ++i) {
+        auto tile = CDBTile::createFromFile(files[i].filename().string());
+        REQUIRE(tile != std::nullopt);
+
+        auto modelsAttributes = CDBModelsAttributes::createFromFile(files[i], *tile, CDBPaths[i]);
+        REQUIRE(modelsAttributes != std::nullopt);
+
+        GDALDatasetUniquePtr dataset = GDALDatasetUniquePtr(
+            (GDALDataset *) GDALOpenEx(files[i].c_str(), GDAL_OF_VECTOR, nullptr, nullptr, nullptr));
+        REQUIRE(dataset != nullptr);
+        CDBModelsAttributes expectedAttributes(std::move(dataset), *tile, CDBPaths[i]);
+
+        const auto &positions = modelsAttributes->getCartographicPositions();
+        const auto &expectedPositions = expectedAttributes.getCartographicPositions();
+        REQUIRE(positions.size() == expectedPositions.size());
+        for (size_t j = 0; j < positions.size(); ++j) {
+            REQUIRE(positions[j].longitude == expectedPositions[j].longitude);
+            REQUIRE(positions[j].latitude == expectedPositions[j].latitude);
+            REQUIRE(positions[j].height == expectedPositions[j].height);
+        }
+
+        const auto &instancesAttribs = modelsAttributes->getInstancesAttributes();
+        const auto &expectedInstancesAttribs = expectedAttributes.getInstancesAttributes();
+        REQUIRE(instancesAttribs.getInstancesCount() > 0);
+        REQUIRE(instancesAttribs.getCNAMs() == expectedInstancesAttribs.getCNAMs());
+        REQUIRE(instancesAttribs.getIntegerAttribs() == expectedInstancesAttribs.getIntegerAttribs());
+        REQUIRE(instancesAttribs.getDoubleAttribs() == expectedInstancesAttribs.getDoubleAttribs());
+        REQUIRE(instancesAttribs.getStringAttribs() == expectedInstancesAttribs.getStringAttribs());
+        REQUIRE(modelsAttributes->getOrientations() == expectedAttributes.getOrientations());
+        REQUIRE(modelsAttributes->getScales() == expectedAttributes.getScales());
+    }
+}
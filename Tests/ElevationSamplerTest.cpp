@@ -0,0 +1,111 @@
+#include "CDBElevation.h"
+#include "Config.h"
+#include "ElevationSampler.h"
+#include "catch2/catch.hpp"
+
+using namespace CDBTo3DTiles;
+using namespace Core;
+
+TEST_CASE("Test sampling heights from elevation grid", "[ElevationSampler]")
+{
+    // rows start from the north edge
+    ElevationGrid grid(2, 2, {1.0f, 2.0f, 3.0f, 4.0f});
+    GlobeRectangle rectangle(0.0, 0.0, 2.0, 2.0);
+
+    SECTION("Test nearest sampling picks the pixel the point falls in")
+    {
+        REQUIRE(grid.sampleNearest(rectangle, Cartographic(0.5, 0.5, 0.0)) == Approx(3.0));
+        REQUIRE(grid.sampleNearest(rectangle, Cartographic(1.5, 0.5, 0.0)) == Approx(4.0));
+        REQUIRE(grid.sampleNearest(rectangle, Cartographic(0.5, 1.5, 0.0)) == Approx(1.0));
+        REQUIRE(grid.sampleNearest(rectangle, Cartographic(2.0, 2.0, 0.0)) == Approx(2.0));
+        REQUIRE(grid.sampleNearest(rectangle, Cartographic(-1.0, -1.0, 0.0)) == Approx(3.0));
+    }
+
+    SECTION("Test bilinear sampling interpolates between pixel centers")
+    {
+        REQUIRE(grid.sampleBilinear(rectangle, Cartographic(0.5, 0.5, 0.0)) == Approx(3.0));
+        REQUIRE(grid.sampleBilinear(rectangle, Cartographic(1.0, 1.0, 0.0)) == Approx(2.5));
+        REQUIRE(grid.sampleBilinear(rectangle, Cartographic(1.0, 0.5, 0.0)) == Approx(3.5));
+        REQUIRE(grid.sampleBilinear(rectangle, Cartographic(0.0, 2.0, 0.0)) == Approx(1.0));
+    }
+}
+
+TEST_CASE("Test elevation sampler caches decoded tiles", "[ElevationSampler]")
+{
+    std::filesystem::path input = dataPath / "CombineTilesets";
+    CDBGeoCell geoCell(32, -119);
+    CDBTile tile(geoCell, CDBDataset::Elevation, 1, 1, -6, 0, 0);
+    CDBTile parentTile(geoCell, CDBDataset::Elevation, 1, 1, -7, 0, 0);
+
+    SECTION("Test points on the same tile decode it once")
+    {
+        ElevationSampler sampler(input, ElevationSampler::DEFAULT_CACHE_SIZE);
+        const auto &rectangle = tile.getBoundRegion().getRectangle();
+        std::vector<Cartographic> points{rectangle.computeCenter(), rectangle.computeCenter()};
+        REQUIRE(sampler.sampleHeights(tile, points));
+        REQUIRE(sampler.sampleHeights(tile, points, {1}));
+
+        auto grid = sampler.getGrid(tile);
+        REQUIRE(grid != nullptr);
+        REQUIRE(grid->getWidth() == 16);
+        REQUIRE(grid->getHeight() == 16);
+        REQUIRE(points[0].height == Approx(grid->sampleNearest(rectangle, points[0])));
+        REQUIRE(points[1].height == Approx(points[0].height));
+        REQUIRE(sampler.getMissCount() == 1);
+        REQUIRE(sampler.getHitCount() == 2);
+        REQUIRE(sampler.getCachedBytes() >= grid->getSizeInBytes());
+    }
+
+    SECTION("Test missing tile leaves points untouched")
+    {
+        ElevationSampler sampler(input, ElevationSampler::DEFAULT_CACHE_SIZE);
+        CDBTile missingTile(geoCell, CDBDataset::Elevation, 1, 1, 5, 0, 0);
+        std::vector<Cartographic> points{Cartographic(0.0, 0.0, 10.0)};
+        REQUIRE(!sampler.sampleHeights(missingTile, points));
+        REQUIRE(!sampler.sampleHeights(missingTile, points));
+        REQUIRE(points[0].height == 10.0);
+        REQUIRE(sampler.getMissCount() == 1);
+    }
+
+    SECTION("Test grid decoded by the elevation conversion is reused")
+    {
+        ElevationSampler sampler(input, ElevationSampler::DEFAULT_CACHE_SIZE);
+        auto elevation = CDBElevation::createFromFile(input / (tile.getRelativePath().string() + ".tif"));
+        REQUIRE(elevation);
+        REQUIRE(elevation->getHeightGrid() != nullptr);
+
+        sampler.insertGrid(elevation->getTile(), elevation->getHeightGrid());
+        REQUIRE(sampler.getGrid(tile) == elevation->getHeightGrid());
+        REQUIRE(sampler.getHitCount() == 1);
+        REQUIRE(sampler.getMissCount() == 0);
+        REQUIRE(sampler.getPeakCachedBytes() >= elevation->getHeightGrid()->getSizeInBytes());
+    }
+
+    SECTION("Test least recently used tile is evicted over the budget")
+    {
+        ElevationSampler sampler(input, 0);
+        REQUIRE(sampler.getGrid(tile) != nullptr);
+        REQUIRE(sampler.getGrid(parentTile) != nullptr);
+        REQUIRE(sampler.getCachedGridCount() == 1);
+        REQUIRE(sampler.getGrid(tile) != nullptr);
+        REQUIRE(sampler.getMissCount() == 3);
+        REQUIRE(sampler.getHitCount() == 0);
+    }
+
+    SECTION("Test trimming drops tiles down to the target")
+    {
+        ElevationSampler sampler(input, ElevationSampler::DEFAULT_CACHE_SIZE);
+        REQUIRE(sampler.getGrid(tile) != nullptr);
+        REQUIRE(sampler.getGrid(parentTile) != nullptr);
+        REQUIRE(sampler.getCachedGridCount() == 2);
+
+        sampler.trim(sampler.getCachedBytes() - 1);
+        REQUIRE(sampler.getCachedGridCount() == 1);
+        REQUIRE(sampler.getGrid(parentTile) != nullptr);
+        REQUIRE(sampler.getHitCount() == 1);
+
+        sampler.trim(0);
+        REQUIRE(sampler.getCachedGridCount() == 0);
+        REQUIRE(sampler.getCachedBytes() == 0);
+    }
+}
@@ -0,0 +1,98 @@
+#include "Ellipsoid.h"
+#include "catch2/catch.hpp"
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using namespace Core;
+
+static std::vector<Cartographic> createCartographics()
+{
+    std::vector<Cartographic> cartographics;
+    for (int i = 0; i <= 36; ++i) {
+        for (int j = 0; j <= 18; ++j) {
+            double longitude = glm::radians(-180.0 + 10.0 * i + 0.123 * j);
+            double latitude = glm::radians(-90.0 + 10.0 * j);
+            double height = -500.0 + 250.0 * (i + j);
+            cartographics.emplace_back(longitude, latitude, height);
+        }
+    }
+
+    // angles outside of the range the SIMD kernel reduces itself
+    cartographics.emplace_back(2.0e5, -3.0e5, 10.0);
+
+    // leave a partially filled batch at the end
+    cartographics.emplace_back(0.1, 0.2, 0.3);
+    cartographics.emplace_back(-0.1, -0.2, -0.3);
+    return cartographics;
+}
+
+// Compare each component against the position magnitude, since components close to zero have no
+// meaningful relative error
+static void requireWithinULPs(const glm::dvec3 &actual, const glm::dvec3 &expected, double ULPs)
+{
+    double magnitude = glm::length(expected);
+    double ULP = std::nextafter(magnitude, std::numeric_limits<double>::infinity()) - magnitude;
+    REQUIRE(glm::abs(actual.x - expected.x) <= ULPs * ULP);
+    REQUIRE(glm::abs(actual.y - expected.y) <= ULPs * ULP);
+    REQUIRE(glm::abs(actual.z - expected.z) <= ULPs * ULP);
+}
+
+TEST_CASE("Test batched ellipsoid conversions", "[Ellipsoid]")
+{
+    const auto &ellipsoid = Ellipsoid::WGS84;
+    auto cartographics = createCartographics();
+
+    std::vector<glm::dvec3> expected;
+    for (const auto &cartographic : cartographics) {
+        expected.emplace_back(ellipsoid.cartographicToCartesian(cartographic));
+    }
+
+    SECTION("Test array of cartographics")
+    {
+        std::vector<glm::dvec3> cartesians(cartographics.size());
+        ellipsoid.cartographicToCartesian(cartographics.data(), cartographics.size(), cartesians.data());
+        for (size_t i = 0; i < cartesians.size(); ++i) {
+            requireWithinULPs(cartesians[i], expected[i], 3.0);
+        }
+    }
+
+    SECTION("Test separate longitude, latitude and height arrays")
+    {
+        std::vector<double> longitudes, latitudes, heights;
+        for (const auto &cartographic : cartographics) {
+            longitudes.emplace_back(cartographic.longitude);
+            latitudes.emplace_back(cartographic.latitude);
+            heights.emplace_back(cartographic.height);
+        }
+
+        std::vector<glm::dvec3> cartesians(cartographics.size());
+        ellipsoid.cartographicToCartesian(longitudes.data(),
+                                          latitudes.data(),
+                                          heights.data(),
+                                          cartographics.size(),
+                                          cartesians.data());
+        for (size_t i = 0; i < cartesians.size(); ++i) {
+            requireWithinULPs(cartesians[i], expected[i], 3.0);
+        }
+    }
+
+    SECTION("Test cartesians to cartographics")
+    {
+        expected.emplace_back(0.0, 0.0, 0.0);
+
+        std::vector<std::optional<Cartographic>> results(expected.size(), std::nullopt);
+        ellipsoid.cartesianToCartographic(expected.data(), expected.size(), results.data());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            auto result = ellipsoid.cartesianToCartographic(expected[i]);
+            REQUIRE(results[i].has_value() == result.has_value());
+            if (result) {
+                REQUIRE(results[i]->longitude == result->longitude);
+                REQUIRE(results[i]->latitude == result->latitude);
+                REQUIRE(results[i]->height == result->height);
+            }
+        }
+
+        REQUIRE(results.back() == std::nullopt);
+    }
+}
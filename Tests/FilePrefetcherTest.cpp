@@ -0,0 +1,128 @@
+#include "CDBElevation.h"
+#include "CDBGeometryVectors.h"
+#include "Config.h"
+#include "FilePrefetcher.h"
+#include "catch2/catch.hpp"
+#include "cpl_vsi.h"
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <thread>
+
+using namespace CDBTo3DTiles;
+
+static const std::filesystem::path elevationFile = dataPath / "Elevation"
+                                                   / "N34W119_D001_S001_T001_LC06_U0_R0.tif";
+
+static std::vector<uint8_t> readWholeFile(const std::filesystem::path &file)
+{
+    std::ifstream fs(file, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(fs), std::istreambuf_iterator<char>());
+}
+
+TEST_CASE("Test prefetcher hands over files", "[FilePrefetcher]")
+{
+    FilePrefetcher prefetcher(2);
+    REQUIRE(prefetcher.getThreadCount() == 2);
+
+    SECTION("Test prefetched file has the content of the file")
+    {
+        prefetcher.prefetch(elevationFile);
+        prefetcher.prefetch(elevationFile);
+        REQUIRE(prefetcher.getPeakPendingCount() == 1);
+
+        // the file may not be started yet, so take it once a thread had the time to read it
+        std::optional<PrefetchedFile> prefetchedFile;
+        for (int i = 0; i < 100 && !prefetchedFile; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            prefetchedFile = prefetcher.take(elevationFile);
+            if (!prefetchedFile) {
+                prefetcher.prefetch(elevationFile);
+            }
+        }
+
+        REQUIRE(prefetchedFile != std::nullopt);
+        REQUIRE(prefetchedFile->getFile() == elevationFile);
+        REQUIRE(prefetchedFile->getData() == readWholeFile(elevationFile));
+        REQUIRE(prefetcher.getHitCount() + prefetcher.getWaitCount() == 1);
+        REQUIRE(prefetcher.getBytesTaken() == prefetchedFile->getData().size());
+
+        // a file is handed over once
+        REQUIRE(prefetcher.take(elevationFile) == std::nullopt);
+    }
+
+    SECTION("Test file not prefetched is a miss")
+    {
+        REQUIRE(prefetcher.take(elevationFile) == std::nullopt);
+        REQUIRE(prefetcher.getMissCount() == 1);
+        REQUIRE(prefetcher.getHitCount() == 0);
+    }
+
+    SECTION("Test missing file is a miss")
+    {
+        auto missingFile = dataPath / "Elevation" / "Missing.tif";
+        prefetcher.prefetch(missingFile);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        REQUIRE(prefetcher.take(missingFile) == std::nullopt);
+        REQUIRE(prefetcher.getMissCount() == 1);
+    }
+
+    SECTION("Test discarded file is not handed over")
+    {
+        prefetcher.prefetch(elevationFile);
+        prefetcher.discard(elevationFile);
+        REQUIRE(prefetcher.getDiscardCount() == 1);
+        REQUIRE(prefetcher.take(elevationFile) == std::nullopt);
+    }
+}
+
+TEST_CASE("Test prefetched file as an in-memory file", "[FilePrefetcher]")
+{
+    SECTION("Test in-memory file lives as long as the prefetched file")
+    {
+        std::string GDALPath;
+        {
+            PrefetchedFile prefetchedFile(elevationFile, readWholeFile(elevationFile));
+            PrefetchedFile movedFile(std::move(prefetchedFile));
+            GDALPath = movedFile.getGDALPath();
+            REQUIRE(GDALPath.find(elevationFile.filename().string()) != std::string::npos);
+
+            VSIStatBufL stat;
+            REQUIRE(VSIStatL(GDALPath.c_str(), &stat) == 0);
+            REQUIRE(static_cast<size_t>(stat.st_size) == movedFile.getData().size());
+        }
+
+        VSIStatBufL stat;
+        REQUIRE(VSIStatL(GDALPath.c_str(), &stat) != 0);
+    }
+
+    SECTION("Test elevation decoded from the in-memory file")
+    {
+        PrefetchedFile prefetchedFile(elevationFile, readWholeFile(elevationFile));
+        auto elevation = CDBElevation::createFromFile(elevationFile, prefetchedFile.getGDALPath());
+        auto expected = CDBElevation::createFromFile(elevationFile);
+        REQUIRE(elevation != std::nullopt);
+        REQUIRE(expected != std::nullopt);
+        REQUIRE(elevation->getTile() == expected->getTile());
+        REQUIRE(elevation->getGridWidth() == expected->getGridWidth());
+        REQUIRE(elevation->getGridHeight() == expected->getGridHeight());
+        REQUIRE(elevation->getUniformGridMesh().positions == expected->getUniformGridMesh().positions);
+    }
+
+    SECTION("Test vectors decoded from prefetched files")
+    {
+        std::filesystem::path CDBPath = dataPath / "RoadNetwork";
+        std::filesystem::path vectorFile = CDBPath / "Tiles" / "N32" / "W118" / "201_RoadNetwork" / "LC"
+                                           / "U0" / "N32W118_D201_S002_T003_LC05_U0_R0.dbf";
+
+        FilePrefetcher prefetcher(1);
+        prefetcher.prefetch(vectorFile);
+        prefetcher.prefetch(std::filesystem::path(vectorFile).replace_extension(".shp"));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        auto vector = CDBGeometryVectors::createFromFile(vectorFile, CDBPath, &prefetcher);
+        REQUIRE(vector != std::nullopt);
+        REQUIRE(vector->getInstancesAttributes().getInstancesCount() == 8);
+        REQUIRE(prefetcher.getHitCount() + prefetcher.getWaitCount() + prefetcher.getMissCount() == 2);
+    }
+}
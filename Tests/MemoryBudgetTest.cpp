@@ -0,0 +1,99 @@
+#include "MemoryBudget.h"
+#include "catch2/catch.hpp"
+#include <limits>
+
+using namespace CDBTo3DTiles;
+
+TEST_CASE("Test memory budget shares", "[MemoryBudget]")
+{
+    SECTION("Test unlimited budget gives unlimited shares")
+    {
+        MemoryBudget budget(0);
+        REQUIRE(!budget.isLimited());
+        REQUIRE(budget.getShare(0.25) == std::numeric_limits<size_t>::max());
+    }
+
+    SECTION("Test limited budget gives a fraction of it")
+    {
+        MemoryBudget budget(1000);
+        REQUIRE(budget.isLimited());
+        REQUIRE(budget.getBudgetInBytes() == 1000);
+        REQUIRE(budget.getShare(0.25) == 250);
+    }
+}
+
+TEST_CASE("Test memory budget shrinks consumers", "[MemoryBudget]")
+{
+    size_t smallCache = 100;
+    size_t largeCache = 400;
+    auto addConsumers = [&](MemoryBudget &budget) {
+        budget.addConsumer(
+            "small", [&]() { return smallCache; }, [&](size_t targetBytes) { smallCache = targetBytes; });
+        budget.addConsumer(
+            "large", [&]() { return largeCache; }, [&](size_t targetBytes) { largeCache = targetBytes; });
+    };
+
+    SECTION("Test unlimited budget never shrinks")
+    {
+        MemoryBudget budget(0);
+        addConsumers(budget);
+        REQUIRE(budget.getConsumedBytes() == 500);
+        REQUIRE(budget.enforce());
+        REQUIRE(smallCache == 100);
+        REQUIRE(largeCache == 400);
+        REQUIRE(budget.getPressureCount() == 0);
+    }
+
+    SECTION("Test budget below the process shrinks every consumer")
+    {
+        // the resident memory of the test process alone is over a budget of one byte
+        MemoryBudget budget(1);
+        addConsumers(budget);
+        REQUIRE(!budget.enforce());
+        REQUIRE(smallCache == 0);
+        REQUIRE(largeCache == 0);
+        REQUIRE(budget.getPressureCount() == 1);
+        REQUIRE(budget.getPeakUsedBytes() > 1);
+    }
+
+    SECTION("Test consumers are shrunk to the low-water mark")
+    {
+        size_t usedBytes = 1200;
+        MemoryBudget budget(1000, [&]() { return usedBytes; });
+        addConsumers(budget);
+        budget.enforce();
+        REQUIRE(smallCache == 100);
+        REQUIRE(largeCache == 100);
+        REQUIRE(budget.getPressureCount() == 1);
+        REQUIRE(budget.getPeakUsedBytes() == 1200);
+    }
+
+    SECTION("Test consumers are only shrunk again after the process grows")
+    {
+        // the memory over the budget is not held by the consumers, so shrinking them doesn't help
+        size_t usedBytes = 1200;
+        MemoryBudget budget(1000, [&]() { return usedBytes; });
+        addConsumers(budget);
+        REQUIRE(!budget.enforce());
+        REQUIRE(budget.getPressureCount() == 1);
+
+        smallCache = 100;
+        largeCache = 400;
+        usedBytes = 1250;
+        REQUIRE(!budget.enforce());
+        REQUIRE(smallCache == 100);
+        REQUIRE(largeCache == 400);
+        REQUIRE(budget.getPressureCount() == 1);
+
+        usedBytes = 1400;
+        REQUIRE(!budget.enforce());
+        REQUIRE(largeCache == 0);
+        REQUIRE(budget.getPressureCount() == 2);
+
+        usedBytes = 900;
+        REQUIRE(budget.enforce());
+        usedBytes = 1050;
+        REQUIRE(!budget.enforce());
+        REQUIRE(budget.getPressureCount() == 3);
+    }
+}
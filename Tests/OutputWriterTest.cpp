@@ -0,0 +1,131 @@
+#include "OutputWriter.h"
+#include "catch2/catch.hpp"
+#include "cpl_vsi.h"
+#include <fstream>
+#include <iterator>
+
+using namespace CDBTo3DTiles;
+
+static std::string readWholeFile(const std::filesystem::path &file)
+{
+    std::ifstream fs(file, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(fs), std::istreambuf_iterator<char>());
+}
+
+static std::string readGzipFile(const std::filesystem::path &file)
+{
+    VSILFILE *fp = VSIFOpenL(("/vsigzip/" + file.string()).c_str(), "rb");
+    REQUIRE(fp != nullptr);
+
+    std::string content;
+    char buffer[4096];
+    size_t readSize;
+    while ((readSize = VSIFReadL(buffer, 1, sizeof(buffer), fp)) > 0) {
+        content.append(buffer, readSize);
+    }
+
+    VSIFCloseL(fp);
+    return content;
+}
+
+TEST_CASE("Test output writer writes files in the background", "[OutputWriter]")
+{
+    std::filesystem::path output = "OutputWriter";
+    std::filesystem::remove_all(output);
+
+    SECTION("Test files and their directories are written")
+    {
+        OutputWriter writer(4);
+        REQUIRE(writer.getThreadCount() == 4);
+        for (int i = 0; i < 20; ++i) {
+            auto directory = output / ("Tileset_" + std::to_string(i % 2)) / "Gltf";
+            writer.write(directory / (std::to_string(i) + ".glb"), std::string(static_cast<size_t>(i), 'a'));
+        }
+
+        writer.flush();
+        REQUIRE(writer.getPendingBytes() == 0);
+        REQUIRE(writer.getFileCount() == 20);
+        REQUIRE(writer.getBytesWritten() == 190);
+        REQUIRE(writer.getDirectoryCount() == 2);
+        REQUIRE(readWholeFile(output / "Tileset_1" / "Gltf" / "19.glb") == std::string(19, 'a'));
+        REQUIRE(std::filesystem::file_size(output / "Tileset_0" / "Gltf" / "0.glb") == 0);
+    }
+
+    SECTION("Test file written twice has the last content")
+    {
+        OutputWriter writer(4);
+        for (int i = 0; i < 100; ++i) {
+            writer.write(output / "tileset.json", std::to_string(i));
+        }
+
+        writer.flush();
+        REQUIRE(readWholeFile(output / "tileset.json") == "99");
+    }
+
+    SECTION("Test write waits once too many bytes are pending")
+    {
+        OutputWriter writer(1, 16);
+        for (int i = 0; i < 10; ++i) {
+            writer.write(output / (std::to_string(i) + ".b3dm"), std::string(10, 'b'));
+        }
+
+        writer.drain(0);
+        REQUIRE(writer.getPendingBytes() == 0);
+        REQUIRE(writer.getFileCount() == 10);
+
+        // a file larger than the limit is still written
+        writer.write(output / "large.b3dm", std::string(64, 'b'));
+        writer.flush();
+        REQUIRE(std::filesystem::file_size(output / "large.b3dm") == 64);
+    }
+
+    SECTION("Test synced files are written")
+    {
+        OutputWriter writer(2);
+        writer.setSyncFiles(true);
+        writer.write(output / "Textures" / "texture.jpeg", "jpeg");
+        writer.flush();
+        REQUIRE(readWholeFile(output / "Textures" / "texture.jpeg") == "jpeg");
+    }
+
+    SECTION("Test files get gzip copies except images")
+    {
+        std::string tileset;
+        for (int i = 0; i < 100; ++i) {
+            tileset += "{\"content\":{\"uri\":\"" + std::to_string(i) + ".b3dm\"},\"geometricError\":0},";
+        }
+
+        OutputWriter writer(4);
+        writer.setGzipFiles(true);
+        writer.write(output / "tileset.json", tileset);
+        writer.write(output / "Textures" / "texture.jpeg", "jpeg");
+        writer.flush();
+
+        auto gzipFile = output / ("tileset.json" + OutputWriter::GZIP_EXTENSION);
+        std::string compressed = readWholeFile(gzipFile);
+        REQUIRE(compressed.substr(0, 2) == "\x1f\x8b");
+        REQUIRE(readGzipFile(gzipFile) == tileset);
+        auto textureGzipFile = output / "Textures" / ("texture.jpeg" + OutputWriter::GZIP_EXTENSION);
+        REQUIRE(!std::filesystem::exists(textureGzipFile));
+        REQUIRE(writer.getFileCount() == 2);
+        REQUIRE(writer.getGzipFileCount() == 1);
+        REQUIRE(writer.getGzipBytesIn() == tileset.size());
+        REQUIRE(writer.getGzipBytesOut() == compressed.size());
+        REQUIRE(compressed.size() < tileset.size() / 5);
+    }
+
+    SECTION("Test failed write is reported by flush")
+    {
+        std::filesystem::create_directories(output);
+        std::ofstream(output / "file").put('a');
+
+        OutputWriter writer(2);
+        writer.write(output / "file" / "tile.b3dm", "b3dm");
+        writer.write(output / "tile.b3dm", "b3dm");
+        REQUIRE_THROWS_AS(writer.flush(), std::runtime_error);
+        REQUIRE(writer.getFileCount() == 1);
+
+        // errors are reported once
+        REQUIRE_NOTHROW(writer.flush());
+    }
+}
@@ -0,0 +1,390 @@
+#include "Ellipsoid.h"
+#include "Gltf.h"
+#include "TileFormatIO.h"
+#include "catch2/catch.hpp"
+#include "nlohmann/json.hpp"
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+using namespace CDBTo3DTiles;
+
+static Mesh createPointMesh(size_t pointCount)
+{
+    Mesh mesh;
+    mesh.aabb = AABB();
+    mesh.primitiveType = PrimitiveType::Points;
+    for (size_t i = 0; i < pointCount; ++i) {
+        glm::dvec3 position(static_cast<double>(i), 0.0, 0.0);
+        mesh.aabb->merge(position);
+        mesh.positions.emplace_back(position);
+        mesh.positionRTCs.emplace_back(position);
+        mesh.batchIDs.emplace_back(static_cast<float>(i));
+    }
+
+    return mesh;
+}
+
+static void readB3DMBatchTable(const std::filesystem::path &path,
+                               nlohmann::json &batchTableJson,
+                               std::vector<uint8_t> &batchTableBuffer)
+{
+    std::ifstream fs(path, std::ios::binary);
+    B3dmHeader header;
+    fs.read(reinterpret_cast<char *>(&header), sizeof(header));
+    REQUIRE(std::string(header.magic, 4) == "b3dm");
+    REQUIRE(header.byteLength == std::filesystem::file_size(path));
+
+    fs.seekg(header.featureTableJsonByteLength + header.featureTableBinByteLength, std::ios::cur);
+    std::string batchTableString(header.batchTableJsonByteLength, ' ');
+    fs.read(batchTableString.data(), static_cast<std::streamsize>(batchTableString.size()));
+    batchTableJson = nlohmann::json::parse(batchTableString);
+
+    batchTableBuffer.resize(header.batchTableBinByteLength);
+    fs.read(reinterpret_cast<char *>(batchTableBuffer.data()),
+            static_cast<std::streamsize>(batchTableBuffer.size()));
+}
+
+TEST_CASE("Test writing string attributes to b3dm batch table", "[TileFormatIO]")
+{
+    Mesh mesh = createPointMesh(4);
+    tinygltf::Model gltf = createGltf(mesh, nullptr, nullptr);
+
+    CDBInstancesAttributes instancesAttribs;
+    instancesAttribs.getCNAMs() = {"Tree", "House", "Tree", "Tree"};
+    instancesAttribs.getStringAttribs()["FACC"] = {"EC030", "AL015", "EC030", "EC030"};
+    instancesAttribs.getIntegerAttribs()["FSC"] = {1, 2, 3, 4};
+
+    std::filesystem::path output = "TileFormatIO";
+    std::filesystem::create_directories(output);
+
+    SECTION("Strings are written as JSON arrays by default")
+    {
+        auto b3dmPath = output / "strings.b3dm";
+        {
+            std::ofstream fs(b3dmPath, std::ios::binary);
+            writeToB3DM(&gltf, &instancesAttribs, fs);
+        }
+
+        nlohmann::json batchTableJson;
+        std::vector<uint8_t> batchTableBuffer;
+        readB3DMBatchTable(b3dmPath, batchTableJson, batchTableBuffer);
+        REQUIRE(batchTableJson["CNAM"] == nlohmann::json({"Tree", "House", "Tree", "Tree"}));
+        REQUIRE(batchTableJson["FACC"] == nlohmann::json({"EC030", "AL015", "EC030", "EC030"}));
+        REQUIRE(batchTableJson.find("extensions") == batchTableJson.end());
+    }
+
+    SECTION("Strings are written as indices into a dictionary")
+    {
+        auto b3dmPath = output / "dictionary.b3dm";
+        {
+            std::ofstream fs(b3dmPath, std::ios::binary);
+            writeToB3DM(&gltf, &instancesAttribs, fs, true);
+        }
+
+        nlohmann::json batchTableJson;
+        std::vector<uint8_t> batchTableBuffer;
+        readB3DMBatchTable(b3dmPath, batchTableJson, batchTableBuffer);
+        REQUIRE(batchTableBuffer.size() % 8 == 0);
+
+        const auto &dictionaries = batchTableJson["extensions"]["CDB_string_dictionary"];
+        REQUIRE(dictionaries["CNAM"] == nlohmann::json({"Tree", "House"}));
+        REQUIRE(dictionaries["FACC"] == nlohmann::json({"EC030", "AL015"}));
+
+        const auto &CNAM = batchTableJson["CNAM"];
+        REQUIRE(CNAM["componentType"] == "UNSIGNED_BYTE");
+        REQUIRE(CNAM["type"] == "SCALAR");
+        size_t CNAMOffset = CNAM["byteOffset"];
+        std::vector<uint8_t> CNAMIndices(batchTableBuffer.begin() + static_cast<long>(CNAMOffset),
+                                         batchTableBuffer.begin() + static_cast<long>(CNAMOffset) + 4);
+        REQUIRE(CNAMIndices == std::vector<uint8_t>{0, 1, 0, 0});
+
+        // numeric columns are untouched
+        REQUIRE(batchTableJson["FSC"]["byteOffset"] == 0);
+        REQUIRE(batchTableJson["FSC"]["componentType"] == "INT");
+    }
+
+    std::filesystem::remove_all(output);
+}
+
+TEST_CASE("Test composite tile is assembled before it is written", "[TileFormatIO]")
+{
+    Mesh mesh = createPointMesh(4);
+    tinygltf::Model gltf = createGltf(mesh, nullptr, nullptr);
+    CDBInstancesAttributes instancesAttribs;
+    instancesAttribs.getCNAMs() = {"Tree", "House", "Tree", "Tree"};
+
+    TileBuffer b3dm = createB3DM(&gltf, &instancesAttribs);
+    std::string b3dmContent = b3dm.toString();
+    REQUIRE(b3dmContent.size() == b3dm.getByteLength());
+    REQUIRE(b3dm.getByteLength() % 8 == 0);
+
+    std::vector<TileBuffer> tiles;
+    tiles.emplace_back(createB3DM(&gltf, &instancesAttribs));
+    tiles.emplace_back(std::move(b3dm));
+    TileBuffer cmpt = createCMPT(std::move(tiles));
+    REQUIRE(cmpt.getByteLength() == sizeof(CmptHeader) + 2 * b3dmContent.size());
+
+    // written in one pass, so a stream that can't seek back gets the same bytes
+    std::ostringstream ss;
+    cmpt.write(ss);
+    std::string cmptContent = ss.str();
+    REQUIRE(cmptContent == cmpt.toString());
+
+    CmptHeader header;
+    std::memcpy(&header, cmptContent.data(), sizeof(header));
+    REQUIRE(std::string(header.magic, 4) == "cmpt");
+    REQUIRE(header.byteLength == cmptContent.size());
+    REQUIRE(header.titleLength == 2);
+    REQUIRE(cmptContent.substr(sizeof(header) + b3dmContent.size()) == b3dmContent);
+}
+
+static nlohmann::json readSubtree(const std::string &subtree, std::vector<uint8_t> &buffer)
+{
+    SubtreeHeader header;
+    REQUIRE(subtree.size() >= sizeof(header));
+    std::memcpy(&header, subtree.data(), sizeof(header));
+    REQUIRE(std::string(header.magic, 4) == "subt");
+    REQUIRE(header.version == 1);
+    REQUIRE(header.jsonByteLength % 8 == 0);
+    REQUIRE(sizeof(header) + header.jsonByteLength + header.binaryByteLength == subtree.size());
+
+    buffer.assign(subtree.begin() + static_cast<std::ptrdiff_t>(sizeof(header) + header.jsonByteLength),
+                  subtree.end());
+    return nlohmann::json::parse(subtree.substr(sizeof(header), header.jsonByteLength));
+}
+
+TEST_CASE("Test tileset geometric error comes from measured content error", "[TileFormatIO]")
+{
+    CDBGeoCell geoCell(32, -118);
+    auto createTile = [&](int level, std::optional<float> geometricError) {
+        CDBTile tile(geoCell, CDBDataset::Elevation, 1, 1, level, 0, 0);
+        tile.setCustomContentURI(tile.getRelativePath().filename().string() + ".b3dm");
+        if (geometricError) {
+            tile.setGeometricError(*geometricError);
+        }
+
+        return tile;
+    };
+
+    SECTION("Test tile never has less error than its children")
+    {
+        CDBTileset tileset;
+        tileset.insertTile(createTile(-10, 5.0f));
+        tileset.insertTile(createTile(-9, 1.0f));
+        tileset.insertTile(createTile(-8, 3.0f));
+        tileset.insertTile(createTile(-7, 4.0f));
+
+        std::ostringstream ss;
+        writeToTilesetJson(tileset, true, ss);
+        auto tilesetJson = nlohmann::json::parse(ss.str());
+        auto tile = tilesetJson["root"];
+        REQUIRE(tilesetJson["geometricError"] == Approx(5.0f));
+        REQUIRE(tile["geometricError"] == Approx(5.0f));
+        tile = tile["children"][0];
+        REQUIRE(tile["geometricError"] == Approx(3.0f));
+        tile = tile["children"][0];
+        REQUIRE(tile["geometricError"] == Approx(3.0f));
+        tile = tile["children"][0];
+        REQUIRE(tile["geometricError"] == Approx(0.0f));
+    }
+
+    SECTION("Test tile without measured error halves the error of its parent")
+    {
+        CDBTileset tileset;
+        tileset.insertTile(createTile(-10, std::nullopt));
+        tileset.insertTile(createTile(-9, std::nullopt));
+        tileset.insertTile(createTile(-8, 2.0f));
+        tileset.insertTile(createTile(-7, std::nullopt));
+
+        std::ostringstream ss;
+        writeToTilesetJson(tileset, true, ss);
+        auto tilesetJson = nlohmann::json::parse(ss.str());
+        auto tile = tilesetJson["root"];
+        REQUIRE(tile["geometricError"] == Approx(300000.0f));
+        tile = tile["children"][0];
+        REQUIRE(tile["geometricError"] == Approx(150000.0f));
+        tile = tile["children"][0];
+        REQUIRE(tile["geometricError"] == Approx(2.0f));
+    }
+
+    SECTION("Test tile without content uses its measured error")
+    {
+        CDBTileset tileset;
+        CDBTile root(geoCell, CDBDataset::Elevation, 1, 1, -10, 0, 0);
+        root.setGeometricError(7.0f);
+        tileset.insertTile(root);
+        tileset.insertTile(createTile(-9, 2.0f));
+        tileset.insertTile(createTile(-8, std::nullopt));
+
+        std::ostringstream ss;
+        writeToTilesetJson(tileset, true, ss);
+        auto tilesetJson = nlohmann::json::parse(ss.str());
+        auto tile = tilesetJson["root"];
+        REQUIRE(tile.find("content") == tile.end());
+        REQUIRE(tilesetJson["geometricError"] == Approx(7.0f));
+        REQUIRE(tile["geometricError"] == Approx(7.0f));
+        tile = tile["children"][0];
+        REQUIRE(tile["geometricError"] == Approx(2.0f));
+    }
+}
+
+TEST_CASE("Test tileset requires the string dictionary extension of its contents", "[TileFormatIO]")
+{
+    CDBGeoCell geoCell(32, -118);
+    CDBTileset tileset;
+    CDBTile tile(geoCell, CDBDataset::RoadNetwork, 2, 3, 0, 0, 0);
+    tile.setCustomContentURI("tile.b3dm");
+    tileset.insertTile(tile);
+
+    std::ostringstream ss;
+    writeToTilesetJson(tileset, true, ss);
+    auto tilesetJson = nlohmann::json::parse(ss.str());
+    REQUIRE(!tilesetJson.contains("extensionsUsed"));
+    REQUIRE(!tilesetJson.contains("extensionsRequired"));
+
+    std::ostringstream dictionaryStream;
+    writeToTilesetJson(tileset, true, dictionaryStream, false, true);
+    auto dictionaryJson = nlohmann::json::parse(dictionaryStream.str());
+    REQUIRE(dictionaryJson["extensionsUsed"] == nlohmann::json({"CDB_string_dictionary"}));
+    REQUIRE(dictionaryJson["extensionsRequired"] == nlohmann::json({"CDB_string_dictionary"}));
+}
+
+TEST_CASE("Test writing tileset with oriented bounding boxes", "[TileFormatIO]")
+{
+    CDBGeoCell geoCell(32, -118);
+    CDBTileset tileset;
+    CDBTile tile(geoCell, CDBDataset::Elevation, 1, 1, 1, 1, 0);
+    tile.setCustomContentURI("tile.b3dm");
+    tile.expandHeights(100.0, 500.0);
+    tileset.insertTile(tile);
+
+    std::ostringstream regionStream;
+    writeToTilesetJson(tileset, true, regionStream);
+    auto regionJson = nlohmann::json::parse(regionStream.str());
+    auto rootRegion = regionJson["root"]["boundingVolume"]["region"];
+    REQUIRE(rootRegion[4] == Approx(100.0));
+    REQUIRE(rootRegion[5] == Approx(500.0));
+
+    std::ostringstream boxStream;
+    writeToTilesetJson(tileset, true, boxStream, true);
+    auto boxJson = nlohmann::json::parse(boxStream.str());
+    auto tileJson = boxJson["root"];
+    while (tileJson.contains("children")) {
+        tileJson = tileJson["children"][0];
+    }
+
+    REQUIRE(!tileJson["boundingVolume"].contains("region"));
+    auto box = tileJson["boundingVolume"]["box"].get<std::vector<double>>();
+    REQUIRE(box.size() == 12);
+
+    // every corner of the region at both heights is inside the box
+    const auto &ellipsoid = Core::Ellipsoid::WGS84;
+    const auto &rectangle = tile.getBoundRegion().getRectangle();
+    glm::dvec3 center(box[0], box[1], box[2]);
+    glm::dvec3 halfAxes[3] = {glm::dvec3(box[3], box[4], box[5]),
+                              glm::dvec3(box[6], box[7], box[8]),
+                              glm::dvec3(box[9], box[10], box[11])};
+    for (double longitude : {rectangle.getWest(), rectangle.getEast()}) {
+        for (double latitude : {rectangle.getSouth(), rectangle.getNorth()}) {
+            for (double height : {100.0, 500.0}) {
+                glm::dvec3 position = ellipsoid.cartographicToCartesian(
+                    Core::Cartographic(longitude, latitude, height));
+                for (const auto &halfAxis : halfAxes) {
+                    double distance = glm::dot(position - center, halfAxis) / glm::dot(halfAxis, halfAxis);
+                    REQUIRE(glm::abs(distance) <= 1.0 + 1e-9);
+                }
+            }
+        }
+    }
+
+    // the height range is 400 meters, so the up axis is about 200 meters long when the tile is small
+    REQUIRE(glm::length(halfAxes[2]) < 400.0);
+}
+
+TEST_CASE("Test writing tileset with implicit tiling", "[TileFormatIO]")
+{
+    CDBGeoCell geoCell(32, -118);
+    CDBTileset tileset;
+    std::vector<CDBTile> tiles{CDBTile(geoCell, CDBDataset::Elevation, 1, 1, -10, 0, 0),
+                               CDBTile(geoCell, CDBDataset::Elevation, 1, 1, 0, 0, 0),
+                               CDBTile(geoCell, CDBDataset::Elevation, 1, 1, 1, 1, 0),
+                               CDBTile(geoCell, CDBDataset::Elevation, 1, 1, 6, 5, 9)};
+    for (auto &tile : tiles) {
+        if (tile.getLevel() < 0) {
+            tile.setCustomContentURI(tile.getRelativePath().filename().string() + ".b3dm");
+        } else {
+            tile.setCustomContentURI(getImplicitTileContentURI(tile, ".b3dm"));
+        }
+
+        tileset.insertTile(tile);
+    }
+
+    REQUIRE(getImplicitTileContentURI(tiles.back(), ".b3dm") == "N32W118_D001_S001_T001_L6_U5_R9.b3dm");
+
+    std::map<std::filesystem::path, std::string> subtrees;
+    std::ostringstream ss;
+    writeToImplicitTilesetJson(tileset,
+                               true,
+                               ss,
+                               [&](const std::filesystem::path &subtreePath, const std::string &subtree) {
+                                   subtrees.insert({subtreePath, subtree});
+                               });
+
+    // negative levels are written explicitly down to the implicit root at level 0
+    auto tilesetJson = nlohmann::json::parse(ss.str());
+    REQUIRE(tilesetJson["asset"]["version"] == "1.1");
+    auto implicitRoot = tilesetJson["root"];
+    REQUIRE(implicitRoot.contains("content"));
+    for (int level = -10; level < 0; ++level) {
+        REQUIRE(implicitRoot["children"].size() == 1);
+        implicitRoot = implicitRoot["children"][0];
+    }
+
+    REQUIRE(!implicitRoot.contains("children"));
+    REQUIRE(implicitRoot["content"]["uri"] == "N32W118_D001_S001_T001_L{level}_U{y}_R{x}.b3dm");
+    REQUIRE(implicitRoot["implicitTiling"]["subdivisionScheme"] == "QUADTREE");
+    REQUIRE(implicitRoot["implicitTiling"]["availableLevels"] == 7);
+    REQUIRE(implicitRoot["implicitTiling"]["subtreeLevels"] == 6);
+    REQUIRE(implicitRoot["implicitTiling"]["subtrees"]["uri"] == "Subtrees/{level}_{x}_{y}.subtree");
+
+    REQUIRE(subtrees.size() == 2);
+    REQUIRE(subtrees.count("Subtrees/0_0_0.subtree") == 1);
+    REQUIRE(subtrees.count("Subtrees/6_9_5.subtree") == 1);
+
+    SECTION("Test root subtree records the tiles above the deepest level")
+    {
+        std::vector<uint8_t> buffer;
+        auto subtreeJson = readSubtree(subtrees["Subtrees/0_0_0.subtree"], buffer);
+
+        // level 0, both tiles of level 1 and one ancestor of the level 6 tile on each level in between
+        const auto &tileAvailability = subtreeJson["tileAvailability"];
+        REQUIRE(tileAvailability["availableCount"] == 7);
+        size_t tileBitstream = tileAvailability["bitstream"];
+        size_t tileOffset = subtreeJson["bufferViews"][tileBitstream]["byteOffset"];
+        REQUIRE(buffer[tileOffset] == 0b101011);
+
+        const auto &contentAvailability = subtreeJson["contentAvailability"][0];
+        REQUIRE(contentAvailability["availableCount"] == 2);
+        size_t contentBitstream = contentAvailability["bitstream"];
+        size_t contentOffset = subtreeJson["bufferViews"][contentBitstream]["byteOffset"];
+        REQUIRE(buffer[contentOffset] == 0b1001);
+
+        // the level 6 tile at x 9 and y 5 has the morton index 99
+        const auto &childSubtreeAvailability = subtreeJson["childSubtreeAvailability"];
+        REQUIRE(childSubtreeAvailability["availableCount"] == 1);
+        size_t childBitstream = childSubtreeAvailability["bitstream"];
+        size_t childOffset = subtreeJson["bufferViews"][childBitstream]["byteOffset"];
+        REQUIRE(buffer[childOffset + 99 / 8] == 1 << (99 % 8));
+    }
+
+    SECTION("Test subtree without child subtrees uses constant availability")
+    {
+        std::vector<uint8_t> buffer;
+        auto subtreeJson = readSubtree(subtrees["Subtrees/6_9_5.subtree"], buffer);
+        REQUIRE(subtreeJson["tileAvailability"]["availableCount"] == 1);
+        REQUIRE(subtreeJson["contentAvailability"][0]["availableCount"] == 1);
+        REQUIRE(subtreeJson["childSubtreeAvailability"]["constant"] == 0);
+    }
+}
@@ -0,0 +1,72 @@
+#include "Utility.h"
+#include "catch2/catch.hpp"
+#include <numeric>
+
+using namespace CDBTo3DTiles;
+
+TEST_CASE("Test running ranges in parallel", "[Utility]")
+{
+    SECTION("Test ranges cover every item once and in order")
+    {
+        for (size_t rangeCount = 1; rangeCount <= 8; ++rangeCount) {
+            std::vector<std::vector<size_t>> rangeItems(rangeCount);
+            parallelForRanges(1000, rangeCount, [&](size_t range, size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    rangeItems[range].emplace_back(i);
+                }
+            });
+
+            std::vector<size_t> items;
+            for (const auto &range : rangeItems) {
+                items.insert(items.end(), range.begin(), range.end());
+            }
+
+            std::vector<size_t> expected(1000);
+            std::iota(expected.begin(), expected.end(), 0);
+            REQUIRE(items == expected);
+        }
+    }
+
+    SECTION("Test exceptions are rethrown on the calling thread")
+    {
+        REQUIRE_THROWS_AS(parallelForRanges(100,
+                                            4,
+                                            [](size_t range, size_t, size_t) {
+                                                if (range == 2) {
+                                                    throw std::runtime_error("range failed");
+                                                }
+                                            }),
+                          std::runtime_error);
+    }
+
+    SECTION("Test workers are reused across calls")
+    {
+        std::vector<size_t> rangeSums(4);
+        for (size_t call = 0; call < 1000; ++call) {
+            parallelForRanges(100, rangeSums.size(), [&](size_t range, size_t begin, size_t end) {
+                rangeSums[range] += end - begin;
+            });
+        }
+
+        REQUIRE(rangeSums == std::vector<size_t>(4, 25000));
+    }
+
+    SECTION("Test ranges that run ranges themselves run them on their own thread")
+    {
+        std::vector<std::vector<size_t>> innerCounts(4, std::vector<size_t>(4));
+        parallelForRanges(4, 4, [&](size_t range, size_t, size_t) {
+            parallelForRanges(40, 4, [&](size_t innerRange, size_t begin, size_t end) {
+                innerCounts[range][innerRange] = end - begin;
+            });
+        });
+
+        REQUIRE(innerCounts == std::vector<std::vector<size_t>>(4, std::vector<size_t>(4, 10)));
+    }
+
+    SECTION("Test range count is bounded by the minimum range size")
+    {
+        REQUIRE(getParallelRangeCount(10, 512) == 1);
+        REQUIRE(getParallelRangeCount(0, 512) == 1);
+        REQUIRE(getParallelRangeCount(1 << 20, 1) >= 1);
+    }
+}